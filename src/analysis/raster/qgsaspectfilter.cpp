@@ -17,6 +17,8 @@
 
 #include "qgsaspectfilter.h"
 
+#include <vector>
+
 QgsAspectFilter::QgsAspectFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
 {
@@ -43,3 +45,23 @@ float QgsAspectFilter::processNineCellWindow(
   }
 }
 
+void QgsAspectFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( rowAbove, row, rowBelow, derX.data(), derY.data(), width );
+
+  for ( int j = 0; j < width; ++j )
+  {
+    if ( derX[j] == mOutputNodataValue ||
+         derY[j] == mOutputNodataValue ||
+         ( derX[j] == 0.0 && derY[j] == 0.0 ) )
+    {
+      result[j] = mOutputNodataValue;
+    }
+    else
+    {
+      result[j] = 180.0 + atan2( derX[j], derY[j] ) * 180.0 / M_PI;
+    }
+  }
+}
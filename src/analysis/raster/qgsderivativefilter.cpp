@@ -17,6 +17,30 @@
 
 #include "qgsderivativefilter.h"
 
+namespace
+{
+
+  /**
+   * Adds the difference between the \a high and \a low cells of a row or column of three cells to \a sum, multiplied
+   * by \a factor. If one of the outer cells is nodata, the difference to the \a center cell is added with half the weight.
+   */
+  inline void addDifference( float low, float center, float high, float nodata, int factor, double &sum, int &weight )
+  {
+    const bool lowValid = low != nodata;
+    const bool centerValid = center != nodata;
+    const bool highValid = high != nodata;
+
+    //written with selects instead of branches, so that loops over rows of cells can be vectorized
+    const bool normal = lowValid && highValid; //the normal case
+    const bool lowHalf = !highValid && lowValid && centerValid; //probably 3x3 window is at the border
+    const bool highHalf = !lowValid && highValid && centerValid;
+    const float difference = normal ? high - low : ( lowHalf ? center - low : ( highHalf ? high - center : 0.0f ) );
+    sum += factor * difference;
+    weight += normal ? 2 * factor : ( lowHalf || highHalf ? factor : 0 );
+  }
+
+}
+
 QgsDerivativeFilter::QgsDerivativeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsNineCellFilter( inputFile, outputFile, outputFormat )
 {
@@ -30,57 +54,9 @@ float QgsDerivativeFilter::calcFirstDerX( float *x11, float *x21, float *x31, fl
 
   int weight = 0;
   double sum = 0;
-
-  //first row
-  if ( *x31 != mInputNodataValue && *x11 != mInputNodataValue ) //the normal case
-  {
-    sum += ( *x31 - *x11 );
-    weight += 2;
-  }
-  else if ( *x31 == mInputNodataValue && *x11 != mInputNodataValue && *x21 != mInputNodataValue ) //probably 3x3 window is at the border
-  {
-    sum += ( *x21 - *x11 );
-    weight += 1;
-  }
-  else if ( *x11 == mInputNodataValue && *x31 != mInputNodataValue && *x21 != mInputNodataValue ) //probably 3x3 window is at the border
-  {
-    sum += ( *x31 - *x21 );
-    weight += 1;
-  }
-
-  //second row
-  if ( *x32 != mInputNodataValue && *x12 != mInputNodataValue ) //the normal case
-  {
-    sum += 2 * ( *x32 - *x12 );
-    weight += 4;
-  }
-  else if ( *x32 == mInputNodataValue && *x12 != mInputNodataValue && *x22 != mInputNodataValue )
-  {
-    sum += 2 * ( *x22 - *x12 );
-    weight += 2;
-  }
-  else if ( *x12 == mInputNodataValue && *x32 != mInputNodataValue && *x22 != mInputNodataValue )
-  {
-    sum += 2 * ( *x32 - *x22 );
-    weight += 2;
-  }
-
-  //third row
-  if ( *x33 != mInputNodataValue && *x13 != mInputNodataValue ) //the normal case
-  {
-    sum += ( *x33 - *x13 );
-    weight += 2;
-  }
-  else if ( *x33 == mInputNodataValue && *x13 != mInputNodataValue && *x23 != mInputNodataValue )
-  {
-    sum += ( *x23 - *x13 );
-    weight += 1;
-  }
-  else if ( *x13 == mInputNodataValue && *x33 != mInputNodataValue && *x23 != mInputNodataValue )
-  {
-    sum += ( *x33 - *x23 );
-    weight += 1;
-  }
+  addDifference( *x11, *x21, *x31, mInputNodataValue, 1, sum, weight ); //first row
+  addDifference( *x12, *x22, *x32, mInputNodataValue, 2, sum, weight ); //second row
+  addDifference( *x13, *x23, *x33, mInputNodataValue, 1, sum, weight ); //third row
 
   if ( weight == 0 )
   {
@@ -95,59 +71,11 @@ float QgsDerivativeFilter::calcFirstDerY( float *x11, float *x21, float *x31, fl
   //the basic formula would be simple, but we need to test for nodata values...
   //return (((*x11 - *x13) + 2 * (*x21 - *x23) + (*x31 - *x33)) / ( 8 * mCellSizeY));
 
-  double sum = 0;
   int weight = 0;
-
-  //first row
-  if ( *x11 != mInputNodataValue && *x13 != mInputNodataValue ) //normal case
-  {
-    sum += ( *x11 - *x13 );
-    weight += 2;
-  }
-  else if ( *x11 == mInputNodataValue && *x13 != mInputNodataValue && *x12 != mInputNodataValue )
-  {
-    sum += ( *x12 - *x13 );
-    weight += 1;
-  }
-  else if ( *x31 == mInputNodataValue && *x11 != mInputNodataValue && *x12 != mInputNodataValue )
-  {
-    sum += ( *x11 - *x12 );
-    weight += 1;
-  }
-
-  //second row
-  if ( *x21 != mInputNodataValue && *x23 != mInputNodataValue )
-  {
-    sum += 2 * ( *x21 - *x23 );
-    weight += 4;
-  }
-  else if ( *x21 == mInputNodataValue && *x23 != mInputNodataValue && *x22 != mInputNodataValue )
-  {
-    sum += 2 * ( *x22 - *x23 );
-    weight += 2;
-  }
-  else if ( *x23 == mInputNodataValue && *x21 != mInputNodataValue && *x22 != mInputNodataValue )
-  {
-    sum += 2 * ( *x21 - *x22 );
-    weight += 2;
-  }
-
-  //third row
-  if ( *x31 != mInputNodataValue && *x33 != mInputNodataValue )
-  {
-    sum += ( *x31 - *x33 );
-    weight += 2;
-  }
-  else if ( *x31 == mInputNodataValue && *x33 != mInputNodataValue && *x32 != mInputNodataValue )
-  {
-    sum += ( *x32 - *x33 );
-    weight += 1;
-  }
-  else if ( *x33 == mInputNodataValue && *x31 != mInputNodataValue && *x32 != mInputNodataValue )
-  {
-    sum += ( *x31 - *x32 );
-    weight += 1;
-  }
+  double sum = 0;
+  addDifference( *x13, *x12, *x11, mInputNodataValue, 1, sum, weight ); //first column
+  addDifference( *x23, *x22, *x21, mInputNodataValue, 2, sum, weight ); //second column
+  addDifference( *x33, *x32, *x31, mInputNodataValue, 1, sum, weight ); //third column
 
   if ( weight == 0 )
   {
@@ -157,7 +85,24 @@ float QgsDerivativeFilter::calcFirstDerY( float *x11, float *x21, float *x31, fl
   return sum / ( weight * mCellSizeY * mZFactor );
 }
 
+void QgsDerivativeFilter::calcFirstDerivatives( const float *rowAbove, const float *row, const float *rowBelow, float *derX, float *derY, int width ) const
+{
+  //same as calcFirstDerX and calcFirstDerY, in a loop without calls the compiler cannot inline
+  for ( int j = 0; j < width; ++j )
+  {
+    int weightX = 0;
+    double sumX = 0;
+    addDifference( rowAbove[j], rowAbove[j + 1], rowAbove[j + 2], mInputNodataValue, 1, sumX, weightX );
+    addDifference( row[j], row[j + 1], row[j + 2], mInputNodataValue, 2, sumX, weightX );
+    addDifference( rowBelow[j], rowBelow[j + 1], rowBelow[j + 2], mInputNodataValue, 1, sumX, weightX );
 
+    int weightY = 0;
+    double sumY = 0;
+    addDifference( rowBelow[j], row[j], rowAbove[j], mInputNodataValue, 1, sumY, weightY );
+    addDifference( rowBelow[j + 1], row[j + 1], rowAbove[j + 1], mInputNodataValue, 2, sumY, weightY );
+    addDifference( rowBelow[j + 2], row[j + 2], rowAbove[j + 2], mInputNodataValue, 1, sumY, weightY );
 
-
-
+    derX[j] = weightX == 0 ? mOutputNodataValue : static_cast< float >( sumX / ( weightX * mCellSizeX * mZFactor ) );
+    derY[j] = weightY == 0 ? mOutputNodataValue : static_cast< float >( sumY / ( weightY * mCellSizeY * mZFactor ) );
+  }
+}
@@ -38,6 +38,15 @@ class ANALYSIS_EXPORT QgsDerivativeFilter : public QgsNineCellFilter
     float calcFirstDerX( float *x11, float *x21, float *x31, float *x12, float *x22, float *x32, float *x13, float *x23, float *x33 );
     //! Calculates the first order derivative in y-direction according to Horn (1981)
     float calcFirstDerY( float *x11, float *x21, float *x31, float *x12, float *x22, float *x32, float *x13, float *x23, float *x33 );
+
+    /**
+     * Calculates the first order derivatives in x- and y-direction of a row of \a width cells in the same way
+     * as calcFirstDerX() and calcFirstDerY(), and stores them in \a derX and \a derY. The input rows
+     * are laid out as for processNineCellRow().
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    void calcFirstDerivatives( const float *rowAbove, const float *row, const float *rowBelow, float *derX, float *derY, int width ) const;
 };
 
 #endif // QGSDERIVATIVEFILTER_H
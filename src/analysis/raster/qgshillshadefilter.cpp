@@ -17,6 +17,8 @@
 
 #include "qgshillshadefilter.h"
 
+#include <vector>
+
 QgsHillshadeFilter::QgsHillshadeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat, double lightAzimuth,
                                         double lightAngle )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
@@ -51,3 +53,37 @@ float QgsHillshadeFilter::processNineCellWindow( float *x11, float *x21, float *
   }
   return qMax( 0.0, 255.0 * ( ( cos( zenith_rad ) * cos( slope_rad ) ) + ( sin( zenith_rad ) * sin( slope_rad ) * cos( azimuth_rad - aspect_rad ) ) ) );
 }
+
+void QgsHillshadeFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( rowAbove, row, rowBelow, derX.data(), derY.data(), width );
+
+  //the light direction is the same for all cells
+  float zenith_rad = mLightAngle * M_PI / 180.0;
+  float azimuth_rad = mLightAzimuth * M_PI / 180.0;
+  const auto cos_zenith = cos( zenith_rad );
+  const auto sin_zenith = sin( zenith_rad );
+
+  for ( int j = 0; j < width; ++j )
+  {
+    if ( derX[j] == mOutputNodataValue || derY[j] == mOutputNodataValue )
+    {
+      result[j] = mOutputNodataValue;
+      continue;
+    }
+
+    float slope_rad = atan( sqrt( derX[j] * derX[j] + derY[j] * derY[j] ) );
+    float aspect_rad = 0;
+    if ( derX[j] == 0 && derY[j] == 0 ) //aspect undefined, take a neutral value
+    {
+      aspect_rad = azimuth_rad / 2.0;
+    }
+    else
+    {
+      aspect_rad = M_PI + atan2( derX[j], derY[j] );
+    }
+    result[j] = qMax( 0.0, 255.0 * ( ( cos_zenith * cos( slope_rad ) ) + ( sin_zenith * sin( slope_rad ) * cos( azimuth_rad - aspect_rad ) ) ) );
+  }
+}
@@ -20,6 +20,20 @@
 #include "cpl_string.h"
 #include <QProgressDialog>
 #include <QFile>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+  //! Number of cells of the rows read at once
+  const int STRIP_CELLS = 1 << 20;
+
+  //! Minimum number of rows read at once, so that wide rasters still process several rows in parallel
+  const int MIN_STRIP_ROWS = 16;
+}
 
 QgsNineCellFilter::QgsNineCellFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : mInputFile( inputFile )
@@ -96,24 +110,26 @@ int QgsNineCellFilter::processRaster( QProgressDialog *p )
     return 6;
   }
 
-  //keep only three scanlines in memory at a time
-  float *scanLine1 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
-  float *scanLine2 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
-  float *scanLine3 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
-
-  float *resultLine = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+  //the rows are processed in strips. The input buffer holds the rows of a strip plus the row above and below it,
+  //and each row has an additional column on the left and right side. Values outside the layer extent
+  //(if the 3x3 window is on the border) are sent to the processing method as (input) nodata values
+  const int stripRows = qBound( 1, qMax( MIN_STRIP_ROWS, STRIP_CELLS / xSize ), ySize );
+  const int stride = xSize + 2;
+  std::vector< float > inputRows( static_cast< size_t >( stripRows + 2 ) * stride, mInputNodataValue );
+  std::vector< float > resultRows( static_cast< size_t >( stripRows ) * xSize );
+  std::vector< int > rowIndices( stripRows );
+  std::iota( rowIndices.begin(), rowIndices.end(), 0 );
 
   if ( p )
   {
     p->setMaximum( ySize );
   }
 
-  //values outside the layer extent (if the 3x3 window is on the border) are sent to the processing method as (input) nodata values
-  for ( int i = 0; i < ySize; ++i )
+  for ( int startRow = 0; startRow < ySize; startRow += stripRows )
   {
     if ( p )
     {
-      p->setValue( i );
+      p->setValue( startRow );
     }
 
     if ( p && p->wasCanceled() )
@@ -121,62 +137,30 @@ int QgsNineCellFilter::processRaster( QProgressDialog *p )
       break;
     }
 
-    if ( i == 0 )
-    {
-      //fill scanline 1 with (input) nodata for the values above the first row and feed scanline2 with the first row
-      for ( int a = 0; a < xSize; ++a )
-      {
-        scanLine1[a] = mInputNodataValue;
-      }
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, 0, xSize, 1, scanLine2, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( "Raster IO Error" );
-      }
-    }
-    else
+    const int rows = qMin( stripRows, ySize - startRow );
+    if ( startRow + rows == ySize )
     {
-      //normally fetch only scanLine3 and release scanline 1 if we move forward one row
-      CPLFree( scanLine1 );
-      scanLine1 = scanLine2;
-      scanLine2 = scanLine3;
-      scanLine3 = ( float * ) CPLMalloc( sizeof( float ) * xSize );
+      //fill the row below the bottom with nodata values
+      std::fill( inputRows.begin() + static_cast< size_t >( rows + 1 ) * stride, inputRows.begin() + static_cast< size_t >( rows + 2 ) * stride, mInputNodataValue );
     }
 
-    if ( i == ySize - 1 ) //fill the row below the bottom with nodata values
-    {
-      for ( int a = 0; a < xSize; ++a )
-      {
-        scanLine3[a] = mInputNodataValue;
-      }
-    }
-    else
+    //read the strip with the neighbour rows inside the layer extent
+    const int firstRow = qMax( 0, startRow - 1 );
+    const int lastRow = qMin( ySize - 1, startRow + rows );
+    float *firstValue = &inputRows[ static_cast< size_t >( firstRow - startRow + 1 ) * stride + 1 ];
+    if ( GDALRasterIO( rasterBand, GF_Read, 0, firstRow, xSize, lastRow - firstRow + 1, firstValue, xSize, lastRow - firstRow + 1,
+                       GDT_Float32, 0, sizeof( float ) * stride ) != CE_None )
     {
-      if ( GDALRasterIO( rasterBand, GF_Read, 0, i + 1, xSize, 1, scanLine3, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( "Raster IO Error" );
-      }
+      QgsDebugMsg( "Raster IO Error" );
     }
 
-    for ( int j = 0; j < xSize; ++j )
+    QtConcurrent::blockingMap( rowIndices.begin(), rowIndices.begin() + rows, [&]( int row )
     {
-      if ( j == 0 )
-      {
-        resultLine[j] = processNineCellWindow( &mInputNodataValue, &scanLine1[j], &scanLine1[j + 1], &mInputNodataValue, &scanLine2[j],
-                                               &scanLine2[j + 1], &mInputNodataValue, &scanLine3[j], &scanLine3[j + 1] );
-      }
-      else if ( j == xSize - 1 )
-      {
-        resultLine[j] = processNineCellWindow( &scanLine1[j - 1], &scanLine1[j], &mInputNodataValue, &scanLine2[j - 1], &scanLine2[j],
-                                               &mInputNodataValue, &scanLine3[j - 1], &scanLine3[j], &mInputNodataValue );
-      }
-      else
-      {
-        resultLine[j] = processNineCellWindow( &scanLine1[j - 1], &scanLine1[j], &scanLine1[j + 1], &scanLine2[j - 1], &scanLine2[j],
-                                               &scanLine2[j + 1], &scanLine3[j - 1], &scanLine3[j], &scanLine3[j + 1] );
-      }
-    }
+      const float *rowAbove = &inputRows[ static_cast< size_t >( row ) * stride ];
+      processNineCellRow( rowAbove, rowAbove + stride, rowAbove + 2 * stride, &resultRows[ static_cast< size_t >( row ) * xSize ], xSize );
+    } );
 
-    if ( GDALRasterIO( outputRasterBand, GF_Write, 0, i, xSize, 1, resultLine, xSize, 1, GDT_Float32, 0, 0 ) != CE_None )
+    if ( GDALRasterIO( outputRasterBand, GF_Write, 0, startRow, xSize, rows, resultRows.data(), xSize, rows, GDT_Float32, 0, 0 ) != CE_None )
     {
       QgsDebugMsg( "Raster IO Error" );
     }
@@ -187,11 +171,6 @@ int QgsNineCellFilter::processRaster( QProgressDialog *p )
     p->setValue( ySize );
   }
 
-  CPLFree( resultLine );
-  CPLFree( scanLine1 );
-  CPLFree( scanLine2 );
-  CPLFree( scanLine3 );
-
   GDALClose( inputDataset );
 
   if ( p && p->wasCanceled() )
@@ -205,6 +184,19 @@ int QgsNineCellFilter::processRaster( QProgressDialog *p )
   return 0;
 }
 
+void QgsNineCellFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  //processNineCellWindow does not modify the values
+  float *scanLine1 = const_cast< float * >( rowAbove );
+  float *scanLine2 = const_cast< float * >( row );
+  float *scanLine3 = const_cast< float * >( rowBelow );
+  for ( int j = 0; j < width; ++j )
+  {
+    result[j] = processNineCellWindow( &scanLine1[j], &scanLine1[j + 1], &scanLine1[j + 2], &scanLine2[j], &scanLine2[j + 1],
+                                       &scanLine2[j + 2], &scanLine3[j], &scanLine3[j + 1], &scanLine3[j + 2] );
+  }
+}
+
 GDALDatasetH QgsNineCellFilter::openInputFile( int &nCellsX, int &nCellsY )
 {
   GDALDatasetH inputDataset = GDALOpen( mInputFile.toUtf8().constData(), GA_ReadOnly );
@@ -36,7 +36,8 @@ class ANALYSIS_EXPORT QgsNineCellFilter
     QgsNineCellFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat );
     virtual ~QgsNineCellFilter() = default;
 
-    /** Starts the calculation, reads from mInputFile and stores the result in mOutputFile
+    /** Starts the calculation, reads from mInputFile and stores the result in mOutputFile. The raster is read in
+      strips of rows, and the rows of each strip are processed in parallel.
       @param p progress dialog that receives update and that is checked for abort. 0 if no progress bar is needed.
       @return 0 in case of success*/
     int processRaster( QProgressDialog *p );
@@ -55,11 +56,27 @@ class ANALYSIS_EXPORT QgsNineCellFilter
     void setOutputNodataValue( double value ) { mOutputNodataValue = value; }
 
     /** Calculates output value from nine input values. The input values and the output value can be equal to the
-      nodata value if not present or outside of the border. Must be implemented by subclasses*/
+      nodata value if not present or outside of the border. Must be implemented by subclasses.
+      processRaster() processes several rows at once, so this method may be called from several threads at the same time*/
     virtual float processNineCellWindow( float *x11, float *x21, float *x31,
                                          float *x12, float *x22, float *x32,
                                          float *x13, float *x23, float *x33 ) = 0;
 
+    /**
+     * Calculates the output values of a row of \a width cells and stores them in \a result. \a row holds
+     * the input values of the row, \a rowAbove and \a rowBelow the values of the neighbour rows.
+     * Each of them contains width + 2 values: the first and last value are the neighbours left of the
+     * first and right of the last cell, and are (input) nodata values. Rows outside the layer extent
+     * are filled with nodata values as well.
+     *
+     * The default implementation calls processNineCellWindow() for each cell. Subclasses may reimplement
+     * it with a loop over the row which avoids the virtual call per cell.
+     * processRaster() may call this method from several threads at the same time.
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    virtual void processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width );
+
   private:
     //default constructor forbidden. We need input file, output file and format obligatory
     QgsNineCellFilter();
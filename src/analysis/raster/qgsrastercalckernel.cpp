@@ -0,0 +1,413 @@
+/***************************************************************************
+                          qgsrastercalckernel.cpp
+                          -----------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrastercalckernel.h"
+#include "qgsrasterblock.h"
+
+#include <qmath.h>
+
+#include <algorithm>
+#include <vector>
+
+///@cond PRIVATE
+
+namespace
+{
+  //! Number of cells held by a register
+  const int CHUNK_SIZE = 256;
+
+  // the operators, with the same results as in QgsRasterMatrix
+
+  struct Plus
+  {
+    double operator()( double a, double b ) const { return a + b; }
+  };
+
+  struct Minus
+  {
+    double operator()( double a, double b ) const { return a - b; }
+  };
+
+  struct Multiply
+  {
+    double operator()( double a, double b ) const { return a * b; }
+  };
+
+  struct Divide
+  {
+    double nodata;
+    double operator()( double a, double b ) const { return b == 0 ? nodata : a / b; }
+  };
+
+  struct Power
+  {
+    double nodata;
+    double operator()( double a, double b ) const
+    {
+      if ( ( a == 0 && b < 0 ) || ( a < 0 && ( b - floor( b ) ) > 0 ) )
+        return nodata;
+      return qPow( a, b );
+    }
+  };
+
+  struct Equal
+  {
+    double operator()( double a, double b ) const { return a == b ? 1.0 : 0.0; }
+  };
+
+  struct NotEqual
+  {
+    double operator()( double a, double b ) const { return a == b ? 0.0 : 1.0; }
+  };
+
+  struct GreaterThan
+  {
+    double operator()( double a, double b ) const { return a > b ? 1.0 : 0.0; }
+  };
+
+  struct LesserThan
+  {
+    double operator()( double a, double b ) const { return a < b ? 1.0 : 0.0; }
+  };
+
+  struct GreaterEqual
+  {
+    double operator()( double a, double b ) const { return a >= b ? 1.0 : 0.0; }
+  };
+
+  struct LesserEqual
+  {
+    double operator()( double a, double b ) const { return a <= b ? 1.0 : 0.0; }
+  };
+
+  struct And
+  {
+    double operator()( double a, double b ) const { return a && b ? 1.0 : 0.0; }
+  };
+
+  struct Or
+  {
+    double operator()( double a, double b ) const { return a || b ? 1.0 : 0.0; }
+  };
+
+  struct SquareRoot
+  {
+    double nodata;
+    double operator()( double a ) const { return a < 0 ? nodata : sqrt( a ); }
+  };
+
+  struct Sin
+  {
+    double operator()( double a ) const { return sin( a ); }
+  };
+
+  struct Cos
+  {
+    double operator()( double a ) const { return cos( a ); }
+  };
+
+  struct Tan
+  {
+    double operator()( double a ) const { return tan( a ); }
+  };
+
+  struct ASin
+  {
+    double operator()( double a ) const { return asin( a ); }
+  };
+
+  struct ACos
+  {
+    double operator()( double a ) const { return acos( a ); }
+  };
+
+  struct ATan
+  {
+    double operator()( double a ) const { return atan( a ); }
+  };
+
+  struct ChangeSign
+  {
+    double operator()( double a ) const { return -a; }
+  };
+
+  struct Log
+  {
+    double nodata;
+    double operator()( double a ) const { return a <= 0 ? nodata : ::log( a ); }
+  };
+
+  struct Log10
+  {
+    double nodata;
+    double operator()( double a ) const { return a <= 0 ? nodata : ::log10( a ); }
+  };
+
+  //! Operations with nodata values always generate nodata
+  template <typename Function>
+  void binaryLoop( double *target, const double *left, const double *right, int count, double nodata, Function function )
+  {
+    for ( int i = 0; i < count; ++i )
+    {
+      target[i] = left[i] == nodata || right[i] == nodata ? nodata : function( left[i], right[i] );
+    }
+  }
+
+  template <typename Function>
+  void unaryLoop( double *target, const double *values, int count, double nodata, Function function )
+  {
+    for ( int i = 0; i < count; ++i )
+    {
+      target[i] = values[i] == nodata ? nodata : function( values[i] );
+    }
+  }
+
+  bool isUnary( QgsRasterCalcNode::Operator op )
+  {
+    switch ( op )
+    {
+      case QgsRasterCalcNode::opSQRT:
+      case QgsRasterCalcNode::opSIN:
+      case QgsRasterCalcNode::opCOS:
+      case QgsRasterCalcNode::opTAN:
+      case QgsRasterCalcNode::opASIN:
+      case QgsRasterCalcNode::opACOS:
+      case QgsRasterCalcNode::opATAN:
+      case QgsRasterCalcNode::opSIGN:
+      case QgsRasterCalcNode::opLOG:
+      case QgsRasterCalcNode::opLOG10:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  //! Applies an operator to \a count values. Returns false if the operator is unknown
+  bool applyOperator( QgsRasterCalcNode::Operator op, double *target, const double *left, const double *right, int count, double nodata )
+  {
+    switch ( op )
+    {
+      case QgsRasterCalcNode::opPLUS:
+        binaryLoop( target, left, right, count, nodata, Plus() );
+        return true;
+      case QgsRasterCalcNode::opMINUS:
+        binaryLoop( target, left, right, count, nodata, Minus() );
+        return true;
+      case QgsRasterCalcNode::opMUL:
+        binaryLoop( target, left, right, count, nodata, Multiply() );
+        return true;
+      case QgsRasterCalcNode::opDIV:
+        binaryLoop( target, left, right, count, nodata, Divide{ nodata } );
+        return true;
+      case QgsRasterCalcNode::opPOW:
+        binaryLoop( target, left, right, count, nodata, Power{ nodata } );
+        return true;
+      case QgsRasterCalcNode::opEQ:
+        binaryLoop( target, left, right, count, nodata, Equal() );
+        return true;
+      case QgsRasterCalcNode::opNE:
+        binaryLoop( target, left, right, count, nodata, NotEqual() );
+        return true;
+      case QgsRasterCalcNode::opGT:
+        binaryLoop( target, left, right, count, nodata, GreaterThan() );
+        return true;
+      case QgsRasterCalcNode::opLT:
+        binaryLoop( target, left, right, count, nodata, LesserThan() );
+        return true;
+      case QgsRasterCalcNode::opGE:
+        binaryLoop( target, left, right, count, nodata, GreaterEqual() );
+        return true;
+      case QgsRasterCalcNode::opLE:
+        binaryLoop( target, left, right, count, nodata, LesserEqual() );
+        return true;
+      case QgsRasterCalcNode::opAND:
+        binaryLoop( target, left, right, count, nodata, And() );
+        return true;
+      case QgsRasterCalcNode::opOR:
+        binaryLoop( target, left, right, count, nodata, Or() );
+        return true;
+      case QgsRasterCalcNode::opSQRT:
+        unaryLoop( target, left, count, nodata, SquareRoot{ nodata } );
+        return true;
+      case QgsRasterCalcNode::opSIN:
+        unaryLoop( target, left, count, nodata, Sin() );
+        return true;
+      case QgsRasterCalcNode::opCOS:
+        unaryLoop( target, left, count, nodata, Cos() );
+        return true;
+      case QgsRasterCalcNode::opTAN:
+        unaryLoop( target, left, count, nodata, Tan() );
+        return true;
+      case QgsRasterCalcNode::opASIN:
+        unaryLoop( target, left, count, nodata, ASin() );
+        return true;
+      case QgsRasterCalcNode::opACOS:
+        unaryLoop( target, left, count, nodata, ACos() );
+        return true;
+      case QgsRasterCalcNode::opATAN:
+        unaryLoop( target, left, count, nodata, ATan() );
+        return true;
+      case QgsRasterCalcNode::opSIGN:
+        unaryLoop( target, left, count, nodata, ChangeSign() );
+        return true;
+      case QgsRasterCalcNode::opLOG:
+        unaryLoop( target, left, count, nodata, Log{ nodata } );
+        return true;
+      case QgsRasterCalcNode::opLOG10:
+        unaryLoop( target, left, count, nodata, Log10{ nodata } );
+        return true;
+      case QgsRasterCalcNode::opNONE:
+        break;
+    }
+    return false;
+  }
+}
+
+QgsRasterCalcKernel::QgsRasterCalcKernel( const QgsRasterCalcNode *tree, double nodataValue )
+  : mNodataValue( nodataValue )
+{
+  mResult = compile( tree, 0 );
+
+  // constants are stored after the intermediate results
+  auto registerIndex = [this]( int reg ) { return reg < 0 ? mStackSize - 1 - reg : reg; };
+  for ( Instruction &instruction : mInstructions )
+  {
+    instruction.left = registerIndex( instruction.left );
+    instruction.right = registerIndex( instruction.right );
+  }
+  mResult = registerIndex( mResult );
+}
+
+void QgsRasterCalcKernel::evaluate( const QVector< QgsRasterBlock * > &blocks, qgssize offset, int count, float *result ) const
+{
+  if ( !mValid )
+    return;
+
+  std::vector< double > registers( static_cast< size_t >( mStackSize + mConstants.size() ) * CHUNK_SIZE );
+  for ( int i = 0; i < mConstants.size(); ++i )
+  {
+    std::fill_n( registers.begin() + static_cast< size_t >( mStackSize + i ) * CHUNK_SIZE, CHUNK_SIZE, mConstants.at( i ) );
+  }
+
+  for ( int start = 0; start < count; start += CHUNK_SIZE )
+  {
+    const int chunkCount = std::min( CHUNK_SIZE, count - start );
+    for ( const Instruction &instruction : mInstructions )
+    {
+      double *target = &registers[ static_cast< size_t >( instruction.target ) * CHUNK_SIZE ];
+      switch ( instruction.type )
+      {
+        case Load:
+        {
+          //also convert input no data to result no data
+          QgsRasterBlock *block = blocks.at( instruction.raster );
+          const qgssize index = offset + start;
+          for ( int i = 0; i < chunkCount; ++i )
+          {
+            target[i] = block->isNoData( index + i ) ? mNodataValue : block->value( index + i );
+          }
+          break;
+        }
+        case Unary:
+          applyOperator( instruction.op, target, &registers[ static_cast< size_t >( instruction.left ) * CHUNK_SIZE ], nullptr, chunkCount, mNodataValue );
+          break;
+        case Binary:
+          applyOperator( instruction.op, target, &registers[ static_cast< size_t >( instruction.left ) * CHUNK_SIZE ],
+                         &registers[ static_cast< size_t >( instruction.right ) * CHUNK_SIZE ], chunkCount, mNodataValue );
+          break;
+      }
+    }
+
+    const double *values = &registers[ static_cast< size_t >( mResult ) * CHUNK_SIZE ];
+    for ( int i = 0; i < chunkCount; ++i )
+    {
+      result[start + i] = static_cast< float >( values[i] );
+    }
+  }
+}
+
+int QgsRasterCalcKernel::compile( const QgsRasterCalcNode *node, int stack )
+{
+  if ( !node )
+  {
+    mValid = false;
+    return 0;
+  }
+
+  switch ( node->mType )
+  {
+    case QgsRasterCalcNode::tNumber:
+      return constantRegister( node->mNumber );
+
+    case QgsRasterCalcNode::tRasterRef:
+    {
+      int raster = mRasterNames.indexOf( node->mRasterName );
+      if ( raster < 0 )
+      {
+        raster = mRasterNames.size();
+        mRasterNames << node->mRasterName;
+      }
+      mInstructions << Instruction{ Load, QgsRasterCalcNode::opNONE, stack, 0, 0, raster };
+      mStackSize = std::max( mStackSize, stack + 1 );
+      return stack;
+    }
+
+    case QgsRasterCalcNode::tOperator:
+    {
+      const bool unary = isUnary( node->mOperator );
+      const int left = compile( node->mLeft, stack );
+      const int right = unary ? left : compile( node->mRight, stack + 1 );
+      if ( !mValid )
+        return 0;
+
+      if ( left < 0 && right < 0 )
+      {
+        // calculate constant subexpressions right away
+        const double leftValue = mConstants.at( -1 - left );
+        const double rightValue = mConstants.at( -1 - right );
+        double value = 0;
+        mValid = applyOperator( node->mOperator, &value, &leftValue, &rightValue, 1, mNodataValue );
+        return constantRegister( value );
+      }
+
+      mInstructions << Instruction{ unary ? Unary : Binary, node->mOperator, stack, left, right, -1 };
+      mStackSize = std::max( mStackSize, stack + 1 );
+      if ( node->mOperator == QgsRasterCalcNode::opNONE )
+        mValid = false;
+      return stack;
+    }
+
+    case QgsRasterCalcNode::tMatrix:
+      break;
+  }
+
+  // matrices are not supported
+  mValid = false;
+  return 0;
+}
+
+int QgsRasterCalcKernel::constantRegister( double value )
+{
+  int index = mConstants.indexOf( value );
+  if ( index < 0 )
+  {
+    index = mConstants.size();
+    mConstants << value;
+  }
+  return -1 - index;
+}
+
+///@endcond
@@ -0,0 +1,117 @@
+/***************************************************************************
+                          qgsrastercalckernel.h
+                          ---------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERCALCKERNEL_H
+#define QGSRASTERCALCKERNEL_H
+
+#include "qgis.h"
+#include "qgis_analysis.h"
+#include "qgsrastercalcnode.h"
+
+#include <QStringList>
+#include <QVector>
+
+class QgsRasterBlock;
+
+///@cond PRIVATE
+
+/**
+ * \ingroup analysis
+ * Compiled form of a raster calculator expression, which calculates the result of each cell
+ * in a single pass without intermediate matrices.
+ *
+ * The expression tree is flattened into a list of instructions working on registers. A register
+ * holds the values of a few hundred cells, so that all registers stay in the CPU cache while the
+ * instructions are executed for a chunk of cells, and each instruction is a simple loop over its
+ * registers. Constant subexpressions are calculated once when the kernel is compiled.
+ *
+ * The results and the handling of nodata values are the same as with QgsRasterCalcNode::calculate().
+ * A kernel may be used from several threads at the same time.
+ * @note added in QGIS 3.0
+ * @note not available in python bindings
+ */
+class ANALYSIS_EXPORT QgsRasterCalcKernel
+{
+  public:
+
+    /**
+     * Compiles the expression \a tree, with \a nodataValue as nodata value of the results.
+     * Check isValid() to see if the tree could be compiled.
+     */
+    QgsRasterCalcKernel( const QgsRasterCalcNode *tree, double nodataValue );
+
+    /**
+     * Returns true if the expression could be compiled.
+     */
+    bool isValid() const { return mValid; }
+
+    /**
+     * Returns the names of the rasters referenced by the expression. The blocks passed to
+     * evaluate() must be in the same order.
+     */
+    QStringList rasterNames() const { return mRasterNames; }
+
+    /**
+     * Calculates the results of \a count cells, starting with the cell at \a offset of
+     * the input \a blocks, and stores them in \a result.
+     */
+    void evaluate( const QVector< QgsRasterBlock * > &blocks, qgssize offset, int count, float *result ) const;
+
+  private:
+
+    enum InstructionType
+    {
+      Load, //!< Reads the values of a raster
+      Unary, //!< Operator with a single argument
+      Binary, //!< Operator with two arguments
+    };
+
+    struct Instruction
+    {
+      InstructionType type;
+      QgsRasterCalcNode::Operator op;
+      int target;
+      int left;
+      int right;
+      int raster;
+    };
+
+    double mNodataValue;
+    bool mValid = true;
+    QStringList mRasterNames;
+    QVector< Instruction > mInstructions;
+
+    //! Number of registers for intermediate results
+    int mStackSize = 0;
+    //! Values of the constants, which are stored in the registers after the intermediate results
+    QVector< double > mConstants;
+    //! Register holding the result
+    int mResult = 0;
+
+    /**
+     * Appends the instructions calculating \a node, using the registers from \a stack for
+     * intermediate results. Returns the register holding the result, constants are
+     * returned as negative numbers.
+     */
+    int compile( const QgsRasterCalcNode *node, int stack );
+
+    //! Returns the register of a constant as a negative number
+    int constantRegister( double value );
+};
+
+///@endcond
+
+#endif // QGSRASTERCALCKERNEL_H
@@ -109,6 +109,7 @@ class ANALYSIS_EXPORT QgsRasterCalcNode
     QgsRasterMatrix *mMatrix = nullptr;
     Operator mOperator;
 
+    friend class QgsRasterCalcKernel;
 };
 
 
@@ -16,19 +16,40 @@
  ***************************************************************************/
 
 #include "qgsrastercalculator.h"
+#include "qgsrastercalckernel.h"
 #include "qgsrastercalcnode.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsrasterinterface.h"
 #include "qgsrasterlayer.h"
-#include "qgsrastermatrix.h"
 #include "qgsrasterprojector.h"
 
 #include <QProgressDialog>
 #include <QFile>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 
 #include <cpl_string.h>
 #include <gdalwarper.h>
 
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+  //! Number of cells of the rows read and calculated at once
+  const int STRIP_CELLS = 1 << 20;
+
+  //! Input raster of the calculation
+  struct Input
+  {
+    int bandNumber = 1;
+    std::unique_ptr< QgsRasterInterface > provider;
+    //! Reprojects the values of the provider, if the raster is in another CRS than the output
+    std::unique_ptr< QgsRasterProjector > projector;
+  };
+}
+
 QgsRasterCalculator::QgsRasterCalculator( const QString &formulaString, const QString &outputFile, const QString &outputFormat,
     const QgsRectangle &outputExtent, int nOutputColumns, int nOutputRows, const QVector<QgsRasterCalculatorEntry> &rasterEntries )
   : mFormulaString( formulaString )
@@ -60,47 +81,63 @@ int QgsRasterCalculator::processCalculation( QProgressDialog *p )
 {
   //prepare search string / tree
   QString errorString;
-  QgsRasterCalcNode *calcNode = QgsRasterCalcNode::parseRasterCalcString( mFormulaString, errorString );
+  std::unique_ptr< QgsRasterCalcNode > calcNode( QgsRasterCalcNode::parseRasterCalcString( mFormulaString, errorString ) );
   if ( !calcNode )
   {
     //error
     return static_cast<int>( ParserError );
   }
 
-  QMap< QString, QgsRasterBlock * > inputBlocks;
+  //compile the tree, so that each cell is calculated in a single pass
+  float outputNodataValue = -FLT_MAX;
+  const QgsRasterCalcKernel kernel( calcNode.get(), outputNodataValue );
+  if ( !kernel.isValid() )
+  {
+    return static_cast<int>( ParserError );
+  }
+
   QVector<QgsRasterCalculatorEntry>::const_iterator it = mRasterEntries.constBegin();
   for ( ; it != mRasterEntries.constEnd(); ++it )
   {
     if ( !it->raster ) // no raster layer in entry
     {
-      delete calcNode;
-      qDeleteAll( inputBlocks );
       return static_cast< int >( InputLayerError );
     }
+  }
 
-    QgsRasterBlock *block = nullptr;
-    // if crs transform needed
-    if ( it->raster->crs() != mOutputCrs )
+  //the rasters are read through copies of their data providers, so that they can be read in the background
+  std::vector< Input > inputs;
+  Q_FOREACH ( const QString &rasterName, kernel.rasterNames() )
+  {
+    const QgsRasterCalculatorEntry *entry = nullptr;
+    for ( const QgsRasterCalculatorEntry &rasterEntry : mRasterEntries )
     {
-      QgsRasterProjector proj;
-      proj.setCrs( it->raster->crs(), mOutputCrs );
-      proj.setInput( it->raster->dataProvider() );
-      proj.setPrecision( QgsRasterProjector::Exact );
-
-      block = proj.block( it->bandNumber, mOutputRectangle, mNumOutputColumns, mNumOutputRows );
+      if ( rasterEntry.ref == rasterName )
+      {
+        entry = &rasterEntry;
+      }
     }
-    else
+    if ( !entry )
     {
-      block = it->raster->dataProvider()->block( it->bandNumber, mOutputRectangle, mNumOutputColumns, mNumOutputRows );
+      return static_cast< int >( InputLayerError );
     }
-    if ( block->isEmpty() )
+
+    Input input;
+    input.bandNumber = entry->bandNumber;
+    input.provider.reset( entry->raster->dataProvider()->clone() );
+    if ( !input.provider )
     {
-      delete block;
-      delete calcNode;
-      qDeleteAll( inputBlocks );
-      return static_cast<int>( MemoryError );
+      return static_cast< int >( InputLayerError );
     }
-    inputBlocks.insert( it->ref, block );
+    // if crs transform needed
+    if ( entry->raster->crs() != mOutputCrs )
+    {
+      input.projector.reset( new QgsRasterProjector() );
+      input.projector->setCrs( entry->raster->crs(), mOutputCrs );
+      input.projector->setInput( input.provider.get() );
+      input.projector->setPrecision( QgsRasterProjector::Exact );
+    }
+    inputs.push_back( std::move( input ) );
   }
 
   //open output dataset for writing
@@ -111,10 +148,13 @@ int QgsRasterCalculator::processCalculation( QProgressDialog *p )
   }
 
   GDALDatasetH outputDataset = openOutputFile( outputDriver );
+  if ( !outputDataset )
+  {
+    return static_cast< int >( CreateOutputError );
+  }
   GDALSetProjection( outputDataset, mOutputCrs.toWkt().toLocal8Bit().data() );
   GDALRasterBandH outputRasterBand = GDALGetRasterBand( outputDataset, 1 );
 
-  float outputNodataValue = -FLT_MAX;
   GDALSetRasterNoDataValue( outputRasterBand, outputNodataValue );
 
   if ( p )
@@ -122,41 +162,86 @@ int QgsRasterCalculator::processCalculation( QProgressDialog *p )
     p->setMaximum( mNumOutputRows );
   }
 
-  QgsRasterMatrix resultMatrix;
-  resultMatrix.setNodataValue( outputNodataValue );
+  //read / write in strips of rows. The next strip is read while the rows of the current strip are calculated in parallel
+  const int stripRows = qBound( 1, STRIP_CELLS / qMax( 1, mNumOutputColumns ), qMax( 1, mNumOutputRows ) );
+  const double rowHeight = mOutputRectangle.height() / mNumOutputRows;
+  auto readStrip = [&]( int startRow ) -> QVector< QgsRasterBlock * >
+  {
+    const int endRow = qMin( startRow + stripRows, mNumOutputRows );
+    const QgsRectangle extent( mOutputRectangle.xMinimum(),
+                               endRow == mNumOutputRows ? mOutputRectangle.yMinimum() : mOutputRectangle.yMaximum() - endRow * rowHeight,
+                               mOutputRectangle.xMaximum(),
+                               mOutputRectangle.yMaximum() - startRow * rowHeight );
+    QVector< QgsRasterBlock * > blocks;
+    for ( const Input &input : inputs )
+    {
+      QgsRasterInterface *source = input.projector ? static_cast< QgsRasterInterface * >( input.projector.get() ) : input.provider.get();
+      blocks << source->block( input.bandNumber, extent, mNumOutputColumns, endRow - startRow );
+    }
+    return blocks;
+  };
+
+  std::vector< float > calcData( static_cast< size_t >( stripRows ) * mNumOutputColumns );
+  std::vector< int > rowIndices( stripRows );
+  std::iota( rowIndices.begin(), rowIndices.end(), 0 );
 
-  //read / write line by line
-  for ( int i = 0; i < mNumOutputRows; ++i )
+  Result result = Success;
+  QFuture< QVector< QgsRasterBlock * > > nextBlocks = QtConcurrent::run( [&readStrip] { return readStrip( 0 ); } );
+  bool reading = true;
+  for ( int startRow = 0; startRow < mNumOutputRows; startRow += stripRows )
   {
+    QVector< QgsRasterBlock * > blocks = nextBlocks.result();
+    reading = false;
+
+    const int rows = qMin( stripRows, mNumOutputRows - startRow );
+    if ( startRow + rows < mNumOutputRows )
+    {
+      const int nextRow = startRow + rows;
+      nextBlocks = QtConcurrent::run( [&readStrip, nextRow] { return readStrip( nextRow ); } );
+      reading = true;
+    }
+
     if ( p )
     {
-      p->setValue( i );
+      p->setValue( startRow );
     }
 
     if ( p && p->wasCanceled() )
     {
+      qDeleteAll( blocks );
+      result = Canceled;
       break;
     }
 
-    if ( calcNode->calculate( inputBlocks, resultMatrix, i ) )
+    bool blocksValid = true;
+    Q_FOREACH ( QgsRasterBlock *block, blocks )
     {
-      bool resultIsNumber = resultMatrix.isNumber();
-      float *calcData = new float[mNumOutputColumns];
-
-      for ( int j = 0; j < mNumOutputColumns; ++j )
-      {
-        calcData[j] = ( float )( resultIsNumber ? resultMatrix.number() : resultMatrix.data()[j] );
-      }
+      blocksValid = blocksValid && !block->isEmpty();
+    }
+    if ( !blocksValid )
+    {
+      qDeleteAll( blocks );
+      result = MemoryError;
+      break;
+    }
 
-      //write scanline to the dataset
-      if ( GDALRasterIO( outputRasterBand, GF_Write, 0, i, mNumOutputColumns, 1, calcData, mNumOutputColumns, 1, GDT_Float32, 0, 0 ) != CE_None )
-      {
-        QgsDebugMsg( "RasterIO error!" );
-      }
+    QtConcurrent::blockingMap( rowIndices.begin(), rowIndices.begin() + rows, [&]( int row )
+    {
+      kernel.evaluate( blocks, static_cast< qgssize >( row ) * mNumOutputColumns, mNumOutputColumns, &calcData[ static_cast< size_t >( row ) * mNumOutputColumns ] );
+    } );
 
-      delete[] calcData;
+    //write the strip to the dataset
+    if ( GDALRasterIO( outputRasterBand, GF_Write, 0, startRow, mNumOutputColumns, rows, calcData.data(), mNumOutputColumns, rows, GDT_Float32, 0, 0 ) != CE_None )
+    {
+      QgsDebugMsg( "RasterIO error!" );
     }
 
+    qDeleteAll( blocks );
+  }
+
+  if ( reading )
+  {
+    qDeleteAll( nextBlocks.result() );
   }
 
   if ( p )
@@ -164,16 +249,11 @@ int QgsRasterCalculator::processCalculation( QProgressDialog *p )
     p->setValue( mNumOutputRows );
   }
 
-  //close datasets and release memory
-  delete calcNode;
-  qDeleteAll( inputBlocks );
-  inputBlocks.clear();
-
-  if ( p && p->wasCanceled() )
+  if ( result != Success )
   {
     //delete the dataset without closing (because it is faster)
     GDALDeleteDataset( outputDriver, mOutputFile.toUtf8().constData() );
-    return static_cast< int >( Canceled );
+    return static_cast< int >( result );
   }
   GDALClose( outputDataset );
 
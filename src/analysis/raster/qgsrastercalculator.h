@@ -79,7 +79,9 @@ class ANALYSIS_EXPORT QgsRasterCalculator
     QgsRasterCalculator( const QString &formulaString, const QString &outputFile, const QString &outputFormat,
                          const QgsRectangle &outputExtent, const QgsCoordinateReferenceSystem &outputCrs, int nOutputColumns, int nOutputRows, const QVector<QgsRasterCalculatorEntry> &rasterEntries );
 
-    /** Starts the calculation and writes new raster
+    /** Starts the calculation and writes new raster. The rasters are read in strips of rows, and the
+      rows of each strip are calculated in parallel while the next strip is read. A raster referenced
+      by the formula but missing from the raster entries is an InputLayerError.
       @param p progress bar (or 0 if called from non-gui code)
       @return 0 in case of success*/
     //TODO QGIS 3.0 - return QgsRasterCalculator::Result
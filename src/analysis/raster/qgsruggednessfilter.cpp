@@ -86,3 +86,25 @@ float QgsRuggednessFilter::processNineCellWindow( float *x11, float *x21, float
   return sqrt( sum );
 }
 
+void QgsRuggednessFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  const float nodata = mInputNodataValue;
+  for ( int j = 0; j < width; ++j )
+  {
+    const float center = row[j + 1];
+    if ( center == nodata )
+    {
+      result[j] = mOutputNodataValue;
+      continue;
+    }
+
+    //nodata neighbours are skipped, in the same order as in processNineCellWindow
+    double sum = 0;
+    const float neighbours[8] = { rowAbove[j], rowAbove[j + 1], rowAbove[j + 2], row[j], row[j + 2], rowBelow[j], rowBelow[j + 1], rowBelow[j + 2] };
+    for ( float neighbour : neighbours )
+    {
+      sum += neighbour != nodata ? ( neighbour - center ) * ( neighbour - center ) : 0.0f;
+    }
+    result[j] = sqrt( sum );
+  }
+}
@@ -38,6 +38,8 @@ class ANALYSIS_EXPORT QgsRuggednessFilter: public QgsNineCellFilter
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
 
+    void processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width ) override;
+
   private:
     QgsRuggednessFilter();
 };
@@ -17,6 +17,8 @@
 
 #include "qgsslopefilter.h"
 
+#include <vector>
+
 QgsSlopeFilter::QgsSlopeFilter( const QString &inputFile, const QString &outputFile, const QString &outputFormat )
   : QgsDerivativeFilter( inputFile, outputFile, outputFormat )
 {
@@ -37,3 +39,21 @@ float QgsSlopeFilter::processNineCellWindow( float *x11, float *x21, float *x31,
   return atan( sqrt( derX * derX + derY * derY ) ) * 180.0 / M_PI;
 }
 
+void QgsSlopeFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  std::vector< float > derX( width );
+  std::vector< float > derY( width );
+  calcFirstDerivatives( rowAbove, row, rowBelow, derX.data(), derY.data(), width );
+
+  for ( int j = 0; j < width; ++j )
+  {
+    if ( derX[j] == mOutputNodataValue || derY[j] == mOutputNodataValue )
+    {
+      result[j] = mOutputNodataValue;
+    }
+    else
+    {
+      result[j] = atan( sqrt( derX[j] * derX[j] + derY[j] * derY[j] ) ) * 180.0 / M_PI;
+    }
+  }
+}
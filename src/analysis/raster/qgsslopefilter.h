@@ -34,6 +34,8 @@ class ANALYSIS_EXPORT QgsSlopeFilter: public QgsDerivativeFilter
     float processNineCellWindow( float *x11, float *x21, float *x31,
                                  float *x12, float *x22, float *x32,
                                  float *x13, float *x23, float *x33 ) override;
+
+    void processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width ) override;
 };
 
 #endif // QGSSLOPEFILTER_H
@@ -41,3 +41,25 @@ float QgsTotalCurvatureFilter::processNineCellWindow( float *x11, float *x21, fl
 
   return dxx * dxx + 2 * dxy * dxy + dyy * dyy;
 }
+
+void QgsTotalCurvatureFilter::processNineCellRow( const float *rowAbove, const float *row, const float *rowBelow, float *result, int width )
+{
+  const float nodata = mInputNodataValue;
+  const double cellSizeAvg = ( mCellSizeX + mCellSizeY ) / 2.0;
+  for ( int j = 0; j < width; ++j )
+  {
+    //return nodata if one value is the nodata value
+    if ( rowAbove[j] == nodata || rowAbove[j + 1] == nodata || rowAbove[j + 2] == nodata || row[j] == nodata
+         || row[j + 1] == nodata || row[j + 2] == nodata || rowBelow[j] == nodata || rowBelow[j + 1] == nodata
+         || rowBelow[j + 2] == nodata )
+    {
+      result[j] = mOutputNodataValue;
+      continue;
+    }
+
+    double dxx = ( row[j + 2] - 2 * row[j + 1] + row[j] ) / ( mCellSizeX * mCellSizeX );
+    double dxy = ( -rowAbove[j] + rowAbove[j + 2] + rowBelow[j] - rowBelow[j + 2] ) / ( 4 * cellSizeAvg * cellSizeAvg );
+    double dyy = ( rowAbove[j + 1] - 2 * row[j + 1] + rowBelow[j + 1] ) / ( mCellSizeY * mCellSizeY );
+    result[j] = dxx * dxx + 2 * dxy * dxy + dyy * dyy;
+  }
+}
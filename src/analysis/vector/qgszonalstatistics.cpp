@@ -28,6 +28,103 @@
 
 #include <QProgressDialog>
 #include <QFile>
+#include <QMutex>
+#include <QPointF>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+///@cond PRIVATE
+namespace
+{
+  //! Number of features which are read before their statistics are calculated with the scanline method
+  const int SCANLINE_BATCH_SIZE = 10000;
+
+  //! Size of the raster tiles which are used to group the zones of a batch
+  const int TILE_SIZE = 256;
+
+  //! Maximum number of cells which are read in one go
+  const int STRIP_CELLS = 1 << 20;
+
+  //! Cells of a raster row from startColumn to endColumn (exclusive)
+  struct CellSpan
+  {
+    int row;
+    int startColumn;
+    int endColumn;
+  };
+
+  /**
+   * Appends the spans of the cells whose centers are inside the \a rings to \a spans, ordered by rows. The rings are
+   * in cell coordinates and combined with the even-odd rule, only cells of the given window are considered.
+   */
+  void scanlineSpans( const QVector< QVector< QPointF > > &rings, int offsetX, int offsetY, int nCellsX, int nCellsY, std::vector< CellSpan > &spans )
+  {
+    //intersections of the edges with the horizontal lines through the cell centers
+    std::vector< std::pair< int, double > > crossings;
+    for ( const QVector< QPointF > &ring : rings )
+    {
+      for ( int i = 1; i < ring.size(); ++i )
+      {
+        const QPointF &p0 = ring.at( i - 1 );
+        const QPointF &p1 = ring.at( i );
+        if ( p0.y() == p1.y() )
+          continue;
+
+        //half open, so that a line through a vertex crosses only one of its edges
+        double firstRow = qBound( static_cast< double >( offsetY ), std::ceil( std::min( p0.y(), p1.y() ) - 0.5 ), static_cast< double >( offsetY + nCellsY ) );
+        double endRow = qBound( static_cast< double >( offsetY ), std::ceil( std::max( p0.y(), p1.y() ) - 0.5 ), static_cast< double >( offsetY + nCellsY ) );
+        double slope = ( p1.x() - p0.x() ) / ( p1.y() - p0.y() );
+        for ( int row = static_cast< int >( firstRow ); row < static_cast< int >( endRow ); ++row )
+        {
+          crossings.emplace_back( row, p0.x() + ( row + 0.5 - p0.y() ) * slope );
+        }
+      }
+    }
+    std::sort( crossings.begin(), crossings.end() );
+
+    //each pair of crossings of a row encloses cells inside the polygon
+    for ( std::size_t i = 0; i + 1 < crossings.size(); )
+    {
+      const int row = crossings[i].first;
+      if ( crossings[i + 1].first != row )
+      {
+        ++i;
+        continue;
+      }
+      int startColumn = static_cast< int >( qBound( static_cast< double >( offsetX ), std::ceil( crossings[i].second - 0.5 ), static_cast< double >( offsetX + nCellsX ) ) );
+      int endColumn = static_cast< int >( qBound( static_cast< double >( offsetX ), std::ceil( crossings[i + 1].second - 0.5 ), static_cast< double >( offsetX + nCellsX ) ) );
+      if ( startColumn < endColumn )
+      {
+        spans.push_back( { row, startColumn, endColumn } );
+      }
+      i += 2;
+    }
+  }
+}
+
+struct QgsZonalStatistics::Zone
+{
+  explicit Zone( bool storeValues = false )
+    : stats( storeValues )
+  {}
+
+  QgsFeatureId id = 0;
+  QgsGeometry geometry;
+  //! Rings of the polygons in cell coordinates, i.e. column and row numbers with fractions
+  QVector< QVector< QPointF > > rings;
+  int offsetX = 0;
+  int offsetY = 0;
+  int nCellsX = 0;
+  int nCellsY = 0;
+  FeatureStats stats;
+};
+///@endcond
 
 QgsZonalStatistics::QgsZonalStatistics( QgsVectorLayer *polygonLayer, QgsRasterLayer *rasterLayer, const QString &attributePrefix, int rasterBand, Statistics stats )
   : mRasterLayer( rasterLayer )
@@ -203,132 +300,248 @@ int QgsZonalStatistics::calculateStatistics( QProgressDialog *p )
   QgsFeature f;
 
   bool statsStoreValues = ( mStatistics & QgsZonalStatistics::Median ) ||
-                          ( mStatistics & QgsZonalStatistics::StDev );
-  bool statsStoreValueCount = ( mStatistics & QgsZonalStatistics::Minority ) ||
-                              ( mStatistics & QgsZonalStatistics::Majority );
+                          ( mStatistics & QgsZonalStatistics::Minority ) ||
+                          ( mStatistics & QgsZonalStatistics::Majority ) ||
+                          ( mStatistics & QgsZonalStatistics::Variety );
 
-  FeatureStats featureStats( statsStoreValues, statsStoreValueCount );
+  FeatureStats featureStats( statsStoreValues );
   int featureCounter = 0;
 
   QgsChangedAttributesMap changeMap;
-  while ( fi.nextFeature( f ) )
-  {
-    if ( p )
-    {
-      p->setValue( featureCounter );
-    }
-
-    if ( p && p->wasCanceled() )
-    {
-      break;
-    }
 
-    if ( !f.hasGeometry() )
-    {
-      ++featureCounter;
-      continue;
-    }
-    QgsGeometry featureGeometry = f.geometry();
-
-    QgsRectangle featureRect = featureGeometry.boundingBox().intersect( &rasterBBox );
-    if ( featureRect.isEmpty() )
-    {
-      ++featureCounter;
-      continue;
-    }
-
-    int offsetX, offsetY, nCellsX, nCellsY;
-    if ( cellInfoForBBox( rasterBBox, featureRect, cellsizeX, cellsizeY, offsetX, offsetY, nCellsX, nCellsY ) != 0 )
-    {
-      ++featureCounter;
-      continue;
-    }
-
-    //avoid access to cells outside of the raster (may occur because of rounding)
-    if ( ( offsetX + nCellsX ) > nCellsXProvider )
-    {
-      nCellsX = nCellsXProvider - offsetX;
-    }
-    if ( ( offsetY + nCellsY ) > nCellsYProvider )
-    {
-      nCellsY = nCellsYProvider - offsetY;
-    }
-
-    statisticsFromMiddlePointTest( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
-                                   rasterBBox, featureStats );
-
-    if ( featureStats.count <= 1 )
-    {
-      //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
-      statisticsFromPreciseIntersection( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
-                                         rasterBBox, featureStats );
-    }
-
-    //write the statistics value to the vector data provider
+  //write the statistics value to the vector data provider
+  auto addStatistics = [&]( QgsFeatureId fid, FeatureStats & stats )
+  {
     QgsAttributeMap changeAttributeMap;
     if ( mStatistics & QgsZonalStatistics::Count )
-      changeAttributeMap.insert( countIndex, QVariant( featureStats.count ) );
+      changeAttributeMap.insert( countIndex, QVariant( stats.count ) );
     if ( mStatistics & QgsZonalStatistics::Sum )
-      changeAttributeMap.insert( sumIndex, QVariant( featureStats.sum ) );
-    if ( featureStats.count > 0 )
+      changeAttributeMap.insert( sumIndex, QVariant( stats.sum ) );
+    if ( stats.count > 0 )
     {
-      double mean = featureStats.sum / featureStats.count;
+      double mean = stats.sum / stats.count;
       if ( mStatistics & QgsZonalStatistics::Mean )
         changeAttributeMap.insert( meanIndex, QVariant( mean ) );
+      //the sorted values give the median, and the values with the same count are ordered as in a map of value counts
+      std::sort( stats.values.begin(), stats.values.end() );
       if ( mStatistics & QgsZonalStatistics::Median )
       {
-        std::sort( featureStats.values.begin(), featureStats.values.end() );
-        int size =  featureStats.values.count();
+        int size = static_cast< int >( stats.values.size() );
         bool even = ( size % 2 ) < 1;
         double medianValue;
         if ( even )
         {
-          medianValue = ( featureStats.values.at( size / 2 - 1 ) + featureStats.values.at( size / 2 ) ) / 2;
+          medianValue = ( stats.values.at( size / 2 - 1 ) + stats.values.at( size / 2 ) ) / 2;
         }
         else //odd
         {
-          medianValue = featureStats.values.at( ( size + 1 ) / 2 - 1 );
+          medianValue = stats.values.at( ( size + 1 ) / 2 - 1 );
         }
         changeAttributeMap.insert( medianIndex, QVariant( medianValue ) );
       }
       if ( mStatistics & QgsZonalStatistics::StDev )
       {
-        double sumSquared = 0;
-        for ( int i = 0; i < featureStats.values.count(); ++i )
-        {
-          double diff = featureStats.values.at( i ) - mean;
-          sumSquared += diff * diff;
-        }
-        double stdev = qPow( sumSquared / featureStats.values.count(), 0.5 );
+        //deviations from the (weighted) mean
+        double meanDiff = stats.cellMean - mean;
+        double sumSquared = stats.cellM2 + stats.cellCount * meanDiff * meanDiff;
+        double stdev = qPow( sumSquared / stats.cellCount, 0.5 );
         changeAttributeMap.insert( stdevIndex, QVariant( stdev ) );
       }
       if ( mStatistics & QgsZonalStatistics::Min )
-        changeAttributeMap.insert( minIndex, QVariant( featureStats.min ) );
+        changeAttributeMap.insert( minIndex, QVariant( stats.min ) );
       if ( mStatistics & QgsZonalStatistics::Max )
-        changeAttributeMap.insert( maxIndex, QVariant( featureStats.max ) );
+        changeAttributeMap.insert( maxIndex, QVariant( stats.max ) );
       if ( mStatistics & QgsZonalStatistics::Range )
-        changeAttributeMap.insert( rangeIndex, QVariant( featureStats.max - featureStats.min ) );
-      if ( mStatistics & QgsZonalStatistics::Minority || mStatistics & QgsZonalStatistics::Majority )
+        changeAttributeMap.insert( rangeIndex, QVariant( stats.max - stats.min ) );
+      if ( mStatistics & QgsZonalStatistics::Minority || mStatistics & QgsZonalStatistics::Majority || mStatistics & QgsZonalStatistics::Variety )
       {
-        QList<int> vals = featureStats.valueCount.values();
-        std::sort( vals.begin(), vals.end() );
-        if ( mStatistics & QgsZonalStatistics::Minority )
+        //runs of equal values, the first of several values with the same count is the smallest one
+        float minorityKey = 0;
+        float majKey = 0;
+        int minorityCount = 0;
+        int majCount = 0;
+        int variety = 0;
+        for ( std::size_t i = 0; i < stats.values.size(); )
         {
-          float minorityKey = featureStats.valueCount.key( vals.first() );
-          changeAttributeMap.insert( minorityIndex, QVariant( minorityKey ) );
+          std::size_t runEnd = i + 1;
+          while ( runEnd < stats.values.size() && stats.values[runEnd] == stats.values[i] )
+            ++runEnd;
+          int runCount = static_cast< int >( runEnd - i );
+          if ( variety == 0 || runCount < minorityCount )
+          {
+            minorityKey = stats.values[i];
+            minorityCount = runCount;
+          }
+          if ( variety == 0 || runCount > majCount )
+          {
+            majKey = stats.values[i];
+            majCount = runCount;
+          }
+          ++variety;
+          i = runEnd;
         }
+        if ( mStatistics & QgsZonalStatistics::Minority )
+          changeAttributeMap.insert( minorityIndex, QVariant( minorityKey ) );
         if ( mStatistics & QgsZonalStatistics::Majority )
-        {
-          float majKey = featureStats.valueCount.key( vals.last() );
           changeAttributeMap.insert( majorityIndex, QVariant( majKey ) );
+        if ( mStatistics & QgsZonalStatistics::Variety )
+          changeAttributeMap.insert( varietyIndex, QVariant( variety ) );
+      }
+    }
+
+    changeMap.insert( fid, changeAttributeMap );
+  };
+
+  if ( mMethod == Scanline )
+  {
+    //the features are processed in batches, so that the memory use does not depend on the number of features
+    QVector< Zone > zones;
+    bool featuresLeft = true;
+    while ( featuresLeft )
+    {
+      if ( p )
+      {
+        p->setValue( featureCounter );
+      }
+
+      if ( p && p->wasCanceled() )
+      {
+        break;
+      }
+
+      zones.clear();
+      while ( zones.size() < SCANLINE_BATCH_SIZE )
+      {
+        if ( !fi.nextFeature( f ) )
+        {
+          featuresLeft = false;
+          break;
+        }
+        ++featureCounter;
+
+        if ( !f.hasGeometry() )
+        {
+          continue;
+        }
+        QgsGeometry featureGeometry = f.geometry();
+
+        QgsRectangle featureRect = featureGeometry.boundingBox().intersect( &rasterBBox );
+        if ( featureRect.isEmpty() )
+        {
+          continue;
+        }
+
+        Zone zone( statsStoreValues );
+        if ( cellInfoForBBox( rasterBBox, featureRect, cellsizeX, cellsizeY, zone.offsetX, zone.offsetY, zone.nCellsX, zone.nCellsY ) != 0 )
+        {
+          continue;
+        }
+
+        //avoid access to cells outside of the raster (may occur because of rounding)
+        zone.nCellsX = qMin( zone.nCellsX, nCellsXProvider - zone.offsetX );
+        zone.nCellsY = qMin( zone.nCellsY, nCellsYProvider - zone.offsetY );
+        if ( zone.nCellsX <= 0 || zone.nCellsY <= 0 )
+        {
+          continue;
         }
+
+        //the rings in cell coordinates
+        QgsMultiPolygon polygons = featureGeometry.isMultipart() ? featureGeometry.asMultiPolygon() : QgsMultiPolygon() << featureGeometry.asPolygon();
+        Q_FOREACH ( const QgsPolygon &polygon, polygons )
+        {
+          Q_FOREACH ( const QgsPolyline &ring, polygon )
+          {
+            QVector< QPointF > cellRing;
+            cellRing.reserve( ring.size() + 1 );
+            Q_FOREACH ( const QgsPoint &point, ring )
+            {
+              cellRing << QPointF( ( point.x() - rasterBBox.xMinimum() ) / cellsizeX, ( rasterBBox.yMaximum() - point.y() ) / cellsizeY );
+            }
+            if ( !cellRing.isEmpty() && cellRing.first() != cellRing.last() )
+            {
+              cellRing << cellRing.first();
+            }
+            zone.rings << cellRing;
+          }
+        }
+
+        zone.id = f.id();
+        zone.geometry = featureGeometry;
+        zones << zone;
+      }
+
+      statisticsFromScanlines( zones, cellsizeX, cellsizeY, rasterBBox );
+
+      for ( Zone &zone : zones )
+      {
+        if ( zone.stats.count <= 1 )
+        {
+          //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+          statisticsFromPreciseIntersection( zone.geometry, zone.offsetX, zone.offsetY, zone.nCellsX, zone.nCellsY, cellsizeX, cellsizeY,
+                                             rasterBBox, zone.stats );
+        }
+        addStatistics( zone.id, zone.stats );
       }
-      if ( mStatistics & QgsZonalStatistics::Variety )
-        changeAttributeMap.insert( varietyIndex, QVariant( featureStats.valueCount.count() ) );
     }
+  }
+  else
+  {
+    while ( fi.nextFeature( f ) )
+    {
+      if ( p )
+      {
+        p->setValue( featureCounter );
+      }
 
-    changeMap.insert( f.id(), changeAttributeMap );
-    ++featureCounter;
+      if ( p && p->wasCanceled() )
+      {
+        break;
+      }
+
+      if ( !f.hasGeometry() )
+      {
+        ++featureCounter;
+        continue;
+      }
+      QgsGeometry featureGeometry = f.geometry();
+
+      QgsRectangle featureRect = featureGeometry.boundingBox().intersect( &rasterBBox );
+      if ( featureRect.isEmpty() )
+      {
+        ++featureCounter;
+        continue;
+      }
+
+      int offsetX, offsetY, nCellsX, nCellsY;
+      if ( cellInfoForBBox( rasterBBox, featureRect, cellsizeX, cellsizeY, offsetX, offsetY, nCellsX, nCellsY ) != 0 )
+      {
+        ++featureCounter;
+        continue;
+      }
+
+      //avoid access to cells outside of the raster (may occur because of rounding)
+      if ( ( offsetX + nCellsX ) > nCellsXProvider )
+      {
+        nCellsX = nCellsXProvider - offsetX;
+      }
+      if ( ( offsetY + nCellsY ) > nCellsYProvider )
+      {
+        nCellsY = nCellsYProvider - offsetY;
+      }
+
+      statisticsFromMiddlePointTest( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
+                                     rasterBBox, featureStats );
+
+      if ( featureStats.count <= 1 )
+      {
+        //the cell resolution is probably larger than the polygon area. We switch to precise pixel - polygon intersection in this case
+        statisticsFromPreciseIntersection( featureGeometry, offsetX, offsetY, nCellsX, nCellsY, cellsizeX, cellsizeY,
+                                           rasterBBox, featureStats );
+      }
+
+      addStatistics( f.id(), featureStats );
+      ++featureCounter;
+    }
   }
 
   vectorProvider->changeAttributeValues( changeMap );
@@ -482,6 +695,158 @@ void QgsZonalStatistics::statisticsFromPreciseIntersection( const QgsGeometry &p
   delete block;
 }
 
+void QgsZonalStatistics::statisticsFromScanlines( QVector< Zone > &zones, double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox )
+{
+  if ( zones.isEmpty() )
+  {
+    return;
+  }
+
+  //zones which fit into a tile are grouped by the tile of their first cell, and the cells of a group are read in one go.
+  //Larger zones are groups of their own
+  auto isLarge = [&zones]( int index )
+  {
+    return zones.at( index ).nCellsX > TILE_SIZE || zones.at( index ).nCellsY > TILE_SIZE;
+  };
+  std::vector< int > order( zones.size() );
+  std::iota( order.begin(), order.end(), 0 );
+  std::sort( order.begin(), order.end(), [&zones]( int a, int b )
+  {
+    const Zone &zoneA = zones.at( a );
+    const Zone &zoneB = zones.at( b );
+    if ( zoneA.offsetY / TILE_SIZE != zoneB.offsetY / TILE_SIZE )
+      return zoneA.offsetY / TILE_SIZE < zoneB.offsetY / TILE_SIZE;
+    if ( zoneA.offsetX / TILE_SIZE != zoneB.offsetX / TILE_SIZE )
+      return zoneA.offsetX / TILE_SIZE < zoneB.offsetX / TILE_SIZE;
+    return a < b;
+  } );
+
+  struct Group
+  {
+    int first;
+    int count;
+    int offsetX;
+    int offsetY;
+    int nCellsX;
+    int nCellsY;
+  };
+  QList< Group > groups;
+  for ( int i = 0; i < static_cast< int >( order.size() ); ++i )
+  {
+    const Zone &zone = zones.at( order[i] );
+    if ( !groups.isEmpty() && !isLarge( order[i] ) )
+    {
+      Group &group = groups.last();
+      const Zone &groupZone = zones.at( order[group.first] );
+      if ( !isLarge( order[group.first] ) && groupZone.offsetY / TILE_SIZE == zone.offsetY / TILE_SIZE
+           && groupZone.offsetX / TILE_SIZE == zone.offsetX / TILE_SIZE )
+      {
+        int endX = std::max( group.offsetX + group.nCellsX, zone.offsetX + zone.nCellsX );
+        int endY = std::max( group.offsetY + group.nCellsY, zone.offsetY + zone.nCellsY );
+        group.offsetX = std::min( group.offsetX, zone.offsetX );
+        group.offsetY = std::min( group.offsetY, zone.offsetY );
+        group.nCellsX = endX - group.offsetX;
+        group.nCellsY = endY - group.offsetY;
+        group.count++;
+        continue;
+      }
+    }
+    groups << Group { i, 1, zone.offsetX, zone.offsetY, zone.nCellsX, zone.nCellsY };
+  }
+
+  //the zones are modified from several threads, so the vector must not detach
+  Zone *zoneData = zones.data();
+  auto processGroup = [&]( QgsRasterInterface * reader, const Group & group )
+  {
+    std::vector< std::vector< CellSpan > > spans( group.count );
+    std::vector< std::size_t > nextSpan( group.count, 0 );
+    for ( int i = 0; i < group.count; ++i )
+    {
+      Zone &zone = zoneData[ order[group.first + i] ];
+      zone.stats.reset();
+      scanlineSpans( zone.rings, zone.offsetX, zone.offsetY, zone.nCellsX, zone.nCellsY, spans[i] );
+    }
+
+    //large zones are read in strips
+    const int stripRows = std::max( 1, STRIP_CELLS / group.nCellsX );
+    for ( int stripRow = group.offsetY; stripRow < group.offsetY + group.nCellsY; stripRow += stripRows )
+    {
+      const int rows = std::min( stripRows, group.offsetY + group.nCellsY - stripRow );
+      QgsRectangle stripExtent( rasterBBox.xMinimum() + group.offsetX * cellSizeX, rasterBBox.yMaximum() - ( stripRow + rows ) * cellSizeY,
+                                rasterBBox.xMinimum() + ( group.offsetX + group.nCellsX ) * cellSizeX, rasterBBox.yMaximum() - stripRow * cellSizeY );
+      std::unique_ptr< QgsRasterBlock > block( reader->block( mRasterBand, stripExtent, group.nCellsX, rows ) );
+      if ( !block )
+      {
+        continue;
+      }
+      const QVector< float > values = block->valuesAsFloat();
+
+      for ( int i = 0; i < group.count; ++i )
+      {
+        FeatureStats &stats = zoneData[ order[group.first + i] ].stats;
+        const std::vector< CellSpan > &zoneSpans = spans[i];
+        std::size_t &spanIndex = nextSpan[i];
+        for ( ; spanIndex < zoneSpans.size() && zoneSpans[spanIndex].row < stripRow + rows; ++spanIndex )
+        {
+          const CellSpan &span = zoneSpans[spanIndex];
+          const float *rowValues = values.constData() + static_cast< qgssize >( span.row - stripRow ) * group.nCellsX - group.offsetX;
+          for ( int column = span.startColumn; column < span.endColumn; ++column )
+          {
+            if ( validPixel( rowValues[column] ) )
+            {
+              stats.addValue( rowValues[column] );
+            }
+          }
+        }
+      }
+    }
+  };
+
+  //the data provider is not thread safe, so each thread reads through its own copy of it
+  std::vector< std::unique_ptr< QgsRasterInterface > > readers;
+  const int readerCount = std::min( groups.size(), QThread::idealThreadCount() );
+  while ( readerCount > 1 && static_cast< int >( readers.size() ) < readerCount )
+  {
+    std::unique_ptr< QgsRasterInterface > reader( mRasterProvider->clone() );
+    if ( !reader )
+      break;
+    readers.push_back( std::move( reader ) );
+  }
+
+  if ( readers.size() > 1 )
+  {
+    QList< QgsRasterInterface * > freeReaders;
+    for ( const std::unique_ptr< QgsRasterInterface > &reader : readers )
+      freeReaders << reader.get();
+    QMutex mutex;
+    QWaitCondition readerReleased;
+
+    QtConcurrent::blockingMap( groups, [&]( const Group & group )
+    {
+      QgsRasterInterface *reader = nullptr;
+      {
+        QMutexLocker locker( &mutex );
+        while ( freeReaders.isEmpty() )
+          readerReleased.wait( &mutex );
+        reader = freeReaders.takeLast();
+      }
+
+      processGroup( reader, group );
+
+      QMutexLocker locker( &mutex );
+      freeReaders << reader;
+      readerReleased.wakeOne();
+    } );
+  }
+  else
+  {
+    for ( const Group &group : groups )
+    {
+      processGroup( mRasterProvider, group );
+    }
+  }
+}
+
 bool QgsZonalStatistics::validPixel( float value ) const
 {
   if ( value == mInputNodataValue || qIsNaN( value ) )
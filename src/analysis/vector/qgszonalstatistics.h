@@ -20,8 +20,10 @@
 
 #include <QString>
 #include <QMap>
+#include <QVector>
 #include <limits>
 #include <cfloat>
+#include <vector>
 #include "qgis_analysis.h"
 
 class QgsGeometry;
@@ -56,12 +58,39 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     };
     Q_DECLARE_FLAGS( Statistics, Statistic )
 
+    /**
+     * Methods for finding the cells covered by a polygon.
+     * @note added in QGIS 3.0
+     */
+    enum Method
+    {
+      CellCenterTest, //!< Tests the center of each cell of the polygon bounding box with GEOS, one polygon after the other
+      Scanline, //!< Rasterizes the polygons with a scanline algorithm and processes batches of polygons in parallel, which is much faster for many polygons
+    };
+
     /**
      * Constructor for QgsZonalStatistics.
      */
     QgsZonalStatistics( QgsVectorLayer *polygonLayer, QgsRasterLayer *rasterLayer, const QString &attributePrefix = "", int rasterBand = 1,
                         Statistics stats = Statistics( Count | Sum | Mean ) );
 
+    /**
+     * Sets the \a method for finding the cells covered by the polygons. Both methods use the cells whose
+     * centers are inside a polygon, and switch to a precise intersection for polygons covering at most one cell.
+     * With the Scanline method, polygons are read in batches which are sorted by raster tiles, so that the
+     * cells of each tile are read in one go, and the tiles are processed in parallel.
+     * @see method()
+     * @note added in QGIS 3.0
+     */
+    void setMethod( Method method ) { mMethod = method; }
+
+    /**
+     * Returns the method for finding the cells covered by the polygons.
+     * @see setMethod()
+     * @note added in QGIS 3.0
+     */
+    Method method() const { return mMethod; }
+
     /** Starts the calculation
       @return 0 in case of success*/
     int calculateStatistics( QProgressDialog *p );
@@ -72,13 +101,12 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     class FeatureStats
     {
       public:
-        FeatureStats( bool storeValues = false, bool storeValueCounts = false )
+        FeatureStats( bool storeValues = false )
           : mStoreValues( storeValues )
-          , mStoreValueCounts( storeValueCounts )
         {
           reset();
         }
-        void reset() { sum = 0; count = 0; max = -FLT_MAX; min = FLT_MAX; valueCount.clear(); values.clear(); }
+        void reset() { sum = 0; count = 0; max = -FLT_MAX; min = FLT_MAX; cellCount = 0; cellMean = 0; cellM2 = 0; values.clear(); }
         void addValue( float value, double weight = 1.0 )
         {
           if ( weight < 1.0 )
@@ -93,23 +121,34 @@ class ANALYSIS_EXPORT QgsZonalStatistics
           }
           min = qMin( min, value );
           max = qMax( max, value );
-          if ( mStoreValueCounts )
-            valueCount.insert( value, valueCount.value( value, 0 ) + 1 );
+          //single pass variance of the cell values, regardless of their weight
+          ++cellCount;
+          double delta = value - cellMean;
+          cellMean += delta / cellCount;
+          cellM2 += delta * ( value - cellMean );
           if ( mStoreValues )
-            values.append( value );
+            values.push_back( value );
         }
         double sum;
         double count;
         float max;
         float min;
-        QMap< float, int > valueCount;
-        QList< float > values;
+        //! Number of cells, regardless of their weight
+        int cellCount;
+        //! Mean of the cell values, regardless of their weight
+        double cellMean;
+        //! Sum of the squared differences between the cell values and cellMean
+        double cellM2;
+        //! Values of the cells, which are sorted to get the median, minority, majority and variety
+        std::vector< float > values;
 
       private:
         bool mStoreValues;
-        bool mStoreValueCounts;
     };
 
+    //! Polygon of a feature which is rasterized with scanlines
+    struct Zone;
+
     /** Analysis what cells need to be considered to cover the bounding box of a feature
       @return 0 in case of success*/
     int cellInfoForBBox( const QgsRectangle &rasterBBox, const QgsRectangle &featureBBox, double cellSizeX, double cellSizeY,
@@ -123,6 +162,12 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     void statisticsFromPreciseIntersection( const QgsGeometry &poly, int pixelOffsetX, int pixelOffsetY, int nCellsX, int nCellsY,
                                             double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox, FeatureStats &stats );
 
+    /**
+     * Calculates the statistics of a batch of \a zones from the cells whose centers are inside the polygons,
+     * which are found with scanlines. The zones are grouped by raster tiles, and the groups are processed in parallel.
+     */
+    void statisticsFromScanlines( QVector< Zone > &zones, double cellSizeX, double cellSizeY, const QgsRectangle &rasterBBox );
+
     //! Tests whether a pixel's value should be included in the result
     bool validPixel( float value ) const;
 
@@ -137,6 +182,7 @@ class ANALYSIS_EXPORT QgsZonalStatistics
     //! The nodata value of the input layer
     float mInputNodataValue = -1;
     Statistics mStatistics = QgsZonalStatistics::All;
+    Method mMethod = CellCenterTest;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS( QgsZonalStatistics::Statistics )
@@ -230,7 +230,6 @@ bool QgsNodeEditorModel::setData( const QModelIndex &index, const QVariant &valu
   mLayer->beginEditCommand( QObject::tr( "Moved vertices" ) );
   mLayer->moveVertex( p, mSelectedFeature->featureId(), index.row() );
   mLayer->endEditCommand();
-  mLayer->triggerRepaint();
 
   return false;
 }
@@ -3040,6 +3040,8 @@ void QgisApp::createOverview()
 
   mMapCanvas->setParallelRenderingEnabled( mySettings.value( QStringLiteral( "qgis/parallel_rendering" ), true ).toBool() );
 
+  mMapCanvas->setProgressiveRenderingEnabled( mySettings.value( QStringLiteral( "qgis/progressive_rendering" ), false ).toBool() );
+
   mMapCanvas->setMapUpdateInterval( mySettings.value( QStringLiteral( "qgis/map_update_interval" ), 250 ).toInt() );
 }
 
@@ -9141,6 +9143,8 @@ void QgisApp::showOptionsDialog( QWidget *parent, const QString &currentPage )
 
     mMapCanvas->setParallelRenderingEnabled( mySettings.value( QStringLiteral( "qgis/parallel_rendering" ), true ).toBool() );
 
+    mMapCanvas->setProgressiveRenderingEnabled( mySettings.value( QStringLiteral( "qgis/progressive_rendering" ), false ).toBool() );
+
     mMapCanvas->setMapUpdateInterval( mySettings.value( QStringLiteral( "qgis/map_update_interval" ), 250 ).toInt() );
 
     if ( oldCapitalize != mySettings.value( QStringLiteral( "qgis/capitalizeLayerName" ), QVariant( false ) ).toBool() )
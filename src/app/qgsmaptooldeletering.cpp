@@ -114,7 +114,6 @@ void QgsMapToolDeleteRing::canvasReleaseEvent( QgsMapMouseEvent *e )
     vlayer->beginEditCommand( tr( "Ring deleted" ) );
     vlayer->changeGeometry( mPressedFid, g );
     vlayer->endEditCommand();
-    vlayer->triggerRepaint();
   }
 }
 
@@ -197,7 +196,6 @@ void QgsMapToolDeleteRing::deleteRing( QgsFeatureId fId, int beforeVertexNr, Qgs
     vlayer->beginEditCommand( tr( "Ring deleted" ) );
     vlayer->changeGeometry( fId, editableGeom );
     vlayer->endEditCommand();
-    vlayer->triggerRepaint();
   }
 
 }
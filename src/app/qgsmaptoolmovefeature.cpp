@@ -194,7 +194,6 @@ void QgsMapToolMoveFeature::cadCanvasReleaseEvent( QgsMapMouseEvent *e )
     }
 
     vlayer->endEditCommand();
-    vlayer->triggerRepaint();
   }
 }
 
@@ -400,7 +400,6 @@ void QgsMapToolRotateFeature::applyRotation( double rotation )
   deleteRubberband();
 
   vlayer->endEditCommand();
-  vlayer->triggerRepaint();
 }
 
 void QgsMapToolRotateFeature::activate()
@@ -20,12 +20,13 @@
 #include "qgscolorramp.h"
 #include "qgslogger.h"
 #include <QtConcurrentMap>
+#include <QThread>
 #include <QColor>
 #include <QPainter>
 #include <qmath.h>
 
-//determined via trial-and-error. Could possibly be optimised, or varied
-//depending on the image size.
+//minimum number of blocks for threaded operations, determined via trial-and-error.
+//More blocks are used on machines with many cores.
 #define BLOCK_THREADS 16
 
 #define INF 1E20
@@ -145,30 +146,46 @@ void QgsImageOperation::runLineOperationOnWholeImage( QImage &image, LineOperati
 
 //multithreaded block processing
 
-template <typename BlockOperation>
-void QgsImageOperation::runBlockOperationInThreads( QImage &image, BlockOperation &operation, LineOperationDirection direction )
+QList< QgsImageOperation::ImageBlock > QgsImageOperation::splitIntoBlocks( unsigned int lineCount, unsigned int lineLength, bool threaded )
 {
-  QList< ImageBlock > blocks;
-  unsigned int height = image.height();
-  unsigned int width = image.width();
-
-  unsigned int blockDimension1 = ( direction == QgsImageOperation::ByRow ) ? height : width;
-  unsigned int blockDimension2 = ( direction == QgsImageOperation::ByRow ) ? width : height;
+  //use at least BLOCK_THREADS blocks, but keep every thread of the global pool busy
+  //on machines with many cores
+  unsigned int blockCount = 1;
+  if ( threaded )
+  {
+    blockCount = qMax( BLOCK_THREADS, 2 * QThread::idealThreadCount() );
+    blockCount = qBound( 1U, blockCount, lineCount );
+  }
 
-  //chunk image up into vertical blocks
-  blocks.reserve( BLOCK_THREADS );
+  QList< ImageBlock > blocks;
+  blocks.reserve( blockCount );
   unsigned int begin = 0;
-  unsigned int blockLen = blockDimension1 / BLOCK_THREADS;
-  for ( unsigned int block = 0; block < BLOCK_THREADS; ++block, begin += blockLen )
+  unsigned int blockLen = lineCount / blockCount;
+  for ( unsigned int block = 0; block < blockCount; ++block, begin += blockLen )
   {
     ImageBlock newBlock;
     newBlock.beginLine = begin;
     //make sure last block goes to end of image
-    newBlock.endLine = block < ( BLOCK_THREADS - 1 ) ? begin + blockLen : blockDimension1;
-    newBlock.lineLength = blockDimension2;
-    newBlock.image = &image;
+    newBlock.endLine = block < ( blockCount - 1 ) ? begin + blockLen : lineCount;
+    newBlock.lineLength = lineLength;
     blocks << newBlock;
   }
+  return blocks;
+}
+
+template <typename BlockOperation>
+void QgsImageOperation::runBlockOperationInThreads( QImage &image, BlockOperation &operation, LineOperationDirection direction )
+{
+  unsigned int height = image.height();
+  unsigned int width = image.width();
+
+  unsigned int blockDimension1 = ( direction == QgsImageOperation::ByRow ) ? height : width;
+  unsigned int blockDimension2 = ( direction == QgsImageOperation::ByRow ) ? width : height;
+
+  //chunk image up into blocks
+  QList< ImageBlock > blocks = splitIntoBlocks( blockDimension1, blockDimension2, true );
+  for ( ImageBlock &block : blocks )
+    block.image = &image;
 
   //process blocks
   QtConcurrent::blockingMap( blocks, operation );
@@ -382,8 +399,8 @@ void QgsImageOperation::distanceTransform( QImage &image, const DistanceTransfor
   ConvertToArrayPixelOperation convertToArray( image.width(), array, properties.shadeExterior );
   runPixelOperation( image, convertToArray );
 
-  //calculate distance transform (single threaded only)
-  distanceTransform2d( array, image.width(), image.height() );
+  //calculate distance transform, threaded for large images
+  distanceTransform2d( array, image.width(), image.height(), image.width() * image.height() >= 100000 );
 
   double spread;
   if ( properties.useMaxDistance )
@@ -477,47 +494,48 @@ double QgsImageOperation::maxValueInDistanceTransformArray( const double *array,
 }
 
 /* distance transform of 2d function using squared distance */
-void QgsImageOperation::distanceTransform2d( double *im, int width, int height )
+void QgsImageOperation::distanceTransform2d( double *im, int width, int height, bool threaded )
 {
-  int maxDimension = qMax( width, height );
+  // each pass transforms independent lines, so both passes are split into
+  // blocks of lines which are processed in parallel when threaded
+  auto transformLines = [im, width, height]( ImageBlock & block, LineOperationDirection direction )
+  {
+    int n = direction == ByColumn ? height : width;
+    int step = direction == ByColumn ? width : 1;
+    int lineStep = direction == ByColumn ? 1 : width;
 
-  double *f = new double[ maxDimension ];
-  int *v = new int[ maxDimension ];
-  double *z = new double[ maxDimension + 1 ];
-  double *d = new double[ maxDimension ];
+    double *f = new double[ n ];
+    int *v = new int[ n ];
+    double *z = new double[ n + 1 ];
+    double *d = new double[ n ];
 
-  // transform along columns
-  for ( int x = 0; x < width; x++ )
-  {
-    for ( int y = 0; y < height; y++ )
-    {
-      f[y] = im[ x + y * width ];
-    }
-    distanceTransform1d( f, height, v, z, d );
-    for ( int y = 0; y < height; y++ )
+    for ( unsigned int line = block.beginLine; line < block.endLine; ++line )
     {
-      im[ x + y * width ] = d[y];
+      double *lineStart = im + line * lineStep;
+      for ( int i = 0; i < n; ++i )
+      {
+        f[i] = lineStart[ i * step ];
+      }
+      distanceTransform1d( f, n, v, z, d );
+      for ( int i = 0; i < n; ++i )
+      {
+        lineStart[ i * step ] = d[i];
+      }
     }
-  }
 
-  // transform along rows
-  for ( int y = 0; y < height; y++ )
-  {
-    for ( int x = 0; x < width; x++ )
-    {
-      f[x] = im[  x + y * width ];
-    }
-    distanceTransform1d( f, width, v, z, d );
-    for ( int x = 0; x < width; x++ )
-    {
-      im[  x + y * width ] = d[x];
-    }
-  }
+    delete [] d;
+    delete [] f;
+    delete [] v;
+    delete [] z;
+  };
 
-  delete [] d;
-  delete [] f;
-  delete [] v;
-  delete [] z;
+  // transform along columns
+  QList< ImageBlock > columnBlocks = splitIntoBlocks( width, height, threaded );
+  QtConcurrent::blockingMap( columnBlocks, [&transformLines]( ImageBlock & block ) { transformLines( block, ByColumn ); } );
+
+  // transform along rows
+  QList< ImageBlock > rowBlocks = splitIntoBlocks( height, width, threaded );
+  QtConcurrent::blockingMap( rowBlocks, [&transformLines]( ImageBlock & block ) { transformLines( block, ByRow ); } );
 }
 
 void QgsImageOperation::ShadeFromArrayOperation::operator()( QRgb &rgb, const int x, const int y )
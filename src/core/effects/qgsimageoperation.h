@@ -20,6 +20,7 @@
 
 #include <QImage>
 #include <QColor>
+#include <QList>
 #include <QtCore/qmath.h>
 
 #include "qgis_core.h"
@@ -205,6 +206,12 @@ class CORE_EXPORT QgsImageOperation
       QImage *image = nullptr;
     };
 
+    /**
+     * Splits \a lineCount lines of length \a lineLength into blocks for processing
+     * on the global thread pool. If \a threaded is false a single block is returned.
+     */
+    static QList< ImageBlock > splitIntoBlocks( unsigned int lineCount, unsigned int lineLength, bool threaded );
+
     //for rect operations
     template <typename RectOperation> static void runRectOperation( QImage &image, RectOperation &operation );
     template <class RectOperation> static void runRectOperationOnWholeImage( QImage &image, RectOperation &operation );
@@ -386,7 +393,7 @@ class CORE_EXPORT QgsImageOperation
         double mSpreadSquared;
         const DistanceTransformProperties &mProperties;
     };
-    static void distanceTransform2d( double *im, int width, int height );
+    static void distanceTransform2d( double *im, int width, int height, bool threaded );
     static void distanceTransform1d( double *f, int n, int *v, double *z, double *d );
     static double maxValueInDistanceTransformArray( const double *array, const unsigned int size );
 
@@ -464,7 +471,7 @@ class CORE_EXPORT QgsImageOperation
         LineOperationDirection mDirection;
     };
 
-
+    friend class TestQgsImageOperation;
 };
 
 #endif // QGSIMAGEOPERATION_H
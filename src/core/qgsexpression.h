@@ -1215,6 +1215,16 @@ class CORE_EXPORT QgsExpression
         {}
         ~NodeCondition() { delete mElseExp; qDeleteAll( mConditions ); }
 
+        /** Returns the list of WHEN ... THEN conditions of the node.
+         * @note added in QGIS 3.0
+         */
+        WhenThenList conditions() const { return mConditions; }
+
+        /** Returns the ELSE expression of the node, or a nullptr if it has none.
+         * @note added in QGIS 3.0
+         */
+        Node *elseExp() const { return mElseExp; }
+
         virtual NodeType nodeType() const override { return ntCondition; }
         virtual QVariant eval( QgsExpression *parent, const QgsExpressionContext *context ) override;
         virtual bool prepare( QgsExpression *parent, const QgsExpressionContext *context ) override;
@@ -28,6 +28,7 @@
 #include "qgsapplication.h"
 #include "qgsmapsettings.h"
 #include "qgsmaplayerlistutils.h"
+#include "qgspropertyresultcache.h"
 
 #include <QSettings>
 #include <QDir>
@@ -223,6 +224,7 @@ QgsExpressionContext::QgsExpressionContext( const QgsExpressionContext &other )
   }
   mHighlightedVariables = other.mHighlightedVariables;
   mCachedValues = other.mCachedValues;
+  mPropertyResultCache = other.mPropertyResultCache;
 }
 
 QgsExpressionContext &QgsExpressionContext::operator=( QgsExpressionContext &&other ) noexcept
@@ -236,6 +238,7 @@ QgsExpressionContext &QgsExpressionContext::operator=( QgsExpressionContext &&ot
 
     mHighlightedVariables = other.mHighlightedVariables;
     mCachedValues = other.mCachedValues;
+    mPropertyResultCache = other.mPropertyResultCache;
   }
   return *this;
 }
@@ -250,6 +253,7 @@ QgsExpressionContext &QgsExpressionContext::operator=( const QgsExpressionContex
   }
   mHighlightedVariables = other.mHighlightedVariables;
   mCachedValues = other.mCachedValues;
+  mPropertyResultCache = other.mPropertyResultCache;
   return *this;
 }
 
@@ -532,6 +536,19 @@ void QgsExpressionContext::clearCachedValues() const
   mCachedValues.clear();
 }
 
+void QgsExpressionContext::setPropertyResultCacheEnabled( bool enabled )
+{
+  if ( !enabled )
+    mPropertyResultCache.reset();
+  else if ( !mPropertyResultCache )
+    mPropertyResultCache = std::make_shared< QgsPropertyResultCache >();
+}
+
+QgsPropertyResultCache *QgsExpressionContext::propertyResultCache() const
+{
+  return mPropertyResultCache.get();
+}
+
 
 //
 // QgsExpressionContextUtils
@@ -21,6 +21,7 @@
 #include <QString>
 #include <QStringList>
 #include <QSet>
+#include <memory>
 #include "qgsfeature.h"
 #include "qgsexpression.h"
 
@@ -32,6 +33,7 @@ class QgsAtlasComposition;
 class QgsMapSettings;
 class QgsProject;
 class QgsSymbol;
+class QgsPropertyResultCache;
 
 /** \ingroup core
  * \class QgsScopedExpressionFunction
@@ -574,6 +576,21 @@ class CORE_EXPORT QgsExpressionContext
      */
     void clearCachedValues() const;
 
+    /** Sets whether the results of data defined property expressions which only depend on the
+     * feature's attributes should be cached and reused for features with the same attribute values.
+     * The cache is shared with all copies of the context made after it was enabled.
+     * @see propertyResultCache()
+     * @note added in QGIS 3.0
+     */
+    void setPropertyResultCacheEnabled( bool enabled );
+
+    /** Returns the cache used for data defined property results, or a nullptr if caching
+     * of property results is not enabled for the context.
+     * @see setPropertyResultCacheEnabled()
+     * @note added in QGIS 3.0
+     */
+    QgsPropertyResultCache *propertyResultCache() const;
+
     //! Inbuilt variable name for fields storage
     static const QString EXPR_FIELDS;
     //! Inbuilt variable name for value original value variable
@@ -603,6 +620,8 @@ class CORE_EXPORT QgsExpressionContext
     // Cache is mutable because we want to be able to add cached values to const contexts
     mutable QMap< QString, QVariant > mCachedValues;
 
+    std::shared_ptr< QgsPropertyResultCache > mPropertyResultCache;
+
 };
 
 /** \ingroup core
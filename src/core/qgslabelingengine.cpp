@@ -26,6 +26,7 @@
 #include "problem.h"
 #include "qgsrendercontext.h"
 #include "qgsmaplayer.h"
+#include "qgsrendertrace.h"
 
 
 // helper function for checking for job cancelation within PAL
@@ -225,6 +226,8 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
 
 
   // for each provider: get labels and register them in PAL
+  QgsRenderTraceSpan registerSpan( context.renderTrace(), QStringLiteral( "Register labels" ), QStringLiteral( "labeling" ) );
+  registerSpan.setArgument( QStringLiteral( "providers" ), mProviders.count() );
   Q_FOREACH ( QgsAbstractLabelProvider *provider, mProviders )
   {
     bool appendedLayerScope = false;
@@ -237,6 +240,7 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
     if ( appendedLayerScope )
       delete context.expressionContext().popScope();
   }
+  registerSpan.end();
 
 
   // NOW DO THE LAYOUT (from QgsPalLabeling::drawLabeling)
@@ -262,6 +266,7 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
 
   QList<pal::LabelPosition *> *labels;
   pal::Problem *problem = nullptr;
+  QgsRenderTraceSpan extractSpan( context.renderTrace(), QStringLiteral( "Extract problem" ), QStringLiteral( "labeling" ) );
   try
   {
     problem = p.extractProblem( bbox );
@@ -272,6 +277,9 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
     QgsDebugMsgLevel( "PAL EXCEPTION :-( " + QString::fromLatin1( e.what() ), 4 );
     return;
   }
+  if ( problem )
+    extractSpan.setArgument( QStringLiteral( "features" ), problem->getNumFeatures() );
+  extractSpan.end();
 
 
   if ( context.renderingStopped() )
@@ -310,7 +318,10 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
   }
 
   // find the solution
+  QgsRenderTraceSpan solveSpan( context.renderTrace(), QStringLiteral( "Solve problem" ), QStringLiteral( "labeling" ) );
   labels = p.solveProblem( problem, mFlags.testFlag( UseAllLabels ) );
+  solveSpan.setArgument( QStringLiteral( "labels" ), labels->size() );
+  solveSpan.end();
 
   QgsDebugMsgLevel( QString( "LABELING work:  %1 ms ... labels# %2" ).arg( t.elapsed() ).arg( labels->size() ), 4 );
   t.restart();
@@ -327,6 +338,7 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
   std::sort( labels->begin(), labels->end(), QgsLabelSorter( mMapSettings ) );
 
   // draw the labels
+  QgsRenderTraceSpan drawSpan( context.renderTrace(), QStringLiteral( "Draw labels" ), QStringLiteral( "labeling" ) );
   QList<pal::LabelPosition *>::iterator it = labels->begin();
   for ( ; it != labels->end(); ++it )
   {
@@ -345,6 +357,7 @@ void QgsLabelingEngine::run( QgsRenderContext &context )
   // Reset composition mode for further drawing operations
   painter->setCompositionMode( QPainter::CompositionMode_SourceOver );
 
+  drawSpan.end();
   QgsDebugMsgLevel( QString( "LABELING draw:  %1 ms" ).arg( t.elapsed() ), 4 );
 
   delete problem;
@@ -1632,6 +1632,14 @@ void QgsMapLayer::triggerRepaint( bool deferredUpdate )
   emit repaintRequested( deferredUpdate );
 }
 
+void QgsMapLayer::triggerPartialRepaint( const QgsRectangle &extent )
+{
+  if ( extent.isNull() )
+    emit repaintRequested();
+  else
+    emit partialRepaintRequested( extent );
+}
+
 QString QgsMapLayer::metadata() const
 {
   return QString();
@@ -720,6 +720,16 @@ class CORE_EXPORT QgsMapLayer : public QObject
      */
     void triggerRepaint( bool deferredUpdate = false );
 
+    /**
+     * Will advise the map canvas (and any other interested party) that only the part of this layer
+     * within \a extent (in the layer's CRS) requires to be repainted, e.g. after a single feature
+     * has been edited. Will emit a partialRepaintRequested() signal.
+     * Passing a null rectangle is equivalent to calling triggerRepaint().
+     *
+     * @note added in QGIS 3.0
+     */
+    void triggerPartialRepaint( const QgsRectangle &extent );
+
     //! \brief Obtain Metadata for this layer
     virtual QString metadata() const;
 
@@ -772,6 +782,14 @@ class CORE_EXPORT QgsMapLayer : public QObject
      */
     void repaintRequested( bool deferredUpdate = false );
 
+    /** By emitting this signal the layer tells that only the content within \a extent (in the layer's CRS)
+     * has been changed. Any view showing the rendered layer should refresh itself, but may keep
+     * the parts of a previously rendered layer image which lie outside of the extent.
+     * @see triggerPartialRepaint()
+     * @note added in QGIS 3.0
+     */
+    void partialRepaintRequested( const QgsRectangle &extent );
+
     //! This is used to send a request that any mapcanvas using this layer update its extents
     void recalculateExtents() const;
 
@@ -17,6 +17,9 @@
 
 #include "qgsmaplayer.h"
 #include "qgsmaplayerlistutils.h"
+#include "qgsmaptopixel.h"
+
+#include <QPainter>
 
 QgsMapRendererCache::QgsMapRendererCache()
 {
@@ -33,6 +36,8 @@ void QgsMapRendererCache::clearInternal()
 {
   mExtent.setMinimal();
   mScale = 0;
+  mSize = QSize();
+  mRotation = 0;
 
   // make sure we are disconnected from all layers
   Q_FOREACH ( const QgsWeakMapLayerPointer &layer, mConnectedLayers )
@@ -41,6 +46,7 @@ void QgsMapRendererCache::clearInternal()
     {
       disconnect( layer.data(), &QgsMapLayer::repaintRequested, this, &QgsMapRendererCache::layerRequestedRepaint );
       disconnect( layer.data(), &QgsMapLayer::willBeDeleted, this, &QgsMapRendererCache::layerRequestedRepaint );
+      disconnect( layer.data(), &QgsMapLayer::partialRepaintRequested, this, &QgsMapRendererCache::layerRequestedPartialRepaint );
     }
   }
   mCachedImages.clear();
@@ -57,6 +63,7 @@ void QgsMapRendererCache::dropUnusedConnections()
     {
       disconnect( layer.data(), &QgsMapLayer::repaintRequested, this, &QgsMapRendererCache::layerRequestedRepaint );
       disconnect( layer.data(), &QgsMapLayer::willBeDeleted, this, &QgsMapRendererCache::layerRequestedRepaint );
+      disconnect( layer.data(), &QgsMapLayer::partialRepaintRequested, this, &QgsMapRendererCache::layerRequestedPartialRepaint );
     }
   }
 
@@ -96,6 +103,100 @@ bool QgsMapRendererCache::init( const QgsRectangle &extent, double scale )
   return false;
 }
 
+bool QgsMapRendererCache::init( const QgsRectangle &extent, double scale, const QgsMapToPixel &mapToPixel, int margin )
+{
+  QMutexLocker lock( &mMutex );
+
+  QSize size( mapToPixel.mapWidth(), mapToPixel.mapHeight() );
+  double rotation = mapToPixel.mapRotation();
+  bool sameView = qgsDoubleNear( scale, mScale ) && size == mSize && qgsDoubleNear( rotation, mRotation );
+
+  // check whether the params are the same
+  if ( extent == mExtent && sameView )
+    return true;
+
+  bool isPan = false;
+  int dx = 0;
+  int dy = 0;
+  if ( sameView && !mExtent.isNull() )
+  {
+    // the previous map center is drawn at the center of the cached images - find
+    // out where it ends up in the new map to get the offset of the pan
+    QgsPoint oldCenter = mapToPixel.transform( mExtent.center() );
+    double offsetX = oldCenter.x() - size.width() / 2.0;
+    double offsetY = oldCenter.y() - size.height() / 2.0;
+    dx = qRound( offsetX );
+    dy = qRound( offsetY );
+    // images can only be reused if they are shifted by whole pixels, otherwise content would be resampled
+    isPan = qgsDoubleNear( offsetX, dx, 0.01 ) && qgsDoubleNear( offsetY, dy, 0.01 )
+            && qAbs( dx ) < size.width() && qAbs( dy ) < size.height();
+  }
+
+  if ( isPan )
+  {
+    panInternal( dx, dy, margin );
+  }
+  else
+  {
+    clearInternal();
+  }
+
+  // set new params
+  mExtent = extent;
+  mScale = scale;
+  mSize = size;
+  mRotation = rotation;
+
+  return false;
+}
+
+void QgsMapRendererCache::panInternal( int dx, int dy, int margin )
+{
+  QRect imageRect( QPoint( 0, 0 ), mSize );
+
+  // the content of the shifted images remains valid, except close to the previous
+  // edges of the map which have moved inside the new map
+  QRect validRect = imageRect.translated( dx, dy );
+  validRect.adjust( dx > 0 ? margin : 0, dy > 0 ? margin : 0, dx < 0 ? -margin : 0, dy < 0 ? -margin : 0 );
+  validRect = validRect.intersected( imageRect );
+
+  QMap<QString, CacheParameters>::iterator it = mCachedImages.begin();
+  for ( ; it != mCachedImages.end(); )
+  {
+    CacheParameters &params = it.value();
+
+    // only images rendered for a single layer can be shifted - anything else
+    // (e.g. labeling results) depends on the whole extent of the map
+    bool isLayerImage = false;
+    Q_FOREACH ( const QgsWeakMapLayerPointer &layer, params.dependentLayers )
+    {
+      if ( layer.data() && layer->id() == it.key() )
+        isLayerImage = true;
+    }
+
+    if ( !isLayerImage || params.cachedImage.size() != mSize || validRect.isEmpty() )
+    {
+      it = mCachedImages.erase( it );
+      continue;
+    }
+
+    QImage shifted( mSize, params.cachedImage.format() );
+    shifted.fill( 0 );
+    QPainter painter( &shifted );
+    painter.setCompositionMode( QPainter::CompositionMode_Source );
+    painter.drawImage( dx, dy, params.cachedImage );
+    painter.end();
+    params.cachedImage = shifted;
+
+    params.invalidRegion.translate( dx, dy );
+    params.invalidRegion += QRegion( imageRect ).subtracted( QRegion( validRect ) );
+    params.invalidRegion &= QRegion( imageRect );
+    ++it;
+  }
+
+  dropUnusedConnections();
+}
+
 void QgsMapRendererCache::setCacheImage( const QString &cacheKey, const QImage &image, const QList<QgsMapLayer *> &dependentLayers )
 {
   QMutexLocker lock( &mMutex );
@@ -113,6 +214,7 @@ void QgsMapRendererCache::setCacheImage( const QString &cacheKey, const QImage &
       {
         connect( layer, &QgsMapLayer::repaintRequested, this, &QgsMapRendererCache::layerRequestedRepaint );
         connect( layer, &QgsMapLayer::willBeDeleted, this, &QgsMapRendererCache::layerRequestedRepaint );
+        connect( layer, &QgsMapLayer::partialRepaintRequested, this, &QgsMapRendererCache::layerRequestedPartialRepaint );
         mConnectedLayers << layer;
       }
     }
@@ -132,6 +234,18 @@ QImage QgsMapRendererCache::cacheImage( const QString &cacheKey ) const
   return mCachedImages.value( cacheKey ).cachedImage;
 }
 
+QList< QgsRectangle > QgsMapRendererCache::dirtyExtents( const QString &cacheKey ) const
+{
+  QMutexLocker lock( &mMutex );
+  return mCachedImages.value( cacheKey ).dirtyExtents;
+}
+
+QRegion QgsMapRendererCache::invalidRegion( const QString &cacheKey ) const
+{
+  QMutexLocker lock( &mMutex );
+  return mCachedImages.value( cacheKey ).invalidRegion;
+}
+
 QList< QgsMapLayer * > QgsMapRendererCache::dependentLayers( const QString &cacheKey ) const
 {
   if ( mCachedImages.contains( cacheKey ) )
@@ -164,6 +278,37 @@ void QgsMapRendererCache::layerRequestedRepaint()
   dropUnusedConnections();
 }
 
+void QgsMapRendererCache::layerRequestedPartialRepaint( const QgsRectangle &extent )
+{
+  QgsMapLayer *layer = qobject_cast<QgsMapLayer *>( sender() );
+  if ( !layer )
+    return;
+
+  QMutexLocker lock( &mMutex );
+
+  // the image rendered for the layer itself can be partially redrawn, but any other
+  // images depending on the layer (e.g. labeling results) have to be cleared
+  QMap<QString, CacheParameters>::iterator it = mCachedImages.begin();
+  for ( ; it != mCachedImages.end(); )
+  {
+    if ( !it.value().dependentLayers.contains( layer ) )
+    {
+      ++it;
+      continue;
+    }
+
+    if ( it.key() == layer->id() && !extent.isNull() )
+    {
+      it.value().dirtyExtents << extent;
+      ++it;
+      continue;
+    }
+
+    it = mCachedImages.erase( it );
+  }
+  dropUnusedConnections();
+}
+
 void QgsMapRendererCache::clearCacheImage( const QString &cacheKey )
 {
   QMutexLocker lock( &mMutex );
@@ -20,10 +20,13 @@
 #include <QMap>
 #include <QImage>
 #include <QMutex>
+#include <QRegion>
 
 #include "qgsrectangle.h"
 #include "qgsmaplayer.h"
 
+class QgsMapToPixel;
+
 
 /** \ingroup core
  * This class is responsible for keeping cache of rendered images resulting from
@@ -34,6 +37,12 @@
  * If triggered, the cache removes the rendered image (and disconnects from the
  * layers).
  *
+ * Layers may also request that only a part of their rendered image is redrawn (see
+ * QgsMapLayer::partialRepaintRequested()), e.g. after a single feature has been edited.
+ * In this case the image cached for the layer is retained and the invalidated extent
+ * is recorded, so that only the affected parts of the image need to be rendered again
+ * (see dirtyExtents()).
+ *
  * The class is thread-safe (multiple classes can access the same instance safely).
  *
  * @note added in 2.4
@@ -58,6 +67,22 @@ class CORE_EXPORT QgsMapRendererCache : public QObject
      */
     bool init( const QgsRectangle &extent, double scale );
 
+    /**
+     * Initialize cache: set new parameters and clears the cache if any
+     * parameters have changed since last initialization.
+     *
+     * If the map has just been panned (i.e. the \a extent has moved while the scale, rotation
+     * and size of the map described by \a mapToPixel stayed the same, and the shift is a whole
+     * number of pixels), the images cached for individual layers are not cleared but shifted
+     * to follow the pan instead. The newly exposed parts of these images, plus a strip of
+     * \a margin pixels along their previous edges (where symbols of features outside the
+     * previous extent would be missing), are reported by invalidRegion() and need to be
+     * rendered again. All other images (e.g. labeling results) are cleared.
+     * @return flag whether the parameters are the same as last time
+     * @note added in QGIS 3.0
+     */
+    bool init( const QgsRectangle &extent, double scale, const QgsMapToPixel &mapToPixel, int margin = 0 );
+
     /**
      * Set the cached \a image for a particular \a cacheKey. The \a cacheKey usually
      * matches the QgsMapLayer::id() which the image is a render of.
@@ -84,6 +109,26 @@ class CORE_EXPORT QgsMapRendererCache : public QObject
      */
     QImage cacheImage( const QString &cacheKey ) const;
 
+    /**
+     * Returns the list of extents (in the layer's CRS) which have been invalidated for the
+     * image with the specified \a cacheKey since it was cached. The remainder of the cached
+     * image is still valid, so only the parts covering these extents need to be redrawn.
+     * An empty list is returned if the whole image is valid (or if no image is cached).
+     * @note added in QGIS 3.0
+     * @see hasCacheImage()
+     */
+    QList< QgsRectangle > dirtyExtents( const QString &cacheKey ) const;
+
+    /**
+     * Returns the region (in pixels) of the image with the specified \a cacheKey which does
+     * not hold valid content, e.g. the parts of the map newly exposed after the cached image
+     * was shifted to follow a pan (see init()). The remainder of the image is still valid.
+     * An empty region is returned if the whole image is valid (or if no image is cached).
+     * @note added in QGIS 3.0
+     * @see dirtyExtents()
+     */
+    QRegion invalidRegion( const QString &cacheKey ) const;
+
     /**
      * Returns a list of map layers on which an image in the cache depends.
      * @note added in QGIS 3.0
@@ -100,14 +145,24 @@ class CORE_EXPORT QgsMapRendererCache : public QObject
     //! Remove layer (that emitted the signal) from the cache
     void layerRequestedRepaint();
 
+    //! Mark part of the image of the layer (that emitted the signal) as dirty
+    void layerRequestedPartialRepaint( const QgsRectangle &extent );
+
   private:
 
     struct CacheParameters
     {
       QImage cachedImage;
       QgsWeakMapLayerPointerList dependentLayers;
+      //! Extents (in layer CRS) invalidated since the image was cached
+      QList< QgsRectangle > dirtyExtents;
+      //! Parts of the image (in pixels) without valid content
+      QRegion invalidRegion;
     };
 
+    //! Shifts the images cached for individual layers by an offset in pixels (without locking)
+    void panInternal( int dx, int dy, int margin );
+
     //! Invalidate cache contents (without locking)
     void clearInternal();
 
@@ -119,6 +174,9 @@ class CORE_EXPORT QgsMapRendererCache : public QObject
     mutable QMutex mMutex;
     QgsRectangle mExtent;
     double mScale = 0;
+    //! Map size in pixels, or invalid if not known
+    QSize mSize;
+    double mRotation = 0;
 
     //! Map of cache key to cache parameters
     QMap<QString, CacheParameters> mCachedImages;
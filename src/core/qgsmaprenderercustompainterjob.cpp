@@ -24,6 +24,7 @@
 #include "qgsvectorlayer.h"
 #include "qgsrenderer.h"
 #include "qgsmaplayerlistutils.h"
+#include "qgsrendertrace.h"
 
 QgsMapRendererCustomPainterJob::QgsMapRendererCustomPainterJob( const QgsMapSettings &settings, QPainter *painter )
   : QgsMapRendererJob( settings )
@@ -47,6 +48,7 @@ void QgsMapRendererCustomPainterJob::start()
     return;
 
   mRenderingStart.start();
+  mTimeToFirstFrame = -1;
 
   mActive = true;
 
@@ -256,10 +258,13 @@ void QgsMapRendererCustomPainterJob::doRender()
       QTime layerTime;
       layerTime.start();
 
-      if ( job.img )
+      if ( job.img && !job.partial )
         job.img->fill( 0 );
 
+      QgsRenderTraceSpan span( job.context.renderTrace(), job.layer ? job.layer->name() : QString(), QStringLiteral( "layer" ) );
+      span.setArgument( QStringLiteral( "layer_id" ), job.layer ? job.layer->id() : QString() );
       job.renderer->render();
+      span.end();
 
       job.renderingTime = layerTime.elapsed();
     }
@@ -275,6 +280,7 @@ void QgsMapRendererCustomPainterJob::doRender()
   }
 
   QgsDebugMsg( "Done rendering map layers" );
+  mTimeToFirstFrame = mRenderingStart.elapsed();
 
   if ( mSettings.testFlag( QgsMapSettings::DrawLabeling ) && !mLabelJob.context.renderingStopped() )
   {
@@ -324,8 +330,12 @@ void QgsMapRendererJob::drawLabeling( const QgsMapSettings &settings, QgsRenderC
   painter->setCompositionMode( QPainter::CompositionMode_SourceOver );
 
   // TODO: this is not ideal - we could override rendering stopped flag that has been set in meanwhile
+  QgsRenderTrace *trace = renderContext.renderTrace();
   renderContext = QgsRenderContext::fromMapSettings( settings );
   renderContext.setPainter( painter );
+  renderContext.setRenderTrace( trace );
+
+  QgsRenderTraceSpan span( trace, QStringLiteral( "Labeling" ), QStringLiteral( "labeling" ) );
 
   if ( labelingEngine2 )
   {
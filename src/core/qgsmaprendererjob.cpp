@@ -16,9 +16,11 @@
 #include "qgsmaprendererjob.h"
 
 #include <QPainter>
+#include <QRegion>
 #include <QTime>
 #include <QTimer>
 #include <QtConcurrentMap>
+#include <qmath.h>
 
 #include "qgslogger.h"
 #include "qgsrendercontext.h"
@@ -36,11 +38,55 @@
 #include "qgsmaplayerlistutils.h"
 #include "qgsvectorlayerlabeling.h"
 #include "qgssettings.h"
+#include "qgsrenderer.h"
+#include "qgspainteffect.h"
+#include "qgsrendertrace.h"
+#include "qgssymbol.h"
+#include "qgssymbollayer.h"
+#include "qgssymbollayerutils.h"
 
 ///@cond PRIVATE
 
 const QString QgsMapRendererJob::LABEL_CACHE_ID = QStringLiteral( "_labels_" );
 
+//! Size (in pixels) of the tiles in which cached layer images are partially redrawn
+static const int PARTIAL_RENDER_TILE_SIZE = 256;
+//! Margin (in pixels) added to the estimated bleed of symbols to cover antialiasing
+static const int PARTIAL_RENDER_ANTIALIASING_MARGIN = 2;
+
+//! Returns how far (in pixels) a symbol may draw outside of the bounds of a feature, or -1 if this is not known in advance
+static double symbolBleed( QgsSymbol *symbol, QgsRenderContext &context )
+{
+  // sizes, offsets and widths evaluated per feature can't be bounded in advance
+  if ( symbol->hasDataDefinedProperties() )
+    return -1;
+
+  double bleed = QgsSymbolLayerUtils::estimateMaxSymbolBleed( symbol, context );
+  if ( symbol->type() == QgsSymbol::Marker )
+  {
+    QRectF bounds = static_cast< QgsMarkerSymbol * >( symbol )->bounds( QPointF( 0, 0 ), context );
+    bleed = qMax( bleed, qMax( qMax( -bounds.left(), bounds.right() ), qMax( -bounds.top(), bounds.bottom() ) ) );
+  }
+
+  for ( int i = 0; i < symbol->symbolLayerCount(); ++i )
+  {
+    QgsSymbolLayer *layer = symbol->symbolLayer( i );
+    // effects, generated geometries and arrows draw beyond what estimateMaxBleed() reports
+    if ( ( layer->paintEffect() && layer->paintEffect()->enabled() )
+         || layer->layerType() == QLatin1String( "GeometryGenerator" ) || layer->layerType() == QLatin1String( "ArrowLine" ) )
+      return -1;
+
+    if ( QgsSymbol *subSymbol = layer->subSymbol() )
+    {
+      double subSymbolBleed = symbolBleed( subSymbol, context );
+      if ( subSymbolBleed < 0 )
+        return -1;
+      bleed = qMax( bleed, subSymbolBleed );
+    }
+  }
+  return bleed;
+}
+
 QgsMapRendererJob::QgsMapRendererJob( const QgsMapSettings &settings )
   : mSettings( settings )
   , mCache( nullptr )
@@ -209,7 +255,89 @@ bool QgsMapRendererJob::reprojectToLayerExtent( const QgsMapLayer *ml, const Qgs
 
 
 
-LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEngine *labelingEngine2 )
+bool QgsMapRendererJob::canRenderPartially( QgsMapLayer *ml )
+{
+  QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( ml );
+  if ( !vl || !vl->renderer() )
+    return false;
+
+  // labels and diagrams are placed considering all features of the layer
+  if ( QgsPalLabeling::staticWillUseLayer( vl ) || vl->diagramsEnabled() )
+    return false;
+
+  // effects applied to the whole layer may reach outside the dirty tiles
+  if ( vl->renderer()->paintEffect() && vl->renderer()->paintEffect()->enabled() )
+    return false;
+
+  // renderers which combine features (e.g. heatmaps, point clusters, inverted polygons)
+  // can't be redrawn piece by piece
+  QString type = vl->renderer()->type();
+  return type == QLatin1String( "singleSymbol" ) || type == QLatin1String( "categorizedSymbol" )
+         || type == QLatin1String( "graduatedSymbol" ) || type == QLatin1String( "RuleRenderer" );
+}
+
+int QgsMapRendererJob::partialRenderMargin( QgsMapLayer *ml, QgsRenderContext &context )
+{
+  QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( ml );
+  if ( !vl || !vl->renderer() )
+    return -1;
+
+  double bleed = 0;
+  Q_FOREACH ( QgsSymbol *symbol, vl->renderer()->symbols( context ) )
+  {
+    double symbolMaxBleed = symbolBleed( symbol, context );
+    if ( symbolMaxBleed < 0 )
+      return -1;
+    bleed = qMax( bleed, symbolMaxBleed );
+  }
+  return qCeil( bleed ) + PARTIAL_RENDER_ANTIALIASING_MARGIN;
+}
+
+bool QgsMapRendererJob::dirtyRegionForExtents( const QList< QgsRectangle > &extents, const QgsCoordinateTransform &ct, int margin, QRegion &region ) const
+{
+  QRect imageRect( QPoint( 0, 0 ), mSettings.outputSize() );
+  const QgsMapToPixel &mtp = mSettings.mapToPixel();
+
+  Q_FOREACH ( const QgsRectangle &layerExtent, extents )
+  {
+    QgsRectangle extent = layerExtent;
+    if ( ct.isValid() )
+    {
+      try
+      {
+        extent = ct.transformBoundingBox( extent );
+      }
+      catch ( QgsCsException &cse )
+      {
+        Q_UNUSED( cse );
+        QgsDebugMsg( "Transform error caught" );
+        return false;
+      }
+    }
+    if ( !extent.isFinite() )
+      return false;
+
+    QgsPoint topLeft = mtp.transform( extent.xMinimum(), extent.yMaximum() );
+    QgsPoint bottomRight = mtp.transform( extent.xMaximum(), extent.yMinimum() );
+    QRect rect = QRect( QPoint( qFloor( topLeft.x() ), qFloor( topLeft.y() ) ),
+                        QPoint( qCeil( bottomRight.x() ), qCeil( bottomRight.y() ) ) ).normalized();
+    rect.adjust( -margin, -margin, margin, margin );
+    rect = rect.intersected( imageRect );
+    if ( rect.isEmpty() )
+      continue;
+
+    // snap to the tile grid, so that repeated edits in an area touch the same pixels
+    int left = rect.left() / PARTIAL_RENDER_TILE_SIZE * PARTIAL_RENDER_TILE_SIZE;
+    int top = rect.top() / PARTIAL_RENDER_TILE_SIZE * PARTIAL_RENDER_TILE_SIZE;
+    int right = ( rect.right() / PARTIAL_RENDER_TILE_SIZE + 1 ) * PARTIAL_RENDER_TILE_SIZE;
+    int bottom = ( rect.bottom() / PARTIAL_RENDER_TILE_SIZE + 1 ) * PARTIAL_RENDER_TILE_SIZE;
+    region += QRect( left, top, right - left, bottom - top ).intersected( imageRect );
+  }
+  return true;
+}
+
+
+LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEngine *labelingEngine2, bool preview )
 {
   LayerRenderJobs layerJobs;
 
@@ -219,7 +347,8 @@ LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEn
 
   if ( mCache )
   {
-    bool cacheValid = mCache->init( mSettings.visibleExtent(), mSettings.scale() );
+    // the parts exposed by a pan are grown by the margin of each layer's symbols below
+    bool cacheValid = mCache->init( mSettings.visibleExtent(), mSettings.scale(), mSettings.mapToPixel() );
     Q_UNUSED( cacheValid );
     QgsDebugMsg( QString( "CACHE VALID: %1" ).arg( cacheValid ) );
   }
@@ -261,14 +390,14 @@ LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEn
       continue;
     }
 
-    // Force render of layers that are being edited
-    // or if there's a labeling engine that needs the layer to register features
+    // Force render of layers if there's a labeling engine that needs the layer to register features.
+    // (Layers being edited invalidate the parts of their cached image affected by edits themselves)
     if ( mCache && ml->type() == QgsMapLayer::VectorLayer )
     {
       QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( ml );
       bool requiresLabeling = false;
       requiresLabeling = ( labelingEngine2 && QgsPalLabeling::staticWillUseLayer( vl ) ) && requiresLabelRedraw;
-      if ( vl->isEditable() || requiresLabeling )
+      if ( requiresLabeling )
       {
         mCache->clearCacheImage( ml->id() );
       }
@@ -277,6 +406,7 @@ LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEn
     layerJobs.append( LayerRenderJob() );
     LayerRenderJob &job = layerJobs.last();
     job.cached = false;
+    job.partial = false;
     job.img = nullptr;
     job.blendMode = ml->blendMode();
     job.opacity = 1.0;
@@ -293,24 +423,96 @@ LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEn
     job.context.setLabelingEngine( labelingEngine2 );
     job.context.setCoordinateTransform( ct );
     job.context.setExtent( r1 );
+    if ( preview )
+      job.context.setFlag( QgsRenderContext::RenderPreview );
 
     if ( mFeatureFilterProvider )
       job.context.setFeatureFilterProvider( mFeatureFilterProvider );
 
+    job.context.setRenderTrace( mRenderTrace );
+
     // if we can use the cache, let's do it and avoid rendering!
+    QRegion dirtyRegion;
     if ( mCache && mCache->hasCacheImage( ml->id() ) )
     {
-      job.cached = true;
-      job.img = new QImage( mCache->cacheImage( ml->id() ) );
-      job.renderer = nullptr;
-      job.context.setPainter( nullptr );
+      QList< QgsRectangle > dirtyExtents = mCache->dirtyExtents( ml->id() );
+      QRegion invalidRegion = mCache->invalidRegion( ml->id() );
+      QImage cachedImage = mCache->cacheImage( ml->id() );
+      bool isDirty = !dirtyExtents.isEmpty() || !invalidRegion.isEmpty();
+      bool canUsePartial = isDirty
+                           && cachedImage.size() == mSettings.outputSize()
+                           && cachedImage.format() == mSettings.outputImageFormat()
+                           && !mSettings.layerStyleOverrides().contains( ml->id() )
+                           && canRenderPartially( ml );
+      // symbols of features outside the dirty parts may reach into them, layers whose symbols
+      // can't be bounded in advance are redrawn completely
+      int margin = canUsePartial ? partialRenderMargin( ml, job.context ) : -1;
+      canUsePartial = canUsePartial && margin >= 0 && dirtyRegionForExtents( dirtyExtents, ct, margin, dirtyRegion );
+      if ( canUsePartial )
+      {
+        // parts of the image exposed by panning the map, plus the margin where symbols of
+        // features in these parts reach into the rest of the image
+        QRect imageRect( QPoint( 0, 0 ), mSettings.outputSize() );
+        Q_FOREACH ( const QRect &rect, invalidRegion.rects() )
+          dirtyRegion += rect.adjusted( -margin, -margin, margin, margin ).intersected( imageRect );
+      }
+
+      if ( !isDirty || ( canUsePartial && dirtyRegion.isEmpty() ) )
+      {
+        // nothing has changed within the visible part of the layer
+        job.cached = true;
+        job.img = new QImage( cachedImage );
+        job.renderer = nullptr;
+        job.context.setPainter( nullptr );
+        continue;
+      }
+      else if ( canUsePartial && !preview )
+      {
+        // redraw just the dirty parts of the cached image
+        job.partial = true;
+        job.img = new QImage( cachedImage );
+        QPainter *mypPainter = new QPainter( job.img );
+        mypPainter->setCompositionMode( QPainter::CompositionMode_Source );
+        Q_FOREACH ( const QRect &rect, dirtyRegion.rects() )
+          mypPainter->fillRect( rect, Qt::transparent );
+        mypPainter->setCompositionMode( QPainter::CompositionMode_SourceOver );
+        mypPainter->setClipRegion( dirtyRegion );
+        mypPainter->setRenderHint( QPainter::Antialiasing, mSettings.testFlag( QgsMapSettings::Antialiasing ) );
+        job.context.setPainter( mypPainter );
+
+        // only fetch features which may be drawn within the dirty parts
+        QRect bounds = dirtyRegion.boundingRect().adjusted( -margin, -margin, margin, margin );
+        const QgsMapToPixel &mtp = mSettings.mapToPixel();
+        QgsRectangle partialExtent( mtp.toMapCoordinatesF( bounds.left(), bounds.bottom() ),
+                                    mtp.toMapCoordinatesF( bounds.right(), bounds.top() ) );
+        QgsRectangle visibleExtent = mSettings.visibleExtent();
+        partialExtent = partialExtent.intersect( &visibleExtent );
+        QgsRectangle pr2;
+        if ( ct.isValid() )
+        {
+          reprojectToLayerExtent( ml, ct, partialExtent, pr2 );
+        }
+        if ( partialExtent.isFinite() )
+          job.context.setExtent( partialExtent );
+      }
+      else if ( !preview )
+      {
+        mCache->clearCacheImage( ml->id() );
+      }
+      // previews draw the whole layer and leave the cached image for the full render to update
+    }
+
+    if ( preview && ml->type() != QgsMapLayer::VectorLayer )
+    {
+      // only vector layers are drawn in quick previews
+      layerJobs.removeLast();
       continue;
     }
 
     // If we are drawing with an alternative blending mode then we need to render to a separate image
     // before compositing this on the map. This effectively flattens the layer and prevents
     // blending occurring between objects on the layer
-    if ( mCache || !painter || needTemporaryImage( ml ) )
+    if ( !job.partial && ( mCache || !painter || needTemporaryImage( ml ) ) )
     {
       // Flattened image for drawing when a blending mode is set
       QImage *mypFlattenedImage = nullptr;
@@ -340,7 +542,8 @@ LayerRenderJobs QgsMapRendererJob::prepareJobs( QPainter *painter, QgsLabelingEn
     if ( hasStyleOverride )
       ml->styleManager()->restoreOverrideStyle();
 
-    if ( mRequestedGeomCacheForLayers.contains( ml->id() ) )
+    // partial renders only see a subset of the features, so must not replace the geometry cache
+    if ( !job.partial && !preview && mRequestedGeomCacheForLayers.contains( ml->id() ) )
     {
       if ( QgsVectorLayerRenderer *vlr = dynamic_cast<QgsVectorLayerRenderer *>( job.renderer ) )
       {
@@ -360,6 +563,7 @@ LabelRenderJob QgsMapRendererJob::prepareLabelingJob( QPainter *painter, QgsLabe
   job.context.setPainter( painter );
   job.context.setLabelingEngine( labelingEngine2 );
   job.context.setExtent( mSettings.visibleExtent() );
+  job.context.setRenderTrace( mRenderTrace );
 
   // if we can use the cache, let's do it and avoid rendering!
   bool hasCache = canUseLabelCache && mCache && mCache->hasCacheImage( LABEL_CACHE_ID );
@@ -405,7 +609,8 @@ void QgsMapRendererJob::cleanupJobs( LayerRenderJobs &jobs )
       delete job.context.painter();
       job.context.setPainter( nullptr );
 
-      if ( mCache && !job.cached && !job.context.renderingStopped() && job.layer )
+      if ( mCache && !job.cached && !job.context.renderingStopped() && job.layer
+           && !job.context.testFlag( QgsRenderContext::RenderPreview ) )
       {
         QgsDebugMsg( "caching image for " + ( job.layer ? job.layer->id() : QString() ) );
         mCache->setCacheImage( job.layer->id(), *job.img, QList< QgsMapLayer * >() << job.layer );
@@ -449,6 +654,9 @@ void QgsMapRendererJob::cleanupLabelJob( LabelRenderJob &job )
 
 QImage QgsMapRendererJob::composeImage( const QgsMapSettings &settings, const LayerRenderJobs &jobs, const LabelRenderJob &labelJob )
 {
+  QgsRenderTraceSpan span( labelJob.context.renderTrace(), QStringLiteral( "Compose image" ), QStringLiteral( "compositing" ) );
+  span.setArgument( QStringLiteral( "layers" ), jobs.count() );
+
   QImage image( settings.outputSize(), settings.outputImageFormat() );
   image.fill( settings.backgroundColor().rgba() );
 
@@ -21,6 +21,7 @@
 #include <QFutureWatcher>
 #include <QImage>
 #include <QPainter>
+#include <QRegion>
 #include <QObject>
 #include <QTime>
 
@@ -36,6 +37,7 @@ class QgsMapLayerRenderer;
 class QgsMapRendererCache;
 class QgsPalLabeling;
 class QgsFeatureFilterProvider;
+class QgsRenderTrace;
 
 /// @cond PRIVATE
 
@@ -50,6 +52,7 @@ struct LayerRenderJob
   QPainter::CompositionMode blendMode;
   double opacity;
   bool cached; // if true, img already contains cached image from previous rendering
+  bool partial; // if true, img contains a cached image and only its dirty parts are being redrawn
   QgsWeakMapLayerPointer layer;
   int renderingTime; //!< Time it took to render the layer in ms (it is -1 if not rendered or still rendering)
 };
@@ -162,6 +165,24 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
     //! each LayerRenderJob.
     const QgsFeatureFilterProvider *featureFilterProvider() const { return mFeatureFilterProvider; }
 
+    /**
+     * Sets a \a trace which records timing spans for the stages of rendering, such as
+     * rendering each layer, labeling and composing the final image. The trace is not owned
+     * by the job and must exist until the job has finished. Set to nullptr to disable tracing.
+     * Must be called before start().
+     * @note added in QGIS 3.0
+     * @see renderTrace()
+     */
+    void setRenderTrace( QgsRenderTrace *trace ) { mRenderTrace = trace; }
+
+    /**
+     * Returns the trace which records timing spans for the stages of rendering, or nullptr
+     * if tracing is disabled.
+     * @note added in QGIS 3.0
+     * @see setRenderTrace()
+     */
+    QgsRenderTrace *renderTrace() const { return mRenderTrace; }
+
     struct Error
     {
       Error( const QString &lid, const QString &msg )
@@ -190,6 +211,34 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
     //! Find out how long it took to finish the job (in milliseconds)
     int renderingTime() const { return mRenderingTime; }
 
+    /**
+     * Returns the time (in milliseconds) from the start of the job until a first image
+     * of the map was available, i.e. until the quick preview was rendered (for progressive
+     * rendering) or until all layers were rendered. Returns -1 if no image is available yet.
+     * @see setProgressiveRendering()
+     * @note added in QGIS 3.0
+     */
+    int timeToFirstFrame() const { return mTimeToFirstFrame; }
+
+    /**
+     * Sets whether the job should render the map progressively. If enabled, a quick, low detail
+     * preview of the map (drawing vector layers with a sample of their features, aggressive
+     * simplification and no labels) is rendered before the full quality render is started.
+     * Completion of the preview is signaled by previewRendered(), while renderingLayersFinished()
+     * and finished() refer to the full quality render. Must be called before start().
+     * Progressive rendering is only supported by QgsMapRendererParallelJob.
+     * @see progressiveRendering()
+     * @note added in QGIS 3.0
+     */
+    void setProgressiveRendering( bool enabled ) { mProgressiveRendering = enabled; }
+
+    /**
+     * Returns true if the job renders the map progressively.
+     * @see setProgressiveRendering()
+     * @note added in QGIS 3.0
+     */
+    bool progressiveRendering() const { return mProgressiveRendering; }
+
     /**
      * Return map settings with which this job was started.
      * @return A QgsMapSettings instance with render settings
@@ -205,6 +254,15 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
 
   signals:
 
+    /**
+     * Emitted when a quick preview of the map has been rendered during progressive
+     * rendering. The preview image is then returned by QgsMapRendererQImageJob::renderedImage()
+     * until the full quality layers are rendered.
+     * @see setProgressiveRendering()
+     * @note Added in QGIS 3.0
+     */
+    void previewRendered();
+
     /**
      * Emitted when the layers are rendered.
      * Rendering labels is not yet done. If the fully rendered layer including labels is required use
@@ -227,6 +285,12 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
 
     int mRenderingTime = 0;
 
+    //! Time (in ms) until a first map image was available, or -1
+    int mTimeToFirstFrame = -1;
+
+    //! Whether a quick preview is rendered before the full quality render
+    bool mProgressiveRendering = false;
+
     /**
      * Prepares the cache for storing the result of labeling. Returns false if
      * the render cannot use cached labels and should not cache the result.
@@ -234,8 +298,14 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
      */
     bool prepareLabelCache() const;
 
-    //! @note not available in python bindings
-    LayerRenderJobs prepareJobs( QPainter *painter, QgsLabelingEngine *labelingEngine2 );
+    /**
+     * Prepares the jobs for rendering the layers. If \a preview is true, jobs for a quick
+     * preview of the map are prepared instead: only vector layers are rendered (with the
+     * QgsRenderContext::RenderPreview flag) and images from the cache are used where valid,
+     * but no cached images are cleared.
+     * @note not available in python bindings
+     */
+    LayerRenderJobs prepareJobs( QPainter *painter, QgsLabelingEngine *labelingEngine2, bool preview = false );
 
     /**
      * Prepares a labeling job.
@@ -276,6 +346,26 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
 
     bool needTemporaryImage( QgsMapLayer *ml );
 
+    /**
+     * Returns true if the cached image of a layer may be updated by redrawing
+     * only its dirty parts, rather than rendering the whole layer again.
+     */
+    static bool canRenderPartially( QgsMapLayer *ml );
+
+    /**
+     * Returns the margin (in pixels) by which the symbols of a layer may extend past the bounds
+     * of its features, or -1 if it can't be estimated in advance (e.g. for data defined sizes),
+     * in which case the layer must not be rendered partially.
+     */
+    static int partialRenderMargin( QgsMapLayer *ml, QgsRenderContext &context );
+
+    /**
+     * Calculates the region of the output image (in pixels, snapped to cache tiles)
+     * covered by a list of dirty \a extents in the layer's CRS, grown by \a margin pixels.
+     * Returns false if the extents could not be transformed to map coordinates.
+     */
+    bool dirtyRegionForExtents( const QList< QgsRectangle > &extents, const QgsCoordinateTransform &ct, int margin, QRegion &region ) const;
+
     //! called when rendering has finished to update all layers' geometry caches
     void updateLayerGeometryCaches();
 
@@ -285,6 +375,8 @@ class CORE_EXPORT QgsMapRendererJob : public QObject
     QMap<QString, QgsGeometryCache> mGeometryCaches;
 
     const QgsFeatureFilterProvider *mFeatureFilterProvider = nullptr;
+
+    QgsRenderTrace *mRenderTrace = nullptr;
 };
 
 
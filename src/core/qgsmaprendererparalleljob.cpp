@@ -23,6 +23,7 @@
 #include "qgsproject.h"
 #include "qgsmaplayer.h"
 #include "qgsmaplayerlistutils.h"
+#include "qgsrendertrace.h"
 
 #include <QtConcurrentMap>
 
@@ -46,7 +47,41 @@ void QgsMapRendererParallelJob::start()
     return;
 
   mRenderingStart.start();
+  mTimeToFirstFrame = -1;
+  mPreviewImage = QImage();
+  mLabelJob = LabelRenderJob();
 
+  if ( mProgressiveRendering )
+  {
+    mPreviewJobs = prepareJobs( nullptr, nullptr, true );
+
+    bool hasPreviewLayers = false;
+    Q_FOREACH ( const LayerRenderJob &job, mPreviewJobs )
+    {
+      if ( !job.cached )
+        hasPreviewLayers = true;
+    }
+
+    if ( hasPreviewLayers )
+    {
+      mStatus = RenderingPreview;
+
+      connect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderPreviewFinished );
+
+      mFuture = QtConcurrent::map( mPreviewJobs, renderLayerStatic );
+      mFutureWatcher.setFuture( mFuture );
+      return;
+    }
+
+    // everything is available from the cache - no need for a preview
+    cleanupJobs( mPreviewJobs );
+  }
+
+  startRenderingLayers();
+}
+
+void QgsMapRendererParallelJob::startRenderingLayers()
+{
   mStatus = RenderingLayers;
 
   mLabelingEngineV2.reset();
@@ -80,6 +115,12 @@ void QgsMapRendererParallelJob::cancel()
   QgsDebugMsg( QString( "PARALLEL cancel at status %1" ).arg( mStatus ) );
 
   mLabelJob.context.setRenderingStopped( true );
+  for ( LayerRenderJobs::iterator it = mPreviewJobs.begin(); it != mPreviewJobs.end(); ++it )
+  {
+    it->context.setRenderingStopped( true );
+    if ( it->renderer && it->renderer->feedback() )
+      it->renderer->feedback()->cancel();
+  }
   for ( LayerRenderJobs::iterator it = mLayerJobs.begin(); it != mLayerJobs.end(); ++it )
   {
     it->context.setRenderingStopped( true );
@@ -87,6 +128,15 @@ void QgsMapRendererParallelJob::cancel()
       it->renderer->feedback()->cancel();
   }
 
+  if ( mStatus == RenderingPreview )
+  {
+    disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderPreviewFinished );
+
+    mFutureWatcher.waitForFinished();
+
+    renderPreviewFinished();
+  }
+
   if ( mStatus == RenderingLayers )
   {
     disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderLayersFinished );
@@ -116,6 +166,12 @@ void QgsMapRendererParallelJob::cancelWithoutBlocking()
   QgsDebugMsg( QString( "PARALLEL cancel at status %1" ).arg( mStatus ) );
 
   mLabelJob.context.setRenderingStopped( true );
+  for ( LayerRenderJobs::iterator it = mPreviewJobs.begin(); it != mPreviewJobs.end(); ++it )
+  {
+    it->context.setRenderingStopped( true );
+    if ( it->renderer && it->renderer->feedback() )
+      it->renderer->feedback()->cancel();
+  }
   for ( LayerRenderJobs::iterator it = mLayerJobs.begin(); it != mLayerJobs.end(); ++it )
   {
     it->context.setRenderingStopped( true );
@@ -123,6 +179,7 @@ void QgsMapRendererParallelJob::cancelWithoutBlocking()
       it->renderer->feedback()->cancel();
   }
 
+  // (when rendering the preview, renderPreviewFinished() takes care of finishing the canceled job)
   if ( mStatus == RenderingLayers )
   {
     disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderLayersFinished );
@@ -135,6 +192,15 @@ void QgsMapRendererParallelJob::waitForFinished()
   if ( !isActive() )
     return;
 
+  if ( mStatus == RenderingPreview )
+  {
+    disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderPreviewFinished );
+
+    mFutureWatcher.waitForFinished();
+
+    renderPreviewFinished();
+  }
+
   if ( mStatus == RenderingLayers )
   {
     disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderLayersFinished );
@@ -186,18 +252,54 @@ QgsLabelingResults *QgsMapRendererParallelJob::takeLabelingResults()
 
 QImage QgsMapRendererParallelJob::renderedImage()
 {
-  if ( mStatus == RenderingLayers )
+  if ( mStatus == RenderingPreview )
+    return composeImage( mSettings, mPreviewJobs, LabelRenderJob() );
+  else if ( mStatus == RenderingLayers && !mPreviewImage.isNull() )
+    return mPreviewImage; // complete preview looks better than partially rendered layers
+  else if ( mStatus == RenderingLayers )
     return composeImage( mSettings, mLayerJobs, mLabelJob );
   else
     return mFinalImage; // when rendering labels or idle
 }
 
+void QgsMapRendererParallelJob::renderPreviewFinished()
+{
+  Q_ASSERT( mStatus == RenderingPreview );
+
+  disconnect( &mFutureWatcher, &QFutureWatcher<void>::finished, this, &QgsMapRendererParallelJob::renderPreviewFinished );
+
+  // job has been canceled while rendering the preview
+  bool canceled = mLabelJob.context.renderingStopped();
+
+  if ( !canceled )
+  {
+    mPreviewImage = composeImage( mSettings, mPreviewJobs, LabelRenderJob() );
+    mTimeToFirstFrame = mRenderingStart.elapsed();
+    QgsDebugMsg( QString( "PARALLEL preview finished: %1 ms" ).arg( mTimeToFirstFrame ) );
+  }
+
+  cleanupJobs( mPreviewJobs );
+
+  if ( canceled )
+  {
+    renderingFinished();
+    return;
+  }
+
+  emit previewRendered();
+
+  startRenderingLayers();
+}
+
 void QgsMapRendererParallelJob::renderLayersFinished()
 {
   Q_ASSERT( mStatus == RenderingLayers );
 
   // compose final image
   mFinalImage = composeImage( mSettings, mLayerJobs, mLabelJob );
+  mPreviewImage = QImage();
+  if ( mTimeToFirstFrame < 0 )
+    mTimeToFirstFrame = mRenderingStart.elapsed();
 
   QgsDebugMsg( "PARALLEL layers finished" );
 
@@ -243,13 +345,17 @@ void QgsMapRendererParallelJob::renderLayerStatic( LayerRenderJob &job )
   if ( job.cached )
     return;
 
-  if ( job.img )
+  if ( job.img && !job.partial )
     job.img->fill( 0 );
 
   QTime t;
   t.start();
   QgsDebugMsgLevel( QString( "job %1 start (layer %2)" ).arg( reinterpret_cast< quint64 >( &job ), 0, 16 ).arg( job.layer ? job.layer->id() : QString() ), 2 );
 
+  QgsRenderTraceSpan span( job.context.renderTrace(), job.layer ? job.layer->name() : QString(), QStringLiteral( "layer" ) );
+  span.setArgument( QStringLiteral( "layer_id" ), job.layer ? job.layer->id() : QString() );
+  span.setArgument( QStringLiteral( "preview" ), job.context.testFlag( QgsRenderContext::RenderPreview ) );
+
   try
   {
     job.renderer->render();
@@ -269,6 +375,7 @@ void QgsMapRendererParallelJob::renderLayerStatic( LayerRenderJob &job )
     QgsDebugMsg( "Caught unhandled unknown exception" );
   }
 
+  span.end();
   job.renderingTime = t.elapsed();
   QgsDebugMsgLevel( QString( "job %1 end [%2 ms] (layer %3)" ).arg( reinterpret_cast< quint64 >( &job ), 0, 16 ).arg( job.renderingTime ).arg( job.layer ? job.layer->id() : QString() ), 2 );
 }
@@ -47,6 +47,8 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
     virtual QImage renderedImage() override;
 
   private slots:
+    //! quick preview of layers is rendered, full quality render is pending
+    void renderPreviewFinished();
     //! layers are rendered, labeling is still pending
     void renderLayersFinished();
     //! all rendering is finished, including labeling
@@ -54,6 +56,9 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
 
   private:
 
+    //! Starts rendering of layers in full quality
+    void startRenderingLayers();
+
     //! @note not available in Python bindings
     static void renderLayerStatic( LayerRenderJob &job );
     //! @note not available in Python bindings
@@ -61,12 +66,16 @@ class CORE_EXPORT QgsMapRendererParallelJob : public QgsMapRendererQImageJob
 
     QImage mFinalImage;
 
+    //! Quick preview of the map (for progressive rendering)
+    QImage mPreviewImage;
+
     //! @note not available in Python bindings
-    enum { Idle, RenderingLayers, RenderingLabels } mStatus;
+    enum { Idle, RenderingPreview, RenderingLayers, RenderingLabels } mStatus;
 
     QFuture<void> mFuture;
     QFutureWatcher<void> mFutureWatcher;
 
+    LayerRenderJobs mPreviewJobs;
     LayerRenderJobs mLayerJobs;
     LabelRenderJob mLabelJob;
 
@@ -54,6 +54,7 @@ void QgsMapRendererSequentialJob::start()
   mLabelingResults.reset();
 
   mRenderingStart.start();
+  mTimeToFirstFrame = -1;
 
   mErrors.clear();
 
@@ -65,6 +66,7 @@ void QgsMapRendererSequentialJob::start()
 
   mInternalJob = new QgsMapRendererCustomPainterJob( mSettings, mPainter );
   mInternalJob->setCache( mCache );
+  mInternalJob->setRenderTrace( mRenderTrace );
 
   connect( mInternalJob, SIGNAL( finished() ), SLOT( internalFinished() ) );
 
@@ -138,6 +140,7 @@ void QgsMapRendererSequentialJob::internalFinished()
   mUsedCachedLabels = mInternalJob->usedCachedLabels();
 
   mErrors = mInternalJob->errors();
+  mTimeToFirstFrame = mInternalJob->timeToFirstFrame();
 
   // now we are in a slot called from mInternalJob - do not delete it immediately
   // so the class is still valid when the execution returns to the class
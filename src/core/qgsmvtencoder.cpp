@@ -0,0 +1,595 @@
+/***************************************************************************
+     qgsmvtencoder.cpp
+     -----------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsmvtencoder.h"
+#include "qgsclipper.h"
+#include "qgscoordinatetransform.h"
+#include "qgscsexception.h"
+#include "qgscurvepolygon.h"
+#include "qgsfeaturefilterprovider.h"
+#include "qgsfeatureiterator.h"
+#include "qgsfeaturerequest.h"
+#include "qgsfeedback.h"
+#include "qgsgeometry.h"
+#include "qgsgeometrycollection.h"
+#include "qgsgeometryengine.h"
+#include "qgslogger.h"
+#include "qgsmaptopixelgeometrysimplifier.h"
+#include "qgspointv2.h"
+#include "qgsvectorlayer.h"
+
+#include <QIODevice>
+#include <QPoint>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+  // field numbers of the vector tile protocol buffer schema
+  const int TILE_LAYERS = 3;
+
+  const int LAYER_NAME = 1;
+  const int LAYER_FEATURES = 2;
+  const int LAYER_KEYS = 3;
+  const int LAYER_VALUES = 4;
+  const int LAYER_EXTENT = 5;
+  const int LAYER_VERSION = 15;
+
+  const int FEATURE_ID = 1;
+  const int FEATURE_TAGS = 2;
+  const int FEATURE_TYPE = 3;
+  const int FEATURE_GEOMETRY = 4;
+
+  const int VALUE_STRING = 1;
+  const int VALUE_DOUBLE = 3;
+  const int VALUE_INT = 4;
+  const int VALUE_UINT = 5;
+  const int VALUE_BOOL = 7;
+
+  // geometry commands
+  const quint32 COMMAND_MOVE_TO = 1;
+  const quint32 COMMAND_LINE_TO = 2;
+  const quint32 COMMAND_CLOSE_PATH = 7;
+
+  //! Minimal writer for the protocol buffer wire format
+  class ProtobufWriter
+  {
+    public:
+
+      const QByteArray &data() const { return mData; }
+
+      void writeVarint( quint64 value )
+      {
+        while ( value >= 0x80 )
+        {
+          mData.append( static_cast< char >( ( value & 0x7f ) | 0x80 ) );
+          value >>= 7;
+        }
+        mData.append( static_cast< char >( value ) );
+      }
+
+      void writeUInt( int field, quint64 value )
+      {
+        writeVarint( static_cast< quint64 >( field ) << 3 );
+        writeVarint( value );
+      }
+
+      void writeDouble( int field, double value )
+      {
+        writeVarint( ( static_cast< quint64 >( field ) << 3 ) | 1 );
+        quint64 bits;
+        memcpy( &bits, &value, sizeof( bits ) );
+        char bytes[8];
+        qToLittleEndian( bits, reinterpret_cast< uchar * >( bytes ) );
+        mData.append( bytes, 8 );
+      }
+
+      void writeBytes( int field, const QByteArray &bytes )
+      {
+        writeVarint( ( static_cast< quint64 >( field ) << 3 ) | 2 );
+        writeVarint( bytes.size() );
+        mData.append( bytes );
+      }
+
+      void writeString( int field, const QString &string )
+      {
+        writeBytes( field, string.toUtf8() );
+      }
+
+      void writePacked( int field, const QVector< quint32 > &values )
+      {
+        ProtobufWriter packed;
+        Q_FOREACH ( quint32 value, values )
+          packed.writeVarint( value );
+        writeBytes( field, packed.data() );
+      }
+
+    private:
+      QByteArray mData;
+  };
+
+  quint32 command( quint32 id, int count )
+  {
+    return ( id & 0x7 ) | ( static_cast< quint32 >( count ) << 3 );
+  }
+
+  quint32 zigZag( int value )
+  {
+    return ( static_cast< quint32 >( value ) << 1 ) ^ static_cast< quint32 >( value >> 31 );
+  }
+
+  //! Converts map coordinates to tile coordinates and writes geometry commands with a shared cursor
+  class GeometryWriter
+  {
+    public:
+      GeometryWriter( const QgsRectangle &tileExtent, int resolution, QVector< quint32 > &commands )
+        : mExtent( tileExtent )
+        , mScaleX( resolution / tileExtent.width() )
+        , mScaleY( resolution / tileExtent.height() )
+        , mCommands( commands )
+      {}
+
+      QPoint toTile( double x, double y ) const
+      {
+        return QPoint( qRound( ( x - mExtent.xMinimum() ) * mScaleX ), qRound( ( mExtent.yMaximum() - y ) * mScaleY ) );
+      }
+
+      //! Converts points to tile coordinates, dropping repeated points
+      QVector< QPoint > quantize( const QPolygonF &points, bool closed ) const
+      {
+        QVector< QPoint > result;
+        result.reserve( points.size() );
+        Q_FOREACH ( const QPointF &p, points )
+        {
+          QPoint tileP = toTile( p.x(), p.y() );
+          if ( result.isEmpty() || result.last() != tileP )
+            result << tileP;
+        }
+        if ( closed )
+        {
+          while ( result.size() > 1 && result.last() == result.first() )
+            result.removeLast();
+        }
+        return result;
+      }
+
+      void writePoints( const QVector< QPoint > &points )
+      {
+        mCommands << command( COMMAND_MOVE_TO, points.size() );
+        Q_FOREACH ( const QPoint &p, points )
+          writeParameters( p );
+      }
+
+      void writeLine( const QVector< QPoint > &points )
+      {
+        mCommands << command( COMMAND_MOVE_TO, 1 );
+        writeParameters( points.at( 0 ) );
+        mCommands << command( COMMAND_LINE_TO, points.size() - 1 );
+        for ( int i = 1; i < points.size(); ++i )
+          writeParameters( points.at( i ) );
+      }
+
+      void writeRing( QVector< QPoint > points, bool exterior )
+      {
+        // exterior rings have a positive area in tile coordinates (y axis pointing down), interior rings a negative one
+        qint64 area = 0;
+        for ( int i = 0; i < points.size(); ++i )
+        {
+          const QPoint &p0 = points.at( i );
+          const QPoint &p1 = points.at( ( i + 1 ) % points.size() );
+          area += static_cast< qint64 >( p0.x() ) * p1.y() - static_cast< qint64 >( p1.x() ) * p0.y();
+        }
+        if ( ( exterior && area < 0 ) || ( !exterior && area > 0 ) )
+          std::reverse( points.begin(), points.end() );
+
+        writeLine( points );
+        mCommands << command( COMMAND_CLOSE_PATH, 1 );
+      }
+
+    private:
+      QgsRectangle mExtent;
+      double mScaleX;
+      double mScaleY;
+      QVector< quint32 > &mCommands;
+      QPoint mCursor;
+
+      void writeParameters( const QPoint &p )
+      {
+        mCommands << zigZag( p.x() - mCursor.x() ) << zigZag( p.y() - mCursor.y() );
+        mCursor = p;
+      }
+  };
+
+  //! Returns the single parts of a geometry
+  QList< const QgsAbstractGeometry * > geometryParts( const QgsAbstractGeometry *geometry )
+  {
+    QList< const QgsAbstractGeometry * > parts;
+    if ( const QgsGeometryCollection *collection = dynamic_cast< const QgsGeometryCollection * >( geometry ) )
+    {
+      for ( int i = 0; i < collection->numGeometries(); ++i )
+        parts << collection->geometryN( i );
+    }
+    else
+    {
+      parts << geometry;
+    }
+    return parts;
+  }
+}
+
+QgsMvtEncoder::QgsMvtEncoder( const QgsRectangle &tileExtent, int resolution, int buffer )
+  : mTileExtent( tileExtent )
+  , mResolution( resolution )
+  , mBuffer( buffer )
+{
+}
+
+QString QgsMvtEncoder::mimeType()
+{
+  return QStringLiteral( "application/vnd.mapbox-vector-tile" );
+}
+
+QgsRectangle QgsMvtEncoder::clipExtent() const
+{
+  const double bufferX = mBuffer * mTileExtent.width() / mResolution;
+  const double bufferY = mBuffer * mTileExtent.height() / mResolution;
+  return QgsRectangle( mTileExtent.xMinimum() - bufferX, mTileExtent.yMinimum() - bufferY,
+                       mTileExtent.xMaximum() + bufferX, mTileExtent.yMaximum() + bufferY );
+}
+
+void QgsMvtEncoder::beginLayer( const QString &name )
+{
+  if ( mInLayer )
+    endLayer();
+
+  mInLayer = true;
+  mLayerName = name;
+  mLayerFeatures.clear();
+  mLayerFeatureCount = 0;
+  mKeys.clear();
+  mKeyIndex.clear();
+  mValues.clear();
+  mValueIndex.clear();
+}
+
+bool QgsMvtEncoder::addFeature( const QgsFeature &feature )
+{
+  if ( !mInLayer || !feature.hasGeometry() || mTileExtent.isEmpty() )
+    return false;
+
+  QgsGeometry geometry = feature.geometry();
+  if ( QgsWkbTypes::isCurvedType( geometry.wkbType() ) )
+    geometry = QgsGeometry( geometry.geometry()->segmentize() );
+
+  // drop vertices which are closer than a tile unit
+  QgsMapToPixelSimplifier simplifier( QgsMapToPixelSimplifier::SimplifyGeometry, mTileExtent.width() / mResolution );
+  geometry = simplifier.simplify( geometry );
+  if ( geometry.isNull() )
+    return false;
+
+  QVector< quint32 > commands;
+  GeometryType type = encodeGeometry( geometry.geometry(), commands );
+  if ( type == Unknown || commands.isEmpty() )
+    return false;
+
+  QVector< quint32 > tags;
+  const QgsFields fields = feature.fields();
+  const QgsAttributes attributes = feature.attributes();
+  for ( int i = 0; i < attributes.count() && i < fields.count(); ++i )
+  {
+    const QVariant &value = attributes.at( i );
+    if ( value.isNull() )
+      continue;
+
+    int valueIdx = valueIndex( value );
+    if ( valueIdx < 0 )
+      continue;
+
+    tags << keyIndex( fields.at( i ).name() ) << valueIdx;
+  }
+
+  ProtobufWriter writer;
+  if ( feature.id() >= 0 )
+    writer.writeUInt( FEATURE_ID, static_cast< quint64 >( feature.id() ) );
+  if ( !tags.isEmpty() )
+    writer.writePacked( FEATURE_TAGS, tags );
+  writer.writeUInt( FEATURE_TYPE, type );
+  writer.writePacked( FEATURE_GEOMETRY, commands );
+
+  ProtobufWriter layerWriter;
+  layerWriter.writeBytes( LAYER_FEATURES, writer.data() );
+  mLayerFeatures.append( layerWriter.data() );
+  mLayerFeatureCount++;
+  mFeatureCount++;
+  return true;
+}
+
+bool QgsMvtEncoder::endLayer()
+{
+  if ( !mInLayer )
+    return true;
+
+  mInLayer = false;
+  if ( mLayerFeatureCount == 0 )
+    return true;
+
+  ProtobufWriter layer;
+  layer.writeUInt( LAYER_VERSION, 2 );
+  layer.writeString( LAYER_NAME, mLayerName );
+  QByteArray layerData = layer.data();
+  layerData.append( mLayerFeatures );
+
+  ProtobufWriter dictionaries;
+  Q_FOREACH ( const QString &key, mKeys )
+    dictionaries.writeString( LAYER_KEYS, key );
+  Q_FOREACH ( const QByteArray &value, mValues )
+    dictionaries.writeBytes( LAYER_VALUES, value );
+  dictionaries.writeUInt( LAYER_EXTENT, mResolution );
+  layerData.append( dictionaries.data() );
+
+  mLayerFeatures.clear();
+  mKeys.clear();
+  mKeyIndex.clear();
+  mValues.clear();
+  mValueIndex.clear();
+
+  ProtobufWriter tile;
+  tile.writeBytes( TILE_LAYERS, layerData );
+
+  if ( mDevice )
+    return mDevice->write( tile.data() ) == tile.data().size();
+
+  mData.append( tile.data() );
+  return true;
+}
+
+int QgsMvtEncoder::addLayer( QgsVectorLayer *layer, const QgsCoordinateReferenceSystem &destinationCrs, const QString &name,
+                             const QSet<QString> &excludedAttributes, QgsFeedback *feedback )
+{
+  if ( !layer || !layer->isValid() )
+    return 0;
+
+  QgsCoordinateTransform ct( layer->crs(), destinationCrs );
+  QgsFeatureRequest request;
+  try
+  {
+    request.setFilterRect( ct.transformBoundingBox( clipExtent(), QgsCoordinateTransform::ReverseTransform ) );
+  }
+  catch ( QgsCsException &cse )
+  {
+    Q_UNUSED( cse );
+    QgsDebugMsg( QString( "Could not transform tile extent to layer CRS: %1" ).arg( cse.what() ) );
+    return 0;
+  }
+  QgsAttributeList excludedIndexes;
+  if ( !excludedAttributes.isEmpty() )
+  {
+    const QgsFields fields = layer->fields();
+    QgsAttributeList attributes;
+    for ( int i = 0; i < fields.count(); ++i )
+    {
+      if ( excludedAttributes.contains( fields.at( i ).name() ) )
+        excludedIndexes << i;
+      else
+        attributes << i;
+    }
+    request.setSubsetOfAttributes( attributes );
+  }
+  if ( mFeatureFilterProvider )
+    mFeatureFilterProvider->filterFeatures( layer, request );
+
+  const int count = mFeatureCount;
+  beginLayer( name.isEmpty() ? layer->name() : name );
+
+  QgsFeatureIterator fit = layer->getFeatures( request );
+  QgsFeature feature;
+  while ( fit.nextFeature( feature ) )
+  {
+    if ( feedback && feedback->isCanceled() )
+      break;
+
+    if ( !feature.hasGeometry() )
+      continue;
+
+    // providers may return more attributes than requested
+    Q_FOREACH ( int idx, excludedIndexes )
+      feature.setAttribute( idx, QVariant() );
+
+    if ( ct.isValid() && !ct.isShortCircuited() )
+    {
+      QgsGeometry geometry = feature.geometry();
+      try
+      {
+        geometry.transform( ct );
+      }
+      catch ( QgsCsException &cse )
+      {
+        Q_UNUSED( cse );
+        QgsDebugMsg( QString( "Failed to transform feature with ID '%1'. Ignoring this feature. %2" ).arg( feature.id() ).arg( cse.what() ) );
+        continue;
+      }
+      feature.setGeometry( geometry );
+    }
+
+    addFeature( feature );
+  }
+
+  endLayer();
+  return mFeatureCount - count;
+}
+
+QgsMvtEncoder::GeometryType QgsMvtEncoder::encodeGeometry( const QgsAbstractGeometry *geometry, QVector< quint32 > &commands ) const
+{
+  const QgsRectangle clip = clipExtent();
+  GeometryWriter writer( mTileExtent, mResolution, commands );
+
+  switch ( QgsWkbTypes::geometryType( geometry->wkbType() ) )
+  {
+    case QgsWkbTypes::PointGeometry:
+    {
+      QVector< QPoint > points;
+      Q_FOREACH ( const QgsAbstractGeometry *part, geometryParts( geometry ) )
+      {
+        const QgsPointV2 *point = dynamic_cast< const QgsPointV2 * >( part );
+        if ( point && clip.contains( QgsPoint( point->x(), point->y() ) ) )
+          points << writer.toTile( point->x(), point->y() );
+      }
+      if ( points.isEmpty() )
+        return Unknown;
+
+      writer.writePoints( points );
+      return Point;
+    }
+
+    case QgsWkbTypes::LineGeometry:
+    {
+      // a line which leaves the clip extent and enters it again is split into several
+      // lines, instead of connecting its parts along the border of the extent
+      std::unique_ptr< QgsGeometryEngine > clipEngine;
+      Q_FOREACH ( const QgsAbstractGeometry *part, geometryParts( geometry ) )
+      {
+        const QgsCurve *curve = dynamic_cast< const QgsCurve * >( part );
+        if ( !curve )
+          continue;
+
+        std::unique_ptr< QgsAbstractGeometry > clipped;
+        QList< const QgsAbstractGeometry * > clippedParts;
+        if ( clip.contains( curve->boundingBox() ) )
+        {
+          clippedParts << curve;
+        }
+        else
+        {
+          if ( !clipEngine )
+          {
+            clipEngine.reset( QgsGeometry::createGeometryEngine( QgsGeometry::fromRect( clip ).geometry() ) );
+            clipEngine->prepareGeometry();
+          }
+          clipped.reset( clipEngine->intersection( *curve ) );
+          if ( clipped )
+            clippedParts = geometryParts( clipped.get() );
+        }
+
+        Q_FOREACH ( const QgsAbstractGeometry *clippedPart, clippedParts )
+        {
+          // the intersection also contains points where the line only touches the extent
+          const QgsCurve *clippedCurve = dynamic_cast< const QgsCurve * >( clippedPart );
+          if ( !clippedCurve )
+            continue;
+
+          QVector< QPoint > points = writer.quantize( clippedCurve->asQPolygonF(), false );
+          if ( points.size() >= 2 )
+            writer.writeLine( points );
+        }
+      }
+      return commands.isEmpty() ? Unknown : LineString;
+    }
+
+    case QgsWkbTypes::PolygonGeometry:
+    {
+      Q_FOREACH ( const QgsAbstractGeometry *part, geometryParts( geometry ) )
+      {
+        const QgsCurvePolygon *polygon = dynamic_cast< const QgsCurvePolygon * >( part );
+        if ( !polygon || !polygon->exteriorRing() )
+          continue;
+
+        QPolygonF exterior = polygon->exteriorRing()->asQPolygonF();
+        QgsClipper::trimPolygon( exterior, clip );
+        QVector< QPoint > exteriorPoints = writer.quantize( exterior, true );
+        if ( exteriorPoints.size() < 3 )
+          continue;
+
+        writer.writeRing( exteriorPoints, true );
+        for ( int i = 0; i < polygon->numInteriorRings(); ++i )
+        {
+          QPolygonF interior = polygon->interiorRing( i )->asQPolygonF();
+          QgsClipper::trimPolygon( interior, clip );
+          QVector< QPoint > interiorPoints = writer.quantize( interior, true );
+          if ( interiorPoints.size() >= 3 )
+            writer.writeRing( interiorPoints, false );
+        }
+      }
+      return commands.isEmpty() ? Unknown : Polygon;
+    }
+
+    case QgsWkbTypes::UnknownGeometry:
+    case QgsWkbTypes::NullGeometry:
+      break;
+  }
+  return Unknown;
+}
+
+int QgsMvtEncoder::keyIndex( const QString &key )
+{
+  QHash< QString, int >::const_iterator it = mKeyIndex.constFind( key );
+  if ( it != mKeyIndex.constEnd() )
+    return it.value();
+
+  int index = mKeys.size();
+  mKeys << key;
+  mKeyIndex.insert( key, index );
+  return index;
+}
+
+int QgsMvtEncoder::valueIndex( const QVariant &value )
+{
+  ProtobufWriter writer;
+  switch ( value.type() )
+  {
+    case QVariant::Bool:
+      writer.writeUInt( VALUE_BOOL, value.toBool() ? 1 : 0 );
+      break;
+
+    case QVariant::Int:
+    case QVariant::LongLong:
+      // negative values are written as 64 bit two's complement
+      writer.writeUInt( VALUE_INT, static_cast< quint64 >( value.toLongLong() ) );
+      break;
+
+    case QVariant::UInt:
+    case QVariant::ULongLong:
+      writer.writeUInt( VALUE_UINT, value.toULongLong() );
+      break;
+
+    case QVariant::Double:
+      writer.writeDouble( VALUE_DOUBLE, value.toDouble() );
+      break;
+
+    case QVariant::Date:
+    case QVariant::DateTime:
+    case QVariant::Time:
+    case QVariant::String:
+      writer.writeString( VALUE_STRING, value.toString() );
+      break;
+
+    default:
+      if ( !value.canConvert< QString >() )
+        return -1;
+      writer.writeString( VALUE_STRING, value.toString() );
+      break;
+  }
+
+  // encoded values are unique for each value, so they can be used as keys of the dictionary
+  QHash< QByteArray, int >::const_iterator it = mValueIndex.constFind( writer.data() );
+  if ( it != mValueIndex.constEnd() )
+    return it.value();
+
+  int index = mValues.size();
+  mValues << writer.data();
+  mValueIndex.insert( writer.data(), index );
+  return index;
+}
@@ -0,0 +1,205 @@
+/***************************************************************************
+     qgsmvtencoder.h
+     ---------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSMVTENCODER_H
+#define QGSMVTENCODER_H
+
+#include "qgis_core.h"
+#include "qgsrectangle.h"
+#include "qgsfeature.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+class QgsAbstractGeometry;
+class QgsCoordinateReferenceSystem;
+class QgsFeatureFilterProvider;
+class QgsFeedback;
+class QgsVectorLayer;
+
+/**
+ * \ingroup core
+ * \class QgsMvtEncoder
+ * \brief Encodes features into a single tile in the Mapbox Vector Tile (MVT) format, version 2.
+ *
+ * The encoder is a streaming writer. Layers are started with beginLayer(), filled with
+ * addFeature() and finished with endLayer(), or written in one step from a vector layer
+ * with addLayer(). Only the features of the current layer are kept in memory. If a
+ * device is set, each finished layer is written to the device straight away, otherwise
+ * the encoded tile is collected and returned by data().
+ *
+ * Feature geometries must be in the coordinate reference system of the tile extent. They
+ * are simplified to the resolution of the tile with QgsMapToPixelSimplifier, clipped to
+ * the tile extent grown by the buffer with QgsClipper and quantized to integer tile
+ * coordinates. Features whose geometry collapses completely are skipped. Attributes
+ * are written to the dictionaries of keys and values shared by all features of a layer.
+ *
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsMvtEncoder
+{
+  public:
+
+    /**
+     * Constructor for QgsMvtEncoder, for a tile covering \a tileExtent. The tile has
+     * \a resolution units in each direction, and geometries are kept up to \a buffer
+     * units beyond the edges of the tile.
+     */
+    QgsMvtEncoder( const QgsRectangle &tileExtent, int resolution = 4096, int buffer = 64 );
+
+    //! QgsMvtEncoder cannot be copied
+    QgsMvtEncoder( const QgsMvtEncoder &rh ) = delete;
+    //! QgsMvtEncoder cannot be copied
+    QgsMvtEncoder &operator=( const QgsMvtEncoder &rh ) = delete;
+
+    /**
+     * Returns the MIME type of encoded tiles.
+     */
+    static QString mimeType();
+
+    /**
+     * Returns the extent covered by the tile.
+     */
+    QgsRectangle tileExtent() const { return mTileExtent; }
+
+    /**
+     * Returns the number of units in each direction of the tile.
+     */
+    int resolution() const { return mResolution; }
+
+    /**
+     * Returns the number of units by which geometries may extend beyond the edges of the tile.
+     */
+    int buffer() const { return mBuffer; }
+
+    /**
+     * Returns the extent to which geometries are clipped, i.e. the tile extent grown by the buffer.
+     */
+    QgsRectangle clipExtent() const;
+
+    /**
+     * Sets the \a device to which each finished layer is written. The device is not
+     * owned by the encoder and must be open for writing. If no device is set (the default),
+     * the encoded tile can be retrieved with data().
+     * @see device()
+     */
+    void setDevice( QIODevice *device ) { mDevice = device; }
+
+    /**
+     * Returns the device to which each finished layer is written, or nullptr.
+     * @see setDevice()
+     */
+    QIODevice *device() const { return mDevice; }
+
+    /**
+     * Sets a feature filter \a provider which restricts the features encoded by addLayer().
+     * Ownership is not transferred and the provider must exist while layers are added.
+     * @see featureFilterProvider()
+     */
+    void setFeatureFilterProvider( const QgsFeatureFilterProvider *provider ) { mFeatureFilterProvider = provider; }
+
+    /**
+     * Returns the feature filter provider which restricts the features encoded by addLayer(), or nullptr.
+     * @see setFeatureFilterProvider()
+     */
+    const QgsFeatureFilterProvider *featureFilterProvider() const { return mFeatureFilterProvider; }
+
+    /**
+     * Starts a new layer with the specified \a name. A layer which has been started
+     * before is finished first.
+     * @see endLayer()
+     */
+    void beginLayer( const QString &name );
+
+    /**
+     * Adds a \a feature to the current layer. The geometry of the feature must be in the
+     * coordinate reference system of the tile extent. Non null attributes are written
+     * with the names of the fields of the feature. Returns false if no layer was started
+     * or if nothing of the geometry remains in the tile.
+     */
+    bool addFeature( const QgsFeature &feature );
+
+    /**
+     * Finishes the current layer. Layers without features are not written.
+     * Returns false if the layer could not be written to the device.
+     * @see beginLayer()
+     */
+    bool endLayer();
+
+    /**
+     * Encodes the features of a vector \a layer which intersect the tile as a new layer
+     * with the specified \a name (or the name of the layer, if empty). The features are
+     * transformed from the layer's CRS to the \a destinationCrs of the tile extent.
+     * Attributes with names in \a excludedAttributes are neither fetched nor written.
+     * An optional \a feedback object allows to cancel the encoding. Returns the number
+     * of features added.
+     */
+    int addLayer( QgsVectorLayer *layer, const QgsCoordinateReferenceSystem &destinationCrs, const QString &name = QString(),
+                  const QSet<QString> &excludedAttributes = QSet<QString>(), QgsFeedback *feedback = nullptr );
+
+    /**
+     * Returns the total number of features encoded in all layers.
+     */
+    int featureCount() const { return mFeatureCount; }
+
+    /**
+     * Returns the encoded tile. The tile is only collected if no device is set.
+     * The current layer is not included until endLayer() has been called.
+     * @see setDevice()
+     */
+    QByteArray data() const { return mData; }
+
+  private:
+
+    //! Geometry types of MVT features
+    enum GeometryType
+    {
+      Unknown = 0,
+      Point = 1,
+      LineString = 2,
+      Polygon = 3,
+    };
+
+    QgsRectangle mTileExtent;
+    int mResolution;
+    int mBuffer;
+    QIODevice *mDevice = nullptr;
+    const QgsFeatureFilterProvider *mFeatureFilterProvider = nullptr;
+    QByteArray mData;
+    int mFeatureCount = 0;
+
+    // state of current layer
+    bool mInLayer = false;
+    QString mLayerName;
+    QByteArray mLayerFeatures;
+    int mLayerFeatureCount = 0;
+    QVector< QString > mKeys;
+    QHash< QString, int > mKeyIndex;
+    QVector< QByteArray > mValues;
+    QHash< QByteArray, int > mValueIndex;
+
+    //! Encodes geometry commands for a geometry, returns the MVT type of the geometry
+    GeometryType encodeGeometry( const QgsAbstractGeometry *geometry, QVector< quint32 > &commands ) const;
+
+    //! Returns the index of a key in the dictionary of the current layer, adding it if needed
+    int keyIndex( const QString &key );
+
+    //! Returns the index of a value in the dictionary of the current layer, adding it if needed, or -1 if the value cannot be encoded
+    int valueIndex( const QVariant &value );
+};
+
+#endif // QGSMVTENCODER_H
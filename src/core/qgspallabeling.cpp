@@ -58,6 +58,7 @@
 #include "qgsproperty.h"
 #include "qgssymbollayerutils.h"
 #include "qgsmaptopixelgeometrysimplifier.h"
+#include "qgstextlayoutcache.h"
 #include <QMessageBox>
 
 
@@ -982,6 +983,11 @@ bool QgsPalLayerSettings::checkMinimumSizeMM( const QgsRenderContext &ct, const
 }
 
 void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, QString text, double &labelX, double &labelY, QgsFeature *f, QgsRenderContext *context )
+{
+  calculateLabelSize( fm, nullptr, text, labelX, labelY, f, context );
+}
+
+void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, const QFont *font, QString text, double &labelX, double &labelY, QgsFeature *f, QgsRenderContext *context )
 {
   if ( !fm || !f )
   {
@@ -1102,7 +1108,7 @@ void QgsPalLayerSettings::calculateLabelSize( const QFontMetricsF *fm, QString t
 
   for ( int i = 0; i < lines; ++i )
   {
-    double width = fm->width( multiLineSplit.at( i ) );
+    double width = font ? QgsTextLayoutCache::instance()->textWidth( *font, multiLineSplit.at( i ) ) : fm->width( multiLineSplit.at( i ) );
     if ( width > w )
     {
       w = width;
@@ -1345,7 +1351,7 @@ void QgsPalLayerSettings::registerFeature( QgsFeature &f, QgsRenderContext &cont
   // NOTE: this should come AFTER any option that affects font metrics
   std::unique_ptr<QFontMetricsF> labelFontMetrics( new QFontMetricsF( labelFont ) );
   double labelX, labelY; // will receive label size
-  calculateLabelSize( labelFontMetrics.get(), labelText, labelX, labelY, mCurFeat, &context );
+  calculateLabelSize( labelFontMetrics.get(), &labelFont, labelText, labelX, labelY, mCurFeat, &context );
 
 
   // maximum angle between curved label characters (hardcoded defaults used in QGIS <2.0)
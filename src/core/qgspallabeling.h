@@ -583,6 +583,12 @@ class CORE_EXPORT QgsPalLayerSettings
 
   private:
 
+    /**
+     * Calculates the size of a label. If \a font is specified, text widths are taken
+     * from the shared QgsTextLayoutCache instead of being measured with \a fm.
+     */
+    void calculateLabelSize( const QFontMetricsF *fm, const QFont *font, QString text, double &labelX, double &labelY, QgsFeature *f, QgsRenderContext *context );
+
     /**
      * Reads data defined properties from a QGIS 2.x project.
      */
@@ -18,9 +18,140 @@
 #include "qgslogger.h"
 #include "qgsexpression.h"
 #include "qgsfeature.h"
+#include "qgsfeaturerequest.h"
 #include "qgssymbollayerutils.h"
 #include "qgscolorramp.h"
+#include "qgspropertyresultcache.h"
 #include <qmath.h>
+#include <QDateTime>
+
+
+//! Functions which may return different results for the same attribute values
+static const QStringList VOLATILE_FUNCTIONS = QStringList() << QStringLiteral( "rand" ) << QStringLiteral( "randf" )
+    << QStringLiteral( "now" ) << QStringLiteral( "uuid" ) << QStringLiteral( "is_selected" ) << QStringLiteral( "num_selected" );
+
+/**
+ * Returns true if the result of an expression \a node only depends on the values of the attributes
+ * it references, i.e. it is safe to reuse the result for other features with the same values.
+ */
+static bool dependsOnAttributesOnly( const QgsExpression::Node *node )
+{
+  if ( !node )
+    return true;
+
+  switch ( node->nodeType() )
+  {
+    case QgsExpression::ntLiteral:
+    case QgsExpression::ntColumnRef:
+      return true;
+
+    case QgsExpression::ntUnaryOperator:
+      return dependsOnAttributesOnly( static_cast< const QgsExpression::NodeUnaryOperator * >( node )->operand() );
+
+    case QgsExpression::ntBinaryOperator:
+    {
+      const QgsExpression::NodeBinaryOperator *op = static_cast< const QgsExpression::NodeBinaryOperator * >( node );
+      return dependsOnAttributesOnly( op->opLeft() ) && dependsOnAttributesOnly( op->opRight() );
+    }
+
+    case QgsExpression::ntInOperator:
+    {
+      const QgsExpression::NodeInOperator *op = static_cast< const QgsExpression::NodeInOperator * >( node );
+      if ( !dependsOnAttributesOnly( op->node() ) )
+        return false;
+      Q_FOREACH ( const QgsExpression::Node *n, op->list()->list() )
+      {
+        if ( !dependsOnAttributesOnly( n ) )
+          return false;
+      }
+      return true;
+    }
+
+    case QgsExpression::ntFunction:
+    {
+      const QgsExpression::NodeFunction *fn = static_cast< const QgsExpression::NodeFunction * >( node );
+      const QgsExpression::Function *fd = QgsExpression::Functions()[ fn->fnIndex()];
+      // $ functions ($id, $currentfeature, ...) and contextual functions read more than just attributes,
+      // and nothing is known about custom (e.g. Python) functions
+      if ( !dynamic_cast< const QgsExpression::StaticFunction * >( fd ) || fd->isContextual()
+           || fd->name().startsWith( '$' ) || VOLATILE_FUNCTIONS.contains( fd->name() ) )
+        return false;
+      if ( fn->args() )
+      {
+        Q_FOREACH ( const QgsExpression::Node *n, fn->args()->list() )
+        {
+          if ( !dependsOnAttributesOnly( n ) )
+            return false;
+        }
+      }
+      return true;
+    }
+
+    case QgsExpression::ntCondition:
+    {
+      const QgsExpression::NodeCondition *condition = static_cast< const QgsExpression::NodeCondition * >( node );
+      Q_FOREACH ( const QgsExpression::WhenThen *whenThen, condition->conditions() )
+      {
+        if ( !dependsOnAttributesOnly( whenThen->mWhenExp ) || !dependsOnAttributesOnly( whenThen->mThenExp ) )
+          return false;
+      }
+      return dependsOnAttributesOnly( condition->elseExp() );
+    }
+  }
+  return false;
+}
+
+/**
+ * Builds the key for storing the result of \a expression for a \a feature in a QgsPropertyResultCache
+ * from the values of the attributes at \a attributeIndexes. Returns false if the values can not
+ * be represented safely in a key.
+ */
+static bool propertyResultCacheKey( const QString &expression, const QList< int > &attributeIndexes, const QgsFeature &feature, QString &key )
+{
+  QgsAttributes attributes = feature.attributes();
+  key = expression;
+  Q_FOREACH ( int idx, attributeIndexes )
+  {
+    if ( idx >= attributes.count() )
+      return false;
+
+    const QVariant &value = attributes.at( idx );
+    switch ( value.type() )
+    {
+      case QVariant::Invalid:
+      case QVariant::Bool:
+      case QVariant::Int:
+      case QVariant::UInt:
+      case QVariant::LongLong:
+      case QVariant::ULongLong:
+      case QVariant::Double:
+      case QVariant::String:
+      case QVariant::Date:
+      case QVariant::Time:
+      case QVariant::DateTime:
+        break;
+
+      default:
+        return false;
+    }
+
+    // QVariant::toString() drops the milliseconds of times, so these are stored as numbers
+    QString str;
+    if ( value.type() == QVariant::DateTime && !value.isNull() )
+    {
+      QDateTime dt = value.toDateTime();
+      str = QStringLiteral( "%1 %2 %3" ).arg( dt.toMSecsSinceEpoch() ).arg( dt.timeSpec() ).arg( dt.offsetFromUtc() );
+    }
+    else if ( value.type() == QVariant::Time && !value.isNull() )
+      str = QString::number( value.toTime().msecsSinceStartOfDay() );
+    else if ( !value.isNull() )
+      str = value.toString();
+
+    // prefix values with their type and length, so that different values never produce the same key
+    key += '\n' + QString::number( value.type() ) + ':' + QString::number( value.isNull() ? -1 : str.length() ) + ':' + str;
+  }
+  return true;
+}
 
 
 QgsPropertyDefinition::QgsPropertyDefinition()
@@ -377,6 +508,26 @@ bool QgsProperty::prepare( const QgsExpressionContext &context ) const
 
       d->expressionPrepared = true;
       d->expressionReferencedCols = d->expression.referencedColumns();
+
+      d->expressionCacheable = false;
+      d->expressionReferencedColIndexes.clear();
+      if ( !d->expression.needsGeometry() && d->expression.referencedVariables().isEmpty()
+           && !d->expressionReferencedCols.contains( QgsFeatureRequest::ALL_ATTRIBUTES )
+           && dependsOnAttributesOnly( d->expression.rootNode() ) )
+      {
+        d->expressionCacheable = true;
+        QgsFields fields = context.fields();
+        Q_FOREACH ( const QString &col, d->expressionReferencedCols )
+        {
+          int idx = fields.lookupField( col );
+          if ( idx < 0 )
+          {
+            d->expressionCacheable = false;
+            break;
+          }
+          d->expressionReferencedColIndexes << idx;
+        }
+      }
       return true;
     }
 
@@ -466,7 +617,22 @@ QVariant QgsProperty::propertyValue( const QgsExpressionContext &context, const
       if ( !d->expressionPrepared && !prepare( context ) )
         return defaultValue;
 
-      QVariant result = d->expression.evaluate( &context );
+      QVariant result;
+      QString cacheKey;
+      QgsPropertyResultCache *cache = d->expressionCacheable ? context.propertyResultCache() : nullptr;
+      if ( cache && propertyResultCacheKey( d->expressionString, d->expressionReferencedColIndexes, context.feature(), cacheKey ) )
+      {
+        if ( !cache->lookup( cacheKey, result ) )
+        {
+          result = d->expression.evaluate( &context );
+          cache->insert( cacheKey, result );
+        }
+      }
+      else
+      {
+        result = d->expression.evaluate( &context );
+      }
+
       if ( result.isValid() )
       {
         if ( ok )
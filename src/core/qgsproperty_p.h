@@ -54,6 +54,8 @@ class QgsPropertyPrivate : public QSharedData
       , expressionPrepared( other.expressionPrepared )
       , expression( other.expression )
       , expressionReferencedCols( other.expressionReferencedCols )
+      , expressionCacheable( other.expressionCacheable )
+      , expressionReferencedColIndexes( other.expressionReferencedColIndexes )
     {}
 
     ~QgsPropertyPrivate()
@@ -82,6 +84,10 @@ class QgsPropertyPrivate : public QSharedData
     mutable QgsExpression expression;
     //! Cached set of referenced columns
     mutable QSet< QString > expressionReferencedCols;
+    //! True if the expression result only depends on the referenced attributes
+    mutable bool expressionCacheable = false;
+    //! Cached indexes of the referenced attributes, used for building result cache keys
+    mutable QList< int > expressionReferencedColIndexes;
 
 };
 
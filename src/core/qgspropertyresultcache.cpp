@@ -0,0 +1,73 @@
+/***************************************************************************
+     qgspropertyresultcache.cpp
+     --------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by agent
+    Email                : agent at local
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgspropertyresultcache.h"
+
+#include <QMutexLocker>
+
+QgsPropertyResultCache::QgsPropertyResultCache( int maximumSize )
+  : mResults( maximumSize )
+{
+}
+
+bool QgsPropertyResultCache::lookup( const QString &key, QVariant &value )
+{
+  QMutexLocker locker( &mMutex );
+  // looking up a result marks it as most recently used
+  QVariant *result = mResults.object( key );
+  if ( !result )
+  {
+    mMisses++;
+    return false;
+  }
+
+  mHits++;
+  value = *result;
+  return true;
+}
+
+void QgsPropertyResultCache::insert( const QString &key, const QVariant &value )
+{
+  QMutexLocker locker( &mMutex );
+  // high cardinality attributes would let the cache grow without bounds, so the least
+  // recently used results are discarded when it is full
+  mResults.insert( key, new QVariant( value ) );
+}
+
+void QgsPropertyResultCache::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mResults.clear();
+  mHits = 0;
+  mMisses = 0;
+}
+
+int QgsPropertyResultCache::count() const
+{
+  QMutexLocker locker( &mMutex );
+  return mResults.count();
+}
+
+int QgsPropertyResultCache::hits() const
+{
+  QMutexLocker locker( &mMutex );
+  return mHits;
+}
+
+int QgsPropertyResultCache::misses() const
+{
+  QMutexLocker locker( &mMutex );
+  return mMisses;
+}
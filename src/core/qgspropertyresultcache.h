@@ -0,0 +1,100 @@
+/***************************************************************************
+     qgspropertyresultcache.h
+     ------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by agent
+    Email                : agent at local
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSPROPERTYRESULTCACHE_H
+#define QGSPROPERTYRESULTCACHE_H
+
+#include "qgis_core.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+
+/**
+ * \ingroup core
+ * \class QgsPropertyResultCache
+ * \brief Caches the results of data defined property expressions.
+ *
+ * Results are stored by a key built from the expression string and the values of the
+ * attributes referenced by the expression, so that an expression which is used by several
+ * properties (e.g. in multiple symbol layers and the labeling of a layer) is only
+ * evaluated once for every distinct combination of attribute values.
+ *
+ * Only expressions which do not depend on anything but the feature's attributes may
+ * be cached. The cache is usually enabled on a render context's expression context by calling
+ * QgsExpressionContext::setPropertyResultCacheEnabled(), which is then used by
+ * QgsProperty::value() and related methods.
+ *
+ * The cache is thread safe, so it can be shared between copies of an expression
+ * context which are used in different threads.
+ *
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsPropertyResultCache
+{
+  public:
+
+    /**
+     * Constructor for QgsPropertyResultCache. When the cache holds more than \a maximumSize
+     * results the least recently used results are discarded.
+     */
+    explicit QgsPropertyResultCache( int maximumSize = 10000 );
+
+    //! QgsPropertyResultCache cannot be copied
+    QgsPropertyResultCache( const QgsPropertyResultCache &rh ) = delete;
+    //! QgsPropertyResultCache cannot be copied
+    QgsPropertyResultCache &operator=( const QgsPropertyResultCache &rh ) = delete;
+
+    /**
+     * Retrieves the cached result matching \a key into \a value. Returns true if a
+     * result was found, and updates the hit and miss counters accordingly.
+     * @see insert()
+     */
+    bool lookup( const QString &key, QVariant &value );
+
+    /**
+     * Stores a result \a value for the specified \a key.
+     * @see lookup()
+     */
+    void insert( const QString &key, const QVariant &value );
+
+    //! Removes all results from the cache and resets the counters
+    void clear();
+
+    //! Returns the number of results currently stored in the cache
+    int count() const;
+
+    /**
+     * Returns the number of lookups which could be served from the cache.
+     * @see misses()
+     */
+    int hits() const;
+
+    /**
+     * Returns the number of lookups which had to be evaluated.
+     * @see hits()
+     */
+    int misses() const;
+
+  private:
+
+    mutable QMutex mMutex;
+    QCache< QString, QVariant > mResults;
+    int mHits = 0;
+    int mMisses = 0;
+
+};
+
+#endif // QGSPROPERTYRESULTCACHE_H
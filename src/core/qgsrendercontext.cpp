@@ -47,6 +47,7 @@ QgsRenderContext::QgsRenderContext( const QgsRenderContext &rh )
   , mExpressionContext( rh.mExpressionContext )
   , mGeometry( rh.mGeometry )
   , mFeatureFilterProvider( rh.mFeatureFilterProvider ? rh.mFeatureFilterProvider->clone() : nullptr )
+  , mRenderTrace( rh.mRenderTrace )
   , mSegmentationTolerance( rh.mSegmentationTolerance )
   , mSegmentationToleranceType( rh.mSegmentationToleranceType )
 {
@@ -68,6 +69,7 @@ QgsRenderContext &QgsRenderContext::operator=( const QgsRenderContext &rh )
   mExpressionContext = rh.mExpressionContext;
   mGeometry = rh.mGeometry;
   mFeatureFilterProvider.reset( rh.mFeatureFilterProvider ? rh.mFeatureFilterProvider->clone() : nullptr );
+  mRenderTrace = rh.mRenderTrace;
   mSegmentationTolerance = rh.mSegmentationTolerance;
   mSegmentationToleranceType = rh.mSegmentationToleranceType;
   return *this;
@@ -35,6 +35,7 @@ class QPainter;
 class QgsAbstractGeometry;
 class QgsLabelingEngine;
 class QgsMapSettings;
+class QgsRenderTrace;
 
 
 /** \ingroup core
@@ -65,6 +66,7 @@ class CORE_EXPORT QgsRenderContext
       RenderMapTile            = 0x40,  //!< Draw map such that there are no problems between adjacent tiles
       Antialiasing             = 0x80,  //!< Use antialiasing while drawing
       RenderPartialOutput      = 0x100, //!< Whether to make extra effort to update map image with partially rendered layers (better for interactive map canvas). Added in QGIS 3.0
+      RenderPreview            = 0x200, //!< Render a quick, low detail preview of the map (e.g. only a sample of features with aggressive simplification). Added in QGIS 3.0
     };
     Q_DECLARE_FLAGS( Flags, Flag )
 
@@ -260,6 +262,22 @@ class CORE_EXPORT QgsRenderContext
      */
     const QgsFeatureFilterProvider *featureFilterProvider() const;
 
+    /**
+     * Sets a \a trace which records timing spans of the stages of rendering. The trace
+     * is not owned by the context, and may be nullptr to disable tracing.
+     * @note added in QGIS 3.0
+     * @see renderTrace()
+     */
+    void setRenderTrace( QgsRenderTrace *trace ) { mRenderTrace = trace; }
+
+    /**
+     * Returns the trace which records timing spans of the stages of rendering,
+     * or nullptr if tracing is disabled.
+     * @note added in QGIS 3.0
+     * @see setRenderTrace()
+     */
+    QgsRenderTrace *renderTrace() const { return mRenderTrace; }
+
     /** Sets the segmentation tolerance applied when rendering curved geometries
     @param tolerance the segmentation tolerance*/
     void setSegmentationTolerance( double tolerance ) { mSegmentationTolerance = tolerance; }
@@ -338,6 +356,9 @@ class CORE_EXPORT QgsRenderContext
     //! The feature filter provider
     std::unique_ptr< QgsFeatureFilterProvider > mFeatureFilterProvider;
 
+    //! Trace for timing spans (not owned, can be nullptr)
+    QgsRenderTrace *mRenderTrace = nullptr;
+
     double mSegmentationTolerance = M_PI_2 / 90;
 
     QgsAbstractGeometry::SegmentationToleranceType mSegmentationToleranceType = QgsAbstractGeometry::MaximumAngle;
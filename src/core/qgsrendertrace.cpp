@@ -0,0 +1,140 @@
+/***************************************************************************
+     qgsrendertrace.cpp
+     ------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrendertrace.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+QgsRenderTrace::QgsRenderTrace()
+{
+  mTimer.start();
+}
+
+qint64 QgsRenderTrace::elapsed() const
+{
+  return mTimer.nsecsElapsed() / 1000;
+}
+
+void QgsRenderTrace::addSpan( const QString &name, const QString &category, qint64 start, qint64 duration, const QVariantMap &arguments )
+{
+  Span span;
+  span.name = name;
+  span.category = category;
+  span.start = start;
+  span.duration = duration;
+  span.arguments = arguments;
+
+  QMutexLocker locker( &mMutex );
+  // thread handles are not meaningful to readers of the trace, so number the threads instead
+  Qt::HANDLE thread = QThread::currentThreadId();
+  QHash< Qt::HANDLE, int >::const_iterator it = mThreads.constFind( thread );
+  if ( it == mThreads.constEnd() )
+    it = mThreads.insert( thread, mThreads.count() + 1 );
+  span.thread = it.value();
+  mSpans.append( span );
+}
+
+QList< QgsRenderTrace::Span > QgsRenderTrace::spans() const
+{
+  QMutexLocker locker( &mMutex );
+  return mSpans;
+}
+
+int QgsRenderTrace::spanCount() const
+{
+  QMutexLocker locker( &mMutex );
+  return mSpans.count();
+}
+
+void QgsRenderTrace::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mSpans.clear();
+  mThreads.clear();
+}
+
+QByteArray QgsRenderTrace::toChromeTrace() const
+{
+  QJsonArray events;
+  Q_FOREACH ( const Span &span, spans() )
+  {
+    QJsonObject event;
+    event.insert( QStringLiteral( "name" ), span.name );
+    event.insert( QStringLiteral( "cat" ), span.category );
+    // complete event, with start and duration
+    event.insert( QStringLiteral( "ph" ), QStringLiteral( "X" ) );
+    event.insert( QStringLiteral( "ts" ), static_cast< double >( span.start ) );
+    event.insert( QStringLiteral( "dur" ), static_cast< double >( span.duration ) );
+    event.insert( QStringLiteral( "pid" ), 1 );
+    event.insert( QStringLiteral( "tid" ), span.thread );
+    if ( !span.arguments.isEmpty() )
+      event.insert( QStringLiteral( "args" ), QJsonObject::fromVariantMap( span.arguments ) );
+    events.append( event );
+  }
+
+  QJsonObject trace;
+  trace.insert( QStringLiteral( "traceEvents" ), events );
+  trace.insert( QStringLiteral( "displayTimeUnit" ), QStringLiteral( "ms" ) );
+  return QJsonDocument( trace ).toJson( QJsonDocument::Compact );
+}
+
+bool QgsRenderTrace::writeChromeTrace( const QString &path ) const
+{
+  QSaveFile file( path );
+  if ( !file.open( QIODevice::WriteOnly ) )
+    return false;
+
+  file.write( toChromeTrace() );
+  return file.commit();
+}
+
+//
+// QgsRenderTraceSpan
+//
+
+QgsRenderTraceSpan::QgsRenderTraceSpan( QgsRenderTrace *trace, const QString &name, const QString &category )
+  : mTrace( trace )
+{
+  if ( !mTrace )
+    return;
+
+  mName = name;
+  mCategory = category;
+  mStart = mTrace->elapsed();
+}
+
+QgsRenderTraceSpan::~QgsRenderTraceSpan()
+{
+  end();
+}
+
+void QgsRenderTraceSpan::setArgument( const QString &key, const QVariant &value )
+{
+  if ( mTrace )
+    mArguments.insert( key, value );
+}
+
+void QgsRenderTraceSpan::end()
+{
+  if ( !mTrace )
+    return;
+
+  mTrace->addSpan( mName, mCategory, mStart, mTrace->elapsed() - mStart, mArguments );
+  mTrace = nullptr;
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+     qgsrendertrace.h
+     ----------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSRENDERTRACE_H
+#define QGSRENDERTRACE_H
+
+#include "qgis_core.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * \ingroup core
+ * \class QgsRenderTrace
+ * \brief Collects timed spans for the stages of a map render.
+ *
+ * A trace is attached to a map render job with QgsMapRendererJob::setRenderTrace(), which
+ * passes it to the render contexts of the layers and the labeling. Rendering code then
+ * records spans (e.g. preparing and drawing a layer, solving the label placement or
+ * composing the final image) together with counts such as the number of features,
+ * vertices and labels, and the time spent fetching features, rendering symbols and
+ * registering labels.
+ *
+ * Spans can be exported to the Chrome trace event format with toChromeTrace(), which
+ * can be loaded into chrome://tracing or similar tools.
+ *
+ * Recording spans is thread safe, so a single trace may be shared by all threads of a
+ * parallel render job, or by several jobs.
+ *
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsRenderTrace
+{
+  public:
+
+    //! A single timed span of a trace
+    struct Span
+    {
+      //! Name of span
+      QString name;
+      //! Category of span, e.g. "layer" or "labeling"
+      QString category;
+      //! Start time of span, in microseconds since the trace was created
+      qint64 start = 0;
+      //! Duration of span, in microseconds
+      qint64 duration = 0;
+      //! Sequential number of the thread which recorded the span
+      int thread = 0;
+      //! Additional arguments, e.g. counts of rendered features
+      QVariantMap arguments;
+    };
+
+    /**
+     * Constructor for QgsRenderTrace. Times of spans are measured relative to the
+     * construction of the trace.
+     */
+    QgsRenderTrace();
+
+    //! QgsRenderTrace cannot be copied
+    QgsRenderTrace( const QgsRenderTrace &rh ) = delete;
+    //! QgsRenderTrace cannot be copied
+    QgsRenderTrace &operator=( const QgsRenderTrace &rh ) = delete;
+
+    /**
+     * Returns the time since the trace was created, in microseconds.
+     */
+    qint64 elapsed() const;
+
+    /**
+     * Records a span with the specified \a name and \a category, which started at \a start
+     * and lasted \a duration microseconds. Optional \a arguments are stored with the span.
+     */
+    void addSpan( const QString &name, const QString &category, qint64 start, qint64 duration, const QVariantMap &arguments = QVariantMap() );
+
+    /**
+     * Returns all spans recorded in the trace.
+     */
+    QList< QgsRenderTrace::Span > spans() const;
+
+    /**
+     * Returns the number of spans recorded in the trace.
+     */
+    int spanCount() const;
+
+    /**
+     * Removes all spans from the trace.
+     */
+    void clear();
+
+    /**
+     * Returns the spans in the Chrome trace event JSON format.
+     * @see writeChromeTrace()
+     */
+    QByteArray toChromeTrace() const;
+
+    /**
+     * Writes the spans in the Chrome trace event JSON format to the file
+     * at \a path. Returns false if the file could not be written.
+     * @see toChromeTrace()
+     */
+    bool writeChromeTrace( const QString &path ) const;
+
+  private:
+
+    QElapsedTimer mTimer;
+    mutable QMutex mMutex;
+    QList< Span > mSpans;
+    QHash< Qt::HANDLE, int > mThreads;
+
+};
+
+/**
+ * \ingroup core
+ * \class QgsRenderTraceSpan
+ * \brief Records a span in a QgsRenderTrace for the lifetime of the object.
+ *
+ * If no trace is set, nothing is recorded, so spans can be created unconditionally
+ * in rendering code.
+ *
+ * \note not available in Python bindings
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsRenderTraceSpan
+{
+  public:
+
+    /**
+     * Starts a span with the specified \a name and \a category in \a trace, which may be nullptr.
+     */
+    QgsRenderTraceSpan( QgsRenderTrace *trace, const QString &name, const QString &category );
+
+    //! Records the span, if it was not already ended with end()
+    ~QgsRenderTraceSpan();
+
+    //! QgsRenderTraceSpan cannot be copied
+    QgsRenderTraceSpan( const QgsRenderTraceSpan &rh ) = delete;
+    //! QgsRenderTraceSpan cannot be copied
+    QgsRenderTraceSpan &operator=( const QgsRenderTraceSpan &rh ) = delete;
+
+    //! Sets an argument which is stored with the span
+    void setArgument( const QString &key, const QVariant &value );
+
+    //! Records the span now, instead of when the object is destroyed
+    void end();
+
+  private:
+
+    QgsRenderTrace *mTrace = nullptr;
+    QString mName;
+    QString mCategory;
+    qint64 mStart = 0;
+    QVariantMap mArguments;
+
+};
+
+#endif // QGSRENDERTRACE_H
@@ -0,0 +1,138 @@
+/***************************************************************************
+     qgstextlayoutcache.cpp
+     ----------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by agent
+    Email                : agent at local
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstextlayoutcache.h"
+
+#include <QFontMetricsF>
+#include <QMutexLocker>
+
+QgsTextLayoutCache *QgsTextLayoutCache::instance()
+{
+  static QgsTextLayoutCache sInstance;
+  return &sInstance;
+}
+
+QgsTextLayoutCache::QgsTextLayoutCache( int maximumSize )
+  : mLayouts( maximumSize )
+{
+}
+
+double QgsTextLayoutCache::textWidth( const QFont &font, const QString &text )
+{
+  QString key = cacheKey( font, text );
+  {
+    QMutexLocker locker( &mMutex );
+    Layout *layout = mLayouts.object( key );
+    if ( layout && layout->width >= 0 )
+    {
+      mHits++;
+      return layout->width;
+    }
+    mMisses++;
+  }
+
+  // measure without holding the lock
+  double width = QFontMetricsF( font ).width( text );
+
+  QMutexLocker locker( &mMutex );
+  Layout *layout = new Layout;
+  if ( Layout *existing = mLayouts.object( key ) )
+    *layout = *existing;
+  layout->width = width;
+  insert( key, layout );
+  return width;
+}
+
+QPainterPath QgsTextLayoutCache::textPath( const QFont &font, const QString &text )
+{
+  QString key = cacheKey( font, text );
+  {
+    QMutexLocker locker( &mMutex );
+    Layout *layout = mLayouts.object( key );
+    if ( layout && layout->hasPath )
+    {
+      mHits++;
+      return layout->path;
+    }
+    mMisses++;
+  }
+
+  // shaping the text is the expensive part, so do it without holding the lock
+  QPainterPath path;
+  path.setFillRule( Qt::WindingFill );
+  path.addText( 0, 0, font, text );
+
+  QMutexLocker locker( &mMutex );
+  Layout *layout = new Layout;
+  if ( Layout *existing = mLayouts.object( key ) )
+    *layout = *existing;
+  layout->path = path;
+  layout->hasPath = true;
+  insert( key, layout );
+  return path;
+}
+
+void QgsTextLayoutCache::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mLayouts.clear();
+  mHits = 0;
+  mMisses = 0;
+}
+
+int QgsTextLayoutCache::count() const
+{
+  QMutexLocker locker( &mMutex );
+  return mLayouts.count();
+}
+
+int QgsTextLayoutCache::size() const
+{
+  QMutexLocker locker( &mMutex );
+  return mLayouts.totalCost();
+}
+
+int QgsTextLayoutCache::hits() const
+{
+  QMutexLocker locker( &mMutex );
+  return mHits;
+}
+
+int QgsTextLayoutCache::misses() const
+{
+  QMutexLocker locker( &mMutex );
+  return mMisses;
+}
+
+void QgsTextLayoutCache::insert( const QString &key, Layout *layout )
+{
+  // the cost is the approximate memory used by the line, so that lines with large paths
+  // are discarded before many small ones. The least recently used lines are discarded first
+  int cost = sizeof( Layout ) + key.size() * sizeof( QChar ) + layout->path.elementCount() * sizeof( QPainterPath::Element );
+  mLayouts.insert( key, layout, cost );
+}
+
+QString QgsTextLayoutCache::cacheKey( const QFont &font, const QString &text )
+{
+  // QFont::key() does not cover the spacing and capitalization settings
+  return font.key()
+         + QStringLiteral( ",%1,%2,%3,%4,%5,%6\n" ).arg( font.letterSpacingType() )
+         .arg( font.letterSpacing() )
+         .arg( font.wordSpacing() )
+         .arg( font.capitalization() )
+         .arg( font.kerning() )
+         .arg( font.hintingPreference() )
+         + text;
+}
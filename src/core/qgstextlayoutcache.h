@@ -0,0 +1,121 @@
+/***************************************************************************
+     qgstextlayoutcache.h
+     --------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by agent
+    Email                : agent at local
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSTEXTLAYOUTCACHE_H
+#define QGSTEXTLAYOUTCACHE_H
+
+#include "qgis_core.h"
+
+#include <QFont>
+#include <QCache>
+#include <QMutex>
+#include <QPainterPath>
+#include <QString>
+
+/**
+ * \ingroup core
+ * \class QgsTextLayoutCache
+ * \brief Caches the measured widths and glyph outlines of single lines of text.
+ *
+ * Lines are stored by the text and the exact font used to render them, which
+ * already includes the scaling of the render context. Labeling uses the cache when
+ * calculating label sizes for candidate placement, and QgsTextRenderer uses it when
+ * drawing text and buffers, so that the same string in the same font is only
+ * measured and converted to a path once.
+ *
+ * Widths used for aligning the lines of multi-line text while drawing are measured with
+ * the font metrics passed to the text renderer and are not cached.
+ *
+ * The cache is thread safe and shared by all render jobs through instance().
+ *
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsTextLayoutCache
+{
+  public:
+
+    /**
+     * Returns the cache shared by the text renderer and labeling.
+     */
+    static QgsTextLayoutCache *instance();
+
+    /**
+     * Constructor for QgsTextLayoutCache. When the cached lines need more than \a maximumSize
+     * bytes, the least recently used lines are discarded.
+     */
+    explicit QgsTextLayoutCache( int maximumSize = 10 * 1024 * 1024 );
+
+    //! QgsTextLayoutCache cannot be copied
+    QgsTextLayoutCache( const QgsTextLayoutCache &rh ) = delete;
+    //! QgsTextLayoutCache cannot be copied
+    QgsTextLayoutCache &operator=( const QgsTextLayoutCache &rh ) = delete;
+
+    /**
+     * Returns the width of a single line of \a text when drawn with \a font,
+     * as returned by QFontMetricsF::width().
+     * @see textPath()
+     */
+    double textWidth( const QFont &font, const QString &text );
+
+    /**
+     * Returns the outline of a single line of \a text when drawn with \a font,
+     * with the text's baseline starting at the origin.
+     * @see textWidth()
+     */
+    QPainterPath textPath( const QFont &font, const QString &text );
+
+    //! Removes all lines from the cache and resets the counters
+    void clear();
+
+    //! Returns the number of lines currently stored in the cache
+    int count() const;
+
+    //! Returns the approximate number of bytes used by the lines currently stored in the cache
+    int size() const;
+
+    /**
+     * Returns the number of width and path requests which could be served from the cache.
+     * @see misses()
+     */
+    int hits() const;
+
+    /**
+     * Returns the number of width and path requests which had to be calculated.
+     * @see hits()
+     */
+    int misses() const;
+
+  private:
+
+    struct Layout
+    {
+      double width = -1;
+      bool hasPath = false;
+      QPainterPath path;
+    };
+
+    //! Returns a key for the line of text, identifying all font properties which affect the layout
+    static QString cacheKey( const QFont &font, const QString &text );
+
+    //! Stores a layout, replacing any previous layout for the same key
+    void insert( const QString &key, Layout *layout );
+
+    mutable QMutex mMutex;
+    QCache< QString, Layout > mLayouts;
+    int mHits = 0;
+    int mMisses = 0;
+
+};
+
+#endif // QGSTEXTLAYOUTCACHE_H
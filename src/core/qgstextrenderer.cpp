@@ -21,6 +21,7 @@
 #include "qgssymbollayerutils.h"
 #include "qgspainting.h"
 #include "qgsmarkersymbollayer.h"
+#include "qgstextlayoutcache.h"
 #include <QFontDatabase>
 
 Q_GUI_EXPORT extern int qt_defaultDpiX();
@@ -1790,9 +1791,7 @@ void QgsTextRenderer::drawBuffer( QgsRenderContext &context, const QgsTextRender
 
   double penSize = context.convertToPainterUnits( buffer.size(), buffer.sizeUnit(), buffer.sizeMapUnitScale() );
 
-  QPainterPath path;
-  path.setFillRule( Qt::WindingFill );
-  path.addText( 0, 0, format.scaledFont( context ), component.text );
+  QPainterPath path = QgsTextLayoutCache::instance()->textPath( format.scaledFont( context ), component.text );
   QColor bufferColor = buffer.color();
   bufferColor.setAlphaF( buffer.opacity() );
   QPen pen( bufferColor );
@@ -2396,6 +2395,8 @@ void QgsTextRenderer::drawTextInternal( TextPart drawType,
     return;
   }
 
+  // the alignment widths are measured with the passed font metrics, which labeling creates for
+  // its own font, so they are not taken from QgsTextLayoutCache
   double labelWidest = 0.0;
   switch ( mode )
   {
@@ -2426,6 +2427,8 @@ void QgsTextRenderer::drawTextInternal( TextPart drawType,
 
   bool adjustForAlignment = alignment != AlignLeft && ( mode != Label || textLines.size() > 1 );
 
+  QFont scaledFont = format.scaledFont( context );
+
   Q_FOREACH ( const QString &line, textLines )
   {
     context.painter()->save();
@@ -2503,9 +2506,7 @@ void QgsTextRenderer::drawTextInternal( TextPart drawType,
     else
     {
       // draw text, QPainterPath method
-      QPainterPath path;
-      path.setFillRule( Qt::WindingFill );
-      path.addText( 0, 0, format.scaledFont( context ), subComponent.text );
+      QPainterPath path = QgsTextLayoutCache::instance()->textPath( scaledFont, subComponent.text );
 
       // store text's drawing in QPicture for drop shadow call
       QPicture textPict;
@@ -2550,7 +2551,7 @@ void QgsTextRenderer::drawTextInternal( TextPart drawType,
       else
       {
         // draw text as text (for SVG and PDF exports)
-        context.painter()->setFont( format.scaledFont( context ) );
+        context.painter()->setFont( scaledFont );
         QColor textColor = format.color();
         textColor.setAlphaF( format.opacity() );
         context.painter()->setPen( textColor );
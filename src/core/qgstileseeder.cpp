@@ -0,0 +1,357 @@
+/***************************************************************************
+     qgstileseeder.cpp
+     -----------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstileseeder.h"
+#include "qgscoordinatetransform.h"
+#include "qgscsexception.h"
+#include "qgsfeatureiterator.h"
+#include "qgsfeedback.h"
+#include "qgslogger.h"
+#include "qgsmaprendererparalleljob.h"
+#include "qgsmvtencoder.h"
+#include "qgsvectorlayer.h"
+#include "qgsvectorlayerfeatureiterator.h"
+
+#include <QDir>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace
+{
+  //! Half of the width of the world in Web Mercator
+  const double WEB_MERCATOR_ORIGIN = 20037508.342789244;
+
+  //! Returns the width of a tile at a zoom level, in map units
+  double tileWidth( int zoom )
+  {
+    return 2 * WEB_MERCATOR_ORIGIN / ( 1 << zoom );
+  }
+
+  //! Returns true if all pixels of an image are fully transparent
+  bool isTransparent( const QImage &image )
+  {
+    if ( !image.hasAlphaChannel() )
+      return false;
+
+    for ( int y = 0; y < image.height(); ++y )
+    {
+      const QRgb *line = reinterpret_cast< const QRgb * >( image.constScanLine( y ) );
+      for ( int x = 0; x < image.width(); ++x )
+      {
+        if ( qAlpha( line[x] ) != 0 )
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+QgsTileSeeder::QgsTileSeeder( const QgsMapSettings &settings )
+  : mSettings( settings )
+  , mMaxParallelMetaTiles( QThread::idealThreadCount() )
+{
+  mSettings.setDestinationCrs( QgsCoordinateReferenceSystem::fromEpsgId( 3857 ) );
+}
+
+QgsRectangle QgsTileSeeder::tileExtent( int x, int y, int zoom )
+{
+  const double width = tileWidth( zoom );
+  return QgsRectangle( -WEB_MERCATOR_ORIGIN + x * width, WEB_MERCATOR_ORIGIN - ( y + 1 ) * width,
+                       -WEB_MERCATOR_ORIGIN + ( x + 1 ) * width, WEB_MERCATOR_ORIGIN - y * width );
+}
+
+int QgsTileSeeder::seed( const QgsRectangle &extent, int minZoom, int maxZoom, QgsFeedback *feedback )
+{
+  const QList< MetaTile > tiles = metaTiles( extent, minZoom, maxZoom );
+  const int batchSize = std::max( 1, mMaxParallelMetaTiles );
+  int written = 0;
+
+  for ( int start = 0; start < tiles.count(); start += batchSize )
+  {
+    if ( feedback && feedback->isCanceled() )
+      break;
+
+    // start the jobs of a batch of meta-tiles, they render concurrently in the global thread pool
+    const int end = std::min( start + batchSize, tiles.count() );
+    std::vector< std::unique_ptr< QgsMapRendererParallelJob > > jobs;
+    for ( int i = start; i < end; ++i )
+    {
+      const MetaTile &meta = tiles.at( i );
+      const double buffer = mMetaTileBuffer * tileWidth( meta.zoom ) / mTileSize;
+      const QgsRectangle topLeft = tileExtent( meta.xMin, meta.yMin, meta.zoom );
+      const QgsRectangle bottomRight = tileExtent( meta.xMax, meta.yMax, meta.zoom );
+
+      QgsMapSettings settings = mSettings;
+      settings.setOutputSize( QSize( ( meta.xMax - meta.xMin + 1 ) * mTileSize + 2 * mMetaTileBuffer,
+                                     ( meta.yMax - meta.yMin + 1 ) * mTileSize + 2 * mMetaTileBuffer ) );
+      settings.setExtent( QgsRectangle( topLeft.xMinimum() - buffer, bottomRight.yMinimum() - buffer,
+                                        bottomRight.xMaximum() + buffer, topLeft.yMaximum() + buffer ) );
+
+      jobs.emplace_back( new QgsMapRendererParallelJob( settings ) );
+      jobs.back()->start();
+    }
+
+    // slice the rendered meta-tiles into tiles
+    for ( int i = start; i < end; ++i )
+    {
+      QgsMapRendererParallelJob *job = jobs.at( i - start ).get();
+      job->waitForFinished();
+      const QImage image = job->renderedImage();
+      const MetaTile &meta = tiles.at( i );
+      for ( int y = meta.yMin; y <= meta.yMax; ++y )
+      {
+        for ( int x = meta.xMin; x <= meta.xMax; ++x )
+        {
+          const QImage tile = image.copy( mMetaTileBuffer + ( x - meta.xMin ) * mTileSize,
+                                          mMetaTileBuffer + ( y - meta.yMin ) * mTileSize,
+                                          mTileSize, mTileSize );
+          if ( isTransparent( tile ) )
+            continue;
+
+          if ( writeTile( x, y, meta.zoom, tile ) )
+            written++;
+        }
+      }
+    }
+
+    if ( feedback )
+      feedback->setProgress( 100.0 * end / tiles.count() );
+  }
+
+  return written;
+}
+
+int QgsTileSeeder::seedVectorTiles( const QgsRectangle &extent, int minZoom, int maxZoom, QgsFeedback *feedback )
+{
+  QList< QgsVectorLayer * > layers;
+  Q_FOREACH ( QgsMapLayer *layer, mSettings.layers() )
+  {
+    if ( QgsVectorLayer *vl = qobject_cast< QgsVectorLayer * >( layer ) )
+      layers << vl;
+  }
+
+  //! A layer of a meta-tile, prepared in the calling thread
+  struct LayerJob
+  {
+    std::shared_ptr< QgsVectorLayerFeatureSource > source;
+    QgsCoordinateTransform transform;
+    QString name;
+  };
+
+  //! A meta-tile encoded in a worker thread
+  struct MetaTileJob
+  {
+    MetaTile meta;
+    QList< LayerJob > layers;
+    QVector< QByteArray > tiles;
+  };
+
+  const QList< MetaTile > tiles = metaTiles( extent, minZoom, maxZoom );
+  const int batchSize = std::max( 1, mMaxParallelMetaTiles );
+  const QgsCoordinateReferenceSystem destinationCrs = mSettings.destinationCrs();
+  int written = 0;
+
+  for ( int start = 0; start < tiles.count(); start += batchSize )
+  {
+    if ( feedback && feedback->isCanceled() )
+      break;
+
+    const int end = std::min( start + batchSize, tiles.count() );
+    QList< MetaTileJob > jobs;
+    for ( int i = start; i < end; ++i )
+    {
+      MetaTileJob job;
+      job.meta = tiles.at( i );
+      // feature sources must be created in the thread of the layers
+      Q_FOREACH ( QgsVectorLayer *layer, layers )
+      {
+        LayerJob layerJob;
+        layerJob.source.reset( new QgsVectorLayerFeatureSource( layer ) );
+        layerJob.transform = QgsCoordinateTransform( layer->crs(), destinationCrs );
+        layerJob.name = layer->name();
+        job.layers << layerJob;
+      }
+      jobs << job;
+    }
+
+    QtConcurrent::blockingMap( jobs, [feedback]( MetaTileJob & job )
+    {
+      const MetaTile &meta = job.meta;
+      std::vector< std::unique_ptr< QgsMvtEncoder > > encoders;
+      for ( int y = meta.yMin; y <= meta.yMax; ++y )
+      {
+        for ( int x = meta.xMin; x <= meta.xMax; ++x )
+          encoders.emplace_back( new QgsMvtEncoder( tileExtent( x, y, meta.zoom ) ) );
+      }
+
+      const QgsRectangle topLeft = encoders.front()->clipExtent();
+      const QgsRectangle bottomRight = encoders.back()->clipExtent();
+      const QgsRectangle metaExtent( topLeft.xMinimum(), bottomRight.yMinimum(), bottomRight.xMaximum(), topLeft.yMaximum() );
+
+      Q_FOREACH ( const LayerJob &layer, job.layers )
+      {
+        QgsFeatureRequest request;
+        try
+        {
+          request.setFilterRect( layer.transform.transformBoundingBox( metaExtent, QgsCoordinateTransform::ReverseTransform ) );
+        }
+        catch ( QgsCsException &cse )
+        {
+          Q_UNUSED( cse );
+          QgsDebugMsg( QString( "Could not transform meta-tile extent to the CRS of layer %1: %2" ).arg( layer.name, cse.what() ) );
+          continue;
+        }
+
+        for ( const auto &encoder : encoders )
+          encoder->beginLayer( layer.name );
+
+        // each feature is fetched and transformed once and then added to all tiles it touches
+        QgsFeatureIterator fit = layer.source->getFeatures( request );
+        QgsFeature feature;
+        while ( fit.nextFeature( feature ) )
+        {
+          if ( feedback && feedback->isCanceled() )
+            break;
+
+          if ( !feature.hasGeometry() )
+            continue;
+
+          if ( layer.transform.isValid() && !layer.transform.isShortCircuited() )
+          {
+            QgsGeometry geometry = feature.geometry();
+            try
+            {
+              geometry.transform( layer.transform );
+            }
+            catch ( QgsCsException &cse )
+            {
+              Q_UNUSED( cse );
+              continue;
+            }
+            feature.setGeometry( geometry );
+          }
+
+          const QgsRectangle bbox = feature.geometry().boundingBox();
+          for ( const auto &encoder : encoders )
+          {
+            if ( encoder->clipExtent().intersects( bbox ) )
+              encoder->addFeature( feature );
+          }
+        }
+
+        for ( const auto &encoder : encoders )
+          encoder->endLayer();
+      }
+
+      job.tiles.resize( static_cast< int >( encoders.size() ) );
+      for ( int i = 0; i < static_cast< int >( encoders.size() ); ++i )
+      {
+        if ( encoders.at( i )->featureCount() > 0 )
+          job.tiles[i] = encoders.at( i )->data();
+      }
+    } );
+
+    Q_FOREACH ( const MetaTileJob &job, jobs )
+    {
+      const MetaTile &meta = job.meta;
+      const int columns = meta.xMax - meta.xMin + 1;
+      for ( int y = meta.yMin; y <= meta.yMax; ++y )
+      {
+        for ( int x = meta.xMin; x <= meta.xMax; ++x )
+        {
+          const QByteArray &tile = job.tiles.at( ( y - meta.yMin ) * columns + ( x - meta.xMin ) );
+          if ( !tile.isEmpty() && writeVectorTile( x, y, meta.zoom, tile ) )
+            written++;
+        }
+      }
+    }
+
+    if ( feedback )
+      feedback->setProgress( 100.0 * end / tiles.count() );
+  }
+
+  return written;
+}
+
+bool QgsTileSeeder::writeTile( int x, int y, int zoom, const QImage &image )
+{
+  const QString fileName = tileFileName( x, y, zoom, mFormat );
+  if ( fileName.isEmpty() )
+    return false;
+
+  return image.save( fileName, mFormat.toLocal8Bit().constData() );
+}
+
+bool QgsTileSeeder::writeVectorTile( int x, int y, int zoom, const QByteArray &tile )
+{
+  const QString fileName = tileFileName( x, y, zoom, QStringLiteral( "mvt" ) );
+  if ( fileName.isEmpty() )
+    return false;
+
+  QSaveFile file( fileName );
+  if ( !file.open( QIODevice::WriteOnly ) )
+    return false;
+
+  file.write( tile );
+  return file.commit();
+}
+
+QList< QgsTileSeeder::MetaTile > QgsTileSeeder::metaTiles( const QgsRectangle &extent, int minZoom, int maxZoom ) const
+{
+  QList< MetaTile > tiles;
+  const int metaSize = std::max( 1, mMetaTileSize );
+  for ( int zoom = std::max( 0, minZoom ); zoom <= std::min( maxZoom, 30 ); ++zoom )
+  {
+    const int count = 1 << zoom;
+    const double width = tileWidth( zoom );
+    const int xMin = std::max( 0, static_cast< int >( std::floor( ( extent.xMinimum() + WEB_MERCATOR_ORIGIN ) / width ) ) );
+    const int xMax = std::min( count - 1, static_cast< int >( std::ceil( ( extent.xMaximum() + WEB_MERCATOR_ORIGIN ) / width ) ) - 1 );
+    const int yMin = std::max( 0, static_cast< int >( std::floor( ( WEB_MERCATOR_ORIGIN - extent.yMaximum() ) / width ) ) );
+    const int yMax = std::min( count - 1, static_cast< int >( std::ceil( ( WEB_MERCATOR_ORIGIN - extent.yMinimum() ) / width ) ) - 1 );
+
+    // meta-tiles are aligned to multiples of the meta-tile size, so that seeding neighbouring extents gives the same tiles
+    for ( int metaY = yMin / metaSize; metaY <= yMax / metaSize && yMin <= yMax; ++metaY )
+    {
+      for ( int metaX = xMin / metaSize; metaX <= xMax / metaSize && xMin <= xMax; ++metaX )
+      {
+        MetaTile meta;
+        meta.zoom = zoom;
+        meta.xMin = std::max( xMin, metaX * metaSize );
+        meta.yMin = std::max( yMin, metaY * metaSize );
+        meta.xMax = std::min( xMax, ( metaX + 1 ) * metaSize - 1 );
+        meta.yMax = std::min( yMax, ( metaY + 1 ) * metaSize - 1 );
+        tiles << meta;
+      }
+    }
+  }
+  return tiles;
+}
+
+QString QgsTileSeeder::tileFileName( int x, int y, int zoom, const QString &extension ) const
+{
+  if ( mOutputDirectory.isEmpty() )
+    return QString();
+
+  QDir dir( mOutputDirectory );
+  const QString path = QStringLiteral( "%1/%2" ).arg( zoom ).arg( x );
+  if ( !dir.mkpath( path ) )
+    return QString();
+
+  return dir.filePath( QStringLiteral( "%1/%2.%3" ).arg( path ).arg( y ).arg( extension ) );
+}
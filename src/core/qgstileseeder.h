@@ -0,0 +1,198 @@
+/***************************************************************************
+     qgstileseeder.h
+     ---------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSTILESEEDER_H
+#define QGSTILESEEDER_H
+
+#include "qgis_core.h"
+#include "qgsmapsettings.h"
+#include "qgsrectangle.h"
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+class QgsFeedback;
+
+/**
+ * \ingroup core
+ * \class QgsTileSeeder
+ * \brief Renders the tiles of an XYZ tile cache in batches.
+ *
+ * Tiles follow the XYZ scheme in the Web Mercator projection (EPSG:3857), with tile 0/0/0
+ * covering the whole world and y growing southwards. Instead of rendering every tile on
+ * its own, the seeder renders meta-tiles of metaTileSize() x metaTileSize() tiles in
+ * one map render job and slices the result into tiles. Preparing the layer renderers,
+ * symbols, expressions and labeling, as well as iterating the features, is done once
+ * for each meta-tile instead of once for each tile, and labels are placed consistently
+ * across tiles. Several meta-tiles are rendered in parallel.
+ *
+ * seedVectorTiles() writes Mapbox vector tiles instead. The features of each vector
+ * layer are fetched and transformed once for each meta-tile and distributed to the
+ * QgsMvtEncoder of every tile they touch.
+ *
+ * Tiles are passed to writeTile() or writeVectorTile(). By default they are written to
+ * files named {z}/{x}/{y}.{extension} below outputDirectory(); subclasses can store them
+ * elsewhere. Both methods are always called from the thread which started the seeding.
+ *
+ * \note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsTileSeeder
+{
+  public:
+
+    /**
+     * Constructor for QgsTileSeeder. The layers, background and rendering flags of the
+     * map \a settings are used for rendering the tiles. The destination CRS, extent and
+     * output size are set by the seeder.
+     */
+    QgsTileSeeder( const QgsMapSettings &settings );
+
+    virtual ~QgsTileSeeder() = default;
+
+    /**
+     * Returns the extent of the tile with the specified \a x, \a y and \a zoom, in EPSG:3857.
+     */
+    static QgsRectangle tileExtent( int x, int y, int zoom );
+
+    /**
+     * Sets the size of a tile in pixels (256 by default).
+     * @see tileSize()
+     */
+    void setTileSize( int size ) { mTileSize = size; }
+
+    /**
+     * Returns the size of a tile in pixels.
+     * @see setTileSize()
+     */
+    int tileSize() const { return mTileSize; }
+
+    /**
+     * Sets the number of tiles in each direction of a meta-tile (8 by default).
+     * @see metaTileSize()
+     */
+    void setMetaTileSize( int size ) { mMetaTileSize = size; }
+
+    /**
+     * Returns the number of tiles in each direction of a meta-tile.
+     * @see setMetaTileSize()
+     */
+    int metaTileSize() const { return mMetaTileSize; }
+
+    /**
+     * Sets the number of pixels rendered around each meta-tile (64 by default), so that symbols
+     * and labels of features just outside a meta-tile are drawn on its tiles.
+     * @see metaTileBuffer()
+     */
+    void setMetaTileBuffer( int pixels ) { mMetaTileBuffer = pixels; }
+
+    /**
+     * Returns the number of pixels rendered around each meta-tile.
+     * @see setMetaTileBuffer()
+     */
+    int metaTileBuffer() const { return mMetaTileBuffer; }
+
+    /**
+     * Sets the maximum number of meta-tiles which are rendered in parallel. By default
+     * this is the number of processor cores.
+     * @see maximumParallelMetaTiles()
+     */
+    void setMaximumParallelMetaTiles( int count ) { mMaxParallelMetaTiles = count; }
+
+    /**
+     * Returns the maximum number of meta-tiles which are rendered in parallel.
+     * @see setMaximumParallelMetaTiles()
+     */
+    int maximumParallelMetaTiles() const { return mMaxParallelMetaTiles; }
+
+    /**
+     * Sets the \a directory below which tiles are written by the default implementations
+     * of writeTile() and writeVectorTile().
+     * @see outputDirectory()
+     */
+    void setOutputDirectory( const QString &directory ) { mOutputDirectory = directory; }
+
+    /**
+     * Returns the directory below which tiles are written.
+     * @see setOutputDirectory()
+     */
+    QString outputDirectory() const { return mOutputDirectory; }
+
+    /**
+     * Sets the image \a format of rendered tiles, e.g. "png" (the default) or "jpg".
+     * @see format()
+     */
+    void setFormat( const QString &format ) { mFormat = format; }
+
+    /**
+     * Returns the image format of rendered tiles.
+     * @see setFormat()
+     */
+    QString format() const { return mFormat; }
+
+    /**
+     * Renders all tiles from \a minZoom up to \a maxZoom which intersect the \a extent
+     * (in EPSG:3857). An optional \a feedback object reports the progress and allows to cancel
+     * the seeding. Returns the number of tiles written.
+     */
+    int seed( const QgsRectangle &extent, int minZoom, int maxZoom, QgsFeedback *feedback = nullptr );
+
+    /**
+     * Encodes the vector layers into Mapbox vector tiles for all tiles from \a minZoom up
+     * to \a maxZoom which intersect the \a extent (in EPSG:3857). An optional \a feedback object
+     * reports the progress and allows to cancel the seeding. Returns the number of tiles written.
+     */
+    int seedVectorTiles( const QgsRectangle &extent, int minZoom, int maxZoom, QgsFeedback *feedback = nullptr );
+
+  protected:
+
+    /**
+     * Writes the rendered \a image of the tile with the specified \a x, \a y and \a zoom.
+     * Returns false if the tile could not be written.
+     */
+    virtual bool writeTile( int x, int y, int zoom, const QImage &image );
+
+    /**
+     * Writes the encoded vector \a tile with the specified \a x, \a y and \a zoom.
+     * Returns false if the tile could not be written.
+     */
+    virtual bool writeVectorTile( int x, int y, int zoom, const QByteArray &tile );
+
+  private:
+
+    //! Range of tiles of a meta-tile at a zoom level
+    struct MetaTile
+    {
+      int zoom;
+      int xMin;
+      int yMin;
+      int xMax;
+      int yMax;
+    };
+
+    QgsMapSettings mSettings;
+    int mTileSize = 256;
+    int mMetaTileSize = 8;
+    int mMetaTileBuffer = 64;
+    int mMaxParallelMetaTiles;
+    QString mOutputDirectory;
+    QString mFormat = QStringLiteral( "png" );
+
+    //! Returns the meta-tiles covering the extent at the zoom levels
+    QList< MetaTile > metaTiles( const QgsRectangle &extent, int minZoom, int maxZoom ) const;
+
+    //! Returns the file name of a tile below the output directory, creating its directory
+    QString tileFileName( int x, int y, int zoom, const QString &extension ) const;
+};
+
+#endif // QGSTILESEEDER_H
@@ -1349,6 +1349,7 @@ bool QgsVectorLayer::startEditing()
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::featureAdded, this, &QgsVectorLayer::featureAdded );
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::featureDeleted, this, &QgsVectorLayer::onFeatureDeleted );
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::geometryChanged, this, &QgsVectorLayer::geometryChanged );
+  connect( mEditBuffer, &QgsVectorLayerEditBuffer::featureExtentChanged, this, &QgsVectorLayer::triggerPartialRepaint );
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::attributeValueChanged, this, &QgsVectorLayer::attributeValueChanged );
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::attributeAdded, this, &QgsVectorLayer::attributeAdded );
   connect( mEditBuffer, &QgsVectorLayerEditBuffer::attributeDeleted, this, &QgsVectorLayer::attributeDeleted );
@@ -1363,6 +1364,9 @@ bool QgsVectorLayer::startEditing()
 
   emit editingStarted();
 
+  // editable layers are rendered with vertex markers, so any cached rendering is outdated
+  emit repaintRequested();
+
   return true;
 }
 
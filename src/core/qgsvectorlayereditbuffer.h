@@ -179,6 +179,13 @@ class CORE_EXPORT QgsVectorLayerEditBuffer : public QObject
      */
     void geometryChanged( QgsFeatureId fid, const QgsGeometry &geom );
 
+    /** Emitted when an edit changes how the layer is rendered within an \a extent (in layer CRS),
+     * e.g. the combined old and new bounding box of a feature whose geometry was changed.
+     * A null rectangle indicates that the whole layer is affected.
+     * @note added in QGIS 3.0
+     */
+    void featureExtentChanged( const QgsRectangle &extent );
+
     void attributeValueChanged( QgsFeatureId fid, int idx, const QVariant & );
     void attributeAdded( int idx );
     void attributeDeleted( int idx );
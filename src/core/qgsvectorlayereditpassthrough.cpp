@@ -37,6 +37,7 @@ bool QgsVectorLayerEditPassthrough::addFeature( QgsFeature &f )
   {
     f = fl.first();
     emit featureAdded( f.id() );
+    emit featureExtentChanged( f.hasGeometry() ? f.geometry().boundingBox() : QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -50,6 +51,7 @@ bool QgsVectorLayerEditPassthrough::addFeatures( QgsFeatureList &features )
     Q_FOREACH ( const QgsFeature &f, features )
     {
       emit featureAdded( f.id() );
+      emit featureExtentChanged( f.hasGeometry() ? f.geometry().boundingBox() : QgsRectangle() );
     }
     mModified = true;
     return true;
@@ -62,6 +64,7 @@ bool QgsVectorLayerEditPassthrough::deleteFeature( QgsFeatureId fid )
   if ( L->dataProvider()->deleteFeatures( QgsFeatureIds() << fid ) )
   {
     emit featureDeleted( fid );
+    emit featureExtentChanged( QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -74,6 +77,7 @@ bool QgsVectorLayerEditPassthrough::deleteFeatures( const QgsFeatureIds &fids )
   {
     Q_FOREACH ( QgsFeatureId fid, fids )
       emit featureDeleted( fid );
+    emit featureExtentChanged( QgsRectangle() );
 
     mModified = true;
     return true;
@@ -88,6 +92,7 @@ bool QgsVectorLayerEditPassthrough::changeGeometry( QgsFeatureId fid, const QgsG
   if ( L->dataProvider()->changeGeometryValues( geomMap ) )
   {
     emit geometryChanged( fid, geom );
+    emit featureExtentChanged( QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -103,6 +108,7 @@ bool QgsVectorLayerEditPassthrough::changeAttributeValue( QgsFeatureId fid, int
   if ( L->dataProvider()->changeAttributeValues( attribMap ) )
   {
     emit attributeValueChanged( fid, field, newValue );
+    emit featureExtentChanged( QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -114,6 +120,7 @@ bool QgsVectorLayerEditPassthrough::addAttribute( const QgsField &field )
   if ( L->dataProvider()->addAttributes( QList<QgsField>() << field ) )
   {
     emit attributeAdded( L->dataProvider()->fieldNameIndex( field.name() ) );
+    emit featureExtentChanged( QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -126,6 +133,7 @@ bool QgsVectorLayerEditPassthrough::deleteAttribute( int attr )
   {
     mModified = true;
     emit attributeDeleted( attr );
+    emit featureExtentChanged( QgsRectangle() );
     mModified = true;
     return true;
   }
@@ -140,6 +148,7 @@ bool QgsVectorLayerEditPassthrough::renameAttribute( int attr, const QString &ne
   {
     mModified = true;
     emit attributeRenamed( attr, newName );
+    emit featureExtentChanged( QgsRectangle() );
     return true;
   }
   return false;
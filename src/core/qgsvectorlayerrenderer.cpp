@@ -32,16 +32,33 @@
 #include "qgsvectorlayerlabeling.h"
 #include "qgsvectorlayerlabelprovider.h"
 #include "qgspainteffect.h"
+#include "qgspropertyresultcache.h"
 #include "qgsfeaturefilterprovider.h"
 #include "qgscsexception.h"
 #include "qgslogger.h"
 #include "qgssettings.h"
+#include "qgsrendertrace.h"
 
 #include <QPicture>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <memory>
 
 // TODO:
 // - passing of cache to QgsVectorLayer
 
+//! Simplification threshold (in pixels) used for quick previews
+static const float PREVIEW_SIMPLIFY_THRESHOLD = 4.0f;
+//! Number of features drawn completely in quick previews before sampling starts
+static const long PREVIEW_FULL_FEATURE_COUNT = 1000;
+//! Only every n-th feature after the first PREVIEW_FULL_FEATURE_COUNT is drawn in quick previews
+static const long PREVIEW_SAMPLE_STRIDE = 4;
+//! Minimum number of features for drawing ranges of symbol levels concurrently
+static const int PARALLEL_LEVELS_MIN_FEATURES = 1000;
+//! Default memory (in MB) for the images of symbol level ranges drawn concurrently
+static const int PARALLEL_LEVELS_DEFAULT_MEMORY = 256;
+
 
 QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRenderContext &context )
   : QgsMapLayerRenderer( layer->id() )
@@ -70,6 +87,15 @@ QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRender
   mSimplifyMethod = layer->simplifyMethod();
   mSimplifyGeometry = layer->simplifyDrawingCanbeApplied( mContext, QgsVectorSimplifyMethod::GeometrySimplification );
 
+  mPreview = mContext.testFlag( QgsRenderContext::RenderPreview );
+  if ( mPreview && ( mGeometryType == QgsWkbTypes::LineGeometry || mGeometryType == QgsWkbTypes::PolygonGeometry ) )
+  {
+    // quick previews always simplify geometries aggressively, regardless of the layer's settings
+    mSimplifyMethod.setSimplifyHints( mSimplifyMethod.simplifyHints() | QgsVectorSimplifyMethod::GeometrySimplification );
+    mSimplifyMethod.setThreshold( qMax( mSimplifyMethod.threshold(), PREVIEW_SIMPLIFY_THRESHOLD ) );
+    mSimplifyGeometry = true;
+  }
+
   QgsSettings settings;
   mVertexMarkerOnlyForSelection = settings.value( QStringLiteral( "qgis/digitizing/marker_only_for_selected" ), true ).toBool();
 
@@ -89,6 +115,9 @@ QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRender
 
   mVertexMarkerSize = settings.value( QStringLiteral( "qgis/digitizing/marker_size" ), 3 ).toInt();
 
+  // each range of symbol levels drawn concurrently takes an image of the size of the destination
+  mParallelLevelsMemory = static_cast< qint64 >( settings.value( QStringLiteral( "qgis/parallel_symbol_levels_memory" ), PARALLEL_LEVELS_DEFAULT_MEMORY ).toInt() ) * 1024 * 1024;
+
   if ( !mRenderer )
     return;
 
@@ -101,6 +130,9 @@ QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRender
   }
 
   mContext.expressionContext() << QgsExpressionContextUtils::layerScope( layer );
+  // symbol layers, labeling and diagrams of a layer often share data defined expressions
+  // based on a few attributes, so reuse their results for the duration of this render
+  mContext.expressionContext().setPropertyResultCacheEnabled( true );
 
   mAttrNames = mRenderer->usedAttributes( context );
 
@@ -129,6 +161,10 @@ bool QgsVectorLayerRenderer::render()
     return false;
   }
 
+  QgsRenderTrace *trace = mContext.renderTrace();
+  QgsRenderTraceSpan prepareSpan( trace, QStringLiteral( "Prepare" ), QStringLiteral( "vector" ) );
+  prepareSpan.setArgument( QStringLiteral( "layer_id" ), layerId() );
+
   bool usingEffect = false;
   if ( mRenderer->paintEffect() && mRenderer->paintEffect()->enabled() )
   {
@@ -245,26 +281,73 @@ bool QgsVectorLayerRenderer::render()
     mContext.setVectorSimplifyMethod( vectorMethod );
   }
 
-  QgsFeatureIterator fit = mSource->getFeatures( featureRequest );
+  // when the renderer cannot draw any feature with the current settings (e.g. all
+  // rules are out of scale) there is no need to fetch anything from the provider
+  QgsFeatureIterator fit;
+  if ( rendererFilter != QLatin1String( "FALSE" ) )
+    fit = mSource->getFeatures( featureRequest );
   // Attach an interruption checker so that iterators that have potentially
   // slow fetchFeature() implementations, such as in the WFS provider, can
   // check it, instead of relying on just the mContext.renderingStopped() check
   // in drawRenderer()
   fit.setInterruptionChecker( &mInterruptionChecker );
+  prepareSpan.end();
+
+  mTraceStatistics = TraceStatistics();
+  QgsRenderTraceSpan drawSpan( trace, QStringLiteral( "Draw features" ), QStringLiteral( "vector" ) );
+  drawSpan.setArgument( QStringLiteral( "layer_id" ), layerId() );
 
   if ( ( mRenderer->capabilities() & QgsFeatureRenderer::SymbolLevels ) && mRenderer->usingSymbolLevels() )
     drawRendererLevels( fit );
   else
     drawRenderer( fit );
 
+  if ( trace )
+  {
+    QVariantMap arguments = mTraceStatistics.toArguments();
+    for ( QVariantMap::const_iterator it = arguments.constBegin(); it != arguments.constEnd(); ++it )
+      drawSpan.setArgument( it.key(), it.value() );
+  }
+  drawSpan.end();
+
   if ( usingEffect )
   {
     mRenderer->paintEffect()->end( mContext );
   }
 
+  if ( QgsPropertyResultCache *cache = mContext.expressionContext().propertyResultCache() )
+  {
+    QgsDebugMsgLevel( QString( "Property result cache for layer %1: %2 hits, %3 misses" ).arg( layerId() ).arg( cache->hits() ).arg( cache->misses() ), 3 );
+  }
+
   return true;
 }
 
+bool QgsVectorLayerRenderer::skipPreviewFeature( long featureIndex ) const
+{
+  return mPreview && featureIndex >= PREVIEW_FULL_FEATURE_COUNT && featureIndex % PREVIEW_SAMPLE_STRIDE != 0;
+}
+
+qint64 QgsVectorLayerRenderer::TraceStatistics::lap( QgsRenderTrace *trace )
+{
+  qint64 now = trace->elapsed();
+  qint64 duration = now - mark;
+  mark = now;
+  return duration;
+}
+
+QVariantMap QgsVectorLayerRenderer::TraceStatistics::toArguments() const
+{
+  QVariantMap arguments;
+  arguments.insert( QStringLiteral( "fetch_us" ), fetchTime );
+  arguments.insert( QStringLiteral( "symbols_us" ), symbolTime );
+  arguments.insert( QStringLiteral( "labeling_us" ), labelingTime );
+  arguments.insert( QStringLiteral( "features" ), features );
+  arguments.insert( QStringLiteral( "vertices" ), vertices );
+  arguments.insert( QStringLiteral( "labels" ), labels );
+  return arguments;
+}
+
 void QgsVectorLayerRenderer::setGeometryCachePointer( QgsGeometryCache *cache )
 {
   mCache = cache;
@@ -283,9 +366,17 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
   QgsExpressionContextScope *symbolScope = QgsExpressionContextUtils::updateSymbolScope( nullptr, new QgsExpressionContextScope() );
   mContext.expressionContext().appendScope( symbolScope );
 
+  QgsRenderTrace *trace = mContext.renderTrace();
+  if ( trace )
+    mTraceStatistics.lap( trace );
+
   QgsFeature fet;
+  long featureIndex = 0;
   while ( fit.nextFeature( fet ) )
   {
+    if ( trace )
+      mTraceStatistics.fetchTime += mTraceStatistics.lap( trace );
+
     try
     {
       if ( mContext.renderingStopped() )
@@ -297,6 +388,9 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
       if ( !fet.hasGeometry() )
         continue; // skip features without geometry
 
+      if ( skipPreviewFeature( featureIndex++ ) )
+        continue;
+
       mContext.expressionContext().setFeature( fet );
 
       bool sel = mContext.showSelection() && mSelectedFeatureIds.contains( fet.id() );
@@ -311,6 +405,17 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
       // render feature
       bool rendered = mRenderer->renderFeature( fet, mContext, -1, sel, drawMarker );
 
+      if ( trace )
+      {
+        mTraceStatistics.symbolTime += mTraceStatistics.lap( trace );
+        if ( rendered )
+        {
+          mTraceStatistics.features++;
+          if ( fet.hasGeometry() )
+            mTraceStatistics.vertices += fet.geometry().geometry()->nCoordinates();
+        }
+      }
+
       // labeling - register feature
       if ( rendered )
       {
@@ -338,6 +443,12 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
           {
             mDiagramProvider->registerFeature( fet, mContext, obstacleGeometry.get() );
           }
+
+          if ( trace )
+          {
+            mTraceStatistics.labelingTime += mTraceStatistics.lap( trace );
+            mTraceStatistics.labels++;
+          }
         }
       }
     }
@@ -356,7 +467,8 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureIterator &fit )
 
 void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
 {
-  QHash< QgsSymbol *, QList<QgsFeature> > features; // key = symbol, value = array of features
+  QHash< QgsSymbol *, QVector<QgsFeature> > features; // key = symbol, value = array of features
+  int featureCount = 0;
 
   QgsSingleSymbolRenderer *selRenderer = nullptr;
   if ( !mSelectedFeatureIds.isEmpty() )
@@ -370,10 +482,18 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
   QgsExpressionContextScope *symbolScope = QgsExpressionContextUtils::updateSymbolScope( nullptr, new QgsExpressionContextScope() );
   mContext.expressionContext().appendScope( symbolScope );
 
+  QgsRenderTrace *trace = mContext.renderTrace();
+  if ( trace )
+    mTraceStatistics.lap( trace );
+
   // 1. fetch features
   QgsFeature fet;
+  long featureIndex = 0;
   while ( fit.nextFeature( fet ) )
   {
+    if ( trace )
+      mTraceStatistics.fetchTime += mTraceStatistics.lap( trace );
+
     if ( mContext.renderingStopped() )
     {
       qDebug( "rendering stop!" );
@@ -385,6 +505,9 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
     if ( !fet.hasGeometry() )
       continue; // skip features without geometry
 
+    if ( skipPreviewFeature( featureIndex++ ) )
+      continue;
+
     mContext.expressionContext().setFeature( fet );
     QgsSymbol *sym = mRenderer->symbolForFeature( fet, mContext );
     if ( !sym )
@@ -392,11 +515,15 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
       continue;
     }
 
-    if ( !features.contains( sym ) )
+    features[sym].append( fet );
+    featureCount++;
+
+    if ( trace )
     {
-      features.insert( sym, QList<QgsFeature>() );
+      mTraceStatistics.features++;
+      if ( fet.hasGeometry() )
+        mTraceStatistics.vertices += fet.geometry().geometry()->nCoordinates();
     }
-    features[sym].append( fet );
 
     if ( mCache )
     {
@@ -428,6 +555,12 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
       {
         mDiagramProvider->registerFeature( fet, mContext, obstacleGeometry.get() );
       }
+
+      if ( trace )
+      {
+        mTraceStatistics.labelingTime += mTraceStatistics.lap( trace );
+        mTraceStatistics.labels++;
+      }
     }
   }
 
@@ -452,49 +585,189 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureIterator &fit )
   }
 
   // 2. draw features in correct order
-  for ( int l = 0; l < levels.count(); l++ )
+  QgsRenderTraceSpan levelsSpan( trace, QStringLiteral( "Draw symbol levels" ), QStringLiteral( "vector" ) );
+  levelsSpan.setArgument( QStringLiteral( "levels" ), levels.count() );
+  levelsSpan.setArgument( QStringLiteral( "features" ), featureCount );
+  if ( trace )
+    mTraceStatistics.lap( trace );
+  if ( canDrawLevelsInParallel( levels, featureCount ) )
   {
-    QgsSymbolLevel &level = levels[l];
-    for ( int i = 0; i < level.count(); i++ )
+    levelsSpan.setArgument( QStringLiteral( "parallel" ), true );
+    drawLevelsInParallel( levels, features );
+  }
+  else
+    drawLevels( mRenderer, mContext, levels, 0, levels.count(), features );
+  if ( trace )
+    mTraceStatistics.symbolTime += mTraceStatistics.lap( trace );
+  levelsSpan.end();
+
+  stopRenderer( selRenderer );
+}
+
+bool QgsVectorLayerRenderer::drawLevels( QgsFeatureRenderer *renderer, QgsRenderContext &context, const QgsSymbolLevelOrder &levels,
+    int firstLevel, int lastLevel, const QHash< QgsSymbol *, QVector<QgsFeature> > &features )
+{
+  for ( int l = firstLevel; l < lastLevel; l++ )
+  {
+    Q_FOREACH ( QgsSymbolLevelItem item, levels.at( l ) )
     {
-      QgsSymbolLevelItem &item = level[i];
-      if ( !features.contains( item.symbol() ) )
+      QHash< QgsSymbol *, QVector<QgsFeature> >::const_iterator symbolIt = features.constFind( item.symbol() );
+      if ( symbolIt == features.constEnd() )
       {
         QgsDebugMsg( "level item's symbol not found!" );
         continue;
       }
       int layer = item.layer();
-      QList<QgsFeature> &lst = features[item.symbol()];
-      QList<QgsFeature>::iterator fit;
-      for ( fit = lst.begin(); fit != lst.end(); ++fit )
+      const QVector<QgsFeature> &lst = symbolIt.value();
+      for ( QVector<QgsFeature>::const_iterator fit = lst.constBegin(); fit != lst.constEnd(); ++fit )
       {
+        // cancelation is always requested on the layer's own context
         if ( mContext.renderingStopped() )
-        {
-          stopRenderer( selRenderer );
-          return;
-        }
+          return false;
 
         bool sel = mSelectedFeatureIds.contains( fit->id() );
         // maybe vertex markers should be drawn only during the last pass...
-        bool drawMarker = ( mDrawVertexMarkers && mContext.drawEditingInformation() && ( !mVertexMarkerOnlyForSelection || sel ) );
+        bool drawMarker = ( mDrawVertexMarkers && context.drawEditingInformation() && ( !mVertexMarkerOnlyForSelection || sel ) );
 
-        mContext.expressionContext().setFeature( *fit );
+        QgsFeature feature = *fit;
+        context.expressionContext().setFeature( feature );
 
         try
         {
-          mRenderer->renderFeature( *fit, mContext, layer, sel, drawMarker );
+          renderer->renderFeature( feature, context, layer, sel, drawMarker );
         }
         catch ( const QgsCsException &cse )
         {
           Q_UNUSED( cse );
           QgsDebugMsg( QString( "Failed to transform a point while drawing a feature with ID '%1'. Ignoring this feature. %2" )
-                       .arg( fet.id() ).arg( cse.what() ) );
+                       .arg( feature.id() ).arg( cse.what() ) );
         }
       }
     }
   }
+  return true;
+}
 
-  stopRenderer( selRenderer );
+bool QgsVectorLayerRenderer::canDrawLevelsInParallel( const QgsSymbolLevelOrder &levels, int featureCount ) const
+{
+  if ( levels.count() < 2 || featureCount < PARALLEL_LEVELS_MIN_FEATURES || QThread::idealThreadCount() < 2 )
+    return false;
+
+  if ( mContext.testFlag( QgsRenderContext::ForceVectorOutput ) )
+    return false;
+
+  // ranges of levels are drawn into separate images which are then drawn over the destination.
+  // This only gives the same result as drawing directly when the destination is a plain image
+  // which is painted without any transformation, blending or opacity
+  QPainter *painter = mContext.painter();
+  if ( !painter || !painter->device() || painter->device()->devType() != QInternal::Image )
+    return false;
+
+  return painter->combinedTransform().isIdentity()
+         && painter->compositionMode() == QPainter::CompositionMode_SourceOver
+         && qgsDoubleNear( painter->opacity(), 1.0 )
+         && parallelLevelRanges( levels, *static_cast< const QImage * >( painter->device() ) ) >= 2;
+}
+
+int QgsVectorLayerRenderer::parallelLevelRanges( const QgsSymbolLevelOrder &levels, const QImage &target ) const
+{
+  qint64 imageBytes = static_cast< qint64 >( target.width() ) * target.height() * 4;
+  qint64 imageCount = imageBytes > 0 ? mParallelLevelsMemory / imageBytes : 0;
+  return static_cast< int >( qMin( imageCount, static_cast< qint64 >( qMin( QThread::idealThreadCount(), levels.count() ) ) ) );
+}
+
+namespace
+{
+  //! A contiguous range of symbol levels, drawn with its own renderer and context into a separate image
+  struct SymbolLevelRange
+  {
+    int firstLevel = 0;
+    int lastLevel = 0;
+    std::unique_ptr< QgsFeatureRenderer > renderer;
+    std::unique_ptr< QgsRenderContext > context;
+    QImage image;
+    bool completed = false;
+  };
+}
+
+void QgsVectorLayerRenderer::drawLevelsInParallel( const QgsSymbolLevelOrder &levels, const QHash< QgsSymbol *, QVector<QgsFeature> > &features )
+{
+  // estimate the cost of each level by the number of features it draws, so that
+  // ranges of levels get a similar amount of work
+  QVector< qint64 > levelCosts( levels.count(), 0 );
+  qint64 totalCost = 0;
+  for ( int l = 0; l < levels.count(); l++ )
+  {
+    Q_FOREACH ( QgsSymbolLevelItem item, levels.at( l ) )
+    {
+      levelCosts[l] += features.value( item.symbol() ).count();
+    }
+    totalCost += levelCosts.at( l );
+  }
+
+  QPainter *painter = mContext.painter();
+  const QImage *target = static_cast< const QImage * >( painter->device() );
+  QPainter::RenderHints hints = painter->renderHints();
+  bool hasClip = painter->hasClipping();
+  QRegion clip = hasClip ? painter->clipRegion() : QRegion();
+
+  int rangeCount = parallelLevelRanges( levels, *target );
+  std::vector< SymbolLevelRange > ranges;
+  ranges.reserve( rangeCount );
+  int firstLevel = 0;
+  qint64 accumulatedCost = 0;
+  for ( int r = 0; r < rangeCount; r++ )
+  {
+    // every range takes at least one level, and the last one takes all remaining levels
+    int maxLastLevel = levels.count() - ( rangeCount - r - 1 );
+    qint64 targetCost = totalCost * ( r + 1 ) / rangeCount;
+    int lastLevel = firstLevel;
+    accumulatedCost += levelCosts.at( lastLevel++ );
+    while ( lastLevel < maxLastLevel && ( r == rangeCount - 1 || accumulatedCost < targetCost ) )
+      accumulatedCost += levelCosts.at( lastLevel++ );
+
+    SymbolLevelRange range;
+    range.firstLevel = firstLevel;
+    range.lastLevel = lastLevel;
+    range.renderer.reset( mRenderer->clone() );
+    if ( mDrawVertexMarkers )
+      range.renderer->setVertexMarkerAppearance( mVertexMarkerStyle, mVertexMarkerSize );
+    range.context.reset( new QgsRenderContext( mContext ) );
+    range.image = QImage( target->size(), QImage::Format_ARGB32_Premultiplied );
+    range.image.setDotsPerMeterX( target->dotsPerMeterX() );
+    range.image.setDotsPerMeterY( target->dotsPerMeterY() );
+    range.image.setDevicePixelRatio( target->devicePixelRatio() );
+    range.image.fill( 0 );
+    ranges.push_back( std::move( range ) );
+
+    firstLevel = lastLevel;
+  }
+
+  QtConcurrent::blockingMap( ranges, [this, &levels, &features, hints, hasClip, &clip]( SymbolLevelRange & range )
+  {
+    QPainter p( &range.image );
+    p.setRenderHints( hints );
+    if ( hasClip )
+      p.setClipRegion( clip );
+    range.context->setPainter( &p );
+
+    range.renderer->startRender( *range.context, mFields );
+    range.completed = drawLevels( range.renderer.get(), *range.context, levels, range.firstLevel, range.lastLevel, features );
+    range.renderer->stopRender( *range.context );
+    range.context->setPainter( nullptr );
+  } );
+
+  if ( mContext.renderingStopped() )
+    return;
+
+  // "source over" composition is associative, so drawing the ranges in level order
+  // gives the same result as drawing all levels in sequence
+  for ( const SymbolLevelRange &range : ranges )
+  {
+    if ( !range.completed )
+      return;
+    painter->drawImage( QPointF( 0, 0 ), range.image );
+  }
 }
 
 
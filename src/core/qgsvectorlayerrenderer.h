@@ -27,6 +27,8 @@ class QgsDiagramLayerSettings;
 class QgsGeometryCache;
 class QgsFeatureIterator;
 class QgsSingleSymbolRenderer;
+class QgsRenderTrace;
+class QImage;
 
 #include <QList>
 #include <QPainter>
@@ -38,6 +40,7 @@ typedef QList<int> QgsAttributeList;
 #include "qgsfeature.h"  // QgsFeatureIds
 #include "qgsfeatureiterator.h"
 #include "qgsvectorsimplifymethod.h"
+#include "qgsrenderer.h"
 
 #include "qgsmaplayerrenderer.h"
 
@@ -93,6 +96,27 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
      */
     void drawRendererLevels( QgsFeatureIterator &fit );
 
+    /** Draws the features collected for the symbol levels from \a firstLevel up to (but excluding)
+     * \a lastLevel using the given \a renderer and \a context. The renderer must be started.
+     * Returns false if rendering was canceled.
+     */
+    bool drawLevels( QgsFeatureRenderer *renderer, QgsRenderContext &context, const QgsSymbolLevelOrder &levels,
+                     int firstLevel, int lastLevel, const QHash< QgsSymbol *, QVector< QgsFeature > > &features );
+
+    //! Returns true if symbol levels with a total of \a featureCount features can be drawn in parallel
+    bool canDrawLevelsInParallel( const QgsSymbolLevelOrder &levels, int featureCount ) const;
+
+    /**
+     * Returns the number of ranges of symbol levels to draw concurrently into images of the size of \a target,
+     * bounded by the number of threads, the number of levels and the memory available for the images.
+     */
+    int parallelLevelRanges( const QgsSymbolLevelOrder &levels, const QImage &target ) const;
+
+    /** Draws ranges of symbol levels concurrently, each with its own copy of the renderer into a
+     * separate image. The images are then composited in level order.
+     */
+    void drawLevelsInParallel( const QgsSymbolLevelOrder &levels, const QHash< QgsSymbol *, QVector< QgsFeature > > &features );
+
     //! Stop version 2 renderer and selected renderer (if required)
     void stopRenderer( QgsSingleSymbolRenderer *selRenderer );
 
@@ -120,6 +144,9 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
     bool mVertexMarkerOnlyForSelection;
     int mVertexMarkerStyle, mVertexMarkerSize;
 
+    //! Memory (in bytes) available for the images of symbol levels drawn concurrently
+    qint64 mParallelLevelsMemory = 0;
+
     QgsWkbTypes::GeometryType mGeometryType;
 
     QSet<QString> mAttrNames;
@@ -140,6 +167,40 @@ class QgsVectorLayerRenderer : public QgsMapLayerRenderer
 
     QgsVectorSimplifyMethod mSimplifyMethod;
     bool mSimplifyGeometry;
+
+    //! True if rendering a quick preview, drawing only a sample of the features
+    bool mPreview = false;
+
+    //! Returns true if the feature with given index in the iteration should be skipped while rendering a preview
+    bool skipPreviewFeature( long featureIndex ) const;
+
+    //! Timings and counts collected while drawing features, only when the render context has a trace
+    struct TraceStatistics
+    {
+      //! Time spent fetching features from the iterator (includes transform and simplification), in microseconds
+      qint64 fetchTime = 0;
+      //! Time spent rendering symbols, in microseconds
+      qint64 symbolTime = 0;
+      //! Time spent registering features with the labeling engine, in microseconds
+      qint64 labelingTime = 0;
+      //! Number of rendered features
+      int features = 0;
+      //! Number of vertices of rendered features
+      qint64 vertices = 0;
+      //! Number of features registered for labeling
+      int labels = 0;
+
+      //! Time of the previous call to lap()
+      qint64 mark = 0;
+
+      //! Returns the time since the previous lap of the \a trace and starts a new lap
+      qint64 lap( QgsRenderTrace *trace );
+
+      //! Converts the statistics to arguments of a trace span
+      QVariantMap toArguments() const;
+    };
+
+    TraceStatistics mTraceStatistics;
 };
 
 
@@ -24,6 +24,37 @@
 
 #include "qgslogger.h"
 
+///@cond PRIVATE
+
+// Returns the extent affected by replacing a geometry with bounding box oldExtent by newGeometry,
+// or a null rectangle if the old extent is unknown
+static QgsRectangle changedExtent( const QgsRectangle &oldExtent, const QgsGeometry &newGeometry )
+{
+  if ( oldExtent.isNull() )
+    return QgsRectangle();
+
+  QgsRectangle extent = oldExtent;
+  if ( !newGeometry.isNull() )
+    extent.combineExtentWith( newGeometry.boundingBox() );
+  return extent;
+}
+
+///@endcond
+
+QgsRectangle QgsVectorLayerUndoCommand::featureBoundingBox( QgsFeatureId fid )
+{
+  QgsGeometry geom;
+  if ( FID_IS_NEW( fid ) )
+  {
+    geom = mBuffer->mAddedFeatures.value( fid ).geometry();
+  }
+  else if ( !cache()->geometry( fid, geom ) )
+  {
+    return QgsRectangle();
+  }
+
+  return geom.isNull() ? QgsRectangle() : geom.boundingBox();
+}
 
 QgsVectorLayerUndoCommandAddFeature::QgsVectorLayerUndoCommandAddFeature( QgsVectorLayerEditBuffer *buffer, QgsFeature &f )
   : QgsVectorLayerUndoCommand( buffer )
@@ -52,7 +83,10 @@ void QgsVectorLayerUndoCommandAddFeature::undo()
   mBuffer->mAddedFeatures.remove( mFeature.id() );
 
   if ( mFeature.hasGeometry() )
+  {
     cache()->removeGeometry( mFeature.id() );
+    emit mBuffer->featureExtentChanged( mFeature.geometry().boundingBox() );
+  }
 
   emit mBuffer->featureDeleted( mFeature.id() );
 }
@@ -62,7 +96,10 @@ void QgsVectorLayerUndoCommandAddFeature::redo()
   mBuffer->mAddedFeatures.insert( mFeature.id(), mFeature );
 
   if ( mFeature.hasGeometry() )
+  {
     cache()->cacheGeometry( mFeature.id(), mFeature.geometry() );
+    emit mBuffer->featureExtentChanged( mFeature.geometry().boundingBox() );
+  }
 
   emit mBuffer->featureAdded( mFeature.id() );
 }
@@ -80,6 +117,8 @@ QgsVectorLayerUndoCommandDeleteFeature::QgsVectorLayerUndoCommandDeleteFeature(
     Q_ASSERT( it != mBuffer->mAddedFeatures.constEnd() );
     mOldAddedFeature = it.value();
   }
+
+  mOldExtent = featureBoundingBox( mFid );
 }
 
 void QgsVectorLayerUndoCommandDeleteFeature::undo()
@@ -93,6 +132,7 @@ void QgsVectorLayerUndoCommandDeleteFeature::undo()
     mBuffer->mDeletedFeatureIds.remove( mFid );
   }
 
+  emit mBuffer->featureExtentChanged( mOldExtent );
   emit mBuffer->featureAdded( mFid );
 }
 
@@ -107,6 +147,7 @@ void QgsVectorLayerUndoCommandDeleteFeature::redo()
     mBuffer->mDeletedFeatureIds.insert( mFid );
   }
 
+  emit mBuffer->featureExtentChanged( mOldExtent );
   emit mBuffer->featureDeleted( mFid );
 }
 
@@ -130,6 +171,8 @@ QgsVectorLayerUndoCommandChangeGeometry::QgsVectorLayerUndoCommandChangeGeometry
     bool cachedGeom = cache()->geometry( mFid, geom );
     mOldGeom = ( changedAlready && cachedGeom ) ? geom : QgsGeometry();
   }
+
+  mOldExtent = featureBoundingBox( mFid );
 }
 
 int QgsVectorLayerUndoCommandChangeGeometry::id() const
@@ -165,6 +208,7 @@ void QgsVectorLayerUndoCommandChangeGeometry::undo()
     it.value().setGeometry( mOldGeom );
 
     cache()->cacheGeometry( mFid, mOldGeom );
+    emit mBuffer->featureExtentChanged( changedExtent( mOldExtent, mNewGeom ) );
     emit mBuffer->geometryChanged( mFid, mOldGeom );
   }
   else
@@ -179,6 +223,7 @@ void QgsVectorLayerUndoCommandChangeGeometry::undo()
       if ( layer()->getFeatures( QgsFeatureRequest().setFilterFid( mFid ).setSubsetOfAttributes( QgsAttributeList() ) ).nextFeature( f ) && f.hasGeometry() )
       {
         cache()->cacheGeometry( mFid, f.geometry() );
+        emit mBuffer->featureExtentChanged( changedExtent( f.geometry().boundingBox(), mNewGeom ) );
         emit mBuffer->geometryChanged( mFid, f.geometry() );
       }
     }
@@ -186,6 +231,7 @@ void QgsVectorLayerUndoCommandChangeGeometry::undo()
     {
       mBuffer->mChangedGeometries[mFid] = mOldGeom;
       cache()->cacheGeometry( mFid, mOldGeom );
+      emit mBuffer->featureExtentChanged( changedExtent( mOldExtent, mNewGeom ) );
       emit mBuffer->geometryChanged( mFid, mOldGeom );
     }
   }
@@ -206,6 +252,7 @@ void QgsVectorLayerUndoCommandChangeGeometry::redo()
     mBuffer->mChangedGeometries[ mFid ] = mNewGeom;
   }
   cache()->cacheGeometry( mFid, mNewGeom );
+  emit mBuffer->featureExtentChanged( changedExtent( mOldExtent, mNewGeom ) );
   emit mBuffer->geometryChanged( mFid, mNewGeom );
 }
 
@@ -273,6 +320,7 @@ void QgsVectorLayerUndoCommandChangeAttribute::undo()
     mBuffer->mChangedAttributeValues[mFid][mFieldIndex] = mOldValue;
   }
 
+  emit mBuffer->featureExtentChanged( featureBoundingBox( mFid ) );
   emit mBuffer->attributeValueChanged( mFid, mFieldIndex, original );
 }
 
@@ -296,6 +344,7 @@ void QgsVectorLayerUndoCommandChangeAttribute::redo()
     mBuffer->mChangedAttributeValues[mFid].insert( mFieldIndex, mNewValue );
   }
 
+  emit mBuffer->featureExtentChanged( featureBoundingBox( mFid ) );
   emit mBuffer->attributeValueChanged( mFid, mFieldIndex, mNewValue );
 }
 
@@ -319,6 +368,7 @@ void QgsVectorLayerUndoCommandAddAttribute::undo()
   mBuffer->handleAttributeDeleted( mFieldIndex );
   mBuffer->updateLayerFields();
 
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeDeleted( mFieldIndex );
 }
 
@@ -328,6 +378,7 @@ void QgsVectorLayerUndoCommandAddAttribute::redo()
   mBuffer->updateLayerFields();
   mBuffer->handleAttributeAdded( mFieldIndex );
 
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeAdded( mFieldIndex );
 }
 
@@ -409,6 +460,7 @@ void QgsVectorLayerUndoCommandDeleteAttribute::undo()
   QgsEditFormConfig formConfig = mBuffer->L->editFormConfig();
   mBuffer->L->setEditFormConfig( formConfig );
 
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeAdded( mFieldIndex );
 }
 
@@ -427,6 +479,7 @@ void QgsVectorLayerUndoCommandDeleteAttribute::redo()
 
   mBuffer->handleAttributeDeleted( mFieldIndex ); // update changed attributes + new features
   mBuffer->updateLayerFields();
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeDeleted( mFieldIndex );
 }
 
@@ -443,6 +496,7 @@ void QgsVectorLayerUndoCommandRenameAttribute::undo()
 {
   mBuffer->mRenamedAttributes[ mFieldIndex ] = mOldName;
   mBuffer->updateLayerFields();
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeRenamed( mFieldIndex, mOldName );
 }
 
@@ -450,5 +504,6 @@ void QgsVectorLayerUndoCommandRenameAttribute::redo()
 {
   mBuffer->mRenamedAttributes[ mFieldIndex ] = mNewName;
   mBuffer->updateLayerFields();
+  emit mBuffer->featureExtentChanged( QgsRectangle() );
   emit mBuffer->attributeRenamed( mFieldIndex, mNewName );
 }
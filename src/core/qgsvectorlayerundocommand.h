@@ -59,6 +59,13 @@ class CORE_EXPORT QgsVectorLayerUndoCommand : public QUndoCommand
   protected:
     //! Associated edit buffer
     QgsVectorLayerEditBuffer *mBuffer = nullptr;
+
+    /** Returns the bounding box of the current geometry of a feature, taken from the
+     * added features or the layer's geometry cache. A null rectangle is returned if the
+     * geometry is not readily available.
+     * @note added in QGIS 3.0
+     */
+    QgsRectangle featureBoundingBox( QgsFeatureId fid );
 };
 
 
@@ -106,6 +113,7 @@ class CORE_EXPORT QgsVectorLayerUndoCommandDeleteFeature : public QgsVectorLayer
   private:
     QgsFeatureId mFid;
     QgsFeature mOldAddedFeature;
+    QgsRectangle mOldExtent;
 };
 
 /** \ingroup core
@@ -133,6 +141,7 @@ class CORE_EXPORT QgsVectorLayerUndoCommandChangeGeometry : public QgsVectorLaye
     QgsFeatureId mFid;
     QgsGeometry mOldGeom;
     mutable QgsGeometry mNewGeom;
+    QgsRectangle mOldExtent;
 };
 
 
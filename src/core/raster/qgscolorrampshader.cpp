@@ -26,10 +26,47 @@ originally part of the larger QgsRasterLayer class
 #include "qgis.h"
 #include "qgscolorramp.h"
 #include "qgscolorrampshader.h"
+#include "qgsrasterblock.h"
 #include "qgsrasterinterface.h"
 #include "qgsrasterminmaxorigin.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+namespace
+{
+  // premultiplies a color the same way as the pseudocolor renderer
+  QRgb premultipliedColor( int red, int green, int blue, int alpha )
+  {
+    if ( alpha < 255 )
+    {
+      red *= ( alpha / 255.0 );
+      green *= ( alpha / 255.0 );
+      blue *= ( alpha / 255.0 );
+    }
+    return qRgba( red, green, blue, alpha );
+  }
+
+  // returns true if values of a data type are looked up directly, without bins
+  bool hasIntegerLookup( Qgis::DataType dataType )
+  {
+    return dataType == Qgis::Byte || dataType == Qgis::UInt16 || dataType == Qgis::Int16;
+  }
+}
+
+struct QgsColorRampShader::ColorLookupTables
+{
+  //! Must be locked while the tables are accessed
+  QMutex mutex;
+  //! Tables of the integer data types by data type, the binned table of all other types as Qgis::UnknownDataType
+  QHash< int, std::shared_ptr< const ColorLookupTable > > tables;
+};
+
 QgsColorRampShader::QgsColorRampShader( double minimumValue, double maximumValue, QgsColorRamp *colorRamp, Type type, ClassificationMode classificationMode )
   : QgsRasterShaderFunction( minimumValue, maximumValue )
   , mColorRampType( type )
@@ -38,6 +75,7 @@ QgsColorRampShader::QgsColorRampShader( double minimumValue, double maximumValue
   , mLUTFactor( 1.0 )
   , mLUTInitialized( false )
   , mClip( false )
+  , mColorLookupTables( std::make_shared< ColorLookupTables >() )
 {
   QgsDebugMsgLevel( "called.", 4 );
 
@@ -53,13 +91,15 @@ QgsColorRampShader::QgsColorRampShader( const QgsColorRampShader &other )
   , mLUTFactor( other.mLUTFactor )
   , mLUTInitialized( other.mLUTInitialized )
   , mClip( other.mClip )
+  , mColorLookupTables( other.mColorLookupTables )
 {
-  mSourceColorRamp.reset( other.sourceColorRamp()->clone() );
+  if ( other.sourceColorRamp() )
+    mSourceColorRamp.reset( other.sourceColorRamp()->clone() );
 }
 
 QgsColorRampShader &QgsColorRampShader::operator=( const QgsColorRampShader &other )
 {
-  mSourceColorRamp.reset( other.sourceColorRamp()->clone() );
+  mSourceColorRamp.reset( other.sourceColorRamp() ? other.sourceColorRamp()->clone() : nullptr );
   mColorRampType = other.mColorRampType;
   mClassificationMode = other.mClassificationMode;
   mLUT = other.mLUT;
@@ -67,6 +107,7 @@ QgsColorRampShader &QgsColorRampShader::operator=( const QgsColorRampShader &oth
   mLUTFactor = other.mLUTFactor;
   mLUTInitialized = other.mLUTInitialized;
   mClip = other.mClip;
+  mColorLookupTables = other.mColorLookupTables;
   return *this;
 }
 
@@ -90,11 +131,13 @@ void QgsColorRampShader::setColorRampItemList( const QList<QgsColorRampShader::C
   // Reset the look up table when the color ramp is changed
   mLUTInitialized = false;
   mLUT.clear();
+  resetColorLookupTables();
 }
 
 void QgsColorRampShader::setColorRampType( QgsColorRampShader::Type colorRampType )
 {
   mColorRampType = colorRampType;
+  resetColorLookupTables();
 }
 
 void QgsColorRampShader::setColorRampType( const QString &type )
@@ -111,6 +154,25 @@ void QgsColorRampShader::setColorRampType( const QString &type )
   {
     mColorRampType = Exact;
   }
+  resetColorLookupTables();
+}
+
+void QgsColorRampShader::setClassificationMode( QgsColorRampShader::ClassificationMode classificationMode )
+{
+  mClassificationMode = classificationMode;
+  resetColorLookupTables();
+}
+
+void QgsColorRampShader::resetColorLookupTables()
+{
+  // copies of the shader keep the tables of their own color ramp
+  mColorLookupTables = std::make_shared< ColorLookupTables >();
+}
+
+void QgsColorRampShader::setClip( bool clip )
+{
+  mClip = clip;
+  resetColorLookupTables();
 }
 
 QgsColorRamp *QgsColorRampShader::sourceColorRamp() const
@@ -450,6 +512,168 @@ bool QgsColorRampShader::shade( double value, int *returnRedValue, int *returnGr
   }
 }
 
+void QgsColorRampShader::shadeValues( const float *values, QRgb *colors, qgssize count, Qgis::DataType dataType, QRgb defaultColor )
+{
+  const std::shared_ptr< const ColorLookupTable > lookupTable = colorLookupTable( dataType );
+  const ColorLookupTable &table = *lookupTable;
+  const int binCount = table.bins.count();
+  const int *bins = table.bins.constData();
+
+  QVector<int> indexes( static_cast< int >( count ) );
+  int *index = indexes.data();
+  for ( qgssize i = 0; i < count; ++i )
+  {
+    const float value = values[i];
+    if ( qIsNaN( value ) )
+      index[i] = -1;
+    else if ( value < table.lower )
+      index[i] = table.below;
+    else if ( value > table.upper )
+      index[i] = table.above;
+    else if ( binCount == 0 )
+      index[i] = -2;
+    else
+      index[i] = bins[ std::min( static_cast< int >( ( value - table.lower ) * table.factor ), binCount - 1 )];
+  }
+
+  QgsRasterBlock::lookupColors( index, colors, count, table.colors.constData(), table.colors.count(), defaultColor );
+
+  // values in bins which are not uniform are shaded exactly
+  for ( qgssize i = 0; i < count; ++i )
+  {
+    if ( index[i] != -2 )
+      continue;
+
+    int red, green, blue, alpha;
+    if ( shade( values[i], &red, &green, &blue, &alpha ) )
+      colors[i] = premultipliedColor( red, green, blue, alpha );
+  }
+}
+
+std::shared_ptr< const QgsColorRampShader::ColorLookupTable > QgsColorRampShader::colorLookupTable( Qgis::DataType dataType )
+{
+  // integer values have a table per data type, all other values share the binned table
+  const int key = hasIntegerLookup( dataType ) ? dataType : Qgis::UnknownDataType;
+  std::shared_ptr< ColorLookupTables > tables = mColorLookupTables;
+  QMutexLocker locker( &tables->mutex );
+  std::shared_ptr< const ColorLookupTable > &table = tables->tables[key];
+  if ( !table )
+    table = buildColorLookupTable( dataType );
+  return table;
+}
+
+std::shared_ptr< const QgsColorRampShader::ColorLookupTable > QgsColorRampShader::buildColorLookupTable( Qgis::DataType dataType )
+{
+  std::shared_ptr< ColorLookupTable > result = std::make_shared< ColorLookupTable >();
+  ColorLookupTable &table = *result;
+  if ( mColorRampItemList.isEmpty() )
+  {
+    // nothing can be shaded
+    table.lower = std::numeric_limits<double>::max();
+    table.upper = -std::numeric_limits<double>::max();
+    return result;
+  }
+
+  if ( hasIntegerLookup( dataType ) )
+  {
+    // one entry for each possible value, all of them exact
+    table.lower = dataType == Qgis::Int16 ? std::numeric_limits<qint16>::min() : 0;
+    table.upper = dataType == Qgis::Byte ? std::numeric_limits<quint8>::max()
+                  : dataType == Qgis::Int16 ? std::numeric_limits<qint16>::max() : std::numeric_limits<quint16>::max();
+    table.factor = 1.0;
+    const int binCount = static_cast< int >( table.upper - table.lower ) + 1;
+    table.bins.resize( binCount );
+    for ( int i = 0; i < binCount; ++i )
+    {
+      table.bins[i] = lookupColorIndex( table, table.lower + i );
+    }
+    return result;
+  }
+
+  // discrete ramps often end with an infinite class break, bins only cover the finite ones
+  table.lower = std::numeric_limits<double>::max();
+  table.upper = -std::numeric_limits<double>::max();
+  Q_FOREACH ( const ColorRampItem &item, mColorRampItemList )
+  {
+    if ( qIsFinite( item.value ) )
+    {
+      table.lower = std::min( table.lower, item.value );
+      table.upper = std::max( table.upper, item.value );
+    }
+  }
+  if ( table.lower > table.upper )
+  {
+    // only infinite class breaks, all values are shaded exactly
+    table.below = -2;
+    table.above = -2;
+    return result;
+  }
+  table.below = lookupColorIndex( table, std::nextafter( table.lower, -std::numeric_limits<double>::max() ) );
+  table.above = lookupColorIndex( table, std::nextafter( table.upper, std::numeric_limits<double>::max() ) );
+  if ( !( table.upper > table.lower ) )
+  {
+    // no bins, values between lower and upper are shaded exactly
+    return result;
+  }
+
+  const int binCount = 65536;
+  table.factor = binCount / ( table.upper - table.lower );
+  table.bins.resize( binCount );
+
+  int item = 0;
+  const int itemCount = mColorRampItemList.count();
+  for ( int i = 0; i < binCount; ++i )
+  {
+    const double start = table.lower + i / table.factor;
+    const double end = table.lower + ( i + 1 ) / table.factor;
+
+    // bins containing a class break are shaded exactly
+    while ( item < itemCount && mColorRampItemList.at( item ).value < start )
+      item++;
+    if ( item < itemCount && mColorRampItemList.at( item ).value <= end )
+    {
+      table.bins[i] = -2;
+      continue;
+    }
+
+    int startRed, startGreen, startBlue, startAlpha;
+    int endRed, endGreen, endBlue, endAlpha;
+    const bool startShaded = shade( start, &startRed, &startGreen, &startBlue, &startAlpha );
+    const bool endShaded = shade( end, &endRed, &endGreen, &endBlue, &endAlpha );
+    if ( !startShaded && !endShaded )
+    {
+      table.bins[i] = -1;
+    }
+    else if ( startShaded && endShaded
+              && std::abs( startRed - endRed ) <= 1 && std::abs( startGreen - endGreen ) <= 1
+              && std::abs( startBlue - endBlue ) <= 1 && std::abs( startAlpha - endAlpha ) <= 1 )
+    {
+      table.bins[i] = lookupColorIndex( table, ( start + end ) / 2.0 );
+    }
+    else
+    {
+      table.bins[i] = -2;
+    }
+  }
+
+  return result;
+}
+
+int QgsColorRampShader::lookupColorIndex( ColorLookupTable &table, double value )
+{
+  int red, green, blue, alpha;
+  if ( !shade( value, &red, &green, &blue, &alpha ) )
+    return -1;
+
+  const QRgb color = premultipliedColor( red, green, blue, alpha );
+  // consecutive bins mostly share colors
+  if ( !table.colors.isEmpty() && table.colors.last() == color )
+    return table.colors.count() - 1;
+
+  table.colors << color;
+  return table.colors.count() - 1;
+}
+
 bool QgsColorRampShader::shade( double redValue, double greenValue,
                                 double blueValue, double alphaValue,
                                 int *returnRedValue, int *returnGreenValue,
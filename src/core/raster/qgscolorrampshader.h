@@ -147,11 +147,24 @@ class CORE_EXPORT QgsColorRampShader : public QgsRasterShaderFunction
     //! \brief Generates and new RGB value based on original RGB value
     bool shade( double, double, double, double, int *, int *, int *, int * ) override;
 
+    /** Shades \a count \a values at once and writes the colors, with premultiplied alpha, to \a colors.
+     * Values which are NaN or cannot be shaded are given the \a defaultColor. The colors are looked
+     * up in a table, which is built on first use after the color ramp changed and is shared by
+     * copies of the shader, so that the clones of a renderer do not build it again. Values of
+     * Byte, UInt16 and Int16 rasters (as given by \a dataType) are looked up in a table holding the
+     * color of every possible value. Other values are looked up in 65536 bins between the lowest
+     * and the highest finite class break, with colors differing by at most one level from shade().
+     * Values in bins which contain a class break or a steeper color change are shaded exactly.
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    void shadeValues( const float *values, QRgb *colors, qgssize count, Qgis::DataType dataType, QRgb defaultColor );
+
     //! \brief Get symbology items if provided by renderer
     void legendSymbologyItems( QList< QPair< QString, QColor > > &symbolItems ) const override;
 
     //! Sets classification mode
-    void setClassificationMode( ClassificationMode classificationMode ) { mClassificationMode = classificationMode; }
+    void setClassificationMode( ClassificationMode classificationMode );
 
     //! Returns the classification mode
     ClassificationMode classificationMode() const { return mClassificationMode; }
@@ -160,7 +173,7 @@ class CORE_EXPORT QgsColorRampShader : public QgsRasterShaderFunction
      * @param clip set to true to clip values which are out of range.
      * @see clip()
      */
-    void setClip( bool clip ) { mClip = clip; }
+    void setClip( bool clip );
 
     /** Returns whether the shader will clip values which are out of range.
      * @see setClip()
@@ -193,6 +206,41 @@ class CORE_EXPORT QgsColorRampShader : public QgsRasterShaderFunction
 
     //! Do not render values out of range
     bool mClip;
+
+    //! Dense lookup table of colors used by shadeValues()
+    struct ColorLookupTable
+    {
+      //! Lowest value covered by the bins
+      double lower = 0.0;
+      //! Highest value covered by the bins
+      double upper = 0.0;
+      //! Number of bins per unit
+      double factor = 1.0;
+      //! Index into colors for each bin, -1 if values cannot be shaded, -2 if they need to be shaded exactly
+      QVector<int> bins;
+      //! Index into colors for values below the lowest value
+      int below = -1;
+      //! Index into colors for values above the highest value
+      int above = -1;
+      //! Premultiplied colors
+      QVector<QRgb> colors;
+    };
+    struct ColorLookupTables;
+
+    //! Lookup tables built for the current color ramp, shared with copies of the shader
+    std::shared_ptr< ColorLookupTables > mColorLookupTables;
+
+    //! Discards the lookup tables after the color ramp changed
+    void resetColorLookupTables();
+
+    //! Returns the lookup table of colors for values of a data type, building it if needed
+    std::shared_ptr< const ColorLookupTable > colorLookupTable( Qgis::DataType dataType );
+
+    //! Builds the lookup table of colors for values of a data type
+    std::shared_ptr< const ColorLookupTable > buildColorLookupTable( Qgis::DataType dataType );
+
+    //! Returns the index of the color of a value in the lookup \a table, adding it if needed, or -1 if the value cannot be shaded
+    int lookupColorIndex( ColorLookupTable &table, double value );
 };
 
 #endif
@@ -28,6 +28,7 @@ class originally created circa 2004 by T.Sutton, Gary E.Sherman, Steve Halasz
 #include "qgsrasterblock.h"
 #include <QDomDocument>
 #include <QDomElement>
+#include <algorithm>
 
 QgsContrastEnhancement::QgsContrastEnhancement( Qgis::DataType dataType )
   : mContrastEnhancementAlgorithm( NoEnhancement )
@@ -193,6 +194,65 @@ int QgsContrastEnhancement::enhanceContrast( double value )
   }
 }
 
+namespace
+{
+  // Linear mapping shared by the built-in enhancement functions: values outside of [lower, upper]
+  // (and NaN) are -1, others are mapped with ( value - offset ) / range * 255 and optionally clamped
+  void linearEnhance( const float *values, int *enhanced, qgssize count, double lower, double upper,
+                      double offset, double range, bool clamp )
+  {
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      const double value = values[i];
+      double stretched = ( ( value - offset ) / range ) * 255.0;
+      if ( clamp )
+        stretched = std::min( std::max( stretched, 0.0 ), 255.0 );
+      enhanced[i] = value >= lower && value <= upper ? static_cast< int >( stretched ) : -1;
+    }
+  }
+}
+
+void QgsContrastEnhancement::enhanceContrast( const float *values, int *enhanced, qgssize count )
+{
+  const double minimumPossible = minimumValuePossible( mRasterDataType );
+  const double maximumPossible = maximumValuePossible( mRasterDataType );
+
+  switch ( mContrastEnhancementAlgorithm )
+  {
+    case NoEnhancement:
+      if ( mRasterDataType == Qgis::Byte )
+        linearEnhance( values, enhanced, count, minimumPossible, maximumPossible, 0.0, 255.0, true );
+      else
+        linearEnhance( values, enhanced, count, minimumPossible, maximumPossible, minimumPossible, maximumPossible - minimumPossible, false );
+      return;
+
+    case StretchToMinimumMaximum:
+      linearEnhance( values, enhanced, count, minimumPossible, maximumPossible, mMinimumValue, mMaximumValue - mMinimumValue, true );
+      return;
+
+    case StretchAndClipToMinimumMaximum:
+      linearEnhance( values, enhanced, count, mMinimumValue, mMaximumValue, mMinimumValue, mMaximumValue - mMinimumValue, true );
+      return;
+
+    case ClipToMinimumMaximum:
+      if ( mRasterDataType == Qgis::Byte )
+        linearEnhance( values, enhanced, count, mMinimumValue, mMaximumValue, 0.0, 255.0, true );
+      else
+        linearEnhance( values, enhanced, count, mMinimumValue, mMaximumValue, minimumPossible, maximumPossible - minimumPossible, false );
+      return;
+
+    case UserDefinedEnhancement:
+      break;
+  }
+
+  // custom functions are applied value by value
+  for ( qgssize i = 0; i < count; ++i )
+  {
+    const double value = values[i];
+    enhanced[i] = !qIsNaN( value ) && isValueInDisplayableRange( value ) ? enhanceContrast( value ) : -1;
+  }
+}
+
 /**
     Generate a new lookup table
 */
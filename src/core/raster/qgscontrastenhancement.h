@@ -96,6 +96,15 @@ class CORE_EXPORT QgsContrastEnhancement
     //! \brief Apply the contrast enhancement to a value. Return values are 0 - 254, -1 means the pixel was clipped and should not be displayed
     int enhanceContrast( double );
 
+    /** Applies the contrast enhancement to \a count \a values and writes the enhanced values (0 - 255)
+     * to \a enhanced. Values which are NaN or not in the displayable range are written as -1.
+     * The built-in linear algorithms are applied in a single loop over the values, which compilers
+     * can vectorise, instead of one function call per value.
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    void enhanceContrast( const float *values, int *enhanced, qgssize count );
+
     //! \brief Return true if pixel is in stretable range, false if pixel is outside of range (i.e., clipped)
     bool isValueInDisplayableRange( double );
 
@@ -24,6 +24,15 @@
 #include <QImage>
 #include <QSet>
 
+namespace
+{
+  // Float64, Int32 and UInt32 values can not always be represented exactly as floats
+  bool convertsExactlyToFloat( Qgis::DataType dataType )
+  {
+    return dataType == Qgis::Byte || dataType == Qgis::UInt16 || dataType == Qgis::Int16 || dataType == Qgis::Float32;
+  }
+}
+
 QgsMultiBandColorRenderer::QgsMultiBandColorRenderer( QgsRasterInterface *input, int redBand, int greenBand, int blueBand,
     QgsContrastEnhancement *redEnhancement,
     QgsContrastEnhancement *greenEnhancement,
@@ -130,6 +139,48 @@ QgsRasterRenderer *QgsMultiBandColorRenderer::create( const QDomElement &elem, Q
   return r;
 }
 
+QVector<int> QgsMultiBandColorRenderer::enhancedBandValues( const QgsRasterBlock *block, QgsContrastEnhancement *enhancement, qgssize count )
+{
+  QVector<int> enhanced( static_cast< int >( count ) );
+  if ( block && !convertsExactlyToFloat( block->dataType() ) )
+  {
+    // Float64, Int32 and UInt32 values would lose precision as floats, so they are enhanced one by one
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      const double value = block->value( i );
+      if ( block->isNoData( i ) )
+      {
+        enhanced[i] = -1;
+      }
+      else if ( enhancement )
+      {
+        enhanced[i] = enhancement->isValueInDisplayableRange( value ) ? enhancement->enhanceContrast( value ) : -1;
+      }
+      else
+      {
+        enhanced[i] = static_cast< int >( value ) & 0xff;
+      }
+    }
+    return enhanced;
+  }
+
+  // an unused band is drawn as 0
+  const QVector<float> values = block ? block->valuesAsFloat() : QVector<float>( static_cast< int >( count ), 0.0f );
+  if ( enhancement )
+  {
+    enhancement->enhanceContrast( values.constData(), enhanced.data(), count );
+  }
+  else
+  {
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      // like qRgba(), only the lowest byte of the value is used
+      enhanced[i] = qIsNaN( values[i] ) ? -1 : static_cast< int >( values[i] ) & 0xff;
+    }
+  }
+  return enhanced;
+}
+
 QgsRasterBlock *QgsMultiBandColorRenderer::block( int bandNo, QgsRectangle  const &extent, int width, int height, QgsRasterBlockFeedback *feedback )
 {
   Q_UNUSED( bandNo );
@@ -226,93 +277,82 @@ QgsRasterBlock *QgsMultiBandColorRenderer::block( int bandNo, QgsRectangle  cons
   }
 
   QRgb myDefaultColor = NODATA_COLOR;
+  const qgssize count = static_cast< qgssize >( width ) * height;
+  QRgb *colors = reinterpret_cast< QRgb * >( outputBlock->bits() );
 
-  for ( qgssize i = 0; i < ( qgssize )width * height; i++ )
+  if ( fastDraw && ( !convertsExactlyToFloat( redBlock->dataType() ) || !convertsExactlyToFloat( greenBlock->dataType() ) || !convertsExactlyToFloat( blueBlock->dataType() ) ) )
   {
-    if ( fastDraw ) //fast rendering if no transparency, stretching, color inversion, etc.
+    // Float64, Int32 and UInt32 values would lose precision as floats, so they are read one by one
+    for ( qgssize i = 0; i < count; i++ )
     {
-      if ( redBlock->isNoData( i ) ||
-           greenBlock->isNoData( i ) ||
-           blueBlock->isNoData( i ) )
+      if ( redBlock->isNoData( i ) || greenBlock->isNoData( i ) || blueBlock->isNoData( i ) )
       {
-        outputBlock->setColor( i, myDefaultColor );
+        colors[i] = myDefaultColor;
       }
       else
       {
-        int redVal = ( int )redBlock->value( i );
-        int greenVal = ( int )greenBlock->value( i );
-        int blueVal = ( int )blueBlock->value( i );
-        outputBlock->setColor( i, qRgba( redVal, greenVal, blueVal, 255 ) );
+        colors[i] = qRgba( static_cast< int >( redBlock->value( i ) ), static_cast< int >( greenBlock->value( i ) ), static_cast< int >( blueBlock->value( i ) ), 255 );
       }
-      continue;
-    }
-
-    bool isNoData = false;
-    double redVal = 0;
-    double greenVal = 0;
-    double blueVal = 0;
-    if ( mRedBand > 0 )
-    {
-      redVal = redBlock->value( i );
-      if ( redBlock->isNoData( i ) ) isNoData = true;
-    }
-    if ( !isNoData && mGreenBand > 0 )
-    {
-      greenVal = greenBlock->value( i );
-      if ( greenBlock->isNoData( i ) ) isNoData = true;
-    }
-    if ( !isNoData && mBlueBand > 0 )
-    {
-      blueVal = blueBlock->value( i );
-      if ( blueBlock->isNoData( i ) ) isNoData = true;
-    }
-    if ( isNoData )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
     }
-
-    //apply default color if red, green or blue not in displayable range
-    if ( ( mRedContrastEnhancement && !mRedContrastEnhancement->isValueInDisplayableRange( redVal ) )
-         || ( mGreenContrastEnhancement && !mGreenContrastEnhancement->isValueInDisplayableRange( redVal ) )
-         || ( mBlueContrastEnhancement && !mBlueContrastEnhancement->isValueInDisplayableRange( redVal ) ) )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
-
-    //stretch color values
-    if ( mRedContrastEnhancement )
-    {
-      redVal = mRedContrastEnhancement->enhanceContrast( redVal );
-    }
-    if ( mGreenContrastEnhancement )
+  }
+  else if ( fastDraw ) //fast rendering if no transparency, stretching, color inversion, etc.
+  {
+    // values are converted for the whole block at once, no data values are NaN
+    const QVector<float> redValues = redBlock->valuesAsFloat();
+    const QVector<float> greenValues = greenBlock->valuesAsFloat();
+    const QVector<float> blueValues = blueBlock->valuesAsFloat();
+    const float *red = redValues.constData();
+    const float *green = greenValues.constData();
+    const float *blue = blueValues.constData();
+    for ( qgssize i = 0; i < count; i++ )
     {
-      greenVal = mGreenContrastEnhancement->enhanceContrast( greenVal );
+      if ( qIsNaN( red[i] ) || qIsNaN( green[i] ) || qIsNaN( blue[i] ) )
+      {
+        colors[i] = myDefaultColor;
+      }
+      else
+      {
+        colors[i] = qRgba( static_cast< int >( red[i] ), static_cast< int >( green[i] ), static_cast< int >( blue[i] ), 255 );
+      }
     }
-    if ( mBlueContrastEnhancement )
+  }
+  else
+  {
+    // enhanced values of each band, -1 for no data and values outside of the displayable range
+    QVector<int> redValues = enhancedBandValues( redBlock, mRedContrastEnhancement, count );
+    QVector<int> greenValues = enhancedBandValues( greenBlock, mGreenContrastEnhancement, count );
+    QVector<int> blueValues = enhancedBandValues( blueBlock, mBlueContrastEnhancement, count );
+    const int *red = redValues.constData();
+    const int *green = greenValues.constData();
+    const int *blue = blueValues.constData();
+
+    for ( qgssize i = 0; i < count; i++ )
     {
-      blueVal = mBlueContrastEnhancement->enhanceContrast( blueVal );
-    }
+      if ( red[i] < 0 || green[i] < 0 || blue[i] < 0 )
+      {
+        colors[i] = myDefaultColor;
+        continue;
+      }
 
-    //opacity
-    double currentOpacity = mOpacity;
-    if ( mRasterTransparency )
-    {
-      currentOpacity = mRasterTransparency->alphaValue( redVal, greenVal, blueVal, mOpacity * 255 ) / 255.0;
-    }
-    if ( mAlphaBand > 0 )
-    {
-      currentOpacity *= alphaBlock->value( i ) / 255.0;
-    }
+      //opacity
+      double currentOpacity = mOpacity;
+      if ( mRasterTransparency )
+      {
+        currentOpacity = mRasterTransparency->alphaValue( red[i], green[i], blue[i], mOpacity * 255 ) / 255.0;
+      }
+      if ( mAlphaBand > 0 )
+      {
+        currentOpacity *= alphaBlock->value( i ) / 255.0;
+      }
 
-    if ( qgsDoubleNear( currentOpacity, 1.0 ) )
-    {
-      outputBlock->setColor( i, qRgba( redVal, greenVal, blueVal, 255 ) );
-    }
-    else
-    {
-      outputBlock->setColor( i, qRgba( currentOpacity * redVal, currentOpacity * greenVal, currentOpacity * blueVal, currentOpacity * 255 ) );
+      if ( qgsDoubleNear( currentOpacity, 1.0 ) )
+      {
+        colors[i] = qRgba( red[i], green[i], blue[i], 255 );
+      }
+      else
+      {
+        colors[i] = qRgba( currentOpacity * red[i], currentOpacity * green[i], currentOpacity * blue[i], currentOpacity * 255 );
+      }
     }
   }
 
@@ -78,6 +78,9 @@ class CORE_EXPORT QgsMultiBandColorRenderer: public QgsRasterRenderer
     QgsContrastEnhancement *mGreenContrastEnhancement = nullptr;
     QgsContrastEnhancement *mBlueContrastEnhancement = nullptr;
 
+    //! Returns the enhanced values of a band block, or of a band of zeros if \a block is nullptr
+    static QVector<int> enhancedBandValues( const QgsRasterBlock *block, QgsContrastEnhancement *enhancement, qgssize count );
+
 };
 
 #endif // QGSMULTIBANDCOLORRENDERER_H
@@ -15,6 +15,7 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <algorithm>
 #include <limits>
 
 #include <QByteArray>
@@ -757,6 +758,106 @@ void QgsRasterBlock::applyScaleOffset( double scale, double offset )
   }
 }
 
+namespace
+{
+  template <typename T>
+  void convertToFloat( const T *values, float *output, qgssize count, bool hasNoDataValue, double noDataValue )
+  {
+    if ( !hasNoDataValue )
+    {
+      for ( qgssize i = 0; i < count; ++i )
+      {
+        output[i] = static_cast< float >( values[i] );
+      }
+      return;
+    }
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      const double value = static_cast< double >( values[i] );
+      output[i] = qgsDoubleNear( value, noDataValue ) ? nan : static_cast< float >( value );
+    }
+  }
+}
+
+QVector<float> QgsRasterBlock::valuesAsFloat() const
+{
+  const qgssize count = static_cast< qgssize >( mWidth ) * mHeight;
+  QVector<float> values( static_cast< int >( count ) );
+  float *output = values.data();
+
+  if ( !mData )
+  {
+    values.fill( std::numeric_limits<float>::quiet_NaN() );
+    return values;
+  }
+
+  switch ( mDataType )
+  {
+    case Qgis::Byte:
+      convertToFloat( static_cast< const quint8 * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::UInt16:
+      convertToFloat( static_cast< const quint16 * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::Int16:
+      convertToFloat( static_cast< const qint16 * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::UInt32:
+      convertToFloat( static_cast< const quint32 * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::Int32:
+      convertToFloat( static_cast< const qint32 * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::Float32:
+      convertToFloat( static_cast< const float * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    case Qgis::Float64:
+      convertToFloat( static_cast< const double * >( mData ), output, count, mHasNoDataValue, mNoDataValue );
+      break;
+    default:
+      QgsDebugMsg( QString( "Data type %1 is not supported" ).arg( mDataType ) );
+      values.fill( std::numeric_limits<float>::quiet_NaN() );
+      return values;
+  }
+
+  if ( !mHasNoDataValue && mNoDataBitmap )
+  {
+    // cells flagged in the no data bitmap, whole bytes without flags are skipped
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for ( int row = 0; row < mHeight; ++row )
+    {
+      const char *bitmapRow = mNoDataBitmap + static_cast< qgssize >( row ) * mNoDataBitmapWidth;
+      float *outputRow = output + static_cast< qgssize >( row ) * mWidth;
+      for ( int byte = 0; byte < mNoDataBitmapWidth; ++byte )
+      {
+        if ( !bitmapRow[byte] )
+          continue;
+
+        const int lastColumn = std::min( mWidth, ( byte + 1 ) * 8 );
+        for ( int column = byte * 8; column < lastColumn; ++column )
+        {
+          if ( bitmapRow[byte] & ( 0x80 >> ( column % 8 ) ) )
+            outputRow[column] = nan;
+        }
+      }
+    }
+  }
+
+  return values;
+}
+
+void QgsRasterBlock::lookupColors( const int *indexes, QRgb *colors, qgssize count, const QRgb *table, int tableSize, QRgb defaultColor )
+{
+  for ( qgssize i = 0; i < count; ++i )
+  {
+    // a single unsigned comparison covers negative indexes too
+    const int index = indexes[i];
+    colors[i] = static_cast< unsigned int >( index ) < static_cast< unsigned int >( tableSize ) ? table[index] : defaultColor;
+  }
+}
+
 void QgsRasterBlock::applyNoDataValues( const QgsRasterRangeList &rangeList )
 {
   if ( rangeList.isEmpty() )
@@ -21,6 +21,7 @@
 #include "qgis_core.h"
 #include <limits>
 #include <QImage>
+#include <QVector>
 #include "qgis.h"
 #include "qgserror.h"
 #include "qgslogger.h"
@@ -338,6 +339,25 @@ class CORE_EXPORT QgsRasterBlock
 
     void applyNoDataValues( const QgsRasterRangeList &rangeList );
 
+    /** Returns all values of the block converted to single precision floats, with
+     * no data cells set to NaN. Each data type is converted in a single tight loop
+     * without per cell type dispatch, which compilers can vectorise, so this is much
+     * faster than calling value() and isNoData() for every cell. Values of UInt32, Int32
+     * and Float64 blocks are rounded to the nearest float. All cells of blocks with
+     * other data types are NaN.
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    QVector<float> valuesAsFloat() const;
+
+    /** Maps \a count \a indexes to the colors of a lookup \a table with \a tableSize entries
+     * and writes them to \a colors. Indexes outside of the table, e.g. -1, are mapped to the
+     * \a defaultColor.
+     * @note added in QGIS 3.0
+     * @note not available in python bindings
+     */
+    static void lookupColors( const int *indexes, QRgb *colors, qgssize count, const QRgb *table, int tableSize, QRgb defaultColor );
+
     /** Apply band scale and offset to raster block values
      * @@note added in 2.3 */
     void applyScaleOffset( double scale, double offset );
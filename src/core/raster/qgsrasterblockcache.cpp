@@ -0,0 +1,960 @@
+/***************************************************************************
+                         qgsrasterblockcache.cpp
+                         -----------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrasterblockcache.h"
+#include "qgsrasterdataprovider.h"
+#include "qgslogger.h"
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+  //default maximum memory used by the cached tiles of all layers, in bytes
+  const qint64 DEFAULT_CACHE_SIZE = Q_INT64_C( 100 ) * 1024 * 1024;
+
+  //the costs of the cached tiles are counted in units of this number of bytes, so that
+  //budgets beyond the range of int fit into QCache
+  const int COST_UNIT = 1024;
+
+  //returns the cost of a number of bytes, rounded up to whole units
+  int costOf( qint64 bytes )
+  {
+    return static_cast< int >( std::min< qint64 >( ( bytes + COST_UNIT - 1 ) / COST_UNIT, std::numeric_limits< int >::max() ) );
+  }
+
+  //resolutions are rounded to levels of this fraction of a power of two, so that
+  //requests which only differ by floating point noise share their tiles
+  const double RESOLUTION_STEPS = 1 << 20;
+
+  //the grid of tiles is shifted by multiples of this fraction of a pixel to match the requests
+  const int PHASE_STEPS = 256;
+
+  //rounds a resolution to its level
+  qint64 resolutionLevel( double resolution )
+  {
+    return qRound64( std::log2( resolution ) * RESOLUTION_STEPS );
+  }
+
+  //splits a position in pixels of the grid into the first pixel and the phase of the grid
+  void alignToGrid( double position, qint64 &pixel, int &phase )
+  {
+    pixel = static_cast< qint64 >( std::floor( position ) );
+    phase = qRound( ( position - pixel ) * PHASE_STEPS );
+    if ( phase == PHASE_STEPS )
+    {
+      pixel++;
+      phase = 0;
+    }
+  }
+
+  //pyramid tiles of the levels up to this one are averaged from a single read of the input at
+  //its native resolution, which also gives the tiles of the finer levels covered by the tile
+  const int PYRAMID_READ_LEVELS = 3;
+
+  //coarsest level of the pyramid, its tiles are averaged from the level below so that a tile
+  //never needs more than 4 reads of the input, coarser blocks are read from the input
+  const int MAX_PYRAMID_LEVEL = 4;
+
+  //returns the number of pixels of level 0 averaged into a pixel of a pyramid level
+  quint32 pyramidWeight( int level )
+  {
+    return 1u << ( 2 * level );
+  }
+
+  //means and numbers of valid pixels of level 0 of a square of pyramid pixels
+  struct PyramidValues
+  {
+    explicit PyramidValues( int size )
+      : size( size )
+      , means( static_cast< size_t >( size ) * size, 0 )
+      , counts( static_cast< size_t >( size ) * size, 0 )
+    {}
+
+    int size;
+    std::vector< double > means;
+    std::vector< quint32 > counts;
+  };
+
+  //averages the 2 x 2 pixels of a block read at the native resolution into the pixels of level 1,
+  //pixels outside of the block have no valid pixels
+  PyramidValues pyramidFromBlock( QgsRasterBlock &block, int size )
+  {
+    PyramidValues values( size );
+    for ( int row = 0; row < block.height(); ++row )
+    {
+      for ( int column = 0; column < block.width(); ++column )
+      {
+        if ( block.isNoData( row, column ) )
+          continue;
+        const size_t index = static_cast< size_t >( row / 2 ) * size + column / 2;
+        values.means[index] += block.value( row, column );
+        values.counts[index]++;
+      }
+    }
+    for ( size_t i = 0; i < values.means.size(); ++i )
+    {
+      if ( values.counts[i] > 0 )
+        values.means[i] /= values.counts[i];
+    }
+    return values;
+  }
+
+  //averages the 2 x 2 pixels of a level into the level above, weighted by their numbers of valid pixels
+  PyramidValues reducePyramid( const PyramidValues &values )
+  {
+    PyramidValues reduced( values.size / 2 );
+    for ( int row = 0; row < reduced.size; ++row )
+    {
+      for ( int column = 0; column < reduced.size; ++column )
+      {
+        double sum = 0;
+        quint32 count = 0;
+        for ( int sourceRow = row * 2; sourceRow < row * 2 + 2; ++sourceRow )
+        {
+          for ( int sourceColumn = column * 2; sourceColumn < column * 2 + 2; ++sourceColumn )
+          {
+            const size_t index = static_cast< size_t >( sourceRow ) * values.size + sourceColumn;
+            sum += values.means[index] * values.counts[index];
+            count += values.counts[index];
+          }
+        }
+        const size_t index = static_cast< size_t >( row ) * reduced.size + column;
+        reduced.counts[index] = count;
+        reduced.means[index] = count > 0 ? sum / count : 0;
+      }
+    }
+    return reduced;
+  }
+
+  //copies a pyramid tile and the numbers of valid pixels of its pixels to the square at left, top,
+  //empty weights stand for fullWeight valid pixels in each pixel which is not no data
+  void addPyramidTile( PyramidValues &values, int left, int top, QgsRasterBlock &tile, const QVector< quint32 > &weights, quint32 fullWeight )
+  {
+    for ( int row = 0; row < tile.height(); ++row )
+    {
+      for ( int column = 0; column < tile.width(); ++column )
+      {
+        if ( tile.isNoData( row, column ) )
+          continue;
+        const size_t index = static_cast< size_t >( top + row ) * values.size + left + column;
+        values.means[index] = tile.value( row, column );
+        values.counts[index] = weights.isEmpty() ? fullWeight : weights.at( row * tile.width() + column );
+      }
+    }
+  }
+
+  //returns the pyramid tile of size x size pixels at left, top, with the data type and no data value
+  //of the format block, and sets the numbers of valid pixels of its pixels to weights, which are left
+  //empty when all valid pixels have fullWeight valid pixels
+  std::unique_ptr< QgsRasterBlock > pyramidToTile( const PyramidValues &values, int left, int top, int size, const QgsRasterBlock &format,
+      quint32 fullWeight, QVector< quint32 > &weights )
+  {
+    const bool integer = format.dataType() != Qgis::Float32 && format.dataType() != Qgis::Float64;
+    std::unique_ptr< QgsRasterBlock > tile( new QgsRasterBlock( format.dataType(), size, size ) );
+    if ( format.hasNoDataValue() )
+      tile->setNoDataValue( format.noDataValue() );
+
+    weights.resize( size * size );
+    bool full = true;
+    for ( int row = 0; row < size; ++row )
+    {
+      for ( int column = 0; column < size; ++column )
+      {
+        const size_t index = static_cast< size_t >( top + row ) * values.size + left + column;
+        const quint32 count = values.counts[index];
+        weights[row * size + column] = count;
+        if ( count == 0 )
+        {
+          tile->setIsNoData( row, column );
+          continue;
+        }
+        full = full && count == fullWeight;
+        tile->setValue( row, column, integer ? std::round( values.means[index] ) : values.means[index] );
+      }
+    }
+    if ( full )
+      weights.clear();
+    return tile;
+  }
+
+  //returns true for the data types which are averaged by the pyramid
+  bool isPyramidType( Qgis::DataType type )
+  {
+    switch ( type )
+    {
+      case Qgis::Byte:
+      case Qgis::UInt16:
+      case Qgis::Int16:
+      case Qgis::UInt32:
+      case Qgis::Int32:
+      case Qgis::Float32:
+      case Qgis::Float64:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  //integer division rounding towards negative infinity
+  qint64 floorDiv( qint64 value, qint64 divisor )
+  {
+    return value >= 0 ? value / divisor : ( value - divisor + 1 ) / divisor;
+  }
+}
+
+struct QgsRasterBlockCache::Tile
+{
+  Qgis::DataType dataType;
+  int width;
+  int height;
+  bool hasNoDataValue;
+  double noDataValue;
+  //! Values of the tile, compressed with qCompress() if compressed is set
+  QByteArray data;
+  //! One byte per pixel flagging no data, empty if the tile has a no data value or no no data bitmap
+  QByteArray noDataMask;
+  //! Numbers of valid pixels of level 0 averaged into the pixels of a pyramid tile, empty for full pixels
+  QByteArray weights;
+  bool compressed;
+
+  int byteCount() const { return data.size() + noDataMask.size() + weights.size() + static_cast< int >( sizeof( Tile ) ); }
+};
+
+struct QgsRasterBlockCache::Storage
+{
+  Storage()
+    : tiles( costOf( DEFAULT_CACHE_SIZE ) )
+  {}
+
+  //! Must be locked while the tiles are accessed
+  QMutex mutex;
+  //! Cached tiles of all layers, keyed by their data source. The cost of entries is their size in COST_UNIT bytes
+  QCache< QByteArray, Tile > tiles;
+  //! Maximum number of bytes taken by the tiles
+  qint64 maximumSize = DEFAULT_CACHE_SIZE;
+  //! Whether the data sources have pyramids of their own, checked once per source
+  QHash< QString, bool > nativePyramids;
+};
+
+struct QgsRasterBlockCache::Shared
+{
+  //! Number of blocks read from the input by the cache and its clones
+  QAtomicInt readCount;
+  //! Keys the tiles of inputs which are not data providers, unique to the cache and its clones
+  QString id;
+};
+
+struct QgsRasterBlockCache::PyramidGrid
+{
+  //! Prefix of the keys of the pyramid tiles
+  QString keyPrefix;
+  int bandNo;
+  //! Extent of the provider, the origin of the pyramid is its top left corner
+  QgsRectangle extent;
+  //! Size of a pixel of level 0
+  double xRes;
+  double yRes;
+  //! Number of pixels of level 0
+  qint64 xSize;
+  qint64 ySize;
+
+  //! Returns the number of columns of pixels of a \a level
+  qint64 columns( int level ) const { return ( xSize + ( Q_INT64_C( 1 ) << level ) - 1 ) >> level; }
+
+  //! Returns the number of rows of pixels of a \a level
+  qint64 rows( int level ) const { return ( ySize + ( Q_INT64_C( 1 ) << level ) - 1 ) >> level; }
+
+  //! Returns the key of a tile of a \a level
+  QByteArray key( int level, qint64 column, qint64 row ) const { return ( keyPrefix + QStringLiteral( "|%1|%2|%3" ).arg( level ).arg( column ).arg( row ) ).toUtf8(); }
+};
+
+QgsRasterBlockCache::QgsRasterBlockCache( QgsRasterInterface *input )
+  : QgsRasterInterface( input )
+  , mShared( std::make_shared< Shared >() )
+{
+  static QAtomicInt sLastId;
+  mShared->id = QStringLiteral( "cache:%1" ).arg( sLastId.fetchAndAddRelaxed( 1 ) + 1 );
+}
+
+QgsRasterBlockCache *QgsRasterBlockCache::clone() const
+{
+  QgsDebugMsgLevel( "Entered", 4 );
+  QgsRasterBlockCache *cache = new QgsRasterBlockCache( nullptr );
+  cache->mShared = mShared;
+  cache->mCompressionEnabled = mCompressionEnabled;
+  cache->mTileSize = mTileSize;
+  cache->mPyramidsEnabled = mPyramidsEnabled;
+  cache->mOn = mOn;
+  return cache;
+}
+
+int QgsRasterBlockCache::bandCount() const
+{
+  if ( mInput ) return mInput->bandCount();
+  return 0;
+}
+
+Qgis::DataType QgsRasterBlockCache::dataType( int bandNo ) const
+{
+  if ( mInput ) return mInput->dataType( bandNo );
+  return Qgis::UnknownDataType;
+}
+
+QgsRasterBlockCache::Storage &QgsRasterBlockCache::storage()
+{
+  // the caches of all layers share the storage, so that the budget is global
+  static Storage sStorage;
+  return sStorage;
+}
+
+QString QgsRasterBlockCache::sourceKey() const
+{
+  const QgsRasterDataProvider *provider = dynamic_cast< const QgsRasterDataProvider * >( sourceInput() );
+  if ( provider )
+  {
+    return provider->name() + ':' + provider->dataSourceUri() + '|';
+  }
+  return mShared->id + '|';
+}
+
+void QgsRasterBlockCache::setMaximumSize( qint64 bytes )
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  s.maximumSize = std::max( bytes, Q_INT64_C( 0 ) );
+  // whole units of cost, so that a budget is never exceeded
+  s.tiles.setMaxCost( static_cast< int >( std::min< qint64 >( s.maximumSize / COST_UNIT, std::numeric_limits< int >::max() ) ) );
+}
+
+qint64 QgsRasterBlockCache::maximumSize() const
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  return s.maximumSize;
+}
+
+int QgsRasterBlockCache::tileCount() const
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  return s.tiles.count();
+}
+
+int QgsRasterBlockCache::readCount() const
+{
+  return mShared->readCount.load();
+}
+
+qint64 QgsRasterBlockCache::size() const
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  return static_cast< qint64 >( s.tiles.totalCost() ) * COST_UNIT;
+}
+
+void QgsRasterBlockCache::clear()
+{
+  const QString source = sourceKey();
+  const QByteArray sourceBytes = source.toUtf8();
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  Q_FOREACH ( const QByteArray &key, s.tiles.keys() )
+  {
+    if ( key.startsWith( sourceBytes ) )
+      s.tiles.remove( key );
+  }
+  QHash< QString, bool >::iterator it = s.nativePyramids.begin();
+  while ( it != s.nativePyramids.end() )
+  {
+    if ( it.key().startsWith( source ) )
+      it = s.nativePyramids.erase( it );
+    else
+      ++it;
+  }
+}
+
+void QgsRasterBlockCache::clearAll()
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  s.tiles.clear();
+  s.nativePyramids.clear();
+}
+
+QgsRasterBlock *QgsRasterBlockCache::block( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback )
+{
+  QgsDebugMsgLevel( "Entered", 4 );
+  if ( !mInput )
+  {
+    return new QgsRasterBlock();
+  }
+
+  const QgsRectangle inputExtent = mInput->extent();
+  const qint64 blockBytes = static_cast< qint64 >( width ) * height * QgsRasterBlock::typeSize( mInput->dataType( bandNo ) );
+  if ( !mOn || width <= 0 || height <= 0 || extent.isEmpty() || inputExtent.isEmpty() || mTileSize <= 0
+       || blockBytes > maximumSize() || ( feedback && feedback->isPreviewOnly() ) )
+  {
+    // blocks which would flush the whole cache and previews are not cached
+    return readInput( bandNo, extent, width, height, feedback );
+  }
+
+  // tiles must not be shared after the data source or the no data values of the provider changed
+  QString source = sourceKey();
+  QgsRasterDataProvider *provider = dynamic_cast< QgsRasterDataProvider * >( sourceInput() );
+  if ( provider )
+  {
+    source += provider->useSourceNoDataValue( bandNo ) ? QStringLiteral( "src" ) : QStringLiteral( "nosrc" );
+    Q_FOREACH ( const QgsRasterRange &range, provider->userNoDataValues( bandNo ) )
+    {
+      source += QStringLiteral( "|%1,%2" ).arg( qgsDoubleToString( range.min() ), qgsDoubleToString( range.max() ) );
+    }
+
+    if ( mPyramidsEnabled )
+    {
+      if ( QgsRasterBlock *pyramid = pyramidBlock( provider, source, bandNo, extent, width, height, feedback ) )
+        return pyramid;
+    }
+  }
+
+  // the grid of tiles is aligned to the top left corner of the input extent, with its resolution
+  // and the sub pixel phase of the request rounded, so that panning at the same scale hits the same tiles
+  const qint64 xLevel = resolutionLevel( extent.width() / width );
+  const qint64 yLevel = resolutionLevel( extent.height() / height );
+  const double xRes = std::exp2( xLevel / RESOLUTION_STEPS );
+  const double yRes = std::exp2( yLevel / RESOLUTION_STEPS );
+  qint64 firstColumn, firstRow;
+  int xPhase, yPhase;
+  alignToGrid( ( extent.xMinimum() - inputExtent.xMinimum() ) / xRes, firstColumn, xPhase );
+  alignToGrid( ( inputExtent.yMaximum() - extent.yMaximum() ) / yRes, firstRow, yPhase );
+  const double originX = inputExtent.xMinimum() + xRes * xPhase / PHASE_STEPS;
+  const double originY = inputExtent.yMaximum() - yRes * yPhase / PHASE_STEPS;
+
+  const QString keyPrefix = source + QStringLiteral( "|%1|%2|%3|%4|%5|%6" ).arg( bandNo ).arg( mTileSize )
+                            .arg( xLevel ).arg( yLevel ).arg( xPhase ).arg( yPhase );
+
+  const qint64 firstTileColumn = floorDiv( firstColumn, mTileSize );
+  const qint64 lastTileColumn = floorDiv( firstColumn + width - 1, mTileSize );
+  const qint64 firstTileRow = floorDiv( firstRow, mTileSize );
+  const qint64 lastTileRow = floorDiv( firstRow + height - 1, mTileSize );
+
+  const int tileColumns = static_cast< int >( lastTileColumn - firstTileColumn + 1 );
+  const int tileRows = static_cast< int >( lastTileRow - firstTileRow + 1 );
+  std::vector< std::unique_ptr< QgsRasterBlock > > tiles( static_cast< size_t >( tileColumns ) * tileRows );
+  QVector< QByteArray > keys( tileColumns * tileRows );
+  for ( int row = 0; row < tileRows; ++row )
+  {
+    for ( int column = 0; column < tileColumns; ++column )
+    {
+      const int index = row * tileColumns + column;
+      keys[index] = ( keyPrefix + QStringLiteral( "|%1|%2" ).arg( firstTileColumn + column ).arg( firstTileRow + row ) ).toUtf8();
+      tiles[index] = cachedTile( keys.at( index ) );
+    }
+  }
+
+  // missing tiles are read in rectangles of adjacent tiles, so that a view which is not cached at all
+  // takes a single request to the input instead of one per tile
+  struct TileRange
+  {
+    int firstColumn;
+    int lastColumn;
+    int firstRow;
+    int lastRow;
+  };
+  QList< TileRange > ranges;
+  QList< TileRange > previousRow;
+  for ( int row = 0; row < tileRows; ++row )
+  {
+    QList< TileRange > currentRow;
+    int column = 0;
+    while ( column < tileColumns )
+    {
+      if ( tiles[ static_cast< size_t >( row * tileColumns + column )] )
+      {
+        column++;
+        continue;
+      }
+      TileRange range;
+      range.firstColumn = column;
+      while ( column < tileColumns && !tiles[ static_cast< size_t >( row * tileColumns + column )] )
+        column++;
+      range.lastColumn = column - 1;
+      range.firstRow = row;
+      range.lastRow = row;
+      // continue a range of the previous row with the same columns
+      for ( int i = 0; i < previousRow.size(); ++i )
+      {
+        if ( previousRow.at( i ).firstColumn == range.firstColumn && previousRow.at( i ).lastColumn == range.lastColumn )
+        {
+          range.firstRow = previousRow.takeAt( i ).firstRow;
+          break;
+        }
+      }
+      currentRow << range;
+    }
+    ranges << previousRow;
+    previousRow = currentRow;
+  }
+  ranges << previousRow;
+
+  Q_FOREACH ( const TileRange &range, ranges )
+  {
+    if ( feedback && feedback->isCanceled() )
+    {
+      return new QgsRasterBlock();
+    }
+
+    const qint64 columnOffset = firstTileColumn + range.firstColumn;
+    const qint64 rowOffset = firstTileRow + range.firstRow;
+    const int columns = range.lastColumn - range.firstColumn + 1;
+    const int rows = range.lastRow - range.firstRow + 1;
+    const QgsRectangle rangeExtent( originX + columnOffset * mTileSize * xRes, originY - ( rowOffset + rows ) * mTileSize * yRes,
+                                    originX + ( columnOffset + columns ) * mTileSize * xRes, originY - rowOffset * mTileSize * yRes );
+    std::vector< std::unique_ptr< QgsRasterBlock > > rangeTiles = readTiles( bandNo, rangeExtent, columns, rows, feedback );
+    if ( rangeTiles.empty() )
+    {
+      QgsDebugMsg( "Could not read tiles, reading block from input" );
+      return readInput( bandNo, extent, width, height, feedback );
+    }
+    if ( feedback && feedback->isCanceled() )
+    {
+      // the tiles may be incomplete
+      return new QgsRasterBlock();
+    }
+
+    for ( int row = 0; row < rows; ++row )
+    {
+      for ( int column = 0; column < columns; ++column )
+      {
+        const int index = ( range.firstRow + row ) * tileColumns + range.firstColumn + column;
+        tiles[ static_cast< size_t >( index )] = std::move( rangeTiles[ static_cast< size_t >( row * columns + column )] );
+        storeTile( keys.at( index ), *tiles[ static_cast< size_t >( index )] );
+      }
+    }
+  }
+
+  const QgsRasterBlock *firstTile = tiles.front().get();
+  std::unique_ptr< QgsRasterBlock > output( new QgsRasterBlock( firstTile->dataType(), width, height ) );
+  if ( firstTile->hasNoDataValue() )
+    output->setNoDataValue( firstTile->noDataValue() );
+
+  for ( qint64 tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow )
+  {
+    for ( qint64 tileColumn = firstTileColumn; tileColumn <= lastTileColumn; ++tileColumn )
+    {
+      QgsRasterBlock *tile = tiles[ static_cast< size_t >( ( tileRow - firstTileRow ) * tileColumns + tileColumn - firstTileColumn )].get();
+
+      // pixels of the tile covered by the block
+      const int left = static_cast< int >( qMax( firstColumn, tileColumn * mTileSize ) - tileColumn * mTileSize );
+      const int right = static_cast< int >( qMin( firstColumn + width, ( tileColumn + 1 ) * mTileSize ) - tileColumn * mTileSize );
+      const int top = static_cast< int >( qMax( firstRow, tileRow * mTileSize ) - tileRow * mTileSize );
+      const int bottom = static_cast< int >( qMin( firstRow + height, ( tileRow + 1 ) * mTileSize ) - tileRow * mTileSize );
+      const int outputColumn = static_cast< int >( tileColumn * mTileSize + left - firstColumn );
+      const int outputRow = static_cast< int >( tileRow * mTileSize + top - firstRow );
+      const int typeSize = tile->dataTypeSize();
+      const bool checkNoData = !tile->hasNoDataValue() && tile->hasNoData();
+
+      for ( int row = top; row < bottom; ++row )
+      {
+        const int destRow = outputRow + row - top;
+        std::memcpy( output->bits( destRow, outputColumn ), tile->bits( row, left ), static_cast< size_t >( right - left ) * typeSize );
+        if ( checkNoData )
+        {
+          for ( int column = left; column < right; ++column )
+          {
+            if ( tile->isNoData( row, column ) )
+              output->setIsNoData( destRow, outputColumn + column - left );
+          }
+        }
+      }
+    }
+  }
+
+  return output.release();
+}
+
+QgsRasterBlock *QgsRasterBlockCache::readInput( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback )
+{
+  mShared->readCount.ref();
+  return mInput->block( bandNo, extent, width, height, feedback );
+}
+
+std::vector< std::unique_ptr< QgsRasterBlock > > QgsRasterBlockCache::readTiles( int bandNo, const QgsRectangle &extent, int columns, int rows, QgsRasterBlockFeedback *feedback )
+{
+  std::vector< std::unique_ptr< QgsRasterBlock > > tiles;
+  const int width = columns * mTileSize;
+  const int height = rows * mTileSize;
+  std::unique_ptr< QgsRasterBlock > block( readInput( bandNo, extent, width, height, feedback ) );
+  if ( !block || !block->isValid() || block->isEmpty() || block->width() != width || block->height() != height )
+  {
+    return tiles;
+  }
+
+  const int typeSize = block->dataTypeSize();
+  const bool checkNoData = !block->hasNoDataValue() && block->hasNoData();
+  for ( int tileRow = 0; tileRow < rows; ++tileRow )
+  {
+    for ( int tileColumn = 0; tileColumn < columns; ++tileColumn )
+    {
+      std::unique_ptr< QgsRasterBlock > tile( new QgsRasterBlock( block->dataType(), mTileSize, mTileSize ) );
+      if ( block->hasNoDataValue() )
+        tile->setNoDataValue( block->noDataValue() );
+      for ( int row = 0; row < mTileSize; ++row )
+      {
+        const int sourceRow = tileRow * mTileSize + row;
+        std::memcpy( tile->bits( row, 0 ), block->bits( sourceRow, tileColumn * mTileSize ), static_cast< size_t >( mTileSize ) * typeSize );
+        if ( checkNoData )
+        {
+          for ( int column = 0; column < mTileSize; ++column )
+          {
+            if ( block->isNoData( sourceRow, tileColumn * mTileSize + column ) )
+              tile->setIsNoData( row, column );
+          }
+        }
+      }
+      tiles.emplace_back( std::move( tile ) );
+    }
+  }
+  return tiles;
+}
+
+bool QgsRasterBlockCache::isCached( const QByteArray &key ) const
+{
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  return s.tiles.contains( key );
+}
+
+std::unique_ptr< QgsRasterBlock > QgsRasterBlockCache::cachedTile( const QByteArray &key, QVector< quint32 > *weights )
+{
+  Tile cached;
+  {
+    Storage &s = storage();
+    QMutexLocker locker( &s.mutex );
+    const Tile *tile = s.tiles.object( key );
+    if ( !tile )
+    {
+      return nullptr;
+    }
+    // only the shared data is copied
+    cached = *tile;
+  }
+
+  std::unique_ptr< QgsRasterBlock > block( new QgsRasterBlock( cached.dataType, cached.width, cached.height ) );
+  block->setData( cached.compressed ? qUncompress( cached.data ) : cached.data );
+  if ( cached.hasNoDataValue )
+    block->setNoDataValue( cached.noDataValue );
+  if ( !cached.noDataMask.isEmpty() )
+  {
+    const QByteArray mask = cached.compressed ? qUncompress( cached.noDataMask ) : cached.noDataMask;
+    for ( int i = 0; i < mask.size(); ++i )
+    {
+      if ( mask.at( i ) )
+        block->setIsNoData( static_cast< qgssize >( i ) );
+    }
+  }
+  if ( weights )
+  {
+    const QByteArray bytes = cached.compressed && !cached.weights.isEmpty() ? qUncompress( cached.weights ) : cached.weights;
+    weights->resize( bytes.size() / static_cast< int >( sizeof( quint32 ) ) );
+    if ( !bytes.isEmpty() )
+      std::memcpy( weights->data(), bytes.constData(), static_cast< size_t >( bytes.size() ) );
+  }
+  return block;
+}
+
+void QgsRasterBlockCache::storeTile( const QByteArray &key, QgsRasterBlock &block, const QVector< quint32 > &weights )
+{
+  Tile *tile = new Tile();
+  tile->dataType = block.dataType();
+  tile->width = block.width();
+  tile->height = block.height();
+  tile->hasNoDataValue = block.hasNoDataValue();
+  tile->noDataValue = block.noDataValue();
+  tile->compressed = mCompressionEnabled;
+  tile->data = mCompressionEnabled ? qCompress( block.data(), 1 ) : block.data();
+  if ( !block.hasNoDataValue() && block.hasNoData() )
+  {
+    const qgssize count = static_cast< qgssize >( block.width() ) * block.height();
+    QByteArray mask( static_cast< int >( count ), 0 );
+    for ( qgssize i = 0; i < count; ++i )
+    {
+      if ( block.isNoData( i ) )
+        mask[ static_cast< int >( i )] = 1;
+    }
+    tile->noDataMask = mCompressionEnabled ? qCompress( mask, 1 ) : mask;
+  }
+  if ( !weights.isEmpty() )
+  {
+    const QByteArray bytes( reinterpret_cast< const char * >( weights.constData() ), weights.size() * static_cast< int >( sizeof( quint32 ) ) );
+    tile->weights = mCompressionEnabled ? qCompress( bytes, 1 ) : bytes;
+  }
+
+  Storage &s = storage();
+  QMutexLocker locker( &s.mutex );
+  s.tiles.insert( key, tile, costOf( tile->byteCount() ) );
+}
+
+QgsRasterBlock *QgsRasterBlockCache::pyramidBlock( QgsRasterDataProvider *provider, const QString &source, int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback )
+{
+  if ( !( provider->capabilities() & QgsRasterDataProvider::Size ) || provider->xSize() <= 0 || provider->ySize() <= 0
+       || !isPyramidType( provider->dataType( bandNo ) ) || provider->colorInterpretation( bandNo ) == QgsRaster::PaletteIndex )
+  {
+    return nullptr;
+  }
+
+  PyramidGrid grid;
+  grid.bandNo = bandNo;
+  grid.extent = provider->extent();
+  grid.xSize = provider->xSize();
+  grid.ySize = provider->ySize();
+  grid.xRes = grid.extent.width() / grid.xSize;
+  grid.yRes = grid.extent.height() / grid.ySize;
+
+  // the coarsest level which is not coarser than the request, so that the block keeps at least the
+  // requested resolution. The pyramid is not worth it for requests at less than half the native
+  // resolution, and blocks coarser than the pyramid are read from the input
+  const double ratio = std::min( extent.width() / width / grid.xRes, extent.height() / height / grid.yRes );
+  const double levels = std::floor( std::log2( ratio ) + 1 / RESOLUTION_STEPS );
+  if ( !( levels >= 1 ) || levels > MAX_PYRAMID_LEVEL )
+  {
+    return nullptr;
+  }
+  const int level = static_cast< int >( levels );
+
+  // providers with pyramids of their own read zoomed out blocks from them
+  bool nativePyramids = false;
+  bool checked = false;
+  {
+    Storage &s = storage();
+    QMutexLocker locker( &s.mutex );
+    QHash< QString, bool >::const_iterator it = s.nativePyramids.constFind( source );
+    if ( it != s.nativePyramids.constEnd() )
+    {
+      nativePyramids = it.value();
+      checked = true;
+    }
+  }
+  if ( !checked )
+  {
+    nativePyramids = provider->hasPyramids();
+    Storage &s = storage();
+    QMutexLocker locker( &s.mutex );
+    s.nativePyramids.insert( source, nativePyramids );
+  }
+  if ( nativePyramids )
+  {
+    return nullptr;
+  }
+
+  grid.keyPrefix = source + QStringLiteral( "|pyramid|%1|%2" ).arg( bandNo ).arg( mTileSize );
+
+  // pixel of the level at the center of each column and row of the block, -1 outside of the level
+  const double levelXRes = std::ldexp( grid.xRes, level );
+  const double levelYRes = std::ldexp( grid.yRes, level );
+  const qint64 levelColumns = grid.columns( level );
+  const qint64 levelRows = grid.rows( level );
+  const double blockXRes = extent.width() / width;
+  const double blockYRes = extent.height() / height;
+  std::vector< qint64 > columns( width );
+  std::vector< qint64 > rows( height );
+  qint64 firstTileColumn = std::numeric_limits< qint64 >::max();
+  qint64 lastTileColumn = -1;
+  qint64 firstTileRow = std::numeric_limits< qint64 >::max();
+  qint64 lastTileRow = -1;
+  for ( int column = 0; column < width; ++column )
+  {
+    const double x = extent.xMinimum() + ( column + 0.5 ) * blockXRes;
+    const qint64 pixel = static_cast< qint64 >( std::floor( ( x - grid.extent.xMinimum() ) / levelXRes ) );
+    columns[column] = pixel >= 0 && pixel < levelColumns ? pixel : -1;
+    if ( columns[column] >= 0 )
+    {
+      firstTileColumn = std::min( firstTileColumn, pixel / mTileSize );
+      lastTileColumn = std::max( lastTileColumn, pixel / mTileSize );
+    }
+  }
+  for ( int row = 0; row < height; ++row )
+  {
+    const double y = extent.yMaximum() - ( row + 0.5 ) * blockYRes;
+    const qint64 pixel = static_cast< qint64 >( std::floor( ( grid.extent.yMaximum() - y ) / levelYRes ) );
+    rows[row] = pixel >= 0 && pixel < levelRows ? pixel : -1;
+    if ( rows[row] >= 0 )
+    {
+      firstTileRow = std::min( firstTileRow, pixel / mTileSize );
+      lastTileRow = std::max( lastTileRow, pixel / mTileSize );
+    }
+  }
+  if ( lastTileColumn < 0 || lastTileRow < 0 )
+  {
+    // outside of the raster, the input knows best what to return
+    return nullptr;
+  }
+
+  const qint64 tileColumns = lastTileColumn - firstTileColumn + 1;
+  const qint64 tileRows = lastTileRow - firstTileRow + 1;
+  std::vector< std::unique_ptr< QgsRasterBlock > > tiles( static_cast< size_t >( tileColumns * tileRows ) );
+  for ( qint64 tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow )
+  {
+    for ( qint64 tileColumn = firstTileColumn; tileColumn <= lastTileColumn; ++tileColumn )
+    {
+      QVector< quint32 > weights;
+      std::unique_ptr< QgsRasterBlock > tile = pyramidTile( grid, level, tileColumn, tileRow, weights, feedback );
+      if ( !tile )
+      {
+        return nullptr;
+      }
+      tiles[ static_cast< size_t >( ( tileRow - firstTileRow ) * tileColumns + tileColumn - firstTileColumn )] = std::move( tile );
+    }
+  }
+
+  const QgsRasterBlock *firstTile = tiles.front().get();
+  std::unique_ptr< QgsRasterBlock > output( new QgsRasterBlock( firstTile->dataType(), width, height ) );
+  if ( firstTile->hasNoDataValue() )
+    output->setNoDataValue( firstTile->noDataValue() );
+
+  for ( int row = 0; row < height; ++row )
+  {
+    const qint64 levelRow = rows[row];
+    for ( int column = 0; column < width; ++column )
+    {
+      const qint64 levelColumn = columns[column];
+      if ( levelRow < 0 || levelColumn < 0 )
+      {
+        output->setIsNoData( row, column );
+        continue;
+      }
+
+      QgsRasterBlock *tile = tiles[ static_cast< size_t >( ( levelRow / mTileSize - firstTileRow ) * tileColumns + levelColumn / mTileSize - firstTileColumn )].get();
+      const int tileRow = static_cast< int >( levelRow % mTileSize );
+      const int tileColumn = static_cast< int >( levelColumn % mTileSize );
+      if ( tile->isNoData( tileRow, tileColumn ) )
+        output->setIsNoData( row, column );
+      else
+        output->setValue( row, column, tile->value( tileRow, tileColumn ) );
+    }
+  }
+  return output.release();
+}
+
+std::unique_ptr< QgsRasterBlock > QgsRasterBlockCache::pyramidTile( const PyramidGrid &grid, int level, qint64 column, qint64 row, QVector< quint32 > &weights, QgsRasterBlockFeedback *feedback )
+{
+  const QByteArray key = grid.key( level, column, row );
+  std::unique_ptr< QgsRasterBlock > tile = cachedTile( key, &weights );
+  if ( tile )
+  {
+    return tile;
+  }
+
+  // the tiles of the level below covered by this tile, tiles outside of the level are missing
+  QList< QPair< int, int > > children;
+  for ( int childRow = 0; childRow < 2; ++childRow )
+  {
+    for ( int childColumn = 0; childColumn < 2; ++childColumn )
+    {
+      if ( ( column * 2 + childColumn ) * mTileSize < grid.columns( level - 1 ) && ( row * 2 + childRow ) * mTileSize < grid.rows( level - 1 ) )
+        children << qMakePair( childColumn, childRow );
+    }
+  }
+
+  // coarse levels are averaged from the level below, as are finer levels whose tiles below are cached already
+  bool fromChildren = level > PYRAMID_READ_LEVELS;
+  if ( !fromChildren && level > 1 )
+  {
+    fromChildren = true;
+    for ( int i = 0; i < children.size() && fromChildren; ++i )
+      fromChildren = isCached( grid.key( level - 1, column * 2 + children.at( i ).first, row * 2 + children.at( i ).second ) );
+  }
+
+  if ( fromChildren )
+  {
+    PyramidValues values( mTileSize * 2 );
+    std::unique_ptr< QgsRasterBlock > format;
+    for ( int i = 0; i < children.size(); ++i )
+    {
+      const int childColumn = children.at( i ).first;
+      const int childRow = children.at( i ).second;
+      QVector< quint32 > childWeights;
+      std::unique_ptr< QgsRasterBlock > child = pyramidTile( grid, level - 1, column * 2 + childColumn, row * 2 + childRow, childWeights, feedback );
+      if ( !child )
+      {
+        return nullptr;
+      }
+      addPyramidTile( values, childColumn * mTileSize, childRow * mTileSize, *child, childWeights, pyramidWeight( level - 1 ) );
+      if ( !format )
+        format = std::move( child );
+    }
+
+    tile = pyramidToTile( reducePyramid( values ), 0, 0, mTileSize, *format, pyramidWeight( level ), weights );
+    storeTile( key, *tile, weights );
+    return tile;
+  }
+
+  // the pixels of level 0 covered by the tile are read in a single block and averaged level by level,
+  // the tiles of the levels below are cached on the way
+  const qint64 footprint = static_cast< qint64 >( mTileSize ) << level;
+  const qint64 left = column * footprint;
+  const qint64 top = row * footprint;
+  const int readWidth = static_cast< int >( std::min( footprint, grid.xSize - left ) );
+  const int readHeight = static_cast< int >( std::min( footprint, grid.ySize - top ) );
+  const QgsRectangle readExtent( grid.extent.xMinimum() + left * grid.xRes, grid.extent.yMaximum() - ( top + readHeight ) * grid.yRes,
+                                 grid.extent.xMinimum() + ( left + readWidth ) * grid.xRes, grid.extent.yMaximum() - top * grid.yRes );
+  std::unique_ptr< QgsRasterBlock > block( readInput( grid.bandNo, readExtent, readWidth, readHeight, feedback ) );
+  if ( !block || !block->isValid() || block->isEmpty() || block->width() != readWidth || block->height() != readHeight )
+  {
+    return nullptr;
+  }
+  if ( feedback && feedback->isCanceled() )
+  {
+    // incomplete tiles must not be cached
+    return nullptr;
+  }
+
+  PyramidValues values = pyramidFromBlock( *block, static_cast< int >( footprint / 2 ) );
+  for ( int readLevel = 1; readLevel <= level; ++readLevel )
+  {
+    if ( readLevel > 1 )
+      values = reducePyramid( values );
+
+    const int tiles = 1 << ( level - readLevel );
+    for ( int tileRow = 0; tileRow < tiles; ++tileRow )
+    {
+      for ( int tileColumn = 0; tileColumn < tiles; ++tileColumn )
+      {
+        const qint64 levelColumn = column * tiles + tileColumn;
+        const qint64 levelRow = row * tiles + tileRow;
+        if ( levelColumn * mTileSize >= grid.columns( readLevel ) || levelRow * mTileSize >= grid.rows( readLevel ) )
+          continue;
+
+        QVector< quint32 > levelWeights;
+        tile = pyramidToTile( values, tileColumn * mTileSize, tileRow * mTileSize, mTileSize, *block, pyramidWeight( readLevel ), levelWeights );
+        storeTile( grid.key( readLevel, levelColumn, levelRow ), *tile, levelWeights );
+        if ( readLevel == level )
+          weights = levelWeights;
+      }
+    }
+  }
+  return tile;
+}
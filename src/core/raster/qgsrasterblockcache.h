@@ -0,0 +1,223 @@
+/***************************************************************************
+                         qgsrasterblockcache.h
+                         ---------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERBLOCKCACHE_H
+#define QGSRASTERBLOCKCACHE_H
+
+#include "qgis_core.h"
+#include "qgsrasterinterface.h"
+
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+class QgsRasterDataProvider;
+
+/** \ingroup core
+ * Raster pipe stage which keeps the blocks read from its input in memory.
+ *
+ * The cache is meant to directly follow the data provider. Requested blocks are
+ * assembled from tiles of tileSize() x tileSize() pixels, which are aligned to a grid
+ * starting at the top left corner of the input extent. Tiles are keyed by the band,
+ * the position of the tile and the resolution level of the request, so that panning
+ * or redrawing a layer at the same scale reads the tiles from the cache instead of
+ * the input. Tiles may be compressed to fit more of them into the cache.
+ *
+ * The caches of all layers keep their tiles in a single storage, where the tiles are also
+ * keyed by the data source of the input. The pipes cloned for rendering a layer therefore
+ * use the tiles cached by earlier renders. The least recently used tiles of all layers are
+ * discarded once the tiles take more than maximumSize() bytes.
+ *
+ * For inputs without overviews of their own, the cache can also build a mip pyramid
+ * of averaged tiles for zoomed out blocks, see setPyramidsEnabled().
+ *
+ * @note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsRasterBlockCache : public QgsRasterInterface
+{
+  public:
+
+    /**
+     * Constructor for QgsRasterBlockCache, with an empty cache.
+     */
+    QgsRasterBlockCache( QgsRasterInterface *input = nullptr );
+
+    /**
+     * Returns a copy of the cache stage, which shares the cached tiles with this one.
+     */
+    QgsRasterBlockCache *clone() const override;
+
+    int bandCount() const override;
+
+    Qgis::DataType dataType( int bandNo ) const override;
+
+    QgsRasterBlock *block( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback = nullptr ) override;
+
+    /**
+     * Sets the maximum number of \a bytes taken by the cached tiles (100 MB by default).
+     * The budget is global, it is shared by the caches of all layers. Raster layers set it
+     * from the "/Raster/blockCacheSize" setting when they are created.
+     * @see maximumSize()
+     */
+    void setMaximumSize( qint64 bytes );
+
+    /**
+     * Returns the maximum number of bytes taken by the cached tiles of all layers.
+     * @see setMaximumSize()
+     */
+    qint64 maximumSize() const;
+
+    /**
+     * Sets whether tiles are compressed before they are cached (false by default).
+     * Compressed tiles take less memory, but have to be decompressed whenever they are used.
+     * @see compressionEnabled()
+     */
+    void setCompressionEnabled( bool enabled ) { mCompressionEnabled = enabled; }
+
+    /**
+     * Returns whether tiles are compressed before they are cached.
+     * @see setCompressionEnabled()
+     */
+    bool compressionEnabled() const { return mCompressionEnabled; }
+
+    /**
+     * Sets the number of pixels in each direction of a cached tile (256 by default).
+     * @see tileSize()
+     */
+    void setTileSize( int size ) { mTileSize = size; }
+
+    /**
+     * Returns the number of pixels in each direction of a cached tile.
+     * @see setTileSize()
+     */
+    int tileSize() const { return mTileSize; }
+
+    /**
+     * Sets whether zoomed out blocks are taken from a mip pyramid (false by default).
+     * Raster layers enable the pyramid of their cache if the "/Raster/blockCachePyramids"
+     * setting is true. They only use it when drawing with a zoomed out resampler and a renderer
+     * of continuous values, i.e. not for paletted rasters or color ramps of exact or discrete classes.
+     *
+     * Each pixel of level n of the pyramid is the mean of the valid pixels of the data provider
+     * in the 2^n x 2^n pixels it covers, starting at the native resolution of the provider.
+     * Tiles of levels 1 to 3 are averaged from a single read of the provider at its native
+     * resolution, which also caches the tiles of the finer levels it covers, and tiles of
+     * level 4 are averaged from the tiles of level 3. Tiles are built lazily when a block
+     * needs them, and are cached like the other tiles.
+     *
+     * Blocks are sampled from the coarsest level which is not coarser than the requested
+     * resolution, so a following resample filter gets data at least as fine as it asked for.
+     * Blocks at less than half the native resolution or coarser than level 4 are read from
+     * the provider as usual.
+     *
+     * The pyramid is only used for numeric bands which are not paletted, and for data
+     * providers with a known size and without pyramids (overviews) of their own.
+     * @see pyramidsEnabled()
+     */
+    void setPyramidsEnabled( bool enabled ) { mPyramidsEnabled = enabled; }
+
+    /**
+     * Returns whether zoomed out blocks are taken from a mip pyramid.
+     * @see setPyramidsEnabled()
+     */
+    bool pyramidsEnabled() const { return mPyramidsEnabled; }
+
+    /**
+     * Returns the number of tiles in the cache, for all layers.
+     */
+    int tileCount() const;
+
+    /**
+     * Returns the number of bytes taken by the cached tiles of all layers. The size of
+     * each tile is rounded up to whole KiB.
+     */
+    qint64 size() const;
+
+    /**
+     * Returns the number of blocks read from the input by the cache and its clones.
+     * Adjacent tiles missing from the cache are read from the input in a single block.
+     */
+    int readCount() const;
+
+    /**
+     * Removes the tiles of the data source of the input from the cache, e.g. when its data has changed.
+     * @see clearAll()
+     */
+    void clear();
+
+    /**
+     * Removes the tiles of all layers from the cache.
+     * @see clear()
+     */
+    static void clearAll();
+
+  private:
+
+    struct Tile;
+    struct Storage;
+    struct Shared;
+    struct PyramidGrid;
+
+    //! State shared with the clones of the cache
+    std::shared_ptr< Shared > mShared;
+    bool mCompressionEnabled = false;
+    int mTileSize = 256;
+    bool mPyramidsEnabled = false;
+
+    //! Returns the storage of the tiles of all layers
+    static Storage &storage();
+
+    //! Returns the prefix of the keys of the tiles of the input
+    QString sourceKey() const;
+
+    //! Reads a block from the input, counting the reads
+    QgsRasterBlock *readInput( int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback );
+
+    /**
+     * Reads \a columns x \a rows adjacent tiles covering \a extent from the input in a single block.
+     * The tiles are returned row by row, or an empty list if they could not be read.
+     */
+    std::vector< std::unique_ptr< QgsRasterBlock > > readTiles( int bandNo, const QgsRectangle &extent, int columns, int rows, QgsRasterBlockFeedback *feedback );
+
+    //! Returns true if a tile is cached
+    bool isCached( const QByteArray &key ) const;
+
+    /**
+     * Returns a cached tile, or nullptr if it is not cached. The \a weights of the pixels
+     * of pyramid tiles are set if requested.
+     */
+    std::unique_ptr< QgsRasterBlock > cachedTile( const QByteArray &key, QVector< quint32 > *weights = nullptr );
+
+    //! Adds a tile to the cache, with the \a weights of the pixels of pyramid tiles
+    void storeTile( const QByteArray &key, QgsRasterBlock &block, const QVector< quint32 > &weights = QVector< quint32 >() );
+
+    /**
+     * Returns a block sampled from the mip pyramid of the \a provider, or nullptr if the pyramid
+     * cannot be used for the request.
+     */
+    QgsRasterBlock *pyramidBlock( QgsRasterDataProvider *provider, const QString &source, int bandNo, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback );
+
+    /**
+     * Returns a tile of a pyramid \a level, building it from the input or the level below if it
+     * is not cached. \a weights is set to the numbers of valid pixels of the input averaged into
+     * each pixel, and left empty if all valid pixels cover 4^level valid pixels of the input.
+     * Returns nullptr if it could not be built.
+     */
+    std::unique_ptr< QgsRasterBlock > pyramidTile( const PyramidGrid &grid, int level, qint64 column, qint64 row, QVector< quint32 > &weights, QgsRasterBlockFeedback *feedback );
+};
+
+#endif // QGSRASTERBLOCKCACHE_H
@@ -20,12 +20,22 @@
 #include "qgsrasterdrawer.h"
 #include "qgsrasterinterface.h"
 #include "qgsrasteriterator.h"
+#include "qgsrasterpipe.h"
+#include "qgsrasterpipepool_p.h"
 #include "qgsrasterviewport.h"
 #include "qgsmaptopixel.h"
 #include "qgsrendercontext.h"
 #include <QImage>
 #include <QPainter>
 #include <QPrinter>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+//! Maximum size of the parts of the viewport which are read in parallel
+static const int PARALLEL_PART_SIZE = 512;
 
 QgsRasterDrawer::QgsRasterDrawer( QgsRasterIterator *iterator ): mIterator( iterator )
 {
@@ -41,6 +51,25 @@ void QgsRasterDrawer::draw( QPainter *p, QgsRasterViewPort *viewPort, const QgsM
 
   // last pipe filter has only 1 band
   int bandNumber = 1;
+
+  // partial previews are drawn by the feedback from the thread reading the data, so these
+  // need the parts to be read sequentially
+  if ( mParallelRendering && !( feedback && feedback->renderPartialOutput() ) )
+  {
+    // the viewport is split into parts of a fixed size, which are usually much smaller
+    // than the tiles of the provider, so that every viewport is read by several threads
+    const int tileWidth = mIterator->maximumTileWidth();
+    const int tileHeight = mIterator->maximumTileHeight();
+    mIterator->setMaximumTileWidth( std::min( tileWidth, PARALLEL_PART_SIZE ) );
+    mIterator->setMaximumTileHeight( std::min( tileHeight, PARALLEL_PART_SIZE ) );
+    mIterator->startRasterRead( bandNumber, viewPort->mWidth, viewPort->mHeight, viewPort->mDrawnExtent, feedback );
+    const bool drawn = drawParallel( p, viewPort, qgsMapToPixel, feedback );
+    mIterator->setMaximumTileWidth( tileWidth );
+    mIterator->setMaximumTileHeight( tileHeight );
+    if ( drawn )
+      return;
+  }
+
   mIterator->startRasterRead( bandNumber, viewPort->mWidth, viewPort->mHeight, viewPort->mDrawnExtent, feedback );
 
   //number of cols/rows in output pixels
@@ -64,51 +93,128 @@ void QgsRasterDrawer::draw( QPainter *p, QgsRasterViewPort *viewPort, const QgsM
       continue;
     }
 
-    QImage img = block->image();
+    drawPart( p, viewPort, block->image(), topLeftCol, topLeftRow, qgsMapToPixel, feedback );
 
-#ifndef QT_NO_PRINTER
-    // Because of bug in Acrobat Reader we must use "white" transparent color instead
-    // of "black" for PDF. See #9101.
-    QPrinter *printer = dynamic_cast<QPrinter *>( p->device() );
-    if ( printer && printer->outputFormat() == QPrinter::PdfFormat )
+    delete block;
+
+    // ok this does not matter much anyway as the tile size quite big so most of the time
+    // there would be just one tile for the whole display area, but it won't hurt...
+    if ( feedback && feedback->isCanceled() )
+      break;
+  }
+}
+
+bool QgsRasterDrawer::drawParallel( QPainter *p, QgsRasterViewPort *viewPort, const QgsMapToPixel *qgsMapToPixel, QgsRasterBlockFeedback *feedback )
+{
+  struct Part
+  {
+    int nCols;
+    int nRows;
+    int topLeftCol;
+    int topLeftRow;
+    QgsRectangle extent;
+    QImage image;
+  };
+
+  int bandNumber = 1;
+  QVector< Part > parts;
+  Part nextPart;
+  while ( mIterator->readNextRasterPart( bandNumber, nextPart.nCols, nextPart.nRows, nextPart.topLeftCol, nextPart.topLeftRow, nextPart.extent ) )
+  {
+    parts << nextPart;
+  }
+  if ( parts.size() < 2 )
+    return false;
+
+  // the input interfaces are not thread safe, so each thread reads through its own clone of them
+  const int cloneCount = std::min( parts.size(), std::max( 1, QThread::idealThreadCount() ) );
+  std::unique_ptr< QgsRasterPipePool > clones;
+  if ( mPipePoolCache )
+    clones = mPipePoolCache->take( mIterator->input(), cloneCount );
+  else
+    clones.reset( new QgsRasterPipePool( mIterator->input(), cloneCount ) );
+  if ( clones->size() == 0 )
+    return false;
+  QgsRasterPipePool &pool = *clones;
+
+  // the parts are read in batches of one part per clone and drawn in order after each batch,
+  // so that only the images of a single batch are held in memory
+  for ( int first = 0; first < parts.size(); first += pool.size() )
+  {
+    if ( feedback && feedback->isCanceled() )
+      break;
+
+    const int last = std::min( first + pool.size(), parts.size() );
+    std::vector< int > batch;
+    for ( int i = first; i < last; ++i )
+      batch.push_back( i );
+
+    QtConcurrent::blockingMap( batch, [&]( int i )
     {
-      QgsDebugMsgLevel( "PdfFormat", 4 );
+      if ( feedback && feedback->isCanceled() )
+        return;
+
+      Part &part = parts[i];
+      const int index = pool.acquire();
+      std::unique_ptr< QgsRasterBlock > block( pool.pipe( index )->last()->block( bandNumber, part.extent, part.nCols, part.nRows, feedback ) );
+      pool.release( index );
+      if ( block )
+        part.image = block->image();
+      else
+        QgsDebugMsg( "Cannot get block" );
+    } );
 
-      img = img.convertToFormat( QImage::Format_ARGB32 );
-      QRgb transparentBlack = qRgba( 0, 0, 0, 0 );
-      QRgb transparentWhite = qRgba( 255, 255, 255, 0 );
-      for ( int x = 0; x < img.width(); x++ )
+    for ( int i = first; i < last; ++i )
+    {
+      Part &part = parts[i];
+      if ( !part.image.isNull() && !( feedback && feedback->isCanceled() ) )
+        drawPart( p, viewPort, part.image, part.topLeftCol, part.topLeftRow, qgsMapToPixel, feedback );
+      part.image = QImage();
+    }
+  }
+
+  if ( mPipePoolCache )
+    mPipePoolCache->give( std::move( clones ) );
+  return true;
+}
+
+void QgsRasterDrawer::drawPart( QPainter *p, QgsRasterViewPort *viewPort, QImage img, int topLeftCol, int topLeftRow, const QgsMapToPixel *qgsMapToPixel, QgsRasterBlockFeedback *feedback ) const
+{
+#ifndef QT_NO_PRINTER
+  // Because of bug in Acrobat Reader we must use "white" transparent color instead
+  // of "black" for PDF. See #9101.
+  QPrinter *printer = dynamic_cast<QPrinter *>( p->device() );
+  if ( printer && printer->outputFormat() == QPrinter::PdfFormat )
+  {
+    QgsDebugMsgLevel( "PdfFormat", 4 );
+
+    img = img.convertToFormat( QImage::Format_ARGB32 );
+    QRgb transparentBlack = qRgba( 0, 0, 0, 0 );
+    QRgb transparentWhite = qRgba( 255, 255, 255, 0 );
+    for ( int x = 0; x < img.width(); x++ )
+    {
+      for ( int y = 0; y < img.height(); y++ )
       {
-        for ( int y = 0; y < img.height(); y++ )
+        if ( img.pixel( x, y ) == transparentBlack )
         {
-          if ( img.pixel( x, y ) == transparentBlack )
-          {
-            img.setPixel( x, y, transparentWhite );
-          }
+          img.setPixel( x, y, transparentWhite );
         }
       }
     }
+  }
 #endif
 
-    if ( feedback && feedback->renderPartialOutput() )
-    {
-      // there could have been partial preview written before
-      // so overwrite anything with the resulting image.
-      // (we are guaranteed to have a temporary image for this layer, see QgsMapRendererJob::needTemporaryImage)
-      p->setCompositionMode( QPainter::CompositionMode_Source );
-    }
-
-    drawImage( p, viewPort, img, topLeftCol, topLeftRow, qgsMapToPixel );
-
-    delete block;
+  if ( feedback && feedback->renderPartialOutput() )
+  {
+    // there could have been partial preview written before
+    // so overwrite anything with the resulting image.
+    // (we are guaranteed to have a temporary image for this layer, see QgsMapRendererJob::needTemporaryImage)
+    p->setCompositionMode( QPainter::CompositionMode_Source );
+  }
 
-    p->setCompositionMode( QPainter::CompositionMode_SourceOver );  // go back to the default composition mode
+  drawImage( p, viewPort, img, topLeftCol, topLeftRow, qgsMapToPixel );
 
-    // ok this does not matter much anyway as the tile size quite big so most of the time
-    // there would be just one tile for the whole display area, but it won't hurt...
-    if ( feedback && feedback->isCanceled() )
-      break;
-  }
+  p->setCompositionMode( QPainter::CompositionMode_SourceOver );  // go back to the default composition mode
 }
 
 void QgsRasterDrawer::drawImage( QPainter *p, QgsRasterViewPort *viewPort, const QImage &img, int topLeftCol, int topLeftRow, const QgsMapToPixel *qgsMapToPixel ) const
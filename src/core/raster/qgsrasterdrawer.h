@@ -28,6 +28,7 @@ class QgsRenderContext;
 struct QgsRasterViewPort;
 class QgsRasterBlockFeedback;
 class QgsRasterIterator;
+class QgsRasterPipePoolCache;
 
 /** \ingroup core
  * The drawing pipe for raster layers.
@@ -45,6 +46,30 @@ class CORE_EXPORT QgsRasterDrawer
      */
     void draw( QPainter *p, QgsRasterViewPort *viewPort, const QgsMapToPixel *qgsMapToPixel, QgsRasterBlockFeedback *feedback = nullptr );
 
+    /** Sets whether the parts of the raster are read in parallel. If enabled, the parts returned by
+     * the iterator are read in a thread pool, each through its own clone of the iterator's input
+     * interfaces, and then drawn in order. Parallel reading is not used if partial output is
+     * rendered, as the preview of partially read data must be drawn from the rendering thread.
+     * Parallel reading is disabled by default.
+     * @see parallelRendering()
+     * @note added in QGIS 3.0
+     */
+    void setParallelRendering( bool enabled ) { mParallelRendering = enabled; }
+
+    /** Returns whether the parts of the raster are read in parallel.
+     * @see setParallelRendering()
+     * @note added in QGIS 3.0
+     */
+    bool parallelRendering() const { return mParallelRendering; }
+
+    /** Sets the \a cache of clones of the input interfaces used for parallel reading, so that the
+     * clones are kept between draws instead of being created for every draw. The cache must
+     * outlive the drawer.
+     * @note added in QGIS 3.0
+     * @note not available in Python bindings
+     */
+    void setPipePoolCache( QgsRasterPipePoolCache *cache ) { mPipePoolCache = cache; }
+
   protected:
 
     /** Draws raster part
@@ -60,6 +85,16 @@ class CORE_EXPORT QgsRasterDrawer
 
   private:
     QgsRasterIterator *mIterator = nullptr;
+    bool mParallelRendering = false;
+    QgsRasterPipePoolCache *mPipePoolCache = nullptr;
+
+    //! Draws the image of a raster part, converting it for PDF output if needed
+    void drawPart( QPainter *p, QgsRasterViewPort *viewPort, QImage img, int topLeftCol, int topLeftRow, const QgsMapToPixel *mapToPixel, QgsRasterBlockFeedback *feedback ) const;
+
+    /** Reads the parts of the raster in parallel and draws them. Returns false without drawing anything
+     * if there is a single part only or the input interfaces cannot be cloned.
+     */
+    bool drawParallel( QPainter *p, QgsRasterViewPort *viewPort, const QgsMapToPixel *mapToPixel, QgsRasterBlockFeedback *feedback );
 };
 
 #endif // QGSRASTERDRAWER_H
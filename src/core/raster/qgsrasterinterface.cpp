@@ -15,12 +15,18 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <algorithm>
 #include <limits>
+#include <memory>
 #include <typeinfo>
+#include <vector>
 
 #include <QByteArray>
+#include <QMutex>
+#include <QThread>
 #include <QTime>
 #include <QStringList>
+#include <QtConcurrentMap>
 
 #include <qmath.h>
 
@@ -28,6 +34,8 @@
 #include "qgsrasterbandstats.h"
 #include "qgsrasterhistogram.h"
 #include "qgsrasterinterface.h"
+#include "qgsrasterpipe.h"
+#include "qgsrasterpipepool_p.h"
 #include "qgsrectangle.h"
 
 QgsRasterInterface::QgsRasterInterface( QgsRasterInterface *input )
@@ -566,6 +574,149 @@ void QgsRasterInterface::cumulativeCut( int bandNo,
   }
 }
 
+QgsRasterQuantileSketch QgsRasterInterface::quantileSketch( int bandNo,
+    double rankError,
+    const QgsRectangle &extent,
+    int sampleSize,
+    QgsRasterBlockFeedback *feedback )
+{
+  QgsDebugMsgLevel( QString( "theBandNo = %1 rankError = %2 sampleSize = %3" ).arg( bandNo ).arg( rankError ).arg( sampleSize ), 4 );
+
+  // the band stats only describe the cells the sketch is computed from
+  QgsRasterBandStats myRasterBandStats;
+  initStatistics( myRasterBandStats, bandNo, QgsRasterBandStats::None, extent, sampleSize );
+
+  for ( const auto &cached : mQuantileSketches )
+  {
+    if ( cached.first.bandNumber == bandNo && cached.first.extent == myRasterBandStats.extent
+         && cached.first.width == myRasterBandStats.width && cached.first.height == myRasterBandStats.height
+         && cached.second.rankError() <= rankError )
+    {
+      QgsDebugMsgLevel( "Using cached quantile sketch.", 4 );
+      return cached.second;
+    }
+  }
+
+  QgsRectangle myExtent = myRasterBandStats.extent;
+  int myWidth = myRasterBandStats.width;
+  int myHeight = myRasterBandStats.height;
+
+  int myXBlockSize = xBlockSize();
+  int myYBlockSize = yBlockSize();
+  if ( myXBlockSize == 0 ) // should not happen, but happens
+  {
+    myXBlockSize = 500;
+  }
+  if ( myYBlockSize == 0 ) // should not happen, but happens
+  {
+    myYBlockSize = 500;
+  }
+
+  int myNXBlocks = ( myWidth + myXBlockSize - 1 ) / myXBlockSize;
+  int myNYBlocks = ( myHeight + myYBlockSize - 1 ) / myYBlockSize;
+
+  double myXRes = myExtent.width() / myWidth;
+  double myYRes = myExtent.height() / myHeight;
+
+  struct Part
+  {
+    QgsRectangle extent;
+    int width;
+    int height;
+  };
+  QVector< Part > parts;
+  for ( int myYBlock = 0; myYBlock < myNYBlocks; myYBlock++ )
+  {
+    for ( int myXBlock = 0; myXBlock < myNXBlocks; myXBlock++ )
+    {
+      Part part;
+      part.width = qMin( myXBlockSize, myWidth - myXBlock * myXBlockSize );
+      part.height = qMin( myYBlockSize, myHeight - myYBlock * myYBlockSize );
+
+      double xmin = myExtent.xMinimum() + myXBlock * myXBlockSize * myXRes;
+      double xmax = xmin + part.width * myXRes;
+      double ymin = myExtent.yMaximum() - myYBlock * myYBlockSize * myYRes;
+      double ymax = ymin - part.height * myYRes;
+      part.extent = QgsRectangle( xmin, ymin, xmax, ymax );
+      parts << part;
+    }
+  }
+
+  // values of these types are converted to floats in bulk without losing precision
+  const Qgis::DataType type = dataType( bandNo );
+  const bool useFloatValues = type == Qgis::Byte || type == Qgis::UInt16 || type == Qgis::Int16 || type == Qgis::Float32;
+  auto addPart = [bandNo, useFloatValues, feedback]( QgsRasterInterface * input, const Part & part, QgsRasterQuantileSketch & sketch )
+  {
+    std::unique_ptr< QgsRasterBlock > blk( input->block( bandNo, part.extent, part.width, part.height, feedback ) );
+    if ( !blk )
+      return;
+
+    if ( useFloatValues )
+    {
+      const QVector<float> values = blk->valuesAsFloat();
+      sketch.add( values.constData(), values.size() );
+      return;
+    }
+    for ( qgssize i = 0; i < ( static_cast< qgssize >( part.height ) ) * part.width; i++ )
+    {
+      if ( blk->isNoData( i ) ) continue; // NULL
+      sketch.add( blk->value( i ) );
+    }
+  };
+
+  // the interfaces are not thread safe, so each thread reads through its own clone of them
+  // and fills the sketch of its clone, the sketches are merged at the end
+  const int workerCount = std::min( parts.size(), QThread::idealThreadCount() );
+  std::unique_ptr< QgsRasterPipePool > pool;
+  if ( workerCount > 1 )
+    pool.reset( new QgsRasterPipePool( this, workerCount ) );
+
+  QgsRasterQuantileSketch sketch( rankError );
+  if ( pool && pool->size() > 1 )
+  {
+    std::vector< QgsRasterQuantileSketch > sketches( pool->size(), QgsRasterQuantileSketch( rankError ) );
+    QMutex progressMutex;
+    int partsDone = 0;
+
+    QtConcurrent::blockingMap( parts, [&]( const Part & part )
+    {
+      if ( feedback && feedback->isCanceled() )
+        return;
+
+      const int index = pool->acquire();
+      addPart( pool->pipe( index )->last(), part, sketches[index] );
+      pool->release( index );
+
+      QMutexLocker locker( &progressMutex );
+      if ( feedback )
+        feedback->setProgress( 100.0 * ++partsDone / parts.size() );
+    } );
+
+    for ( const QgsRasterQuantileSketch &workerSketch : sketches )
+      sketch.merge( workerSketch );
+  }
+  else
+  {
+    for ( int i = 0; i < parts.size(); ++i )
+    {
+      if ( feedback && feedback->isCanceled() )
+        break;
+
+      addPart( this, parts.at( i ), sketch );
+      if ( feedback )
+        feedback->setProgress( 100.0 * ( i + 1 ) / parts.size() );
+    }
+  }
+
+  QgsDebugMsgLevel( QString( "count = %1 retained = %2" ).arg( sketch.count() ).arg( sketch.retainedCount() ), 4 );
+
+  if ( !feedback || !feedback->isCanceled() )
+  {
+    mQuantileSketches.append( qMakePair( myRasterBandStats, sketch ) );
+  }
+  return sketch;
+}
+
 QString QgsRasterInterface::capabilitiesString() const
 {
   QStringList abilitiesList;
@@ -23,11 +23,13 @@
 
 #include <QCoreApplication> // for tr()
 #include <QImage>
+#include <QPair>
 
 #include "qgsfeedback.h"
 #include "qgsrasterbandstats.h"
 #include "qgsrasterblock.h"
 #include "qgsrasterhistogram.h"
+#include "qgsrasterquantilesketch.h"
 #include "qgsrectangle.h"
 
 /** \ingroup core
@@ -254,6 +256,23 @@ class CORE_EXPORT QgsRasterInterface
                                 const QgsRectangle &extent = QgsRectangle(),
                                 int sampleSize = 0 );
 
+    /** \brief Get a sketch of the values of a band, which answers quantile queries approximately.
+     * The sketch is computed in a single pass. Where the interface and its inputs can be cloned,
+     * the blocks of the band are read and summarized in parallel, each thread reading through its
+     * own clones. Sketches are cached like statistics.
+     * @param bandNo The band (number).
+     * @param rankError Maximum normalized rank error of quantiles, e.g. 0.01 for 1%.
+     * @param extent Extent used to calc the sketch, if empty, whole raster extent is used.
+     * @param sampleSize Approximate number of cells in sample. If 0, all cells (whole raster will be used).
+     * @param feedback optional feedback object for cancelation and progress. Sketches of canceled runs are not cached.
+     * @note added in QGIS 3.0
+     */
+    QgsRasterQuantileSketch quantileSketch( int bandNo,
+                                            double rankError = 0.01,
+                                            const QgsRectangle &extent = QgsRectangle(),
+                                            int sampleSize = 0,
+                                            QgsRasterBlockFeedback *feedback = nullptr );
+
     //! Write base class members to xml.
     virtual void writeXml( QDomDocument &doc, QDomElement &parentElem ) const { Q_UNUSED( doc ); Q_UNUSED( parentElem ); }
     //! Sets base class members from xml. Usually called from create() methods of subclasses
@@ -269,6 +288,9 @@ class CORE_EXPORT QgsRasterInterface
     //! \brief List  of cached histograms, all bands mixed
     QList <QgsRasterHistogram> mHistograms;
 
+    //! \brief List of cached quantile sketches with the band, extent and size they were computed for, all bands mixed
+    QList< QPair< QgsRasterBandStats, QgsRasterQuantileSketch > > mQuantileSketches;
+
     // On/off state, if off, it does not do anything, replicates input
     bool mOn;
 
@@ -66,6 +66,22 @@ bool QgsRasterIterator::readNextRasterPart( int bandNumber,
 {
   QgsDebugMsgLevel( "Entered", 4 );
   *block = nullptr;
+
+  QgsRectangle blockRect;
+  if ( !readNextRasterPart( bandNumber, nCols, nRows, topLeftCol, topLeftRow, blockRect ) )
+  {
+    return false;
+  }
+
+  *block = mInput->block( bandNumber, blockRect, nCols, nRows, mFeedback );
+  return true;
+}
+
+bool QgsRasterIterator::readNextRasterPart( int bandNumber,
+    int &nCols, int &nRows,
+    int &topLeftCol, int &topLeftRow,
+    QgsRectangle &blockExtent )
+{
   //get partinfo
   QMap<int, RasterPartInfo>::iterator partIt = mRasterPartInfos.find( bandNumber );
   if ( partIt == mRasterPartInfos.end() )
@@ -104,9 +120,8 @@ bool QgsRasterIterator::readNextRasterPart( int bandNumber,
   double ymin = pInfo.currentRow + nRows == pInfo.nRows ? viewPortExtent.yMinimum() :  // avoid extra FP math if not necessary
                 viewPortExtent.yMaximum() - ( pInfo.currentRow + nRows ) / static_cast< double >( pInfo.nRows ) * viewPortExtent.height();
   double ymax = viewPortExtent.yMaximum() - pInfo.currentRow / static_cast< double >( pInfo.nRows ) * viewPortExtent.height();
-  QgsRectangle blockRect( xmin, ymin, xmax, ymax );
+  blockExtent = QgsRectangle( xmin, ymin, xmax, ymax );
 
-  *block = mInput->block( bandNumber, blockRect, nCols, nRows, mFeedback );
   topLeftCol = pInfo.currentCol;
   topLeftRow = pInfo.currentRow;
 
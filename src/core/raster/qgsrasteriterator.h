@@ -58,6 +58,23 @@ class CORE_EXPORT QgsRasterIterator
                              QgsRasterBlock **block,
                              int &topLeftCol, int &topLeftRow );
 
+    /** Fetches the position and extent of the next part of raster data without reading it,
+       so that the part can be read later, e.g. from another thread.
+       @param bandNumber band to read
+       @param nCols number of columns on output device
+       @param nRows number of rows on output device
+       @param topLeftCol top left column
+       @param topLeftRow top left row
+       @param blockExtent extent of the part
+       @return false if the last part was already returned
+       @note added in QGIS 3.0
+       @note not available in python bindings
+     */
+    bool readNextRasterPart( int bandNumber,
+                             int &nCols, int &nRows,
+                             int &topLeftCol, int &topLeftRow,
+                             QgsRectangle &blockExtent );
+
     void stopRasterRead( int bandNumber );
 
     const QgsRasterInterface *input() const { return mInput; }
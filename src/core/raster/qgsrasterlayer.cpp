@@ -30,6 +30,8 @@ email                : tim at linfiniti.com
 #include "qgspalettedrasterrenderer.h"
 #include "qgsprojectfiletransform.h"
 #include "qgsproviderregistry.h"
+#include "qgsrasterblockcache.h"
+#include "qgsrasterpipepool_p.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsrasterdrawer.h"
 #include "qgsrasteriterator.h"
@@ -237,6 +239,12 @@ void QgsRasterLayer::reload()
   {
     mDataProvider->reloadData();
   }
+  if ( mPipe.blockCache() )
+  {
+    mPipe.blockCache()->clear();
+  }
+  // the clones of the provider do not see the reloaded data
+  mPipePools.reset( new QgsRasterPipePoolCache() );
 }
 
 QgsMapLayerRenderer *QgsRasterLayer::createMapRenderer( QgsRenderContext &rendererContext )
@@ -610,6 +618,7 @@ void QgsRasterLayer::setDataProvider( QString const &provider )
 
   mPipe.remove( mDataProvider ); // deletes if exists
   mDataProvider = nullptr;
+  mPipePools.reset( new QgsRasterPipePoolCache() );
 
   // XXX should I check for and possibly delete any pre-existing providers?
   // XXX How often will that scenario occur?
@@ -772,6 +781,23 @@ void QgsRasterLayer::setDataProvider( QString const &provider )
   QgsRasterProjector *projector = new QgsRasterProjector;
   mPipe.set( projector );
 
+  // block cache (directly follows the provider), so that redrawing the layer reads the data
+  // from memory. The budget in bytes is shared by all layers, it is configurable and 0 disables
+  // the cache. Zoomed out blocks of providers without overviews can be averaged in the mip pyramid of the cache
+  QgsSettings settings;
+  QgsRasterBlockCache *blockCache = new QgsRasterBlockCache();
+  const qint64 blockCacheSize = settings.value( QStringLiteral( "/Raster/blockCacheSize" ), Q_INT64_C( 100 ) * 1024 * 1024 ).toLongLong();
+  if ( blockCacheSize > 0 )
+  {
+    blockCache->setMaximumSize( blockCacheSize );
+    blockCache->setPyramidsEnabled( settings.value( QStringLiteral( "/Raster/blockCachePyramids" ), false ).toBool() );
+    mPipe.set( blockCache );
+  }
+  else
+  {
+    delete blockCache;
+  }
+
   // Set default identify format - use the richest format available
   int capabilities = mDataProvider->capabilities();
   QgsRaster::IdentifyFormat identifyFormat = QgsRaster::IdentifyFormatUndefined;
@@ -845,7 +871,26 @@ void QgsRasterLayer::computeMinMax( int band,
     const double myLower = mmo.cumulativeCutLower();
     const double myUpper = mmo.cumulativeCutUpper();
     QgsDebugMsgLevel( QString( "myLower = %1 myUpper = %2" ).arg( myLower ).arg( myUpper ), 4 );
-    mDataProvider->cumulativeCut( band, myLower, myUpper, min, max, extent, sampleSize );
+    if ( mmo.quantileRankError() > 0 )
+    {
+      // single pass over the raster, instead of statistics followed by a histogram
+      QgsRasterQuantileSketch sketch = mDataProvider->quantileSketch( band, mmo.quantileRankError(), extent, sampleSize );
+      min = sketch.quantile( myLower );
+      max = sketch.quantile( myUpper );
+
+      // fix integer data - round down/up, as QgsRasterInterface::cumulativeCut() does
+      Qgis::DataType dataType = mDataProvider->sourceDataType( band );
+      if ( dataType == Qgis::Byte || dataType == Qgis::Int16 || dataType == Qgis::Int32 ||
+           dataType == Qgis::UInt16 || dataType == Qgis::UInt32 )
+      {
+        min = std::floor( min );
+        max = std::ceil( max );
+      }
+    }
+    else
+    {
+      mDataProvider->cumulativeCut( band, myLower, myUpper, min, max, extent, sampleSize );
+    }
   }
   QgsDebugMsgLevel( QString( "band = %1 min = %2 max = %3" ).arg( band ).arg( min ).arg( max ), 4 );
 
@@ -29,6 +29,8 @@
 #include <QPair>
 #include <QVector>
 
+#include <memory>
+
 #include "qgis.h"
 #include "qgsmaplayer.h"
 #include "qgsraster.h"
@@ -39,6 +41,7 @@
 
 class QgsMapToPixel;
 class QgsRasterRenderer;
+class QgsRasterPipePoolCache;
 class QgsRectangle;
 class QImage;
 class QLibrary;
@@ -425,6 +428,11 @@ class CORE_EXPORT QgsRasterLayer : public QgsMapLayer
 
     QgsRasterPipe mPipe;
 
+    //! Clones of the pipe for reading in parallel, kept between renderings of the layer
+    std::shared_ptr< QgsRasterPipePoolCache > mPipePools;
+
+    friend class QgsRasterLayerRenderer;
+
     //! To save computations and possible infinite cycle of notifications
     QgsRectangle mLastRectangleUsedByRefreshContrastEnhancementIfNeeded;
 };
@@ -16,14 +16,45 @@
 #include "qgsrasterlayerrenderer.h"
 
 #include "qgsmessagelog.h"
+#include "qgsrasterblockcache.h"
 #include "qgsrasterdataprovider.h"
 #include "qgsrasterdrawer.h"
 #include "qgsrasteriterator.h"
 #include "qgsrasterlayer.h"
 #include "qgsrasterprojector.h"
+#include "qgsrasterresamplefilter.h"
+#include "qgsrastershader.h"
+#include "qgscolorrampshader.h"
+#include "qgsmultibandcolorrenderer.h"
+#include "qgssinglebandgrayrenderer.h"
+#include "qgssinglebandpseudocolorrenderer.h"
 #include "qgsrendercontext.h"
 #include "qgscsexception.h"
 
+namespace
+{
+  // Returns true if zoomed out blocks drawn by a pipe may be averaged in the pyramid of its block cache.
+  // The averaged values would mix the codes of classes drawn by paletted or classified renderers, and
+  // would replace the nearest neighbour resampling used when there is no zoomed out resampler
+  bool canUsePyramids( const QgsRasterPipe *pipe )
+  {
+    const QgsRasterResampleFilter *resampleFilter = pipe->resampleFilter();
+    if ( !resampleFilter || !resampleFilter->zoomedOutResampler() )
+      return false;
+
+    const QgsRasterRenderer *renderer = pipe->renderer();
+    if ( dynamic_cast< const QgsSingleBandGrayRenderer * >( renderer ) || dynamic_cast< const QgsMultiBandColorRenderer * >( renderer ) )
+      return true;
+
+    // only interpolated color ramps are continuous
+    const QgsSingleBandPseudoColorRenderer *pseudoColorRenderer = dynamic_cast< const QgsSingleBandPseudoColorRenderer * >( renderer );
+    if ( !pseudoColorRenderer || !pseudoColorRenderer->shader() )
+      return false;
+    const QgsColorRampShader *rampShader = dynamic_cast< const QgsColorRampShader * >( pseudoColorRenderer->shader()->rasterShaderFunction() );
+    return rampShader && rampShader->colorRampType() == QgsColorRampShader::Interpolated;
+  }
+}
+
 QgsRasterLayerRenderer::QgsRasterLayerRenderer( QgsRasterLayer *layer, QgsRenderContext &rendererContext )
   : QgsMapLayerRenderer( layer->id() )
   , mRasterViewPort( nullptr )
@@ -177,6 +208,12 @@ QgsRasterLayerRenderer::QgsRasterLayerRenderer( QgsRasterLayer *layer, QgsRender
 
   // copy the whole raster pipe!
   mPipe = new QgsRasterPipe( *layer->pipe() );
+  mPipePools = layer->mPipePools;
+  QgsRasterBlockCache *blockCache = mPipe->blockCache();
+  if ( blockCache && blockCache->pyramidsEnabled() && !canUsePyramids( mPipe ) )
+  {
+    blockCache->setPyramidsEnabled( false );
+  }
   QgsRasterRenderer *rasterRenderer = mPipe->renderer();
   if ( rasterRenderer )
     layer->refreshRendererIfNeeded( rasterRenderer, rendererContext.extent() );
@@ -218,6 +255,8 @@ bool QgsRasterLayerRenderer::render()
   // Drawer to pipe?
   QgsRasterIterator iterator( mPipe->last() );
   QgsRasterDrawer drawer( &iterator );
+  drawer.setParallelRendering( true );
+  drawer.setPipePoolCache( mPipePools.get() );
   drawer.draw( mPainter, mRasterViewPort, mMapToPixel, mFeedback );
 
   QgsDebugMsgLevel( QString( "total raster draw time (ms):     %1" ).arg( time.elapsed(), 5 ), 4 );
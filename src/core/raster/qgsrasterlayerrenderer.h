@@ -24,6 +24,7 @@ class QgsMapToPixel;
 class QgsRasterBlockFeedback;
 class QgsRasterLayer;
 class QgsRasterPipe;
+class QgsRasterPipePoolCache;
 struct QgsRasterViewPort;
 class QgsRenderContext;
 
@@ -31,6 +32,8 @@ class QgsRasterLayerRenderer;
 
 #include "qgsrasterinterface.h"
 
+#include <memory>
+
 
 /** \ingroup core
  * Implementation of threaded rendering for raster layers.
@@ -57,6 +60,9 @@ class QgsRasterLayerRenderer : public QgsMapLayerRenderer
     QgsRasterPipe *mPipe = nullptr;
     QgsRenderContext &mContext;
 
+    //! Clones of the layer's pipe for reading in parallel, shared with other renderings of the layer
+    std::shared_ptr< QgsRasterPipePoolCache > mPipePools;
+
     /** \ingroup core
      * Specific internal feedback class to provide preview of raster layer rendering.
      * @note added in 3.0
@@ -42,7 +42,8 @@ bool QgsRasterMinMaxOrigin::operator ==( const QgsRasterMinMaxOrigin &other ) co
          mAccuracy == other.mAccuracy &&
          qAbs( mCumulativeCutLower - other.mCumulativeCutLower ) < 1e-5 &&
          qAbs( mCumulativeCutUpper - other.mCumulativeCutUpper ) < 1e-5 &&
-         qAbs( mStdDevFactor - other.mStdDevFactor ) < 1e-5;
+         qAbs( mStdDevFactor - other.mStdDevFactor ) < 1e-5 &&
+         qAbs( mQuantileRankError - other.mQuantileRankError ) < 1e-5;
 }
 
 QString QgsRasterMinMaxOrigin::limitsString( Limits limits )
@@ -163,6 +164,15 @@ void QgsRasterMinMaxOrigin::writeXml( QDomDocument &doc, QDomElement &parentElem
   QDomText stdDevFactorText = doc.createTextNode( QString::number( mStdDevFactor ) );
   stdDevFactorElem.appendChild( stdDevFactorText );
   parentElem.appendChild( stdDevFactorElem );
+
+  // mQuantileRankError
+  if ( mQuantileRankError > 0 )
+  {
+    QDomElement quantileRankErrorElem = doc.createElement( QStringLiteral( "quantileRankError" ) );
+    QDomText quantileRankErrorText = doc.createTextNode( QString::number( mQuantileRankError ) );
+    quantileRankErrorElem.appendChild( quantileRankErrorText );
+    parentElem.appendChild( quantileRankErrorElem );
+  }
 }
 
 void QgsRasterMinMaxOrigin::readXml( const QDomElement &elem )
@@ -202,4 +212,10 @@ void QgsRasterMinMaxOrigin::readXml( const QDomElement &elem )
   {
     mStdDevFactor = stdDevFactorElem.text().toDouble();
   }
+
+  QDomElement quantileRankErrorElem = elem.firstChildElement( QStringLiteral( "quantileRankError" ) );
+  if ( !quantileRankErrorElem.isNull() )
+  {
+    mQuantileRankError = quantileRankErrorElem.text().toDouble();
+  }
 }
@@ -100,6 +100,12 @@ class CORE_EXPORT QgsRasterMinMaxOrigin
     //! \brief Return factor f so that the min/max range is [ mean - f * stddev , mean + f * stddev ]
     double stdDevFactor() const { return mStdDevFactor; }
 
+    /** \brief Return the maximum rank error of the quantile sketch used for the cumulative cut, or 0 if a histogram is used.
+     * @see setQuantileRankError()
+     * @note added in QGIS 3.0
+     */
+    double quantileRankError() const { return mQuantileRankError; }
+
     //////// Setter methods /////////////////////
 
     //! \brief Set limits.
@@ -120,6 +126,16 @@ class CORE_EXPORT QgsRasterMinMaxOrigin
     //! \brief Set factor f so that the min/max range is [ mean - f * stddev , mean + f * stddev ]
     void setStdDevFactor( double val ) { mStdDevFactor = val; }
 
+    /** \brief Set the maximum rank \a error (between 0 and 1) of the quantile sketch used for the cumulative cut.
+     * With a sketch, the cut is computed in a single parallel pass over the raster, which is cached by the
+     * data provider, and the cut values are within \a error of the requested fractions. If 0 (the default),
+     * the cut is computed from a histogram with QgsRasterInterface::cumulativeCut().
+     * @see quantileRankError()
+     * @see QgsRasterInterface::quantileSketch()
+     * @note added in QGIS 3.0
+     */
+    void setQuantileRankError( double error ) { mQuantileRankError = error; }
+
     //////// XML serialization /////////////////////
 
     //! \brief Serialize object.
@@ -156,6 +172,7 @@ class CORE_EXPORT QgsRasterMinMaxOrigin
     double mCumulativeCutLower;
     double mCumulativeCutUpper;
     double mStdDevFactor;
+    double mQuantileRankError = 0;
 };
 
 #endif // QGSRASTERMINMAXORIGIN_H
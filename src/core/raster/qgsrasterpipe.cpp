@@ -28,6 +28,7 @@
 #include "qgshuesaturationfilter.h"
 #include "qgsrasterprojector.h"
 #include "qgsrasternuller.h"
+#include "qgsrasterblockcache.h"
 
 QgsRasterPipe::QgsRasterPipe()
 {
@@ -97,7 +98,8 @@ bool QgsRasterPipe::insert( int idx, QgsRasterInterface *interface )
   {
     success = true;
     mInterfaces.insert( idx, interface );
-    setRole( interface, idx );
+    // the following interfaces moved, e.g. when a cache is inserted after the provider
+    updateRoles();
     QgsDebugMsgLevel( "inserted ok", 4 );
   }
 
@@ -143,6 +145,7 @@ QgsRasterPipe::Role QgsRasterPipe::interfaceRole( QgsRasterInterface *interface
   else if ( dynamic_cast<QgsHueSaturationFilter *>( interface ) ) role = HueSaturationRole;
   else if ( dynamic_cast<QgsRasterProjector *>( interface ) ) role = ProjectorRole;
   else if ( dynamic_cast<QgsRasterNuller *>( interface ) ) role = NullerRole;
+  else if ( dynamic_cast<QgsRasterBlockCache *>( interface ) ) role = CacheRole;
 
   QgsDebugMsgLevel( QString( "%1 role = %2" ).arg( typeid( *interface ).name() ).arg( role ), 4 );
   return role;
@@ -155,6 +158,15 @@ void QgsRasterPipe::setRole( QgsRasterInterface *interface, int idx )
   mRoleMap.insert( role, idx );
 }
 
+void QgsRasterPipe::updateRoles()
+{
+  mRoleMap.clear();
+  for ( int i = 0; i < mInterfaces.size(); i++ )
+  {
+    setRole( mInterfaces.at( i ), i );
+  }
+}
+
 void QgsRasterPipe::unsetRole( QgsRasterInterface *interface )
 {
   Role role = interfaceRole( interface );
@@ -184,11 +196,13 @@ bool QgsRasterPipe::set( QgsRasterInterface *interface )
 
   // Not found, find the best default position for this kind of interface
   //   QgsRasterDataProvider  - ProviderRole
+  //   QgsRasterBlockCache    - CacheRole
   //   QgsRasterRenderer      - RendererRole
   //   QgsRasterResampler     - ResamplerRole
   //   QgsRasterProjector     - ProjectorRole
 
   int providerIdx = mRoleMap.value( ProviderRole, -1 );
+  int cacheIdx = mRoleMap.value( CacheRole, -1 );
   int rendererIdx = mRoleMap.value( RendererRole, -1 );
   int resamplerIdx = mRoleMap.value( ResamplerRole, -1 );
   int brightnessIdx = mRoleMap.value( BrightnessRole, -1 );
@@ -198,25 +212,29 @@ bool QgsRasterPipe::set( QgsRasterInterface *interface )
   {
     idx = 0;
   }
+  else if ( role == CacheRole )
+  {
+    idx = providerIdx + 1;
+  }
   else if ( role == RendererRole )
   {
-    idx =  providerIdx + 1;
+    idx =  qMax( providerIdx, cacheIdx ) + 1;
   }
   else if ( role == BrightnessRole )
   {
-    idx =  qMax( providerIdx, rendererIdx ) + 1;
+    idx =  qMax( qMax( providerIdx, cacheIdx ), rendererIdx ) + 1;
   }
   else if ( role == HueSaturationRole )
   {
-    idx =  qMax( qMax( providerIdx, rendererIdx ), brightnessIdx ) + 1;
+    idx =  qMax( qMax( qMax( providerIdx, cacheIdx ), rendererIdx ), brightnessIdx ) + 1;
   }
   else if ( role == ResamplerRole )
   {
-    idx = qMax( qMax( qMax( providerIdx, rendererIdx ), brightnessIdx ), hueSaturationIdx ) + 1;
+    idx = qMax( qMax( qMax( qMax( providerIdx, cacheIdx ), rendererIdx ), brightnessIdx ), hueSaturationIdx ) + 1;
   }
   else if ( role == ProjectorRole )
   {
-    idx = qMax( qMax( qMax( qMax( providerIdx, rendererIdx ), brightnessIdx ), hueSaturationIdx ), resamplerIdx )  + 1;
+    idx = qMax( qMax( qMax( qMax( qMax( providerIdx, cacheIdx ), rendererIdx ), brightnessIdx ), hueSaturationIdx ), resamplerIdx )  + 1;
   }
 
   return insert( idx, interface );  // insert may still fail and return false
@@ -267,6 +285,11 @@ QgsRasterNuller *QgsRasterPipe::nuller() const
   return dynamic_cast<QgsRasterNuller *>( interface( NullerRole ) );
 }
 
+QgsRasterBlockCache *QgsRasterPipe::blockCache() const
+{
+  return dynamic_cast<QgsRasterBlockCache *>( interface( CacheRole ) );
+}
+
 bool QgsRasterPipe::remove( int idx )
 {
   QgsDebugMsgLevel( QString( "remove at %1" ).arg( idx ), 4 );
@@ -282,9 +305,9 @@ bool QgsRasterPipe::remove( int idx )
   if ( connect( interfaces ) )
   {
     success = true;
-    unsetRole( mInterfaces.at( idx ) );
     delete mInterfaces.at( idx );
     mInterfaces.remove( idx );
+    updateRoles();
     QgsDebugMsgLevel( "removed ok", 4 );
   }
 
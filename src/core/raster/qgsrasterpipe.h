@@ -30,6 +30,7 @@ class QgsBrightnessContrastFilter;
 class QgsHueSaturationFilter;
 class QgsRasterProjector;
 class QgsRasterNuller;
+class QgsRasterBlockCache;
 class QgsRasterResampleFilter;
 class QgsContrastEnhancement;
 class QgsRasterDataProvider;
@@ -54,7 +55,8 @@ class CORE_EXPORT QgsRasterPipe
       ResamplerRole = 4,
       ProjectorRole = 5,
       NullerRole = 6,
-      HueSaturationRole = 7
+      HueSaturationRole = 7,
+      CacheRole = 8 //!< Block cache, added in QGIS 3.0
     };
 
     QgsRasterPipe();
@@ -74,8 +76,8 @@ class CORE_EXPORT QgsRasterPipe
 
     /** Insert a new known interface in default place or replace interface of the same
      * role if it already exists. Known interfaces are: QgsRasterDataProvider,
-     * QgsRasterRenderer, QgsRasterResampleFilter, QgsRasterProjector and their
-     * subclasses. For unknown interfaces it mus be explicitly specified position
+     * QgsRasterBlockCache, QgsRasterRenderer, QgsRasterResampleFilter, QgsRasterProjector
+     * and their subclasses. For unknown interfaces it mus be explicitly specified position
      * where it should be inserted using insert() method.
      */
     bool set( QgsRasterInterface *interface );
@@ -106,6 +108,11 @@ class CORE_EXPORT QgsRasterPipe
     QgsRasterProjector *projector() const;
     QgsRasterNuller *nuller() const;
 
+    /** Returns the block cache following the provider, or nullptr if the pipe has none.
+     * @note added in QGIS 3.0
+     */
+    QgsRasterBlockCache *blockCache() const;
+
   private:
     //! Get known parent type_info of interface parent
     Role interfaceRole( QgsRasterInterface *iface ) const;
@@ -118,6 +125,9 @@ class CORE_EXPORT QgsRasterPipe
     // Set role in mRoleMap
     void setRole( QgsRasterInterface *interface, int idx );
 
+    // Set the roles of all interfaces in mRoleMap
+    void updateRoles();
+
     // Unset role in mRoleMap
     void unsetRole( QgsRasterInterface *interface );
 
@@ -0,0 +1,152 @@
+/***************************************************************************
+                         qgsrasterpipepool.cpp
+                         ---------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrasterpipepool_p.h"
+#include "qgsrasterdataprovider.h"
+#include "qgsrasterinterface.h"
+#include "qgsrasterpipe.h"
+#include "qgslogger.h"
+
+#include <QMutexLocker>
+
+/// @cond PRIVATE
+
+QgsRasterPipe *QgsRasterPipePool::clonePipe( const QgsRasterInterface *interface )
+{
+  QList< const QgsRasterInterface * > interfaces;
+  for ( const QgsRasterInterface *ri = interface; ri; ri = ri->input() )
+  {
+    interfaces.prepend( ri );
+  }
+
+  std::unique_ptr< QgsRasterPipe > pipe( new QgsRasterPipe() );
+  Q_FOREACH ( const QgsRasterInterface *ri, interfaces )
+  {
+    QgsRasterInterface *clone = ri->clone();
+    if ( !clone || !pipe->insert( pipe->size(), clone ) )
+    {
+      QgsDebugMsg( "Cannot clone raster interface" );
+      delete clone;
+      return nullptr;
+    }
+  }
+  return pipe.release();
+}
+
+QgsRasterPipePool::QgsRasterPipePool( const QgsRasterInterface *interface, int count )
+{
+  addClones( interface, count );
+}
+
+bool QgsRasterPipePool::update( const QgsRasterInterface *interface, int count )
+{
+  QList< const QgsRasterInterface * > interfaces;
+  for ( const QgsRasterInterface *ri = interface; ri; ri = ri->input() )
+  {
+    interfaces.prepend( ri );
+  }
+
+  const QgsRasterDataProvider *provider = dynamic_cast< const QgsRasterDataProvider * >( interfaces.first() );
+  for ( const std::unique_ptr< QgsRasterPipe > &pipe : mPipes )
+  {
+    // the settings of the provider which may change without changing the data source
+    if ( QgsRasterDataProvider *providerClone = dynamic_cast< QgsRasterDataProvider * >( pipe->at( 0 ) ) )
+    {
+      if ( !provider )
+        return false;
+      providerClone->setDpi( provider->dpi() );
+      for ( int band = 1; band <= provider->bandCount(); ++band )
+      {
+        providerClone->setUseSourceNoDataValue( band, provider->useSourceNoDataValue( band ) );
+        providerClone->setUserNoDataValue( band, provider->userNoDataValues( band ) );
+      }
+    }
+
+    // all other interfaces are cheap to clone
+    while ( pipe->size() > 1 )
+    {
+      if ( !pipe->remove( pipe->size() - 1 ) )
+        return false;
+    }
+    for ( int i = 1; i < interfaces.size(); ++i )
+    {
+      QgsRasterInterface *clone = interfaces.at( i )->clone();
+      if ( !clone || !pipe->insert( pipe->size(), clone ) )
+      {
+        QgsDebugMsg( "Cannot clone raster interface" );
+        delete clone;
+        return false;
+      }
+    }
+  }
+
+  addClones( interface, count );
+  return true;
+}
+
+void QgsRasterPipePool::addClones( const QgsRasterInterface *interface, int count )
+{
+  // the clones are made up front in the calling thread
+  while ( static_cast< int >( mPipes.size() ) < count )
+  {
+    std::unique_ptr< QgsRasterPipe > pipe( clonePipe( interface ) );
+    if ( !pipe )
+      break;
+    mFree << static_cast< int >( mPipes.size() );
+    mPipes.emplace_back( std::move( pipe ) );
+  }
+}
+
+int QgsRasterPipePool::acquire()
+{
+  QMutexLocker locker( &mMutex );
+  while ( mFree.isEmpty() )
+    mReleased.wait( &mMutex );
+  return mFree.takeLast();
+}
+
+void QgsRasterPipePool::release( int index )
+{
+  QMutexLocker locker( &mMutex );
+  mFree << index;
+  mReleased.wakeOne();
+}
+
+std::unique_ptr< QgsRasterPipePool > QgsRasterPipePoolCache::take( const QgsRasterInterface *interface, int count )
+{
+  std::unique_ptr< QgsRasterPipePool > pool;
+  {
+    QMutexLocker locker( &mMutex );
+    if ( !mIdle.empty() )
+    {
+      pool = std::move( mIdle.back() );
+      mIdle.pop_back();
+    }
+  }
+
+  if ( pool && pool->update( interface, count ) )
+    return pool;
+
+  return std::unique_ptr< QgsRasterPipePool >( new QgsRasterPipePool( interface, count ) );
+}
+
+void QgsRasterPipePoolCache::give( std::unique_ptr< QgsRasterPipePool > pool )
+{
+  QMutexLocker locker( &mMutex );
+  mIdle.emplace_back( std::move( pool ) );
+}
+
+/// @endcond
@@ -0,0 +1,130 @@
+/***************************************************************************
+                         qgsrasterpipepool_p.h
+                         ---------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERPIPEPOOL_P_H
+#define QGSRASTERPIPEPOOL_P_H
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <memory>
+#include <vector>
+
+class QgsRasterInterface;
+class QgsRasterPipe;
+
+/**
+ * \ingroup core
+ * Clones of a chain of raster interfaces, for reading from several threads.
+ *
+ * The raster interfaces are not thread safe, so each thread reads through its own
+ * clone of them. A thread takes a free clone with acquire() and hands it back with
+ * release() when done, so that a pool of a few clones serves any number of tasks.
+ * @note added in QGIS 3.0
+ */
+class QgsRasterPipePool
+{
+  public:
+
+    /**
+     * Clones \a interface together with its inputs into a new pipe, the clone of
+     * \a interface is the last interface of the pipe. Returns nullptr if an interface
+     * cannot be cloned.
+     */
+    static QgsRasterPipe *clonePipe( const QgsRasterInterface *interface );
+
+    /**
+     * Creates a pool with up to \a count clones of \a interface. The pool is smaller
+     * if the interfaces cannot be cloned, check size().
+     */
+    QgsRasterPipePool( const QgsRasterInterface *interface, int count );
+
+    /**
+     * Updates the clones to match \a interface and its inputs, and adds clones until the
+     * pool has at least \a count of them. The first interface of each clone, usually a data
+     * provider which is expensive to clone, is kept and only gets the nodata and dpi settings
+     * of the original, so it must read the same data source. Returns false if an interface
+     * cannot be cloned, the pool must not be used then.
+     */
+    bool update( const QgsRasterInterface *interface, int count );
+
+    //! Returns the number of clones of the pool
+    int size() const { return static_cast< int >( mPipes.size() ); }
+
+    //! Returns the clone with the specified \a index
+    QgsRasterPipe *pipe( int index ) const { return mPipes.at( index ).get(); }
+
+    //! Waits until a clone is free and returns its index, the clone must be given back with release()
+    int acquire();
+
+    //! Gives back the clone with the specified \a index, which was taken with acquire()
+    void release( int index );
+
+  private:
+
+    std::vector< std::unique_ptr< QgsRasterPipe > > mPipes;
+    QList< int > mFree;
+    QMutex mMutex;
+    QWaitCondition mReleased;
+
+    //! Adds clones until the pool has \a count of them
+    void addClones( const QgsRasterInterface *interface, int count );
+};
+
+/**
+ * \ingroup core
+ * Pools of clones of the raster pipe of a layer, which are kept between draws of the layer.
+ *
+ * Each draw takes a pool with take() and hands it back with give() when done, so that
+ * concurrent draws of the layer use separate pools while consecutive draws only clone the
+ * data provider once per thread. The layer replaces its pools when its data source changes.
+ * @note added in QGIS 3.0
+ */
+class QgsRasterPipePoolCache
+{
+  public:
+
+    /**
+     * Returns an idle pool updated to read through clones of \a interface with at least
+     * \a count clones, or a new pool if there is none. Check the size of the pool, as it
+     * is empty if the interfaces cannot be cloned.
+     */
+    std::unique_ptr< QgsRasterPipePool > take( const QgsRasterInterface *interface, int count );
+
+    //! Keeps a \a pool returned by take() for later draws
+    void give( std::unique_ptr< QgsRasterPipePool > pool );
+
+  private:
+
+    QMutex mMutex;
+    std::vector< std::unique_ptr< QgsRasterPipePool > > mIdle;
+};
+
+/// @endcond
+
+#endif // QGSRASTERPIPEPOOL_P_H
@@ -23,12 +23,42 @@
 #include "qgscoordinatetransform.h"
 #include "qgscsexception.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QtConcurrentMap>
+
+#include <numeric>
+#include <vector>
+
+///@cond PRIVATE
+namespace
+{
+  //! Maximum number of approximation grids in the cache of a projector
+  const int PROJECTOR_DATA_CACHE_SIZE = 32;
+
+  //! Minimum number of cells of a block which is reprojected with several threads
+  const int PARALLEL_WARP_CELLS = 1 << 16;
+
+  QString keyNumber( double value )
+  {
+    return QString::number( value, 'g', 17 );
+  }
+}
+
+struct QgsRasterProjector::ProjectorDataCache
+{
+  QMutex mutex;
+  QCache< QString, std::shared_ptr< const ProjectorData > > entries{ PROJECTOR_DATA_CACHE_SIZE };
+};
+///@endcond
+
 
 QgsRasterProjector::QgsRasterProjector()
   : QgsRasterInterface( nullptr )
   , mSrcDatumTransform( -1 )
   , mDestDatumTransform( -1 )
   , mPrecision( Approximate )
+  , mProjectorDataCache( std::make_shared< ProjectorDataCache >() )
 {
   QgsDebugMsgLevel( "Entered", 4 );
 }
@@ -43,6 +73,7 @@ QgsRasterProjector *QgsRasterProjector::clone() const
   projector->mSrcDatumTransform = mSrcDatumTransform;
   projector->mDestDatumTransform = mDestDatumTransform;
   projector->mPrecision = mPrecision;
+  projector->mProjectorDataCache = mProjectorDataCache;
   return projector;
 }
 
@@ -87,9 +118,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   , mSrcYRes( 0.0 )
   , mDestRowsPerMatrixRow( 0.0 )
   , mDestColsPerMatrixCol( 0.0 )
-  , pHelperTop( nullptr )
-  , pHelperBottom( nullptr )
-  , mHelperTopRow( 0 )
   , mCPCols( 0 )
   , mCPRows( 0 )
   , mSqrTolerance( 0.0 )
@@ -192,12 +220,16 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   QgsDebugMsgLevel( "CPMatrix:", 5 );
   QgsDebugMsgLevel( cpToString(), 5 );
 
-  // init helper points
-  pHelperTop = new QgsPoint[mDestCols];
-  pHelperBottom = new QgsPoint[mDestCols];
-  calcHelper( 0, pHelperTop );
-  calcHelper( 1, pHelperBottom );
-  mHelperTopRow = 0;
+  // flat copy of the matrix and helper values of destination columns, for fast access
+  mCPPoints.reserve( mCPRows * mCPCols );
+  for ( int i = 0; i < mCPRows; i++ )
+  {
+    for ( int j = 0; j < mCPCols; j++ )
+    {
+      mCPPoints.append( mCPMatrix[i][j] );
+    }
+  }
+  calcColumnHelper();
 
   // Calculate source dimensions
   calcSrcExtent();
@@ -208,8 +240,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
 
 ProjectorData::~ProjectorData()
 {
-  delete[] pHelperTop;
-  delete[] pHelperBottom;
   delete mInverseCt;
 }
 
@@ -377,24 +407,26 @@ void ProjectorData::calcSrcRowsCols()
 }
 
 
-inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY )
+inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const
 {
   *theX = mDestExtent.xMinimum() + col * mDestExtent.width() / ( mCPCols - 1 );
   *theY = mDestExtent.yMaximum() - row * mDestExtent.height() / ( mCPRows - 1 );
 }
 
-inline int ProjectorData::matrixRow( int destRow )
+inline int ProjectorData::matrixRow( int destRow ) const
 {
   return static_cast< int >( floor( ( destRow + 0.5 ) / mDestRowsPerMatrixRow ) );
 }
-inline int ProjectorData::matrixCol( int destCol )
+inline int ProjectorData::matrixCol( int destCol ) const
 {
   return static_cast< int >( floor( ( destCol + 0.5 ) / mDestColsPerMatrixCol ) );
 }
 
-void ProjectorData::calcHelper( int matrixRow, QgsPoint *points )
+void ProjectorData::calcColumnHelper()
 {
   // TODO?: should we also precalc dest cell center coordinates for x and y?
+  mHelperMatrixCols.resize( mDestCols );
+  mHelperXFracs.resize( mDestCols );
   for ( int myDestCol = 0; myDestCol < mDestCols; myDestCol++ )
   {
     double myDestX = mDestExtent.xMinimum() + ( myDestCol + 0.5 ) * mDestXRes;
@@ -403,33 +435,15 @@ void ProjectorData::calcHelper( int matrixRow, QgsPoint *points )
 
     double myDestXMin, myDestYMin, myDestXMax, myDestYMax;
 
-    destPointOnCPMatrix( matrixRow, myMatrixCol, &myDestXMin, &myDestYMin );
-    destPointOnCPMatrix( matrixRow, myMatrixCol + 1, &myDestXMax, &myDestYMax );
-
-    double xfrac = ( myDestX - myDestXMin ) / ( myDestXMax - myDestXMin );
+    destPointOnCPMatrix( 0, myMatrixCol, &myDestXMin, &myDestYMin );
+    destPointOnCPMatrix( 0, myMatrixCol + 1, &myDestXMax, &myDestYMax );
 
-    QgsPoint &mySrcPoint0 = mCPMatrix[matrixRow][myMatrixCol];
-    QgsPoint &mySrcPoint1 = mCPMatrix[matrixRow][myMatrixCol + 1];
-    double s = mySrcPoint0.x() + ( mySrcPoint1.x() - mySrcPoint0.x() ) * xfrac;
-    double t = mySrcPoint0.y() + ( mySrcPoint1.y() - mySrcPoint0.y() ) * xfrac;
-
-    points[myDestCol].setX( s );
-    points[myDestCol].setY( t );
+    mHelperMatrixCols[myDestCol] = myMatrixCol;
+    mHelperXFracs[myDestCol] = ( myDestX - myDestXMin ) / ( myDestXMax - myDestXMin );
   }
 }
 
-void ProjectorData::nextHelper()
-{
-  // We just switch pHelperTop and pHelperBottom, memory is not lost
-  QgsPoint *tmp = nullptr;
-  tmp = pHelperTop;
-  pHelperTop = pHelperBottom;
-  pHelperBottom = tmp;
-  calcHelper( mHelperTopRow + 2, pHelperBottom );
-  mHelperTopRow++;
-}
-
-bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
   if ( mApproximate )
   {
@@ -441,7 +455,7 @@ bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCo
   }
 }
 
-bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
 #ifdef QGISDEBUG
   QgsDebugMsgLevel( QString( "theDestRow = %1" ).arg( destRow ), 5 );
@@ -490,16 +504,10 @@ bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int
   return true;
 }
 
-bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
   int myMatrixRow = matrixRow( destRow );
-  int myMatrixCol = matrixCol( destCol );
-
-  if ( myMatrixRow > mHelperTopRow )
-  {
-    // TODO: make it more robust (for random, not sequential reading)
-    nextHelper();
-  }
+  int myMatrixCol = mHelperMatrixCols[destCol];
 
   double myDestY = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
 
@@ -512,17 +520,19 @@ bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow,
 
   double yfrac = ( myDestY - myDestYMin ) / ( myDestYMax - myDestYMin );
 
-  QgsPoint &myTop = pHelperTop[destCol];
-  QgsPoint &myBot = pHelperBottom[destCol];
+  // source points on the matrix rows above and below the destination cell
+  double xfrac = mHelperXFracs[destCol];
+  const QgsPoint *myTop = mCPPoints.constData() + static_cast< qgssize >( myMatrixRow ) * mCPCols + myMatrixCol;
+  const QgsPoint *myBot = myTop + mCPCols;
 
   // Warning: this is very SLOW compared to the following code!:
   //double mySrcX = myBot.x() + (myTop.x() - myBot.x()) * yfrac;
   //double mySrcY = myBot.y() + (myTop.y() - myBot.y()) * yfrac;
 
-  double tx = myTop.x();
-  double ty = myTop.y();
-  double bx = myBot.x();
-  double by = myBot.y();
+  double tx = myTop[0].x() + ( myTop[1].x() - myTop[0].x() ) * xfrac;
+  double ty = myTop[0].y() + ( myTop[1].y() - myTop[0].y() ) * xfrac;
+  double bx = myBot[0].x() + ( myBot[1].x() - myBot[0].x() ) * xfrac;
+  double by = myBot[0].y() + ( myBot[1].y() - myBot[0].y() ) * xfrac;
   double mySrcX = bx + ( tx - bx ) * yfrac;
   double mySrcY = by + ( ty - by ) * yfrac;
 
@@ -759,19 +769,19 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
 
   QgsCoordinateTransform inverseCt = QgsCoordinateTransformCache::instance()->transform( mDestCRS.authid(), mSrcCRS.authid(), mDestDatumTransform, mSrcDatumTransform );
 
-  ProjectorData pd( extent, width, height, mInput, inverseCt, mPrecision );
+  std::shared_ptr< const ProjectorData > pd = projectorData( extent, width, height, inverseCt );
 
-  QgsDebugMsgLevel( QString( "srcExtent:\n%1" ).arg( pd.srcExtent().toString() ), 4 );
-  QgsDebugMsgLevel( QString( "srcCols = %1 srcRows = %2" ).arg( pd.srcCols() ).arg( pd.srcRows() ), 4 );
+  QgsDebugMsgLevel( QString( "srcExtent:\n%1" ).arg( pd->srcExtent().toString() ), 4 );
+  QgsDebugMsgLevel( QString( "srcCols = %1 srcRows = %2" ).arg( pd->srcCols() ).arg( pd->srcRows() ), 4 );
 
   // If we zoom out too much, projector srcRows / srcCols maybe 0, which can cause problems in providers
-  if ( pd.srcRows() <= 0 || pd.srcCols() <= 0 )
+  if ( pd->srcRows() <= 0 || pd->srcCols() <= 0 )
   {
     QgsDebugMsgLevel( "Zero srcRows or srcCols", 4 );
     return new QgsRasterBlock();
   }
 
-  QgsRasterBlock *inputBlock = mInput->block( bandNo, pd.srcExtent(), pd.srcCols(), pd.srcRows(), feedback );
+  QgsRasterBlock *inputBlock = mInput->block( bandNo, pd->srcExtent(), pd->srcCols(), pd->srcRows(), feedback );
   if ( !inputBlock || inputBlock->isEmpty() )
   {
     QgsDebugMsg( "No raster data!" );
@@ -810,15 +820,24 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
 
   outputBlock->setIsNoData();
 
-  int srcRow, srcCol;
-  for ( int i = 0; i < height; ++i )
+  char *srcData = inputBlock->bits();
+  char *destData = outputBlock->bits();
+  if ( !srcData || !destData )
+  {
+    QgsDebugMsg( "Cannot get block data" );
+    delete inputBlock;
+    return outputBlock;
+  }
+
+  auto projectRow = [&]( int i )
   {
+    int srcRow, srcCol;
     for ( int j = 0; j < width; ++j )
     {
-      bool inside = pd.srcRowCol( i, j, &srcRow, &srcCol );
+      bool inside = pd->srcRowCol( i, j, &srcRow, &srcCol );
       if ( !inside ) continue; // we have everything set to no data
 
-      qgssize srcIndex = static_cast< qgssize >( srcRow ) * pd.srcCols() + srcCol;
+      qgssize srcIndex = static_cast< qgssize >( srcRow ) * pd->srcCols() + srcCol;
 
       // isNoData() may be slow so we check doNoData first
       if ( doNoData && inputBlock->isNoData( srcRow, srcCol ) )
@@ -828,21 +847,25 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
       }
 
       qgssize destIndex = static_cast< qgssize >( i ) * width + j;
-      char *srcBits = inputBlock->bits( srcIndex );
-      char *destBits = outputBlock->bits( destIndex );
-      if ( !srcBits )
-      {
-        QgsDebugMsg( QString( "Cannot get input block data: row = %1 col = %2" ).arg( i ).arg( j ) );
-        continue;
-      }
-      if ( !destBits )
-      {
-        QgsDebugMsg( QString( "Cannot set output block data: srcRow = %1 srcCol = %2" ).arg( srcRow ).arg( srcCol ) );
-        continue;
-      }
-      memcpy( destBits, srcBits, pixelSize );
+      memcpy( destData + destIndex * pixelSize, srcData + srcIndex * pixelSize, pixelSize );
       outputBlock->setIsData( i, j );
     }
+  };
+
+  // The approximation may be used by several threads. Rows of the no data bitmap do not share bytes,
+  // but the bitmap of blocks with no data bitmaps (doNoData) may be created when a cell is set.
+  if ( pd->isApproximate() && !doNoData && static_cast< qgssize >( width ) * height >= PARALLEL_WARP_CELLS )
+  {
+    std::vector< int > rows( height );
+    std::iota( rows.begin(), rows.end(), 0 );
+    QtConcurrent::blockingMap( rows, projectRow );
+  }
+  else
+  {
+    for ( int i = 0; i < height; ++i )
+    {
+      projectRow( i );
+    }
   }
 
   delete inputBlock;
@@ -850,6 +873,40 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
   return outputBlock;
 }
 
+std::shared_ptr< const ProjectorData > QgsRasterProjector::projectorData( const QgsRectangle &extent, int width, int height, const QgsCoordinateTransform &inverseCt )
+{
+  QgsRasterDataProvider *provider = mInput ? dynamic_cast<QgsRasterDataProvider *>( mInput->sourceInput() ) : nullptr;
+  if ( mPrecision != Approximate || !provider || mSrcCRS.authid().isEmpty() || mDestCRS.authid().isEmpty() )
+  {
+    return std::shared_ptr< const ProjectorData >( new ProjectorData( extent, width, height, mInput, inverseCt, mPrecision ) );
+  }
+
+  // the grid depends on the source extent and resolution too
+  QgsRectangle providerExtent = provider->extent();
+  QString key = QStringList( { mSrcCRS.authid(), mDestCRS.authid(), QString::number( mSrcDatumTransform ), QString::number( mDestDatumTransform ),
+                               keyNumber( extent.xMinimum() ), keyNumber( extent.yMinimum() ), keyNumber( extent.xMaximum() ), keyNumber( extent.yMaximum() ),
+                               QString::number( width ), QString::number( height ),
+                               keyNumber( providerExtent.xMinimum() ), keyNumber( providerExtent.yMinimum() ), keyNumber( providerExtent.xMaximum() ), keyNumber( providerExtent.yMaximum() ),
+                               provider->capabilities() & QgsRasterDataProvider::Size ? QStringLiteral( "%1x%2" ).arg( provider->xSize() ).arg( provider->ySize() ) : QString()
+                             } ).join( '|' );
+  {
+    QMutexLocker locker( &mProjectorDataCache->mutex );
+    if ( std::shared_ptr< const ProjectorData > *cached = mProjectorDataCache->entries.object( key ) )
+    {
+      return *cached;
+    }
+  }
+
+  std::shared_ptr< const ProjectorData > pd( new ProjectorData( extent, width, height, mInput, inverseCt, mPrecision ) );
+  // if the grid would be too large, each cell is transformed exactly and the data cannot be shared between threads
+  if ( pd->isApproximate() )
+  {
+    QMutexLocker locker( &mProjectorDataCache->mutex );
+    mProjectorDataCache->entries.insert( key, new std::shared_ptr< const ProjectorData >( pd ) );
+  }
+  return pd;
+}
+
 bool QgsRasterProjector::destExtentSize( const QgsRectangle &srcExtent, int srcXSize, int srcYSize,
     QgsRectangle &destExtent, int &destXSize, int &destYSize )
 {
@@ -32,14 +32,20 @@
 #include "qgsrasterinterface.h"
 
 #include <cmath>
+#include <memory>
 
 class QgsPoint;
 class QgsCoordinateTransform;
+class ProjectorData;
 
 /** \ingroup core
  * \brief QgsRasterProjector implements approximate projection support for
  * it calculates grid of points in source CRS for target CRS + extent
  * which are used to calculate affine transformation matrices.
+ *
+ * Approximation grids are cached and shared by all clones of a projector, so that
+ * the bands of a block and repeated requests for the same extent and size reuse them.
+ * Blocks are reprojected with several threads when the approximation is used.
  * \class QgsRasterProjector
  */
 class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
@@ -106,6 +112,17 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
     //! Requested precision
     Precision mPrecision;
 
+    struct ProjectorDataCache;
+
+    //! Approximation grids which are shared by the clones of the projector
+    std::shared_ptr< ProjectorDataCache > mProjectorDataCache;
+
+    /**
+     * Returns the data for reprojecting a block of the given \a extent and size. Approximation
+     * grids are taken from the cache, or added to it.
+     */
+    std::shared_ptr< const ProjectorData > projectorData( const QgsRectangle &extent, int width, int height, const QgsCoordinateTransform &inverseCt );
+
 };
 
 /// @cond PRIVATE
@@ -113,7 +130,8 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
 /**
  * Internal class for reprojection of rasters - either exact or approximate.
  * QgsRasterProjector creates it and then keeps calling srcRowCol() to get source pixel position
- * for every destination pixel position.
+ * for every destination pixel position. Once created, it is not modified any more, and
+ * srcRowCol() may be called from several threads if isApproximate() is true.
  */
 class ProjectorData
 {
@@ -129,7 +147,10 @@ class ProjectorData
         If source pixel is outside source extent srcRow and srcCol are left unchanged.
         @return true if inside source
      */
-    bool srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    bool srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const;
+
+    //! Returns true if source positions are calculated with the approximation grid
+    bool isApproximate() const { return mApproximate; }
 
     QgsRectangle srcExtent() const { return mSrcExtent; }
     int srcRows() const { return mSrcRows; }
@@ -138,17 +159,17 @@ class ProjectorData
   private:
 
     //! \brief get destination point for _current_ destination position
-    void destPointOnCPMatrix( int row, int col, double *theX, double *theY );
+    void destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const;
 
     //! \brief Get matrix upper left row/col indexes for destination row/col
-    int matrixRow( int destRow );
-    int matrixCol( int destCol );
+    int matrixRow( int destRow ) const;
+    int matrixCol( int destCol ) const;
 
     //! \brief Get precise source row and column indexes for current source extent and resolution
-    inline bool preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    inline bool preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const;
 
     //! \brief Get approximate source row and column indexes for current source extent and resolution
-    inline bool approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    inline bool approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol ) const;
 
     //! \brief insert rows to matrix
     void insertRows( const QgsCoordinateTransform &ct );
@@ -179,11 +200,8 @@ class ProjectorData
       * returns true if within threshold */
     bool checkRows( const QgsCoordinateTransform &ct );
 
-    //! Calculate array of src helper points
-    void calcHelper( int matrixRow, QgsPoint *points );
-
-    //! Calc / switch helper
-    void nextHelper();
+    //! Calculate the matrix column and its fraction for each destination column
+    void calcColumnHelper();
 
     //! Get mCPMatrix as string
     QString cpToString();
@@ -241,16 +259,15 @@ class ProjectorData
     /* Same size as mCPMatrix */
     QList< QList<bool> > mCPLegalMatrix;
 
-    //! Array of source points for each destination column on top of current CPMatrix grid row
+    //! Grid of source control points, row by row
     /* Warning: using QList is slow on access */
-    QgsPoint *pHelperTop = nullptr;
+    QVector<QgsPoint> mCPPoints;
 
-    //! Array of source points for each destination column on bottom of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPoint *pHelperBottom = nullptr;
+    //! Matrix column of each destination column
+    QVector<int> mHelperMatrixCols;
 
-    //! Current mHelperTop matrix row
-    int mHelperTopRow;
+    //! Position of each destination column between its matrix column and the next one
+    QVector<double> mHelperXFracs;
 
     //! Number of mCPMatrix columns
     int mCPCols;
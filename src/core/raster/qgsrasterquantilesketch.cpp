@@ -0,0 +1,243 @@
+/***************************************************************************
+                         qgsrasterquantilesketch.cpp
+                         ---------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsrasterquantilesketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // product of the top level size and the normalized rank error of KLL sketches,
+  // for a single quantile with a probability of 99%
+  const double RANK_ERROR_FACTOR = 2.7;
+
+  // ratio of the capacities of consecutive levels
+  const double LEVEL_CAPACITY_RATIO = 2.0 / 3.0;
+}
+
+QgsRasterQuantileSketch::QgsRasterQuantileSketch( double rankError )
+  : mRankError( qBound( 0.0001, rankError, 1.0 ) )
+  , mK( std::max( 8, static_cast< int >( std::ceil( RANK_ERROR_FACTOR / mRankError ) ) ) )
+{
+  mLevels.resize( 1 );
+  updateCapacity();
+}
+
+void QgsRasterQuantileSketch::add( double value )
+{
+  if ( qIsNaN( value ) )
+    return;
+
+  mCount++;
+  if ( mCount == 1 )
+  {
+    mMinimum = value;
+    mMaximum = value;
+  }
+  else
+  {
+    mMinimum = std::min( mMinimum, value );
+    mMaximum = std::max( mMaximum, value );
+  }
+  // single pass stdev, as in QgsRasterInterface::bandStatistics()
+  const double delta = value - mMean;
+  mMean += delta / mCount;
+  mM2 += delta * ( value - mMean );
+
+  mLevels[0].append( value );
+  mRetainedCount++;
+  if ( mRetainedCount >= mCapacity )
+    compress();
+}
+
+void QgsRasterQuantileSketch::add( const float *values, qgssize count )
+{
+  for ( qgssize i = 0; i < count; ++i )
+  {
+    add( static_cast< double >( values[i] ) );
+  }
+}
+
+void QgsRasterQuantileSketch::merge( const QgsRasterQuantileSketch &other )
+{
+  if ( other.isEmpty() )
+    return;
+
+  if ( isEmpty() )
+  {
+    mMinimum = other.mMinimum;
+    mMaximum = other.mMaximum;
+    mMean = other.mMean;
+    mM2 = other.mM2;
+  }
+  else
+  {
+    // combine the moments of both parts
+    const double total = static_cast< double >( mCount + other.mCount );
+    const double delta = other.mMean - mMean;
+    mMean += delta * other.mCount / total;
+    mM2 += other.mM2 + delta * delta * mCount * other.mCount / total;
+    mMinimum = std::min( mMinimum, other.mMinimum );
+    mMaximum = std::max( mMaximum, other.mMaximum );
+  }
+  mCount += other.mCount;
+
+  if ( mLevels.size() < other.mLevels.size() )
+  {
+    mLevels.resize( other.mLevels.size() );
+    updateCapacity();
+  }
+  for ( int level = 0; level < other.mLevels.size(); ++level )
+  {
+    mLevels[level] += other.mLevels.at( level );
+  }
+  mRetainedCount += other.mRetainedCount;
+  if ( mRetainedCount >= mCapacity )
+    compress();
+}
+
+double QgsRasterQuantileSketch::minimum() const
+{
+  return isEmpty() ? std::numeric_limits<double>::quiet_NaN() : mMinimum;
+}
+
+double QgsRasterQuantileSketch::maximum() const
+{
+  return isEmpty() ? std::numeric_limits<double>::quiet_NaN() : mMaximum;
+}
+
+double QgsRasterQuantileSketch::mean() const
+{
+  return isEmpty() ? std::numeric_limits<double>::quiet_NaN() : mMean;
+}
+
+double QgsRasterQuantileSketch::stdDev() const
+{
+  return mCount < 2 ? std::numeric_limits<double>::quiet_NaN() : std::sqrt( mM2 / ( mCount - 1 ) );
+}
+
+double QgsRasterQuantileSketch::quantile( double fraction ) const
+{
+  if ( isEmpty() )
+    return std::numeric_limits<double>::quiet_NaN();
+  if ( fraction <= 0 )
+    return mMinimum;
+  if ( fraction >= 1 )
+    return mMaximum;
+
+  std::vector< std::pair< double, qint64 > > weighted;
+  weighted.reserve( mRetainedCount );
+  qint64 totalWeight = 0;
+  for ( int level = 0; level < mLevels.size(); ++level )
+  {
+    const qint64 weight = Q_INT64_C( 1 ) << level;
+    Q_FOREACH ( double value, mLevels.at( level ) )
+    {
+      weighted.emplace_back( value, weight );
+      totalWeight += weight;
+    }
+  }
+  std::sort( weighted.begin(), weighted.end() );
+
+  const double target = fraction * totalWeight;
+  qint64 cumulative = 0;
+  for ( const auto &item : weighted )
+  {
+    cumulative += item.second;
+    if ( cumulative >= target )
+      return item.first;
+  }
+  return mMaximum;
+}
+
+double QgsRasterQuantileSketch::rank( double value ) const
+{
+  if ( isEmpty() )
+    return std::numeric_limits<double>::quiet_NaN();
+
+  qint64 below = 0;
+  qint64 totalWeight = 0;
+  for ( int level = 0; level < mLevels.size(); ++level )
+  {
+    const qint64 weight = Q_INT64_C( 1 ) << level;
+    Q_FOREACH ( double levelValue, mLevels.at( level ) )
+    {
+      if ( levelValue <= value )
+        below += weight;
+      totalWeight += weight;
+    }
+  }
+  return static_cast< double >( below ) / totalWeight;
+}
+
+int QgsRasterQuantileSketch::levelCapacity( int level ) const
+{
+  const int depth = mLevels.size() - 1 - level;
+  return std::max( 2, static_cast< int >( std::ceil( mK * std::pow( LEVEL_CAPACITY_RATIO, depth ) ) ) );
+}
+
+void QgsRasterQuantileSketch::updateCapacity()
+{
+  mCapacity = 0;
+  for ( int level = 0; level < mLevels.size(); ++level )
+  {
+    mCapacity += levelCapacity( level );
+  }
+}
+
+void QgsRasterQuantileSketch::compress()
+{
+  // as long as the sketch is over its capacity, at least one level is over its own capacity
+  while ( mRetainedCount >= mCapacity )
+  {
+    for ( int level = 0; level < mLevels.size(); ++level )
+    {
+      if ( mLevels.at( level ).size() < levelCapacity( level ) )
+        continue;
+
+      if ( level + 1 == mLevels.size() )
+      {
+        mLevels.resize( mLevels.size() + 1 );
+        updateCapacity();
+      }
+
+      QVector< double > &values = mLevels[level];
+      std::sort( values.begin(), values.end() );
+
+      // xorshift, so that results are reproducible
+      mRandomState ^= mRandomState << 13;
+      mRandomState ^= mRandomState >> 17;
+      mRandomState ^= mRandomState << 5;
+      const int offset = mRandomState & 1;
+
+      // with an odd number of values, the smallest one stays in the level
+      const int first = values.size() % 2;
+      const int pairs = values.size() / 2;
+      QVector< double > &nextValues = mLevels[level + 1];
+      for ( int i = 0; i < pairs; ++i )
+      {
+        nextValues.append( values.at( first + 2 * i + offset ) );
+      }
+      values.resize( first );
+      mRetainedCount -= pairs;
+      break;
+    }
+  }
+}
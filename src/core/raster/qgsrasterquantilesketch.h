@@ -0,0 +1,149 @@
+/***************************************************************************
+                         qgsrasterquantilesketch.h
+                         -------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERQUANTILESKETCH_H
+#define QGSRASTERQUANTILESKETCH_H
+
+#include "qgis_core.h"
+#include "qgis.h"
+
+#include <QVector>
+
+/** \ingroup core
+ * Summary of a stream of raster values which answers quantile queries approximately,
+ * using a fixed amount of memory.
+ *
+ * The sketch is a KLL sketch: values are kept in levels of growing weight, and full
+ * levels are compacted by keeping every other value. The rank of the value returned
+ * by quantile() differs from the requested fraction by at most rankError() with a
+ * probability of 99%, regardless of the number of values. Sketches of parts of a
+ * raster can be filled independently and merged afterwards.
+ *
+ * The count, minimum, maximum, mean and standard deviation of the values are
+ * tracked exactly.
+ *
+ * @note added in QGIS 3.0
+ */
+class CORE_EXPORT QgsRasterQuantileSketch
+{
+  public:
+
+    /**
+     * Constructor for QgsRasterQuantileSketch, with the maximum normalized \a rankError
+     * of quantiles (e.g. 0.01 for 1%). Smaller errors need more memory.
+     */
+    explicit QgsRasterQuantileSketch( double rankError = 0.01 );
+
+    /**
+     * Returns the maximum normalized rank error of quantiles.
+     */
+    double rankError() const { return mRankError; }
+
+    /**
+     * Adds a \a value to the sketch. NaN values are ignored.
+     */
+    void add( double value );
+
+    /**
+     * Adds \a count \a values to the sketch. NaN values are ignored.
+     * @note not available in python bindings
+     */
+    void add( const float *values, qgssize count );
+
+    /**
+     * Adds all values of an \a other sketch to this sketch.
+     */
+    void merge( const QgsRasterQuantileSketch &other );
+
+    /**
+     * Returns the number of values added to the sketch.
+     */
+    qint64 count() const { return mCount; }
+
+    /**
+     * Returns true if no values have been added to the sketch.
+     */
+    bool isEmpty() const { return mCount == 0; }
+
+    /**
+     * Returns the smallest value, or NaN if the sketch is empty.
+     */
+    double minimum() const;
+
+    /**
+     * Returns the largest value, or NaN if the sketch is empty.
+     */
+    double maximum() const;
+
+    /**
+     * Returns the mean of the values, or NaN if the sketch is empty.
+     */
+    double mean() const;
+
+    /**
+     * Returns the sample standard deviation of the values, or NaN if the sketch
+     * contains less than two values.
+     */
+    double stdDev() const;
+
+    /**
+     * Returns the value below which the specified \a fraction (between 0 and 1) of the
+     * values lies, or NaN if the sketch is empty. A fraction of 0 returns minimum() and a
+     * fraction of 1 returns maximum().
+     */
+    double quantile( double fraction ) const;
+
+    /**
+     * Returns the approximate fraction of the values which are smaller than or equal
+     * to \a value, or NaN if the sketch is empty.
+     */
+    double rank( double value ) const;
+
+    /**
+     * Returns the number of values held by the sketch, which is independent of count().
+     */
+    int retainedCount() const { return mRetainedCount; }
+
+  private:
+
+    double mRankError;
+    //! Maximum number of values of the top level
+    int mK;
+    //! Values of each level, a value of level h stands for 2^h values
+    QVector< QVector< double > > mLevels;
+    int mRetainedCount = 0;
+    int mCapacity = 0;
+    //! State of the generator deciding which values are kept when compacting
+    quint32 mRandomState = 0x9e3779b9;
+
+    qint64 mCount = 0;
+    double mMinimum = 0;
+    double mMaximum = 0;
+    double mMean = 0;
+    //! Sum of squared differences from the mean
+    double mM2 = 0;
+
+    //! Returns the number of values a level can hold before it is compacted
+    int levelCapacity( int level ) const;
+
+    //! Updates the total capacity after the number of levels changed
+    void updateCapacity();
+
+    //! Compacts levels until the values fit into the capacity
+    void compress();
+};
+
+#endif // QGSRASTERQUANTILESKETCH_H
@@ -120,19 +120,65 @@ QgsRasterBlock *QgsSingleBandGrayRenderer::block( int bandNo, QgsRectangle  cons
   }
 
   QRgb myDefaultColor = NODATA_COLOR;
-  for ( qgssize i = 0; i < ( qgssize )width * height; i++ )
+  const qgssize count = static_cast< qgssize >( width ) * height;
+  QRgb *colors = reinterpret_cast< QRgb * >( outputBlock->bits() );
+
+  // values are converted and enhanced for the whole block at once, no data values are NaN.
+  // Float64, Int32 and UInt32 values would lose precision as floats, so they are read one by one
+  const Qgis::DataType dataType = inputBlock->dataType();
+  const bool useFloatValues = dataType == Qgis::Byte || dataType == Qgis::UInt16 || dataType == Qgis::Int16 || dataType == Qgis::Float32;
+  const QVector<float> values = useFloatValues ? inputBlock->valuesAsFloat() : QVector<float>();
+  QVector<int> enhanced;
+  if ( mContrastEnhancement )
+  {
+    enhanced.resize( static_cast< int >( count ) );
+    if ( useFloatValues )
+    {
+      mContrastEnhancement->enhanceContrast( values.constData(), enhanced.data(), count );
+    }
+    else
+    {
+      for ( qgssize i = 0; i < count; i++ )
+      {
+        const double value = inputBlock->value( i );
+        enhanced[i] = !inputBlock->isNoData( i ) && mContrastEnhancement->isValueInDisplayableRange( value ) ? mContrastEnhancement->enhanceContrast( value ) : -1;
+      }
+    }
+  }
+
+  if ( mContrastEnhancement && !mRasterTransparency && mAlphaBand <= 0 )
+  {
+    // the color only depends on the enhanced value, so it is looked up in a table
+    QRgb table[256];
+    for ( int i = 0; i < 256; ++i )
+    {
+      int grayVal = mGradient == WhiteToBlack ? 255 - i : i;
+      if ( qgsDoubleNear( mOpacity, 1.0 ) )
+      {
+        table[i] = qRgba( grayVal, grayVal, grayVal, 255 );
+      }
+      else
+      {
+        table[i] = qRgba( mOpacity * grayVal, mOpacity * grayVal, mOpacity * grayVal, mOpacity * 255 );
+      }
+    }
+    QgsRasterBlock::lookupColors( enhanced.constData(), colors, count, table, 256, myDefaultColor );
+    return outputBlock.release();
+  }
+
+  for ( qgssize i = 0; i < count; i++ )
   {
-    if ( inputBlock->isNoData( i ) )
+    if ( useFloatValues ? qIsNaN( values[i] ) : inputBlock->isNoData( i ) )
     {
-      outputBlock->setColor( i, myDefaultColor );
+      colors[i] = myDefaultColor;
       continue;
     }
-    double grayVal = inputBlock->value( i );
+    double grayVal = useFloatValues ? values[i] : inputBlock->value( i );
 
     double currentAlpha = mOpacity;
     if ( mRasterTransparency )
     {
-      currentAlpha = mRasterTransparency->alphaValue( grayVal, mOpacity * 255 ) / 255.0;
+      currentAlpha = mRasterTransparency->alphaValue( inputBlock->value( i ), mOpacity * 255 ) / 255.0;
     }
     if ( mAlphaBand > 0 )
     {
@@ -141,12 +187,12 @@ QgsRasterBlock *QgsSingleBandGrayRenderer::block( int bandNo, QgsRectangle  cons
 
     if ( mContrastEnhancement )
     {
-      if ( !mContrastEnhancement->isValueInDisplayableRange( grayVal ) )
+      if ( enhanced[i] < 0 )
       {
-        outputBlock->setColor( i, myDefaultColor );
+        colors[i] = myDefaultColor;
         continue;
       }
-      grayVal = mContrastEnhancement->enhanceContrast( grayVal );
+      grayVal = enhanced[i];
     }
 
     if ( mGradient == WhiteToBlack )
@@ -156,11 +202,11 @@ QgsRasterBlock *QgsSingleBandGrayRenderer::block( int bandNo, QgsRectangle  cons
 
     if ( qgsDoubleNear( currentAlpha, 1.0 ) )
     {
-      outputBlock->setColor( i, qRgba( grayVal, grayVal, grayVal, 255 ) );
+      colors[i] = qRgba( grayVal, grayVal, grayVal, 255 );
     }
     else
     {
-      outputBlock->setColor( i, qRgba( currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * 255 ) );
+      colors[i] = qRgba( currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * 255 );
     }
   }
 
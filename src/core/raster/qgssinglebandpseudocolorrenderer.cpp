@@ -88,16 +88,10 @@ QgsSingleBandPseudoColorRenderer *QgsSingleBandPseudoColorRenderer::clone() cons
 
     if ( origColorRampShader )
     {
-      QgsColorRampShader *colorRampShader = new QgsColorRampShader( mShader->minimumValue(), mShader->maximumValue() );
-
-      if ( origColorRampShader->sourceColorRamp() )
-      {
-        colorRampShader->setSourceColorRamp( origColorRampShader->sourceColorRamp()->clone() );
-      }
-      colorRampShader->setColorRampType( origColorRampShader->colorRampType() );
-      colorRampShader->setClassificationMode( origColorRampShader->classificationMode() );
-      colorRampShader->setClip( origColorRampShader->clip() );
-      colorRampShader->setColorRampItemList( origColorRampShader->colorRampItemList() );
+      // the copy shares the color lookup tables of the original, so that they are not built again for each render
+      QgsColorRampShader *colorRampShader = new QgsColorRampShader( *origColorRampShader );
+      colorRampShader->setMinimumValue( mShader->minimumValue() );
+      colorRampShader->setMaximumValue( mShader->maximumValue() );
       shader->setRasterShaderFunction( colorRampShader );
     }
   }
@@ -245,48 +239,79 @@ QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangl
   }
 
   QRgb myDefaultColor = NODATA_COLOR;
+  const qgssize count = static_cast< qgssize >( width ) * height;
+  QRgb *colors = reinterpret_cast< QRgb * >( outputBlock->bits() );
 
-  for ( qgssize i = 0; i < ( qgssize )width * height; i++ )
-  {
-    if ( inputBlock->isNoData( i ) )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
-    double val = inputBlock->value( i );
-    int red, green, blue, alpha;
-    if ( !mShader->shade( val, &red, &green, &blue, &alpha ) )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
+  // the shader compares values exactly, so they are only converted to floats for the whole
+  // block at once if no precision is lost
+  const Qgis::DataType dataType = inputBlock->dataType();
+  const bool useFloatValues = dataType == Qgis::Byte || dataType == Qgis::UInt16 || dataType == Qgis::Int16 || dataType == Qgis::Float32;
+  const QVector<float> values = useFloatValues ? inputBlock->valuesAsFloat() : QVector<float>();
 
-    if ( alpha < 255 )
+  QgsColorRampShader *rampShader = dynamic_cast<QgsColorRampShader *>( mShader->rasterShaderFunction() );
+  if ( useFloatValues && rampShader && !hasTransparency )
+  {
+    // colors are looked up for the whole block at once
+    rampShader->shadeValues( values.constData(), colors, count, dataType, myDefaultColor );
+  }
+  else
+  {
+    for ( qgssize i = 0; i < count; i++ )
     {
-      // Working with premultiplied colors, so multiply values by alpha
-      red *= ( alpha / 255.0 );
-      blue *= ( alpha / 255.0 );
-      green *= ( alpha / 255.0 );
-    }
+      double val;
+      if ( useFloatValues )
+      {
+        val = values[i];
+        if ( qIsNaN( val ) )
+        {
+          colors[i] = myDefaultColor;
+          continue;
+        }
+      }
+      else
+      {
+        if ( inputBlock->isNoData( i ) )
+        {
+          colors[i] = myDefaultColor;
+          continue;
+        }
+        val = inputBlock->value( i );
+      }
 
-    if ( !hasTransparency )
-    {
-      outputBlock->setColor( i, qRgba( red, green, blue, alpha ) );
-    }
-    else
-    {
-      //opacity
-      double currentOpacity = mOpacity;
-      if ( mRasterTransparency )
+      int red, green, blue, alpha;
+      if ( !mShader->shade( val, &red, &green, &blue, &alpha ) )
       {
-        currentOpacity = mRasterTransparency->alphaValue( val, mOpacity * 255 ) / 255.0;
+        colors[i] = myDefaultColor;
+        continue;
       }
-      if ( mAlphaBand > 0 )
+
+      if ( alpha < 255 )
       {
-        currentOpacity *= alphaBlock->value( i ) / 255.0;
+        // Working with premultiplied colors, so multiply values by alpha
+        red *= ( alpha / 255.0 );
+        blue *= ( alpha / 255.0 );
+        green *= ( alpha / 255.0 );
       }
 
-      outputBlock->setColor( i, qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha ) );
+      if ( !hasTransparency )
+      {
+        colors[i] = qRgba( red, green, blue, alpha );
+      }
+      else
+      {
+        //opacity
+        double currentOpacity = mOpacity;
+        if ( mRasterTransparency )
+        {
+          currentOpacity = mRasterTransparency->alphaValue( val, mOpacity * 255 ) / 255.0;
+        }
+        if ( mAlphaBand > 0 )
+        {
+          currentOpacity *= alphaBlock->value( i ) / 255.0;
+        }
+
+        colors[i] = qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha );
+      }
     }
   }
 
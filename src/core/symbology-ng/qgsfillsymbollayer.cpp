@@ -30,6 +30,10 @@
 
 #include <QPainter>
 #include <QFile>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QMutex>
+#include <memory>
 #include <QSvgRenderer>
 #include <QDomDocument>
 #include <QDomElement>
@@ -935,6 +939,119 @@ QgsMapUnitScale QgsGradientFillSymbolLayer::mapUnitScale() const
 
 //QgsShapeburstFillSymbolLayer
 
+///@cond PRIVATE
+
+//! Distance field and polygon mask for a rendered shapeburst shape
+struct QgsShapeburstDistanceField
+{
+  //! Squared distances to the polygon boundary, one per pixel
+  QVector<double> distances;
+  //! Antialiased mask of the polygon
+  QImage alphaImage;
+
+  int byteCount() const { return distances.size() * sizeof( double ) + alphaImage.byteCount(); }
+};
+
+namespace
+{
+  //default maximum memory used by cached distance fields, in bytes
+  const int DEFAULT_DISTANCE_CACHE_SIZE = 50 * 1024 * 1024;
+
+  typedef QCache< QByteArray, std::shared_ptr< const QgsShapeburstDistanceField > > DistanceFieldCache;
+
+  QMutex *distanceCacheMutex()
+  {
+    static QMutex sMutex;
+    return &sMutex;
+  }
+
+  //shared between all shapeburst symbol layers, since symbols are cloned for every render job.
+  //The cost of entries is their size in bytes. Must be accessed with distanceCacheMutex() locked.
+  DistanceFieldCache *distanceCache()
+  {
+    static DistanceFieldCache sCache( DEFAULT_DISTANCE_CACHE_SIZE );
+    return &sCache;
+  }
+
+  void addRingToHash( QCryptographicHash &hash, const QPolygonF &ring, QPointF origin )
+  {
+    //coordinates are relative to the polygon's bounding box, so panning the map
+    //doesn't invalidate cached distance fields
+    QVector< qint32 > coords;
+    coords.reserve( ring.size() * 2 + 1 );
+    coords << ring.size();
+    for ( const QPointF &pt : ring )
+    {
+      coords << qRound( ( pt.x() - origin.x() ) * 256 ) << qRound( ( pt.y() - origin.y() ) * 256 );
+    }
+    hash.addData( reinterpret_cast< const char * >( coords.constData() ), coords.size() * sizeof( qint32 ) );
+  }
+
+  QByteArray distanceFieldCacheKey( const QPolygonF &points, const QList<QPolygonF> *rings, const QgsSymbolRenderContext &context,
+                                    int sideBuffer, bool ignoreRings, QSize imageSize )
+  {
+    const QgsVectorSimplifyMethod &simplifyMethod = context.renderContext().vectorSimplifyMethod();
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    QVector< qint32 > header;
+    header << imageSize.width() << imageSize.height() << sideBuffer << ignoreRings << ( rings ? rings->size() : -1 )
+           << static_cast< qint32 >( simplifyMethod.simplifyHints() & QgsVectorSimplifyMethod::AntialiasingSimplification )
+           << qRound( simplifyMethod.threshold() * 256 );
+    hash.addData( reinterpret_cast< const char * >( header.constData() ), header.size() * sizeof( qint32 ) );
+
+    QPointF origin = points.boundingRect().topLeft();
+    addRingToHash( hash, points, origin );
+    if ( rings )
+    {
+      for ( const QPolygonF &ring : *rings )
+        addRingToHash( hash, ring, origin );
+    }
+    return hash.result();
+  }
+
+  std::shared_ptr< const QgsShapeburstDistanceField > cachedDistanceField( const QByteArray &key )
+  {
+    QMutexLocker locker( distanceCacheMutex() );
+    std::shared_ptr< const QgsShapeburstDistanceField > *field = distanceCache()->object( key );
+    return field ? *field : std::shared_ptr< const QgsShapeburstDistanceField >();
+  }
+
+  void cacheDistanceField( const QByteArray &key, const std::shared_ptr< const QgsShapeburstDistanceField > &field )
+  {
+    QMutexLocker locker( distanceCacheMutex() );
+    int cost = field->byteCount();
+    if ( cost > distanceCache()->maxCost() )
+      return;
+
+    distanceCache()->insert( key, new std::shared_ptr< const QgsShapeburstDistanceField >( field ), cost );
+  }
+}
+
+///@endcond
+
+void QgsShapeburstFillSymbolLayer::setDistanceCacheMaximumSize( int bytes )
+{
+  QMutexLocker locker( distanceCacheMutex() );
+  distanceCache()->setMaxCost( bytes );
+}
+
+int QgsShapeburstFillSymbolLayer::distanceCacheMaximumSize()
+{
+  QMutexLocker locker( distanceCacheMutex() );
+  return distanceCache()->maxCost();
+}
+
+int QgsShapeburstFillSymbolLayer::distanceCacheSize()
+{
+  QMutexLocker locker( distanceCacheMutex() );
+  return distanceCache()->totalCost();
+}
+
+void QgsShapeburstFillSymbolLayer::clearDistanceCache()
+{
+  QMutexLocker locker( distanceCacheMutex() );
+  distanceCache()->clear();
+}
+
 QgsShapeburstFillSymbolLayer::QgsShapeburstFillSymbolLayer( const QColor &color, const QColor &color2, ShapeburstColorType colorType,
     int blurRadius, bool useWholeShape, double maxDistance )
   : mBlurRadius( blurRadius )
@@ -1187,54 +1304,66 @@ void QgsShapeburstFillSymbolLayer::renderPolygon( const QPolygonF &points, QList
   double imHeight = points.boundingRect().height() + ( sideBuffer * 2 );
   QImage *fillImage = new QImage( imWidth,
                                   imHeight, QImage::Format_ARGB32_Premultiplied );
-  //Fill this image with black. Initially the distance transform is drawn in greyscale, where black pixels have zero distance from the
-  //polygon boundary. Since we don't care about pixels which fall outside the polygon, we start with a black image and then draw over it the
-  //polygon in white. The distance transform function then fills in the correct distance values for the white pixels.
-  fillImage->fill( Qt::black );
 
-  //also create an image to store the alpha channel
-  QImage *alphaImage = new QImage( fillImage->width(), fillImage->height(), QImage::Format_ARGB32_Premultiplied );
-  //initially fill the alpha channel image with a transparent color
-  alphaImage->fill( Qt::transparent );
+  //the distance field only depends on the shape of the polygon, so reuse it when
+  //the same shape was already rendered at this scale
+  QByteArray cacheKey = distanceFieldCacheKey( points, rings, context, sideBuffer, ignoreRings, fillImage->size() );
+  std::shared_ptr< const QgsShapeburstDistanceField > distanceField = cachedDistanceField( cacheKey );
+  if ( !distanceField )
+  {
+    std::shared_ptr< QgsShapeburstDistanceField > newField = std::make_shared< QgsShapeburstDistanceField >();
 
-  //now, draw the polygon in the alpha channel image
-  QPainter imgPainter;
-  imgPainter.begin( alphaImage );
-  imgPainter.setRenderHint( QPainter::Antialiasing, true );
-  imgPainter.setBrush( QBrush( Qt::white ) );
-  imgPainter.setPen( QPen( Qt::black ) );
-  imgPainter.translate( -points.boundingRect().left() + sideBuffer, - points.boundingRect().top() + sideBuffer );
-  _renderPolygon( &imgPainter, points, rings, context );
-  imgPainter.end();
+    //Fill this image with black. Initially the distance transform is drawn in greyscale, where black pixels have zero distance from the
+    //polygon boundary. Since we don't care about pixels which fall outside the polygon, we start with a black image and then draw over it the
+    //polygon in white. The distance transform function then fills in the correct distance values for the white pixels.
+    fillImage->fill( Qt::black );
 
-  //now that we have a render of the polygon in white, draw this onto the shapeburst fill image too
-  //(this avoids calling _renderPolygon twice, since that can be slow)
-  imgPainter.begin( fillImage );
-  if ( !ignoreRings )
-  {
-    imgPainter.drawImage( 0, 0, *alphaImage );
-  }
-  else
-  {
-    //using ignore rings mode, so the alpha image can't be used
-    //directly as the alpha channel contains polygon rings and we need
-    //to draw now without any rings
+    //also create an image to store the alpha channel
+    newField->alphaImage = QImage( fillImage->width(), fillImage->height(), QImage::Format_ARGB32_Premultiplied );
+    //initially fill the alpha channel image with a transparent color
+    newField->alphaImage.fill( Qt::transparent );
+
+    //now, draw the polygon in the alpha channel image
+    QPainter imgPainter;
+    imgPainter.begin( &newField->alphaImage );
+    imgPainter.setRenderHint( QPainter::Antialiasing, true );
     imgPainter.setBrush( QBrush( Qt::white ) );
     imgPainter.setPen( QPen( Qt::black ) );
     imgPainter.translate( -points.boundingRect().left() + sideBuffer, - points.boundingRect().top() + sideBuffer );
-    _renderPolygon( &imgPainter, points, nullptr, context );
-  }
-  imgPainter.end();
+    _renderPolygon( &imgPainter, points, rings, context );
+    imgPainter.end();
+
+    //now that we have a render of the polygon in white, draw this onto the shapeburst fill image too
+    //(this avoids calling _renderPolygon twice, since that can be slow)
+    imgPainter.begin( fillImage );
+    if ( !ignoreRings )
+    {
+      imgPainter.drawImage( 0, 0, newField->alphaImage );
+    }
+    else
+    {
+      //using ignore rings mode, so the alpha image can't be used
+      //directly as the alpha channel contains polygon rings and we need
+      //to draw now without any rings
+      imgPainter.setBrush( QBrush( Qt::white ) );
+      imgPainter.setPen( QPen( Qt::black ) );
+      imgPainter.translate( -points.boundingRect().left() + sideBuffer, - points.boundingRect().top() + sideBuffer );
+      _renderPolygon( &imgPainter, points, nullptr, context );
+    }
+    imgPainter.end();
 
-  //apply distance transform to image, uses the current color ramp to calculate final pixel colors
-  double *dtArray = distanceTransform( fillImage );
+    //apply distance transform to image
+    newField->distances = distanceTransform( fillImage );
+
+    cacheDistanceField( cacheKey, newField );
+    distanceField = newField;
+  }
 
   //copy distance transform values back to QImage, shading by appropriate color ramp
-  dtArrayToQImage( dtArray, fillImage, mColorType == QgsShapeburstFillSymbolLayer::SimpleTwoColor ? mTwoColorGradientRamp : mGradientRamp,
+  dtArrayToQImage( distanceField->distances.constData(), fillImage, mColorType == QgsShapeburstFillSymbolLayer::SimpleTwoColor ? mTwoColorGradientRamp : mGradientRamp,
                    context.alpha(), useWholeShape, outputPixelMaxDist );
 
   //clean up some variables
-  delete [] dtArray;
   if ( mColorType == QgsShapeburstFillSymbolLayer::SimpleTwoColor )
   {
     delete mTwoColorGradientRamp;
@@ -1247,12 +1376,11 @@ void QgsShapeburstFillSymbolLayer::renderPolygon( const QPolygonF &points, QList
   }
 
   //apply alpha channel to distance transform image, so that areas outside the polygon are transparent
+  QPainter imgPainter;
   imgPainter.begin( fillImage );
   imgPainter.setCompositionMode( QPainter::CompositionMode_DestinationIn );
-  imgPainter.drawImage( 0, 0, *alphaImage );
+  imgPainter.drawImage( 0, 0, distanceField->alphaImage );
   imgPainter.end();
-  //we're finished with the alpha channel image now
-  delete alphaImage;
 
   //draw shapeburst image in correct place in the destination painter
 
@@ -1309,87 +1437,68 @@ void QgsShapeburstFillSymbolLayer::distanceTransform1d( double *f, int n, int *v
   }
 }
 
-/* distance transform of 2d function using squared distance */
-void QgsShapeburstFillSymbolLayer::distanceTransform2d( double *im, int width, int height )
-{
-  int maxDimension = qMax( width, height );
-  double *f = new double[ maxDimension ];
-  int *v = new int[ maxDimension ];
-  double *z = new double[ maxDimension + 1 ];
-  double *d = new double[ maxDimension ];
-
-  // transform along columns
-  for ( int x = 0; x < width; x++ )
-  {
-    for ( int y = 0; y < height; y++ )
-    {
-      f[y] = im[ x + y * width ];
-    }
-    distanceTransform1d( f, height, v, z, d );
-    for ( int y = 0; y < height; y++ )
-    {
-      im[ x + y * width ] = d[y];
-    }
-  }
-
-  // transform along rows
-  for ( int y = 0; y < height; y++ )
-  {
-    for ( int x = 0; x < width; x++ )
-    {
-      f[x] = im[  x + y * width ];
-    }
-    distanceTransform1d( f, width, v, z, d );
-    for ( int x = 0; x < width; x++ )
-    {
-      im[  x + y * width ] = d[x];
-    }
-  }
-
-  delete [] d;
-  delete [] f;
-  delete [] v;
-  delete [] z;
-}
-
 /* distance transform of a binary QImage */
-double *QgsShapeburstFillSymbolLayer::distanceTransform( QImage *im )
+QVector<double> QgsShapeburstFillSymbolLayer::distanceTransform( QImage *im )
 {
   int width = im->width();
   int height = im->height();
 
-  double *dtArray = new double[width * height];
+  QVector<double> dtArray( width * height );
+  double *dt = dtArray.data();
 
-  //load qImage to array
-  QRgb tmpRgb;
-  int idx = 0;
-  for ( int heightIndex = 0; heightIndex < height; ++heightIndex )
+  //the source image is binary, so the column pass reduces to finding the distance
+  //to the nearest black pixel in each column. This is done with a top-down and a
+  //bottom-up sweep over whole rows, which keeps memory access sequential
+  for ( int y = 0; y < height; ++y )
   {
-    const QRgb *scanLine = reinterpret_cast< const QRgb * >( im->constScanLine( heightIndex ) );
-    for ( int widthIndex = 0; widthIndex < width; ++widthIndex )
+    const QRgb *scanLine = reinterpret_cast< const QRgb * >( im->constScanLine( y ) );
+    double *row = dt + y * width;
+    for ( int x = 0; x < width; ++x )
     {
-      tmpRgb = scanLine[widthIndex];
-      if ( qRed( tmpRgb ) == 0 )
+      if ( qRed( scanLine[x] ) == 0 )
       {
         //black pixel, so zero distance
-        dtArray[ idx ] = 0;
+        row[x] = 0;
       }
       else
       {
-        //white pixel, so initially set distance as infinite
-        dtArray[ idx ] = INF;
+        //white pixel, distance is one more than the pixel above
+        row[x] = y > 0 ? row[x - width] + 1 : INF;
       }
-      idx++;
     }
   }
+  for ( int y = height - 2; y >= 0; --y )
+  {
+    double *row = dt + y * width;
+    for ( int x = 0; x < width; ++x )
+    {
+      if ( row[x + width] + 1 < row[x] )
+        row[x] = row[x + width] + 1;
+    }
+  }
+  for ( int i = 0; i < width * height; ++i )
+  {
+    //distances are squared
+    if ( dt[i] < INF )
+      dt[i] *= dt[i];
+  }
 
-  //calculate squared distance transform
-  distanceTransform2d( dtArray, width, height );
+  //then transform along rows using the lower envelope of parabolas, giving the exact
+  //squared euclidean distance in linear time
+  QVector<double> d( width );
+  QVector<int> v( width );
+  QVector<double> z( width + 1 );
+  for ( int y = 0; y < height; ++y )
+  {
+    double *row = dt + y * width;
+    distanceTransform1d( row, width, v.data(), z.data(), d.data() );
+    std::copy( d.constBegin(), d.constEnd(), row );
+  }
 
   return dtArray;
 }
 
-void QgsShapeburstFillSymbolLayer::dtArrayToQImage( double *array, QImage *im, QgsColorRamp *ramp, double layerAlpha, bool useWholeShape, int maxPixelDistance )
+void QgsShapeburstFillSymbolLayer::dtArrayToQImage( const double *array, QImage *im, QgsColorRamp *ramp, double layerAlpha, bool useWholeShape, int maxPixelDistance )
 {
   int width = im->width();
   int height = im->height();
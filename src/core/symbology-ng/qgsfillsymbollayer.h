@@ -540,6 +540,35 @@ class CORE_EXPORT QgsShapeburstFillSymbolLayer : public QgsFillSymbolLayer
     void setMapUnitScale( const QgsMapUnitScale &scale ) override;
     QgsMapUnitScale mapUnitScale() const override;
 
+    /** Sets the maximum memory, in bytes, used for caching the distance fields of rendered
+     * shapes. The cache is shared by all shapeburst fills and lets shapes which are rendered
+     * again with the same size (e.g., when panning the map) skip the distance transform.
+     * A size of 0 disables the cache.
+     * @note added in QGIS 3.0
+     * @see distanceCacheMaximumSize()
+     * @see clearDistanceCache()
+     */
+    static void setDistanceCacheMaximumSize( int bytes );
+
+    /** Returns the maximum memory, in bytes, used for caching the distance fields of rendered shapes.
+     * @note added in QGIS 3.0
+     * @see setDistanceCacheMaximumSize()
+     * @see distanceCacheSize()
+     */
+    static int distanceCacheMaximumSize();
+
+    /** Returns the memory, in bytes, currently used by cached distance fields.
+     * @note added in QGIS 3.0
+     * @see distanceCacheMaximumSize()
+     */
+    static int distanceCacheSize();
+
+    /** Removes all cached distance fields.
+     * @note added in QGIS 3.0
+     * @see setDistanceCacheMaximumSize()
+     */
+    static void clearDistanceCache();
+
   protected:
     QBrush mBrush;
     QBrush mSelBrush;
@@ -570,13 +599,11 @@ class CORE_EXPORT QgsShapeburstFillSymbolLayer : public QgsFillSymbolLayer
 
     /* distance transform of a 1d function using squared distance */
     void distanceTransform1d( double *f, int n, int *v, double *z, double *d );
-    /* distance transform of 2d function using squared distance */
-    void distanceTransform2d( double *im, int width, int height );
-    /* distance transform of a binary QImage */
-    double *distanceTransform( QImage *im );
+    /* squared distance transform of a binary QImage */
+    QVector<double> distanceTransform( QImage *im );
 
     /* fills a QImage with values from an array of doubles containing squared distance transform values */
-    void dtArrayToQImage( double *array, QImage *im, QgsColorRamp *ramp, double layerAlpha = 1, bool useWholeShape = true, int maxPixelDistance = 0 );
+    void dtArrayToQImage( const double *array, QImage *im, QgsColorRamp *ramp, double layerAlpha = 1, bool useWholeShape = true, int maxPixelDistance = 0 );
 };
 
 /** \ingroup core
@@ -30,9 +30,16 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QThread>
+#include <QtConcurrentMap>
+
+// minimum number of points before accumulation is split between threads
+#define HEATMAP_PARALLEL_THRESHOLD 10000
 
 QgsHeatmapRenderer::QgsHeatmapRenderer()
   : QgsFeatureRenderer( QStringLiteral( "heatmapRenderer" ) )
+  , mValuesWidth( 0 )
+  , mValuesHeight( 0 )
   , mCalculatedMaxValue( 0 )
   , mRadius( 10 )
   , mRadiusPixels( 0 )
@@ -55,12 +62,28 @@ QgsHeatmapRenderer::~QgsHeatmapRenderer()
 
 void QgsHeatmapRenderer::initializeValues( QgsRenderContext &context )
 {
-  mValues.resize( context.painter()->device()->width() * context.painter()->device()->height() / ( mRenderQuality * mRenderQuality ) );
+  mValuesWidth = context.painter()->device()->width() / mRenderQuality;
+  mValuesHeight = context.painter()->device()->height() / mRenderQuality;
+  mValues.resize( mValuesWidth * mValuesHeight );
   mValues.fill( 0 );
+  mPoints.clear();
   mCalculatedMaxValue = 0;
   mFeaturesRendered = 0;
   mRadiusPixels = qRound( context.convertToPainterUnits( mRadius, mRadiusUnit, mRadiusMapUnitScale ) / mRenderQuality );
   mRadiusSquared = mRadiusPixels * mRadiusPixels;
+
+  // precompute the kernel stamp, so that accumulating a point is just a weighted copy
+  int stampWidth = 2 * mRadiusPixels;
+  mKernel.resize( stampWidth * stampWidth );
+  int idx = 0;
+  for ( int dy = -mRadiusPixels; dy < mRadiusPixels; ++dy )
+  {
+    for ( int dx = -mRadiusPixels; dx < mRadiusPixels; ++dx )
+    {
+      double distanceSquared = dx * dx + dy * dy;
+      mKernel[ idx++ ] = distanceSquared > mRadiusSquared ? 0.0 : quarticKernel( sqrt( distanceSquared ), mRadiusPixels );
+    }
+  }
 }
 
 void QgsHeatmapRenderer::startRender( QgsRenderContext &context, const QgsFields &fields )
@@ -136,9 +159,6 @@ bool QgsHeatmapRenderer::renderFeature( QgsFeature &feature, QgsRenderContext &c
     }
   }
 
-  int width = context.painter()->device()->width() / mRenderQuality;
-  int height = context.painter()->device()->height() / mRenderQuality;
-
   //transform geometry if required
   QgsGeometry geom = feature.geometry();
   QgsCoordinateTransform xform = context.coordinateTransform();
@@ -150,36 +170,21 @@ bool QgsHeatmapRenderer::renderFeature( QgsFeature &feature, QgsRenderContext &c
   //convert point to multipoint
   QgsMultiPoint multiPoint = convertToMultipoint( &geom );
 
-  //loop through all points in multipoint
+  //collect all points in multipoint, values are accumulated when rendering stops
   for ( QgsMultiPoint::const_iterator pointIt = multiPoint.constBegin(); pointIt != multiPoint.constEnd(); ++pointIt )
   {
     QgsPoint pixel = context.mapToPixel().transform( *pointIt );
-    int pointX = pixel.x() / mRenderQuality;
-    int pointY = pixel.y() / mRenderQuality;
-    for ( int x = qMax( pointX - mRadiusPixels, 0 ); x < qMin( pointX + mRadiusPixels, width ); ++x )
-    {
-      for ( int y = qMax( pointY - mRadiusPixels, 0 ); y < qMin( pointY + mRadiusPixels, height ); ++y )
-      {
-        int index = y * width + x;
-        if ( index >= mValues.count() )
-        {
-          continue;
-        }
-        double distanceSquared = pow( pointX - x, 2.0 ) + pow( pointY - y, 2.0 );
-        if ( distanceSquared > mRadiusSquared )
-        {
-          continue;
-        }
-
-        double score = weight * quarticKernel( sqrt( distanceSquared ), mRadiusPixels );
-        double value = mValues.at( index ) + score;
-        if ( value > mCalculatedMaxValue )
-        {
-          mCalculatedMaxValue = value;
-        }
-        mValues[ index ] = value;
-      }
-    }
+    HeatmapPoint point;
+    point.x = pixel.x() / mRenderQuality;
+    point.y = pixel.y() / mRenderQuality;
+    point.weight = weight;
+
+    // skip points whose kernel does not touch the visible area
+    if ( point.x + mRadiusPixels <= 0 || point.x - mRadiusPixels >= mValuesWidth
+         || point.y + mRadiusPixels <= 0 || point.y - mRadiusPixels >= mValuesHeight )
+      continue;
+
+    mPoints << point;
   }
 
   mFeaturesRendered++;
@@ -223,10 +228,90 @@ double QgsHeatmapRenderer::triangularKernel( const double distance, const int ba
 
 void QgsHeatmapRenderer::stopRender( QgsRenderContext &context )
 {
+  accumulateValues();
   renderImage( context );
   mWeightExpression.reset();
 }
 
+void QgsHeatmapRenderer::accumulateValues()
+{
+  if ( mPoints.isEmpty() || mRadiusPixels <= 0 || mValuesWidth <= 0 || mValuesHeight <= 0 )
+  {
+    mPoints.clear();
+    return;
+  }
+
+  // split the grid into horizontal bands. Each band only touches its own rows, so
+  // bands can be accumulated concurrently without locking or merging partial grids
+  int bandCount = 1;
+  if ( mPoints.count() >= HEATMAP_PARALLEL_THRESHOLD )
+    bandCount = qBound( 1, QThread::idealThreadCount(), mValuesHeight );
+  int bandHeight = ( mValuesHeight + bandCount - 1 ) / bandCount;
+  bandCount = ( mValuesHeight + bandHeight - 1 ) / bandHeight;
+
+  QList< HeatmapBand > bands;
+  bands.reserve( bandCount );
+  for ( int i = 0; i < bandCount; ++i )
+  {
+    HeatmapBand band;
+    band.startRow = i * bandHeight;
+    band.endRow = qMin( band.startRow + bandHeight, mValuesHeight );
+    band.width = mValuesWidth;
+    band.radius = mRadiusPixels;
+    band.kernel = mKernel.constData();
+    band.values = mValues.data();
+    band.maxValue = 0;
+    bands << band;
+  }
+
+  // distribute points to the bands covered by their kernel, keeping the original point order
+  Q_FOREACH ( const HeatmapPoint &point, mPoints )
+  {
+    int firstBand = qMax( point.y - mRadiusPixels, 0 ) / bandHeight;
+    int lastBand = ( qMin( point.y + mRadiusPixels, mValuesHeight ) - 1 ) / bandHeight;
+    for ( int i = firstBand; i <= lastBand; ++i )
+      bands[ i ].points << point;
+  }
+  mPoints.clear();
+
+  if ( bandCount == 1 )
+    accumulateBand( bands[ 0 ] );
+  else
+    QtConcurrent::blockingMap( bands, accumulateBand );
+
+  Q_FOREACH ( const HeatmapBand &band, bands )
+  {
+    mCalculatedMaxValue = qMax( mCalculatedMaxValue, band.maxValue );
+  }
+}
+
+void QgsHeatmapRenderer::accumulateBand( HeatmapBand &band )
+{
+  int stampWidth = 2 * band.radius;
+  Q_FOREACH ( const HeatmapPoint &point, band.points )
+  {
+    int xMin = qMax( point.x - band.radius, 0 );
+    int xMax = qMin( point.x + band.radius, band.width );
+    int yMin = qMax( point.y - band.radius, band.startRow );
+    int yMax = qMin( point.y + band.radius, band.endRow );
+
+    for ( int y = yMin; y < yMax; ++y )
+    {
+      const double *kernel = band.kernel + ( y - point.y + band.radius ) * stampWidth + ( xMin - point.x + band.radius );
+      double *value = band.values + y * band.width + xMin;
+      for ( int x = xMin; x < xMax; ++x, ++kernel, ++value )
+      {
+        if ( *kernel <= 0 )
+          continue;
+
+        *value += point.weight * *kernel;
+        if ( *value > band.maxValue )
+          band.maxValue = *value;
+      }
+    }
+  }
+}
+
 void QgsHeatmapRenderer::renderImage( QgsRenderContext &context )
 {
   if ( !context.painter() || !mGradientRamp )
@@ -164,7 +164,36 @@ class CORE_EXPORT QgsHeatmapRenderer : public QgsFeatureRenderer
 
   private:
 
+    //! Point position (in heatmap pixels) and weight, collected during rendering
+    struct HeatmapPoint
+    {
+      int x;
+      int y;
+      double weight;
+    };
+
+    //! Horizontal band of the heatmap grid, accumulated independently of other bands
+    struct HeatmapBand
+    {
+      int startRow;
+      int endRow;
+      int width;
+      int radius;
+      const double *kernel = nullptr;
+      double *values = nullptr;
+      QVector< HeatmapPoint > points;
+      double maxValue;
+    };
+
     QVector<double> mValues;
+    int mValuesWidth;
+    int mValuesHeight;
+
+    //! Precomputed kernel values for a 2*radius square around a point
+    QVector<double> mKernel;
+
+    //! Points collected by renderFeature, accumulated into mValues at stopRender
+    QVector< HeatmapPoint > mPoints;
 
     double mCalculatedMaxValue;
 
@@ -193,6 +222,8 @@ class CORE_EXPORT QgsHeatmapRenderer : public QgsFeatureRenderer
 
     QgsMultiPoint convertToMultipoint( const QgsGeometry *geom );
     void initializeValues( QgsRenderContext &context );
+    void accumulateValues();
+    static void accumulateBand( HeatmapBand &band );
     void renderImage( QgsRenderContext &context );
 };
 
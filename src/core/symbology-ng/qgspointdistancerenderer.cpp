@@ -18,7 +18,6 @@
 #include "qgspointdistancerenderer.h"
 #include "qgsgeometry.h"
 #include "qgssymbollayerutils.h"
-#include "qgsspatialindex.h"
 #include "qgsmultipoint.h"
 #include "qgslogger.h"
 
@@ -39,7 +38,7 @@ QgsPointDistanceRenderer::QgsPointDistanceRenderer( const QString &rendererName,
   , mToleranceUnit( QgsUnitTypes::RenderMillimeters )
   , mDrawLabels( true )
   , mMaxLabelScaleDenominator( -1 )
-  , mSpatialIndex( nullptr )
+  , mSearchDistance( 0 )
 {
   mRenderer.reset( QgsFeatureRenderer::defaultRenderer( QgsWkbTypes::PointGeometry ) );
 }
@@ -89,12 +88,35 @@ bool QgsPointDistanceRenderer::renderFeature( QgsFeature &feature, QgsRenderCont
     transformedFeature.setGeometry( geom );
   }
 
-  double searchDistance = context.convertToMapUnits( mTolerance, mToleranceUnit, mToleranceMapUnitScale );
   QgsPoint point = transformedFeature.geometry().asPoint();
-  QList<QgsFeatureId> intersectList = mSpatialIndex->intersects( searchRect( point, searchDistance ) );
+
+  // collect groups whose first feature lies within the search rectangle. The grid cells are
+  // sized to the search distance, so only the cell containing the point and its neighbors
+  // can contain candidates
+  QList<QgsFeatureId> intersectList;
+  QPair< qint64, qint64 > cell = gridCell( point );
+  for ( qint64 column = cell.first - 1; column <= cell.first + 1; ++column )
+  {
+    for ( qint64 row = cell.second - 1; row <= cell.second + 1; ++row )
+    {
+      QHash< QPair< qint64, qint64 >, QList< GroupSeed > >::const_iterator cellIt = mGroupGrid.constFind( qMakePair( column, row ) );
+      if ( cellIt == mGroupGrid.constEnd() )
+        continue;
+
+      Q_FOREACH ( const GroupSeed &seed, cellIt.value() )
+      {
+        if ( qAbs( seed.point.x() - point.x() ) <= mSearchDistance && qAbs( seed.point.y() - point.y() ) <= mSearchDistance )
+          intersectList << seed.id;
+      }
+    }
+  }
+
   if ( intersectList.empty() )
   {
-    mSpatialIndex->insertFeature( transformedFeature );
+    GroupSeed seed;
+    seed.id = transformedFeature.id();
+    seed.point = point;
+    mGroupGrid[ cell ] << seed;
     // create new group
     ClusteredGroup newGroup;
     newGroup << GroupedFeature( transformedFeature, symbol, selected, label );
@@ -292,7 +314,8 @@ void QgsPointDistanceRenderer::startRender( QgsRenderContext &context, const Qgs
   mClusteredGroups.clear();
   mGroupIndex.clear();
   mGroupLocations.clear();
-  mSpatialIndex = new QgsSpatialIndex;
+  mGroupGrid.clear();
+  mSearchDistance = context.convertToMapUnits( mTolerance, mToleranceUnit, mToleranceMapUnitScale );
 
   if ( mLabelAttributeName.isEmpty() )
   {
@@ -325,8 +348,7 @@ void QgsPointDistanceRenderer::stopRender( QgsRenderContext &context )
   mClusteredGroups.clear();
   mGroupIndex.clear();
   mGroupLocations.clear();
-  delete mSpatialIndex;
-  mSpatialIndex = nullptr;
+  mGroupGrid.clear();
 
   mRenderer->stopRender( context );
 }
@@ -355,6 +377,14 @@ QgsRectangle QgsPointDistanceRenderer::searchRect( const QgsPoint &p, double dis
   return QgsRectangle( p.x() - distance, p.y() - distance, p.x() + distance, p.y() + distance );
 }
 
+QPair< qint64, qint64 > QgsPointDistanceRenderer::gridCell( const QgsPoint &p ) const
+{
+  // a zero tolerance only groups coincident points, so any cell size will do
+  double cellSize = mSearchDistance > 0 ? mSearchDistance : 1.0;
+  return qMakePair( static_cast< qint64 >( std::floor( p.x() / cellSize ) ),
+                    static_cast< qint64 >( std::floor( p.y() / cellSize ) ) );
+}
+
 void QgsPointDistanceRenderer::printGroupInfo() const
 {
 #ifdef QGISDEBUG
@@ -22,8 +22,6 @@
 #include "qgsrenderer.h"
 #include <QFont>
 
-class QgsSpatialIndex;
-
 /** \class QgsPointDistanceRenderer
  * \ingroup core
  * An abstract base class for distance based point renderers (e.g., clusterer and displacement renderers).
@@ -236,13 +234,25 @@ class CORE_EXPORT QgsPointDistanceRenderer: public QgsFeatureRenderer
     QList<ClusteredGroup> mClusteredGroups;
 
     //! Mapping of feature ID to the feature's group index.
-    QMap<QgsFeatureId, int> mGroupIndex;
+    QHash<QgsFeatureId, int> mGroupIndex;
 
     //! Mapping of feature ID to approximate group location
-    QMap<QgsFeatureId, QgsPoint > mGroupLocations;
+    QHash<QgsFeatureId, QgsPoint > mGroupLocations;
 
-    //! Spatial index for fast lookup of nearby points.
-    QgsSpatialIndex *mSpatialIndex = nullptr;
+    //! Position of the first feature of a group, stored in the group grid
+    struct GroupSeed
+    {
+      QgsFeatureId id;
+      QgsPoint point;
+    };
+
+    /** Uniform grid of group seeds for fast lookup of nearby groups, keyed by cell column and row.
+     * Cells are sized to the search distance, so only the 3x3 cells around a point need to be checked.
+     */
+    QHash< QPair< qint64, qint64 >, QList< GroupSeed > > mGroupGrid;
+
+    //! Search distance (in map units) for the current render. Also used as the group grid cell size.
+    double mSearchDistance;
 
     /** Renders the labels for a group.
      * @param centerPoint center point of group
@@ -265,6 +275,9 @@ class CORE_EXPORT QgsPointDistanceRenderer: public QgsFeatureRenderer
     //! Creates a search rectangle with specified distance tolerance.
     QgsRectangle searchRect( const QgsPoint &p, double distance ) const;
 
+    //! Returns the group grid cell containing a point
+    QPair< qint64, qint64 > gridCell( const QgsPoint &p ) const;
+
     //! Debugging function to check the entries in the clustered groups
     void printGroupInfo() const;
 
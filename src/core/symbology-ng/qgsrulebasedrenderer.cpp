@@ -427,6 +427,20 @@ bool QgsRuleBasedRenderer::Rule::startRender( QgsRenderContext &context, const Q
     }
   }
 
+  // children which cannot match anything do not widen the request,
+  // and identical filters only need to be sent once
+  subfilters.removeAll( QStringLiteral( "FALSE" ) );
+  subfilters.removeDuplicates();
+
+  // a rule with an invalid filter never matches, and a rule without symbol and
+  // without children that can match never draws anything. Tell the provider
+  // not to return any features for them
+  if ( ( mFilter && mFilter->hasParserError() ) || ( !mSymbol && subfilters.isEmpty() ) )
+  {
+    filter = QStringLiteral( "FALSE" );
+    return true;
+  }
+
   // subfilters (on the same level) are joined with OR
   // Finally they are joined with their parent (this) with AND
   QString sf;
@@ -35,6 +35,35 @@
 #include <QFileInfo>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QSaveFile>
+
+#include <memory>
+
+#ifdef Q_OS_UNIX
+#include <utime.h>
+#elif _MSC_VER
+#include <sys/utime.h>
+#endif
+
+//! Header of the image files in the shared cache directory, followed by the ARGB32 premultiplied pixels
+struct QgsSvgSharedImageHeader
+{
+  quint32 magic;
+  qint32 width;
+  qint32 height;
+  qint32 bytesPerLine;
+};
+
+//! Identifies (version 1 of) the shared image file format
+static const quint32 SVG_SHARED_IMAGE_MAGIC = 0x51535631;
+
+//! Releases the memory mapping of an image from the shared cache directory
+static void releaseSharedImage( void *file )
+{
+  delete static_cast< QFile * >( file );
+}
 
 QgsSvgCacheEntry::QgsSvgCacheEntry()
   : file( QString() )
@@ -87,7 +116,7 @@ int QgsSvgCacheEntry::dataSize() const
   }
   if ( image )
   {
-    size += ( image->width() * image->height() * 32 );
+    size += image->byteCount();
   }
   return size;
 }
@@ -118,18 +147,23 @@ QImage QgsSvgCache::svgAsImage( const QString &file, double size, const QColor &
   //if current entry image is 0: cache image for entry
   // checks to see if image will fit into cache
   //update stats for memory usage
-  if ( !currentEntry->image )
+  if ( currentEntry->image )
+  {
+    mImageHits++;
+  }
+  else
   {
+    mImageMisses++;
     QSvgRenderer r( currentEntry->svgContent );
     double hwRatio = 1.0;
     if ( r.viewBoxF().width() > 0 )
     {
       hwRatio = r.viewBoxF().height() / r.viewBoxF().width();
     }
-    long cachedDataSize = 0;
+    qint64 cachedDataSize = 0;
     cachedDataSize += currentEntry->svgContent.size();
-    cachedDataSize += static_cast< int >( currentEntry->size * currentEntry->size * hwRatio * 32 );
-    if ( cachedDataSize > MAXIMUM_SIZE / 2 )
+    cachedDataSize += static_cast< qint64 >( currentEntry->size * currentEntry->size * hwRatio * 32 );
+    if ( cachedDataSize > mMaximumSize / 2 )
     {
       fitsInCache = false;
       delete currentEntry->image;
@@ -149,7 +183,8 @@ QImage QgsSvgCache::svgAsImage( const QString &file, double size, const QColor &
     trimToMaximumSize();
   }
 
-  return *( currentEntry->image );
+  // images too large for the cache are not kept, callers should use the picture instead
+  return currentEntry->image ? *( currentEntry->image ) : QImage();
 }
 
 QPicture QgsSvgCache::svgAsPicture( const QString &file, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
@@ -486,8 +521,28 @@ void QgsSvgCache::cacheImage( QgsSvgCacheEntry *entry )
     return;
   }
 
-  delete entry->image;
-  entry->image = nullptr;
+  if ( entry->image )
+  {
+    mTotalSize -= entry->image->byteCount();
+    delete entry->image;
+    entry->image = nullptr;
+  }
+
+  // another process may have rasterized the same image already
+  QString sharedPath;
+  if ( !mSharedCacheDirectory.isEmpty() )
+  {
+    sharedPath = sharedImagePath( entry );
+    entry->image = loadSharedImage( sharedPath );
+    if ( entry->image )
+    {
+      mSharedImageHits++;
+      mTotalSize += entry->image->byteCount();
+      // the modification time orders the files from least to most recently used
+      utime( sharedPath.toUtf8().constData(), nullptr );
+      return;
+    }
+  }
 
   QSvgRenderer r( entry->svgContent );
   double hwRatio = 1.0;
@@ -524,8 +579,23 @@ void QgsSvgCache::cacheImage( QgsSvgCacheEntry *entry )
     r.render( &p, rect );
   }
 
+  p.end();
+
+  if ( !sharedPath.isEmpty() )
+  {
+    // share the image with other processes, and use the mapped copy ourselves so
+    // that the memory for it is shared too
+    storeSharedImage( sharedPath, *image );
+    trimSharedCache();
+    if ( QImage *sharedImage = loadSharedImage( sharedPath ) )
+    {
+      delete image;
+      image = sharedImage;
+    }
+  }
+
   entry->image = image;
-  mTotalSize += ( image->width() * image->height() * 32 );
+  mTotalSize += image->byteCount();
 }
 
 void QgsSvgCache::cachePicture( QgsSvgCacheEntry *entry, bool forceVectorOutput )
@@ -536,8 +606,12 @@ void QgsSvgCache::cachePicture( QgsSvgCacheEntry *entry, bool forceVectorOutput
     return;
   }
 
-  delete entry->picture;
-  entry->picture = nullptr;
+  if ( entry->picture )
+  {
+    mTotalSize -= entry->picture->size();
+    delete entry->picture;
+    entry->picture = nullptr;
+  }
 
   //correct QPictures dpi correction
   QPicture *picture = new QPicture();
@@ -557,6 +631,7 @@ void QgsSvgCache::cachePicture( QgsSvgCacheEntry *entry, bool forceVectorOutput
 
   QPainter p( picture );
   r.render( &p, rect );
+  p.end();
   entry->picture = picture;
   mTotalSize += entry->picture->size();
 }
@@ -903,8 +978,9 @@ void QgsSvgCache::trimToMaximumSize()
   {
     return;
   }
+  // never remove the most recent entry, it is the one currently in use
   QgsSvgCacheEntry *entry = mLeastRecentEntry;
-  while ( entry && ( mTotalSize > MAXIMUM_SIZE ) )
+  while ( entry && entry != mMostRecentEntry && ( mTotalSize > mMaximumSize ) )
   {
     QgsSvgCacheEntry *bkEntry = entry;
     entry = entry->nextEntry;
@@ -916,6 +992,159 @@ void QgsSvgCache::trimToMaximumSize()
   }
 }
 
+void QgsSvgCache::setMaximumCacheSize( qint64 bytes )
+{
+  QMutexLocker locker( &mMutex );
+  mMaximumSize = bytes;
+  trimToMaximumSize();
+}
+
+qint64 QgsSvgCache::maximumCacheSize() const
+{
+  QMutexLocker locker( &mMutex );
+  return mMaximumSize;
+}
+
+qint64 QgsSvgCache::cacheSize() const
+{
+  QMutexLocker locker( &mMutex );
+  return mTotalSize;
+}
+
+void QgsSvgCache::setSharedCacheDirectory( const QString &path )
+{
+  QMutexLocker locker( &mMutex );
+  if ( !path.isEmpty() && !QDir().mkpath( path ) )
+  {
+    QgsMessageLog::logMessage( tr( "Could not create SVG cache directory %1" ).arg( path ), tr( "SVG" ) );
+    mSharedCacheDirectory.clear();
+    return;
+  }
+  mSharedCacheDirectory = path;
+}
+
+QString QgsSvgCache::sharedCacheDirectory() const
+{
+  QMutexLocker locker( &mMutex );
+  return mSharedCacheDirectory;
+}
+
+void QgsSvgCache::setMaximumSharedCacheSize( qint64 bytes )
+{
+  QMutexLocker locker( &mMutex );
+  mMaximumSharedSize = bytes;
+  trimSharedCache();
+}
+
+qint64 QgsSvgCache::maximumSharedCacheSize() const
+{
+  QMutexLocker locker( &mMutex );
+  return mMaximumSharedSize;
+}
+
+int QgsSvgCache::imageCacheHits() const
+{
+  QMutexLocker locker( &mMutex );
+  return mImageHits;
+}
+
+int QgsSvgCache::imageCacheMisses() const
+{
+  QMutexLocker locker( &mMutex );
+  return mImageMisses;
+}
+
+int QgsSvgCache::sharedImageCacheHits() const
+{
+  QMutexLocker locker( &mMutex );
+  return mSharedImageHits;
+}
+
+void QgsSvgCache::resetStatistics()
+{
+  QMutexLocker locker( &mMutex );
+  mImageHits = 0;
+  mImageMisses = 0;
+  mSharedImageHits = 0;
+}
+
+QString QgsSvgCache::sharedImagePath( const QgsSvgCacheEntry *entry ) const
+{
+  // the svg content already has the fill, stroke and stroke width replaced, and also changes
+  // whenever the file itself is modified
+  QCryptographicHash hash( QCryptographicHash::Sha1 );
+  hash.addData( entry->svgContent );
+  hash.addData( QStringLiteral( "|%1|%2|%3|%4|%5" ).arg( entry->file ).arg( entry->size, 0, 'g', 17 )
+                .arg( entry->strokeWidth, 0, 'g', 17 ).arg( entry->widthScaleFactor, 0, 'g', 17 )
+                .arg( entry->fill.name( QColor::HexArgb ) + '|' + entry->stroke.name( QColor::HexArgb ) ).toUtf8() );
+  return QDir( mSharedCacheDirectory ).filePath( QString::fromLatin1( hash.result().toHex() ) + QStringLiteral( ".img" ) );
+}
+
+QImage *QgsSvgCache::loadSharedImage( const QString &path ) const
+{
+  std::unique_ptr< QFile > file( new QFile( path ) );
+  if ( !file->open( QIODevice::ReadOnly ) || file->size() < static_cast< qint64 >( sizeof( QgsSvgSharedImageHeader ) ) )
+    return nullptr;
+
+  uchar *data = file->map( 0, file->size() );
+  if ( !data )
+    return nullptr;
+
+  QgsSvgSharedImageHeader header;
+  memcpy( &header, data, sizeof( header ) );
+  if ( header.magic != SVG_SHARED_IMAGE_MAGIC || header.width <= 0 || header.height <= 0 || header.bytesPerLine < header.width * 4
+       || file->size() != static_cast< qint64 >( sizeof( header ) ) + static_cast< qint64 >( header.bytesPerLine ) * header.height )
+  {
+    QgsDebugMsg( QString( "Invalid shared SVG image %1" ).arg( path ) );
+    return nullptr;
+  }
+
+  // the image references the read only mapping directly and copies it on modification.
+  // The mapping is released together with the last copy of the image
+  const uchar *bits = data + sizeof( header );
+  return new QImage( bits, header.width, header.height, header.bytesPerLine, QImage::Format_ARGB32_Premultiplied,
+                     releaseSharedImage, file.release() );
+}
+
+void QgsSvgCache::storeSharedImage( const QString &path, const QImage &image ) const
+{
+  // written to a temporary file and renamed, so that other processes never see partial images
+  QSaveFile file( path );
+  if ( !file.open( QIODevice::WriteOnly ) )
+    return;
+
+  QgsSvgSharedImageHeader header;
+  header.magic = SVG_SHARED_IMAGE_MAGIC;
+  header.width = image.width();
+  header.height = image.height();
+  header.bytesPerLine = image.bytesPerLine();
+  file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+  file.write( reinterpret_cast< const char * >( image.constBits() ), image.byteCount() );
+  if ( !file.commit() )
+  {
+    QgsDebugMsg( QString( "Could not write shared SVG image %1" ).arg( path ) );
+  }
+}
+
+void QgsSvgCache::trimSharedCache() const
+{
+  if ( mSharedCacheDirectory.isEmpty() )
+    return;
+
+  // files are sorted from most to least recently used. Processes which still have a removed
+  // file mapped keep their copy of it until the image is released
+  QFileInfoList files = QDir( mSharedCacheDirectory ).entryInfoList( QStringList() << QStringLiteral( "*.img" ), QDir::Files, QDir::Time );
+  qint64 totalSize = 0;
+  Q_FOREACH ( const QFileInfo &file, files )
+  {
+    totalSize += file.size();
+    if ( totalSize > mMaximumSharedSize && !QFile::remove( file.absoluteFilePath() ) )
+    {
+      QgsDebugMsg( QString( "Could not remove shared SVG image %1" ).arg( file.absoluteFilePath() ) );
+    }
+  }
+}
+
 void QgsSvgCache::takeEntryFromList( QgsSvgCacheEntry *entry )
 {
   if ( !entry )
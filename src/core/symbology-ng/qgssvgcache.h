@@ -186,6 +186,86 @@ class CORE_EXPORT QgsSvgCache : public QObject
     QByteArray svgContent( const QString &file, double size, const QColor &fill, const QColor &stroke, double strokeWidth,
                            double widthScaleFactor );
 
+    /** Sets the maximum size of the cache in bytes. When the cached images, pictures and
+     * SVG contents need more memory, the least recently used entries are removed.
+     * @see maximumCacheSize()
+     * @see cacheSize()
+     * @note added in QGIS 3.0
+     */
+    void setMaximumCacheSize( qint64 bytes );
+
+    /** Returns the maximum size of the cache in bytes.
+     * @see setMaximumCacheSize()
+     * @note added in QGIS 3.0
+     */
+    qint64 maximumCacheSize() const;
+
+    /** Returns the number of bytes currently used by the cached images, pictures and SVG contents.
+     * @see maximumCacheSize()
+     * @note added in QGIS 3.0
+     */
+    qint64 cacheSize() const;
+
+    /** Sets a directory for sharing rasterized SVG images between processes, e.g. between
+     * multiple QGIS server workers. Images are stored uncompressed in the directory and memory mapped
+     * when they are requested, so that all processes using the same directory share both the
+     * rendering work and the memory of the images. When the files need more space than
+     * maximumSharedCacheSize(), the least recently used ones are removed. An empty path disables
+     * the shared cache.
+     * @see sharedCacheDirectory()
+     * @note added in QGIS 3.0
+     */
+    void setSharedCacheDirectory( const QString &path );
+
+    /** Returns the directory used for sharing rasterized SVG images between processes, or an
+     * empty string if sharing is disabled.
+     * @see setSharedCacheDirectory()
+     * @note added in QGIS 3.0
+     */
+    QString sharedCacheDirectory() const;
+
+    /** Sets the maximum size in bytes of the images in the shared cache directory. When the
+     * files need more space, the least recently used ones are removed.
+     * @see maximumSharedCacheSize()
+     * @see setSharedCacheDirectory()
+     * @note added in QGIS 3.0
+     */
+    void setMaximumSharedCacheSize( qint64 bytes );
+
+    /** Returns the maximum size in bytes of the images in the shared cache directory.
+     * @see setMaximumSharedCacheSize()
+     * @note added in QGIS 3.0
+     */
+    qint64 maximumSharedCacheSize() const;
+
+    /** Returns the number of svgAsImage() requests which were served with an image already in
+     * the cache.
+     * @see imageCacheMisses()
+     * @see sharedImageCacheHits()
+     * @note added in QGIS 3.0
+     */
+    int imageCacheHits() const;
+
+    /** Returns the number of svgAsImage() requests for which the image was not in the cache.
+     * This includes requests served from the shared cache directory.
+     * @see imageCacheHits()
+     * @see sharedImageCacheHits()
+     * @note added in QGIS 3.0
+     */
+    int imageCacheMisses() const;
+
+    /** Returns the number of images which were loaded from the shared cache directory
+     * instead of being rasterized.
+     * @see setSharedCacheDirectory()
+     * @note added in QGIS 3.0
+     */
+    int sharedImageCacheHits() const;
+
+    /** Resets the image cache hit and miss counters.
+     * @note added in QGIS 3.0
+     */
+    void resetStatistics();
+
   signals:
     //! Emit a signal to be caught by qgisapp and display a msg on status bar
     void statusChanged( const QString  &statusQString );
@@ -224,15 +304,40 @@ class CORE_EXPORT QgsSvgCache : public QObject
     //! Entry pointers accessible by file name
     QMultiHash< QString, QgsSvgCacheEntry * > mEntryLookup;
     //! Estimated total size of all images, pictures and svgContent
-    long mTotalSize;
+    qint64 mTotalSize;
 
     //The svg cache keeps the entries on a double connected list, moving the current entry to the front.
     //That way, removing entries for more space can start with the least used objects.
     QgsSvgCacheEntry *mLeastRecentEntry = nullptr;
     QgsSvgCacheEntry *mMostRecentEntry = nullptr;
 
-    //! Maximum cache size
-    static const long MAXIMUM_SIZE = 20000000;
+    //! Default maximum cache size
+    static const qint64 MAXIMUM_SIZE = 20000000;
+    //! Maximum cache size in bytes
+    qint64 mMaximumSize = MAXIMUM_SIZE;
+
+    //! Directory for sharing rasterized images between processes
+    QString mSharedCacheDirectory;
+    //! Default maximum size of the shared cache directory
+    static const qint64 MAXIMUM_SHARED_SIZE = 100000000;
+    //! Maximum size of the shared cache directory in bytes
+    qint64 mMaximumSharedSize = MAXIMUM_SHARED_SIZE;
+
+    int mImageHits = 0;
+    int mImageMisses = 0;
+    int mSharedImageHits = 0;
+
+    //! Returns the path of the file for the entry's image in the shared cache directory
+    QString sharedImagePath( const QgsSvgCacheEntry *entry ) const;
+
+    //! Memory maps an image stored in the shared cache directory. Returns nullptr if there is no valid image at \a path.
+    QImage *loadSharedImage( const QString &path ) const;
+
+    //! Stores an image in the shared cache directory
+    void storeSharedImage( const QString &path, const QImage &image ) const;
+
+    //! Removes the least recently used images from the shared cache directory until it fits its maximum size
+    void trimSharedCache() const;
 
     //! Replaces parameters in elements of a dom node and calls method for all child nodes
     void replaceElemParams( QDomElement &elem, const QColor &fill, const QColor &stroke, double strokeWidth );
@@ -257,7 +362,7 @@ class CORE_EXPORT QgsSvgCache : public QObject
     QByteArray mMissingSvg;
 
     //! Mutex to prevent concurrent access to the class from multiple threads at once (may corrupt the entries otherwise).
-    QMutex mMutex;
+    mutable QMutex mMutex;
 
 };
 
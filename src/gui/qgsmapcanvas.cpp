@@ -298,6 +298,7 @@ void QgsMapCanvas::setLayers( const QList<QgsMapLayer *> &layers )
   Q_FOREACH ( QgsMapLayer *layer, oldLayers )
   {
     disconnect( layer, &QgsMapLayer::repaintRequested, this, &QgsMapCanvas::layerRepaintRequested );
+    disconnect( layer, &QgsMapLayer::partialRepaintRequested, this, &QgsMapCanvas::refresh );
     disconnect( layer, &QgsMapLayer::crsChanged, this, &QgsMapCanvas::layerCrsChange );
     disconnect( layer, &QgsMapLayer::autoRefreshIntervalChanged, this, &QgsMapCanvas::updateAutoRefreshTimer );
     if ( QgsVectorLayer *vlayer = qobject_cast<QgsVectorLayer *>( layer ) )
@@ -313,6 +314,7 @@ void QgsMapCanvas::setLayers( const QList<QgsMapLayer *> &layers )
     if ( !layer )
       continue;
     connect( layer, &QgsMapLayer::repaintRequested, this, &QgsMapCanvas::layerRepaintRequested );
+    connect( layer, &QgsMapLayer::partialRepaintRequested, this, &QgsMapCanvas::refresh );
     connect( layer, &QgsMapLayer::crsChanged, this, &QgsMapCanvas::layerCrsChange );
     connect( layer, &QgsMapLayer::autoRefreshIntervalChanged, this, &QgsMapCanvas::updateAutoRefreshTimer );
     if ( QgsVectorLayer *vlayer = qobject_cast<QgsVectorLayer *>( layer ) )
@@ -420,6 +422,16 @@ bool QgsMapCanvas::isParallelRenderingEnabled() const
   return mUseParallelRendering;
 }
 
+void QgsMapCanvas::setProgressiveRenderingEnabled( bool enabled )
+{
+  mUseProgressiveRendering = enabled;
+}
+
+bool QgsMapCanvas::isProgressiveRenderingEnabled() const
+{
+  return mUseProgressiveRendering;
+}
+
 void QgsMapCanvas::setMapUpdateInterval( int timeMilliseconds )
 {
   mMapUpdateTimer.setInterval( timeMilliseconds );
@@ -489,7 +501,10 @@ void QgsMapCanvas::refreshMap()
     mJob = new QgsMapRendererParallelJob( mSettings );
   else
     mJob = new QgsMapRendererSequentialJob( mSettings );
+  mJob->setProgressiveRendering( mUseProgressiveRendering );
   connect( mJob, &QgsMapRendererJob::finished, this, &QgsMapCanvas::rendererJobFinished );
+  // show the preview as soon as it is available
+  connect( mJob, &QgsMapRendererJob::previewRendered, this, &QgsMapCanvas::mapUpdateTimeout );
   mJob->setCache( mCache );
 
   QStringList layersForGeometryCache;
@@ -550,7 +565,7 @@ void QgsMapCanvas::rendererJobFinished()
     QgsSettings settings;
     if ( settings.value( QStringLiteral( "Map/logCanvasRefreshEvent" ), false ).toBool() )
     {
-      QString logMsg = tr( "Canvas refresh: %1 ms" ).arg( mJob->renderingTime() );
+      QString logMsg = tr( "Canvas refresh: %1 ms (first frame: %2 ms)" ).arg( mJob->renderingTime() ).arg( mJob->timeToFirstFrame() );
       QgsMessageLog::logMessage( logMsg, tr( "Rendering" ) );
     }
 
@@ -126,6 +126,22 @@ class GUI_EXPORT QgsMapCanvas : public QGraphicsView
     //! @note added in 2.4
     bool isParallelRenderingEnabled() const;
 
+    /**
+     * Set whether a quick preview of the map is shown before the map is rendered in full
+     * quality. This only has an effect if parallel rendering is enabled.
+     * @see isProgressiveRenderingEnabled()
+     * @see QgsMapRendererJob::setProgressiveRendering()
+     * @note added in QGIS 3.0
+     */
+    void setProgressiveRenderingEnabled( bool enabled );
+
+    /**
+     * Check whether a quick preview of the map is shown before the map is rendered in full quality.
+     * @see setProgressiveRenderingEnabled()
+     * @note added in QGIS 3.0
+     */
+    bool isProgressiveRenderingEnabled() const;
+
     //! Set how often map preview should be updated while it is being rendered (in milliseconds)
     //! @note added in 2.4
     void setMapUpdateInterval( int timeMilliseconds );
@@ -676,6 +692,9 @@ class GUI_EXPORT QgsMapCanvas : public QGraphicsView
     //! Whether layers are rendered sequentially or in parallel
     bool mUseParallelRendering;
 
+    //! Whether a quick preview is rendered before the full quality map
+    bool mUseProgressiveRendering = false;
+
     //! Whether to add rendering stats to the rendered image
     bool mDrawRenderingStats;
 
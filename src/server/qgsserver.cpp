@@ -40,6 +40,7 @@
 #include "qgsfilterresponsedecorator.h"
 #include "qgsservice.h"
 #include "qgsserverprojectutils.h"
+#include "qgssvgcache.h"
 
 #include <QDomDocument>
 #include <QNetworkDiskCache>
@@ -223,6 +224,11 @@ bool QgsServer::init( )
   QgsMSLayerCache::instance();
   QgsMSLayerCache::instance()->setMaxCacheLayers( sSettings.maxCacheLayers() );
 
+  // share rasterized svg images between server processes
+  QgsApplication::svgCache()->setMaximumCacheSize( sSettings.svgCacheSize() );
+  QgsApplication::svgCache()->setMaximumSharedCacheSize( sSettings.svgSharedCacheSize() );
+  QgsApplication::svgCache()->setSharedCacheDirectory( sSettings.svgCacheDirectory() );
+
   // log settings currently used
   sSettings.logSummary();
 
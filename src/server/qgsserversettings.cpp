@@ -130,6 +130,61 @@ void QgsServerSettings::initSettings()
                                QVariant()
                              };
   mSettings[ sCacheSize.envVar ] = sCacheSize;
+
+  // svg cache directory
+  const Setting sSvgCacheDir = { QgsServerSettingsEnv::QGIS_SERVER_SVG_CACHE_DIRECTORY,
+                                 QgsServerSettingsEnv::DEFAULT_VALUE,
+                                 "Specify a directory for sharing rasterized SVG images between server processes",
+                                 "/svg_cache/directory",
+                                 QVariant::String,
+                                 QVariant( "" ),
+                                 QVariant()
+                               };
+  mSettings[ sSvgCacheDir.envVar ] = sSvgCacheDir;
+
+  // svg cache size
+  const Setting sSvgCacheSize = { QgsServerSettingsEnv::QGIS_SERVER_SVG_CACHE_SIZE,
+                                  QgsServerSettingsEnv::DEFAULT_VALUE,
+                                  "Specify the maximum size of the in memory SVG cache",
+                                  "/svg_cache/size",
+                                  QVariant::LongLong,
+                                  QVariant( 20000000 ),
+                                  QVariant()
+                                };
+  mSettings[ sSvgCacheSize.envVar ] = sSvgCacheSize;
+
+  // svg shared cache size
+  const Setting sSvgSharedCacheSize = { QgsServerSettingsEnv::QGIS_SERVER_SVG_SHARED_CACHE_SIZE,
+                                        QgsServerSettingsEnv::DEFAULT_VALUE,
+                                        "Specify the maximum size of the SVG images shared between server processes",
+                                        "/svg_cache/shared_size",
+                                        QVariant::LongLong,
+                                        QVariant( 100000000 ),
+                                        QVariant()
+                                      };
+  mSettings[ sSvgSharedCacheSize.envVar ] = sSvgSharedCacheSize;
+
+  // render trace directory
+  const Setting sRenderTraceDir = { QgsServerSettingsEnv::QGIS_SERVER_RENDER_TRACE_DIRECTORY,
+                                    QgsServerSettingsEnv::DEFAULT_VALUE,
+                                    "Specify a directory where a trace of each map rendering is written",
+                                    "/render_trace/directory",
+                                    QVariant::String,
+                                    QVariant( "" ),
+                                    QVariant()
+                                  };
+  mSettings[ sRenderTraceDir.envVar ] = sRenderTraceDir;
+
+  // render trace max files
+  const Setting sRenderTraceMaxFiles = { QgsServerSettingsEnv::QGIS_SERVER_RENDER_TRACE_MAX_FILES,
+                                         QgsServerSettingsEnv::DEFAULT_VALUE,
+                                         "Specify the maximum number of render traces kept in the trace directory",
+                                         "/render_trace/max_files",
+                                         QVariant::Int,
+                                         QVariant( 100 ),
+                                         QVariant()
+                                       };
+  mSettings[ sRenderTraceMaxFiles.envVar ] = sRenderTraceMaxFiles;
 }
 
 void QgsServerSettings::load()
@@ -305,3 +360,28 @@ QString QgsServerSettings::cacheDirectory() const
 {
   return value( QgsServerSettingsEnv::QGIS_SERVER_CACHE_DIRECTORY ).toString();
 }
+
+QString QgsServerSettings::svgCacheDirectory() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_SVG_CACHE_DIRECTORY ).toString();
+}
+
+qint64 QgsServerSettings::svgCacheSize() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_SVG_CACHE_SIZE ).toLongLong();
+}
+
+qint64 QgsServerSettings::svgSharedCacheSize() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_SVG_SHARED_CACHE_SIZE ).toLongLong();
+}
+
+QString QgsServerSettings::renderTraceDirectory() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_RENDER_TRACE_DIRECTORY ).toString();
+}
+
+int QgsServerSettings::renderTraceMaxFiles() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_RENDER_TRACE_MAX_FILES ).toInt();
+}
@@ -54,7 +54,12 @@ class SERVER_EXPORT QgsServerSettingsEnv : public QObject
       QGIS_PROJECT_FILE,
       MAX_CACHE_LAYERS,
       QGIS_SERVER_CACHE_DIRECTORY,
-      QGIS_SERVER_CACHE_SIZE
+      QGIS_SERVER_CACHE_SIZE,
+      QGIS_SERVER_SVG_CACHE_DIRECTORY,
+      QGIS_SERVER_SVG_CACHE_SIZE,
+      QGIS_SERVER_SVG_SHARED_CACHE_SIZE,
+      QGIS_SERVER_RENDER_TRACE_DIRECTORY,
+      QGIS_SERVER_RENDER_TRACE_MAX_FILES
     };
     Q_ENUM( EnvVar )
 };
@@ -141,6 +146,32 @@ class SERVER_EXPORT QgsServerSettings
       */
     QString cacheDirectory() const;
 
+    /** Returns the directory used for sharing rasterized SVG images between server processes.
+      * @return the directory, or an empty string if SVG images are not shared.
+      */
+    QString svgCacheDirectory() const;
+
+    /** Returns the maximum size of the in memory SVG cache of a server process.
+      * @return the size in bytes.
+      */
+    qint64 svgCacheSize() const;
+
+    /** Returns the maximum size of the images in the directory shared between server processes.
+      * @return the size in bytes.
+      */
+    qint64 svgSharedCacheSize() const;
+
+    /** Returns the directory where a trace of each map rendering is written.
+      * @return the directory, or an empty string if rendering is not traced.
+      */
+    QString renderTraceDirectory() const;
+
+    /** Returns the maximum number of render traces kept in the trace directory. When
+      * more traces are written, the oldest ones are removed.
+      * @return the number of traces, or 0 for no limit.
+      */
+    int renderTraceMaxFiles() const;
+
   private:
     void initSettings();
     QVariant value( QgsServerSettingsEnv::EnvVar envVar ) const;
@@ -27,23 +27,6 @@ namespace QgsWms
   namespace
   {
 
-    QMap<QString, QString> parseFormatOptions( const QString &optionString )
-    {
-      QMap<QString, QString> options;
-
-      QStringList optionsList = optionString.split( QStringLiteral( ";" ) );
-      for ( auto optionsIt = optionsList.constBegin(); optionsIt != optionsList.constEnd(); ++optionsIt )
-      {
-        int equalIdx = optionsIt->indexOf( QLatin1String( ":" ) );
-        if ( equalIdx > 0 && equalIdx < ( optionsIt->length() - 1 ) )
-        {
-          options.insert( optionsIt->left( equalIdx ).toUpper(),
-                          optionsIt->right( optionsIt->length() - equalIdx - 1 ).toUpper() );
-        }
-      }
-      return options;
-    }
-
     void readDxfLayerSettings( const QgsServerRequest::Parameters &parameters, QgsWmsConfigParser *configParser,
                                QList< QPair<QgsVectorLayer *, int > > &layers,
                                const QMap<QString, QString> &options )
@@ -20,6 +20,13 @@
 #include "qgsmessagelog.h"
 #include "qgsmaprendererparalleljob.h"
 #include "qgsmaprenderercustompainterjob.h"
+#include "qgsrendertrace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
 
 namespace QgsWms
 {
@@ -49,12 +56,17 @@ namespace QgsWms
 
   void QgsMapRendererJobProxy::render( const QgsMapSettings &mapSettings, QImage *image )
   {
+    std::unique_ptr< QgsRenderTrace > trace;
+    if ( !mRenderTraceDirectory.isEmpty() )
+      trace.reset( new QgsRenderTrace() );
+
     if ( mParallelRendering )
     {
       QgsMapRendererParallelJob renderJob( mapSettings );
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
       renderJob.setFeatureFilterProvider( mAccessControl );
 #endif
+      renderJob.setRenderTrace( trace.get() );
       renderJob.start();
       renderJob.waitForFinished();
       *image = renderJob.renderedImage();
@@ -67,8 +79,50 @@ namespace QgsWms
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
       renderJob.setFeatureFilterProvider( mAccessControl );
 #endif
+      renderJob.setRenderTrace( trace.get() );
       renderJob.renderSynchronously();
     }
+
+    if ( trace )
+      writeRenderTrace( *trace );
+  }
+
+  void QgsMapRendererJobProxy::writeRenderTrace( const QgsRenderTrace &trace ) const
+  {
+    static QAtomicInt sTraceCount;
+
+    QDir dir( mRenderTraceDirectory );
+    if ( !dir.exists() && !dir.mkpath( QStringLiteral( "." ) ) )
+    {
+      QgsMessageLog::logMessage( QStringLiteral( "Cannot create render trace directory %1" ).arg( mRenderTraceDirectory ), QStringLiteral( "server" ), QgsMessageLog::WARNING );
+      return;
+    }
+
+    const QString fileName = QStringLiteral( "render-%1-%2-%3.json" )
+                             .arg( QDateTime::currentDateTimeUtc().toString( QStringLiteral( "yyyyMMdd-hhmmsszzz" ) ) )
+                             .arg( QCoreApplication::applicationPid() )
+                             .arg( sTraceCount.fetchAndAddRelaxed( 1 ) );
+    if ( !trace.writeChromeTrace( dir.filePath( fileName ) ) )
+    {
+      QgsMessageLog::logMessage( QStringLiteral( "Cannot write render trace %1" ).arg( dir.filePath( fileName ) ), QStringLiteral( "server" ), QgsMessageLog::WARNING );
+    }
+
+    trimRenderTraces( dir );
+  }
+
+  void QgsMapRendererJobProxy::trimRenderTraces( const QDir &dir ) const
+  {
+    if ( mRenderTraceMaxFiles <= 0 )
+      return;
+
+    // file names start with the time of the rendering, so sorting them by name sorts
+    // the traces of all server processes from oldest to newest
+    QStringList files = dir.entryList( QStringList() << QStringLiteral( "render-*.json" ), QDir::Files, QDir::Name );
+    for ( int i = 0; i < files.count() - mRenderTraceMaxFiles; ++i )
+    {
+      // another process may have removed it already
+      QFile::remove( dir.filePath( files.at( i ) ) );
+    }
   }
 
   QPainter *QgsMapRendererJobProxy::takePainter()
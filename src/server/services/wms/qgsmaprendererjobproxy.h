@@ -21,6 +21,9 @@
 #include "qgsmapsettings.h"
 #include "qgsaccesscontrol.h"
 
+class QgsRenderTrace;
+class QDir;
+
 namespace QgsWms
 {
 
@@ -53,8 +56,28 @@ namespace QgsWms
         */
       QPainter *takePainter();
 
+      /** Sets the directory where a trace of each rendering is written in the
+        * Chrome trace event JSON format. An empty directory disables tracing.
+        * @param directory the directory
+        */
+      void setRenderTraceDirectory( const QString &directory ) { mRenderTraceDirectory = directory; }
+
+      /** Sets the maximum number of traces kept in the trace directory. When more
+        * traces are written, the oldest ones are removed.
+        * @param count the number of traces, or 0 for no limit
+        */
+      void setRenderTraceMaxFiles( int count ) { mRenderTraceMaxFiles = count; }
+
     private:
+      //! Writes the trace of a rendering to a new file in the trace directory
+      void writeRenderTrace( const QgsRenderTrace &trace ) const;
+
+      //! Removes the oldest traces beyond the maximum number of files from the trace directory
+      void trimRenderTraces( const QDir &dir ) const;
+
       bool mParallelRendering;
+      QString mRenderTraceDirectory;
+      int mRenderTraceMaxFiles = 0;
       QgsAccessControl *mAccessControl = nullptr;
       std::unique_ptr<QPainter> mPainter;
   };
@@ -0,0 +1,138 @@
+/***************************************************************************
+                        qgsmvtwriter.cpp
+  -------------------------------------------------------------------
+Date                 : October 2026
+Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgsmodule.h"
+#include "qgsmvtwriter.h"
+#include "qgswmsutils.h"
+#include "qgsmaplayer.h"
+#include "qgsvectorlayer.h"
+#include "qgsmvtencoder.h"
+#include "qgsaccesscontrol.h"
+
+namespace QgsWms
+{
+
+  namespace
+  {
+
+    QList<QgsVectorLayer *> readMvtLayers( const QgsServerRequest::Parameters &parameters, QgsWmsConfigParser *configParser )
+    {
+      QSet<QString> wfsLayers = QSet<QString>::fromList( configParser->wfsLayerNames() );
+
+      //LAYERS and STYLES
+      QStringList layerList, styleList;
+      readLayersAndStyles( parameters, layerList, styleList );
+
+      QList<QgsVectorLayer *> layers;
+      for ( int i = 0; i < layerList.size(); ++i )
+      {
+        QString styleName;
+        if ( styleList.size() > i )
+        {
+          styleName = styleList.at( i );
+        }
+
+        QList<QgsMapLayer *> mapLayers = configParser->mapLayerFromStyle( layerList.at( i ), styleName );
+        for ( auto layerIt = mapLayers.constBegin(); layerIt != mapLayers.constEnd(); ++layerIt )
+        {
+          if ( !( *layerIt ) || ( *layerIt )->type() != QgsMapLayer::VectorLayer )
+          {
+            continue;
+          }
+
+          //only wfs layers are allowed to be published, as for the DXF output
+          QgsVectorLayer *vlayer = static_cast<QgsVectorLayer *>( *layerIt );
+          if ( !wfsLayers.contains( vlayer->name() ) )
+          {
+            continue;
+          }
+
+          layers.append( vlayer );
+        }
+      }
+      return layers;
+    }
+
+  }
+
+  void writeAsMvt( QgsServerInterface *serverIface,  const QString &version, const QgsServerRequest &request, QgsServerResponse &response )
+  {
+    QgsWmsConfigParser *configParser = getConfigParser( serverIface );
+    QgsServerRequest::Parameters params = request.parameters();
+
+    QgsRectangle extent = parseBbox( params.value( QStringLiteral( "BBOX" ) ) );
+    if ( extent.isEmpty() )
+    {
+      throw QgsBadRequestException( QStringLiteral( "InvalidParameterValue" ), QStringLiteral( "Invalid BBOX parameter" ) );
+    }
+
+    QString crs = params.value( QStringLiteral( "CRS" ), params.value( QStringLiteral( "SRS" ) ) );
+    if ( crs.compare( QLatin1String( "CRS:84" ), Qt::CaseInsensitive ) == 0 )
+    {
+      crs = QStringLiteral( "EPSG:4326" );
+      extent.invert();
+    }
+    QgsCoordinateReferenceSystem outputCrs = QgsCoordinateReferenceSystem::fromOgcWmsCrs( crs );
+    if ( !outputCrs.isValid() )
+    {
+      throw QgsBadRequestException( QStringLiteral( "InvalidCRS" ), QStringLiteral( "Could not create output CRS" ) );
+    }
+    if ( version != QLatin1String( "1.1.1" ) && outputCrs.hasAxisInverted() )
+    {
+      extent.invert();
+    }
+
+    int resolution = 4096;
+    int buffer = 64;
+    QMap<QString, QString> formatOptionsMap = parseFormatOptions( params.value( QStringLiteral( "FORMAT_OPTIONS" ) ) );
+    if ( formatOptionsMap.contains( QStringLiteral( "RESOLUTION" ) ) )
+    {
+      bool ok = false;
+      int value = formatOptionsMap.value( QStringLiteral( "RESOLUTION" ) ).toInt( &ok );
+      if ( ok && value > 0 )
+        resolution = value;
+    }
+    if ( formatOptionsMap.contains( QStringLiteral( "BUFFER" ) ) )
+    {
+      bool ok = false;
+      int value = formatOptionsMap.value( QStringLiteral( "BUFFER" ) ).toInt( &ok );
+      if ( ok && value >= 0 )
+        buffer = value;
+    }
+
+    QList<QgsVectorLayer *> layers = readMvtLayers( params, configParser );
+
+    // Write output, each layer is streamed to the response as soon as it is encoded
+    response.setHeader( QStringLiteral( "Content-Type" ), QgsMvtEncoder::mimeType() );
+
+    QgsMvtEncoder encoder( extent, resolution, buffer );
+    encoder.setDevice( response.io() );
+#ifdef HAVE_SERVER_PYTHON_PLUGINS
+    QgsAccessControl *accessControl = serverIface->accessControls();
+    encoder.setFeatureFilterProvider( accessControl );
+#endif
+
+    Q_FOREACH ( QgsVectorLayer *layer, layers )
+    {
+#ifdef HAVE_SERVER_PYTHON_PLUGINS
+      if ( accessControl && !accessControl->layerReadPermission( layer ) )
+      {
+        continue;
+      }
+#endif
+      encoder.addLayer( layer, outputCrs, layer->name(), layer->excludeAttributesWfs() );
+    }
+  }
+
+
+} // namespace QgsWms
@@ -0,0 +1,27 @@
+/***************************************************************************
+                        qgsmvtwriter.h
+  -------------------------------------------------------------------
+Date                 : October 2026
+Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef QGSMVTWRITER_H
+#define QGSMVTWRITER_H
+
+namespace QgsWms
+{
+
+  /** Output GetMap response as a Mapbox vector tile
+   */
+  void writeAsMvt( QgsServerInterface *serverIface, const QString &version, const QgsServerRequest &request,
+                   QgsServerResponse &response );
+
+} // namespace QgsWms
+
+#endif // QGSMVTWRITER_H
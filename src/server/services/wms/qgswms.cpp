@@ -22,6 +22,7 @@
 #include "qgsmodule.h"
 #include "qgswmsutils.h"
 #include "qgsdxfwriter.h"
+#include "qgsmvtwriter.h"
 #include "qgswmsgetcapabilities.h"
 #include "qgswmsgetmap.h"
 #include "qgswmsgetstyle.h"
@@ -99,6 +100,10 @@ namespace QgsWms
           {
             writeAsDxf( mServerIface, versionString, request, response );
           }
+          else if ( QSTR_COMPARE( format, "application/vnd.mapbox-vector-tile" ) || QSTR_COMPARE( format, "application/x-protobuf" ) )
+          {
+            writeAsMvt( mServerIface, versionString, request, response );
+          }
           else
           {
             writeGetMap( mServerIface, project, versionString, request, response );
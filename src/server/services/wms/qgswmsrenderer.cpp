@@ -760,6 +760,8 @@ namespace QgsWms
       mAccessControl->resolveFilterFeatures( mapSettings.layers() );
 #endif
       QgsMapRendererJobProxy renderJob( mSettings.parallelRendering(), mSettings.maxThreads(), mAccessControl );
+      renderJob.setRenderTraceDirectory( mSettings.renderTraceDirectory() );
+      renderJob.setRenderTraceMaxFiles( mSettings.renderTraceMaxFiles() );
       renderJob.render( mapSettings, image );
       painter.reset( renderJob.takePainter() );
     }
@@ -195,6 +195,23 @@ namespace QgsWms
     return QgsRectangle( d[0], d[1], d[2], d[3] );
   }
 
+  QMap<QString, QString> parseFormatOptions( const QString &optionString )
+  {
+    QMap<QString, QString> options;
+
+    QStringList optionsList = optionString.split( QStringLiteral( ";" ) );
+    for ( auto optionsIt = optionsList.constBegin(); optionsIt != optionsList.constEnd(); ++optionsIt )
+    {
+      int equalIdx = optionsIt->indexOf( QLatin1String( ":" ) );
+      if ( equalIdx > 0 && equalIdx < ( optionsIt->length() - 1 ) )
+      {
+        options.insert( optionsIt->left( equalIdx ).toUpper(),
+                        optionsIt->right( optionsIt->length() - equalIdx - 1 ).toUpper() );
+      }
+    }
+    return options;
+  }
+
 } // namespace QgsWms
 
 
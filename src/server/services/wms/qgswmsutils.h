@@ -86,6 +86,11 @@ namespace QgsWms
    */
   void readLayersAndStyles( const QgsServerRequest::Parameters &parameters, QStringList &layersList, QStringList &stylesList );
 
+  /** Parses the FORMAT_OPTIONS parameter, e.g. "MODE:FeatureSymbology;SCALE:1000"
+   * @return the options, with upper case names and values
+   */
+  QMap<QString, QString> parseFormatOptions( const QString &optionString );
+
 } // namespace QgsWms
 
 #endif
@@ -83,6 +83,7 @@ void usage( std::string const &appName )
             << "\t[--quality]\trenderer hint(s), comma separated, possible values: Antialiasing,TextAntialiasing,SmoothPixmapTransform,NonCosmeticDefaultPen\n"
             << "\t[--parallel]\trender layers in parallel instead of sequentially\n"
             << "\t[--print type]\twhat kind of time to print, possible values: wall,total,user,sys. Default is total.\n"
+            << "\t[--trace filename]\twrite a trace (Chrome trace event JSON) of the last rendering cycle to given file\n"
             << "\t[--help]\t\tthis text\n\n"
             << "  FILES:\n"
             << "    Files specified on the command line can include rasters,\n"
@@ -139,6 +140,7 @@ int main( int argc, char *argv[] )
   QString myQuality = QLatin1String( "" );
   bool myParallel = false;
   QString myPrintTime = QStringLiteral( "total" );
+  QString myTraceFileName;
 
   // This behavior will set initial extent of map canvas, but only if
   // there are no command line arguments. This gives a usable map
@@ -179,13 +181,14 @@ int main( int argc, char *argv[] )
       {"quality", required_argument, 0, 'q'},
       {"parallel", no_argument, 0, 'P'},
       {"print", required_argument, 0, 'R'},
+      {"trace", required_argument, 0, 't'},
       {0, 0, 0, 0}
     };
 
     /* getopt_long stores the option index here. */
     int option_index = 0;
 
-    optionChar = getopt_long( argc, argv, "islwhpeocrq",
+    optionChar = getopt_long( argc, argv, "islwhpeocrqt",
                               long_options, &option_index );
 
     /* Detect the end of the options. */
@@ -256,6 +259,10 @@ int main( int argc, char *argv[] )
         myPrintTime = optarg;
         break;
 
+      case 't':
+        myTraceFileName = QDir::toNativeSeparators( QFileInfo( QFile::decodeName( optarg ) ).absoluteFilePath() );
+        break;
+
       case '?':
         usage( argv[0] );
         return 2;   // XXX need standard exit codes
@@ -343,6 +350,10 @@ int main( int argc, char *argv[] )
     {
       myPrintTime = argv[++i];
     }
+    else if ( i + 1 < argc && ( arg == "--trace" || arg == "-t" ) )
+    {
+      myTraceFileName = QDir::toNativeSeparators( QFileInfo( QFile::decodeName( argv[++i] ) ).absoluteFilePath() );
+    }
     else
     {
       sFileList.append( QDir::toNativeSeparators( QFileInfo( QFile::decodeName( argv[i] ) ).absoluteFilePath() ) );
@@ -516,6 +527,7 @@ int main( int argc, char *argv[] )
   }
 
   qbench->setParallel( myParallel );
+  qbench->setTraceFileName( myTraceFileName );
 
   /////////////////////////////////////////////////////////////////////
   // autoload any file names that were passed in on the command line
@@ -42,6 +42,7 @@
 #include "qgsmaprendererparalleljob.h"
 #include "qgsmaprenderersequentialjob.h"
 #include "qgsproject.h"
+#include "qgsrendertrace.h"
 
 const char *pre[] = { "user", "sys", "total", "wall" };
 
@@ -204,6 +205,10 @@ void QgsBench::render()
     else
       job = new QgsMapRendererSequentialJob( mMapSettings );
 
+    QgsRenderTrace trace;
+    if ( !mTraceFileName.isEmpty() )
+      job->setRenderTrace( &trace );
+
     start();
     job->start();
     job->waitForFinished();
@@ -211,6 +216,11 @@ void QgsBench::render()
 
     mImage = job->renderedImage();
     delete job;
+
+    if ( !mTraceFileName.isEmpty() && i == mIterations - 1 && !trace.writeChromeTrace( mTraceFileName ) )
+    {
+      fprintf( stderr, "Cannot write trace to %s\n", mTraceFileName.toLocal8Bit().constData() );
+    }
   }
 
 
@@ -60,6 +60,9 @@ class QgsBench :  public QObject
 
     void setParallel( bool enabled ) { mParallel = enabled; }
 
+    // record a trace of the last rendering cycle and write it to the given file
+    void setTraceFileName( const QString &fileName ) { mTraceFileName = fileName; }
+
   public slots:
     void readProject( const QDomDocument &doc );
 
@@ -94,6 +97,8 @@ class QgsBench :  public QObject
     QgsMapSettings mMapSettings;
 
     bool mParallel;
+
+    QString mTraceFileName;
 };
 
 #endif // QGSBENCH_H
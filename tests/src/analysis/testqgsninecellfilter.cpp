@@ -0,0 +1,182 @@
+/***************************************************************************
+     testqgsninecellfilter.cpp
+     --------------------------------------
+    Date                 : October 2026
+    Copyright            : (C) 2026 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgstest.h"
+
+#include "qgsaspectfilter.h"
+#include "qgshillshadefilter.h"
+#include "qgsruggednessfilter.h"
+#include "qgsslopefilter.h"
+#include "qgstotalcurvaturefilter.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gdal.h>
+
+static QString _tempFile( const QString &name )
+{
+  return QStringLiteral( "%1/ninecelltest-%2.tif" ).arg( QDir::tempPath(), name );
+}
+
+/** \ingroup UnitTests
+ * This is a unit test for the nine cell filters
+ */
+class TestQgsNineCellFilter : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSlope();
+    void testAspect();
+    void testHillshade();
+    void testRuggedness();
+    void testTotalCurvature();
+
+  private:
+    //! Checks that processRaster() gives the same values as processNineCellWindow() for each cell
+    void checkFilter( QgsNineCellFilter *filter, const QString &outputFile );
+
+    QString mDemFile;
+    int mWidth = 0;
+    int mHeight = 0;
+    std::vector< float > mDem;
+};
+
+void TestQgsNineCellFilter::initTestCase()
+{
+  GDALAllRegister();
+
+  // a synthetic DEM with some nodata cells, with enough rows to be processed in several strips
+  mDemFile = _tempFile( QStringLiteral( "dem" ) );
+  mWidth = 1200;
+  mHeight = 2000;
+  mDem.resize( static_cast< size_t >( mWidth ) * mHeight );
+  for ( int row = 0; row < mHeight; ++row )
+  {
+    for ( int col = 0; col < mWidth; ++col )
+    {
+      float value = 500 + 200 * std::sin( col / 60.0 ) * std::cos( row / 90.0 ) + ( ( col * 7 + row * 13 ) % 11 );
+      if ( ( col * 31 + row * 17 ) % 97 == 0 || ( row > 700 && row < 720 && col > 100 && col < 130 ) )
+        value = -9999;
+      mDem[ static_cast< size_t >( row ) * mWidth + col ] = value;
+    }
+  }
+
+  GDALDriverH driver = GDALGetDriverByName( "GTiff" );
+  QVERIFY( driver );
+  GDALDatasetH dataset = GDALCreate( driver, mDemFile.toUtf8().constData(), mWidth, mHeight, 1, GDT_Float32, nullptr );
+  QVERIFY( dataset );
+  double geoTransform[6] = { 100000, 10, 0, 200000, 0, -10 };
+  GDALSetGeoTransform( dataset, geoTransform );
+  GDALRasterBandH band = GDALGetRasterBand( dataset, 1 );
+  GDALSetRasterNoDataValue( band, -9999 );
+  QCOMPARE( GDALRasterIO( band, GF_Write, 0, 0, mWidth, mHeight, mDem.data(), mWidth, mHeight, GDT_Float32, 0, 0 ), CE_None );
+  GDALClose( dataset );
+}
+
+void TestQgsNineCellFilter::cleanupTestCase()
+{
+  QFile::remove( mDemFile );
+}
+
+void TestQgsNineCellFilter::checkFilter( QgsNineCellFilter *filter, const QString &outputFile )
+{
+  QCOMPARE( filter->processRaster( nullptr ), 0 );
+  QCOMPARE( filter->inputNodataValue(), -9999.0 );
+  QCOMPARE( filter->cellSizeX(), 10.0 );
+  QCOMPARE( filter->cellSizeY(), 10.0 );
+
+  GDALDatasetH dataset = GDALOpen( outputFile.toUtf8().constData(), GA_ReadOnly );
+  QVERIFY( dataset );
+  QCOMPARE( GDALGetRasterXSize( dataset ), mWidth );
+  QCOMPARE( GDALGetRasterYSize( dataset ), mHeight );
+  std::vector< float > result( mDem.size() );
+  QCOMPARE( GDALRasterIO( GDALGetRasterBand( dataset, 1 ), GF_Read, 0, 0, mWidth, mHeight, result.data(), mWidth, mHeight, GDT_Float32, 0, 0 ), CE_None );
+  GDALClose( dataset );
+  QFile::remove( outputFile );
+
+  // the expected values, with nodata values around the layer extent
+  float nodata = -9999;
+  auto cell = [&]( int row, int col ) -> float *
+  {
+    if ( row < 0 || row >= mHeight || col < 0 || col >= mWidth )
+      return &nodata;
+    return &mDem[ static_cast< size_t >( row ) * mWidth + col ];
+  };
+
+  int nodataCount = 0;
+  for ( int row = 0; row < mHeight; ++row )
+  {
+    for ( int col = 0; col < mWidth; ++col )
+    {
+      float expected = filter->processNineCellWindow( cell( row - 1, col - 1 ), cell( row - 1, col ), cell( row - 1, col + 1 ),
+                       cell( row, col - 1 ), cell( row, col ), cell( row, col + 1 ),
+                       cell( row + 1, col - 1 ), cell( row + 1, col ), cell( row + 1, col + 1 ) );
+      float value = result[ static_cast< size_t >( row ) * mWidth + col ];
+      if ( expected == filter->outputNodataValue() )
+        nodataCount++;
+      if ( !qgsDoubleNear( value, expected, 0.0001 * std::max( 1.0f, std::fabs( expected ) ) ) )
+      {
+        QFAIL( QStringLiteral( "Value %1 at row %2, column %3 differs from %4" ).arg( value ).arg( row ).arg( col ).arg( expected ).toUtf8().constData() );
+      }
+    }
+  }
+  QVERIFY( nodataCount > 0 );
+}
+
+void TestQgsNineCellFilter::testSlope()
+{
+  QString outputFile = _tempFile( QStringLiteral( "slope" ) );
+  QgsSlopeFilter filter( mDemFile, outputFile, QStringLiteral( "GTiff" ) );
+  checkFilter( &filter, outputFile );
+}
+
+void TestQgsNineCellFilter::testAspect()
+{
+  QString outputFile = _tempFile( QStringLiteral( "aspect" ) );
+  QgsAspectFilter filter( mDemFile, outputFile, QStringLiteral( "GTiff" ) );
+  checkFilter( &filter, outputFile );
+}
+
+void TestQgsNineCellFilter::testHillshade()
+{
+  QString outputFile = _tempFile( QStringLiteral( "hillshade" ) );
+  QgsHillshadeFilter filter( mDemFile, outputFile, QStringLiteral( "GTiff" ), 315, 45 );
+  checkFilter( &filter, outputFile );
+}
+
+void TestQgsNineCellFilter::testRuggedness()
+{
+  QString outputFile = _tempFile( QStringLiteral( "ruggedness" ) );
+  QgsRuggednessFilter filter( mDemFile, outputFile, QStringLiteral( "GTiff" ) );
+  checkFilter( &filter, outputFile );
+}
+
+void TestQgsNineCellFilter::testTotalCurvature()
+{
+  QString outputFile = _tempFile( QStringLiteral( "curvature" ) );
+  QgsTotalCurvatureFilter filter( mDemFile, outputFile, QStringLiteral( "GTiff" ) );
+  checkFilter( &filter, outputFile );
+}
+
+QGSTEST_MAIN( TestQgsNineCellFilter )
+#include "testqgsninecellfilter.moc"
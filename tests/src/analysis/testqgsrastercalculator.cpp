@@ -22,6 +22,8 @@ Email                : nyall dot dawson at gmail dot com
 #include "qgsapplication.h"
 #include "qgsproject.h"
 
+#include <cfloat>
+
 Q_DECLARE_METATYPE( QgsRasterCalcNode::Operator )
 
 
@@ -57,6 +59,8 @@ class TestQgsRasterCalculator : public QObject
 
     void calcWithLayers();
     void calcWithReprojectedLayers();
+    void calcInStrips(); //test calculation of outputs with several strips against calculating the tree
+    void calcConstant();
 
   private:
 
@@ -532,5 +536,107 @@ void TestQgsRasterCalculator::calcWithReprojectedLayers()
   delete block;
 }
 
+void TestQgsRasterCalculator::calcInStrips()
+{
+  QVector<QgsRasterCalculatorEntry> entries;
+  for ( int band = 1; band <= 3; ++band )
+  {
+    QgsRasterCalculatorEntry entry;
+    entry.bandNumber = band;
+    entry.raster = mpLandsatRasterLayer;
+    entry.ref = QStringLiteral( "landsat@%1" ).arg( band );
+    entries << entry;
+  }
+
+  // large enough for several strips of rows, which start at the edges of source rows
+  QgsRectangle extent = mpLandsatRasterLayer->extent();
+  int columns = 2097;
+  int rows = 1000;
+
+  QTemporaryFile tmpFile;
+  tmpFile.open(); // fileName is no avialable until open
+  QString tmpName = tmpFile.fileName();
+  tmpFile.close();
+
+  // includes divisions by zero and square roots of negative numbers, which give nodata
+  QString formula = QStringLiteral( "( \"landsat@1\" - \"landsat@2\" ) / ( \"landsat@1\" + \"landsat@2\" - 250 ) + sqrt( \"landsat@3\" - 130 ) * 2 ^ 0.5"
+                                    " - ( \"landsat@1\" > 125 AND \"landsat@2\" <= 130 ) * -log10( \"landsat@3\" )" );
+  QgsRasterCalculator rc( formula, tmpName, QStringLiteral( "GTiff" ), extent, mpLandsatRasterLayer->crs(), columns, rows, entries );
+  QCOMPARE( rc.processCalculation(), 0 );
+
+  // calculate the whole raster at once with the tree
+  QString error;
+  QgsRasterCalcNode *calcNode = QgsRasterCalcNode::parseRasterCalcString( formula, error );
+  QVERIFY( calcNode );
+  QMap<QString, QgsRasterBlock *> rasterData;
+  Q_FOREACH ( const QgsRasterCalculatorEntry &entry, entries )
+  {
+    rasterData.insert( entry.ref, mpLandsatRasterLayer->dataProvider()->block( entry.bandNumber, extent, columns, rows ) );
+  }
+  QgsRasterMatrix expected;
+  expected.setNodataValue( -FLT_MAX );
+  QVERIFY( calcNode->calculate( rasterData, expected ) );
+  QCOMPARE( expected.nColumns(), columns );
+  QCOMPARE( expected.nRows(), rows );
+
+  QgsRasterLayer *result = new QgsRasterLayer( tmpName, QStringLiteral( "result" ) );
+  QCOMPARE( result->width(), columns );
+  QCOMPARE( result->height(), rows );
+  QgsRasterBlock *block = result->dataProvider()->block( 1, extent, columns, rows );
+  int nodataCount = 0;
+  for ( int i = 0; i < columns * rows; ++i )
+  {
+    if ( expected.data()[i] == expected.nodataValue() )
+    {
+      QVERIFY( block->isNoData( i ) );
+      nodataCount++;
+    }
+    else
+    {
+      QCOMPARE( block->value( i ), static_cast< double >( static_cast< float >( expected.data()[i] ) ) );
+    }
+  }
+  QVERIFY( nodataCount > 0 );
+  QVERIFY( nodataCount < columns * rows );
+
+  delete result;
+  delete block;
+  delete calcNode;
+  qDeleteAll( rasterData );
+}
+
+void TestQgsRasterCalculator::calcConstant()
+{
+  QgsRasterCalculatorEntry entry1;
+  entry1.bandNumber = 1;
+  entry1.raster = mpLandsatRasterLayer;
+  entry1.ref = QStringLiteral( "landsat@1" );
+  QVector<QgsRasterCalculatorEntry> entries;
+  entries << entry1;
+
+  QgsRectangle extent( 783235, 3348110, 783350, 3347960 );
+
+  QTemporaryFile tmpFile;
+  tmpFile.open(); // fileName is no avialable until open
+  QString tmpName = tmpFile.fileName();
+  tmpFile.close();
+
+  QgsRasterCalculator rc( QStringLiteral( "2 * 3 + sqrt( 4 )" ), tmpName, QStringLiteral( "GTiff" ), extent, 2, 3, entries );
+  QCOMPARE( rc.processCalculation(), 0 );
+
+  QgsRasterLayer *result = new QgsRasterLayer( tmpName, QStringLiteral( "result" ) );
+  QgsRasterBlock *block = result->dataProvider()->block( 1, extent, 2, 3 );
+  for ( int i = 0; i < 6; ++i )
+  {
+    QCOMPARE( block->value( i ), 8.0 );
+  }
+  delete result;
+  delete block;
+
+  // rasters which are not in the entries
+  QgsRasterCalculator rc2( QStringLiteral( "\"landsat@1\" + \"missing@1\"" ), tmpName, QStringLiteral( "GTiff" ), extent, 2, 3, entries );
+  QCOMPARE( rc2.processCalculation(), static_cast< int >( QgsRasterCalculator::InputLayerError ) );
+}
+
 QGSTEST_MAIN( TestQgsRasterCalculator )
 #include "testqgsrastercalculator.moc"
@@ -22,6 +22,14 @@
 #include "qgsrasterlayer.h"
 #include "qgszonalstatistics.h"
 #include "qgsproject.h"
+#include "qgsvectordataprovider.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <gdal.h>
 
 /** \ingroup UnitTests
  * This is a unit test for the zonal statistics class
@@ -37,6 +45,7 @@ class TestQgsZonalStatistics : public QObject
     void cleanup() {}
 
     void testStatistics();
+    void testScanline();
 
   private:
     QgsVectorLayer *mVectorLayer = nullptr;
@@ -175,5 +184,148 @@ void TestQgsZonalStatistics::testStatistics()
   QCOMPARE( f.attribute( "myqgis2_va" ).toDouble(), 2.0 );
 }
 
+void TestQgsZonalStatistics::testScanline()
+{
+  // a raster with several tiles and some nodata cells
+  const int width = 700;
+  const int height = 600;
+  const double originX = 1000;
+  const double originY = 5000;
+  const double cellSize = 2;
+  const float nodata = -9999;
+  std::vector< float > data( static_cast< size_t >( width ) * height );
+  for ( int row = 0; row < height; ++row )
+  {
+    for ( int col = 0; col < width; ++col )
+    {
+      data[ static_cast< size_t >( row ) * width + col ] = ( col + row ) % 29 == 0 ? nodata : ( col * 3 + row * 7 ) % 13;
+    }
+  }
+  QString rasterFile = QDir::tempPath() + "/zonalstatistics_scanline.tif";
+  GDALAllRegister();
+  GDALDatasetH dataset = GDALCreate( GDALGetDriverByName( "GTiff" ), rasterFile.toUtf8().constData(), width, height, 1, GDT_Float32, nullptr );
+  QVERIFY( dataset );
+  double geoTransform[6] = { originX, cellSize, 0, originY, 0, -cellSize };
+  GDALSetGeoTransform( dataset, geoTransform );
+  GDALRasterBandH band = GDALGetRasterBand( dataset, 1 );
+  GDALSetRasterNoDataValue( band, nodata );
+  QCOMPARE( GDALRasterIO( band, GF_Write, 0, 0, width, height, data.data(), width, height, GDT_Float32, 0, 0 ), CE_None );
+  GDALClose( dataset );
+
+  // many small polygons, a polygon with a hole spanning several tiles, a multipolygon,
+  // a polygon smaller than a cell and a polygon which is partly outside of the raster
+  QStringList wkts;
+  for ( int i = 0; i < 15; ++i )
+  {
+    for ( int j = 0; j < 12; ++j )
+    {
+      QStringList vertices;
+      for ( int k = 0; k <= 5; ++k )
+      {
+        double angle = 2 * M_PI * ( k % 5 ) / 5 + 0.1 * i;
+        double radius = 20 + ( i + j ) % 4 * 4.3;
+        vertices << QStringLiteral( "%1 %2" ).arg( originX + 45.3 + i * 90 + radius * std::cos( angle ), 0, 'f', 6 ).arg( originY - 45.7 - j * 95 + radius * std::sin( angle ), 0, 'f', 6 );
+      }
+      wkts << QStringLiteral( "Polygon ((%1))" ).arg( vertices.join( QStringLiteral( ", " ) ) );
+    }
+  }
+  wkts << QStringLiteral( "Polygon ((1010.3 4990.1, 2350.7 4850.3, 2200.1 3900.9, 1100.5 3950.2, 1010.3 4990.1), (1500.2 4700.7, 1900.3 4600.1, 1700.9 4200.4, 1500.2 4700.7))" );
+  wkts << QStringLiteral( "MultiPolygon (((1200.3 4400.2, 1260.7 4450.1, 1230.2 4350.6, 1200.3 4400.2)), ((1800.1 4300.3, 1850.4 4310.9, 1820.6 4250.2, 1800.1 4300.3)))" );
+  wkts << QStringLiteral( "Polygon ((1500.2 4500.2, 1500.9 4500.2, 1500.9 4500.9, 1500.2 4500.2))" );
+  wkts << QStringLiteral( "Polygon ((2350.3 4000.1, 2500.6 4020.4, 2450.2 3880.7, 2350.3 4000.1))" );
+
+  QgsVectorLayer layer( QStringLiteral( "Polygon" ), QStringLiteral( "zones" ), QStringLiteral( "memory" ) );
+  QgsFeatureList features;
+  Q_FOREACH ( const QString &wkt, wkts )
+  {
+    QgsFeature feature;
+    feature.setGeometry( QgsGeometry::fromWkt( wkt ) );
+    QVERIFY( feature.hasGeometry() );
+    features << feature;
+  }
+  QVERIFY( layer.dataProvider()->addFeatures( features ) );
+
+  QgsRasterLayer raster( rasterFile, QStringLiteral( "raster" ), QStringLiteral( "gdal" ) );
+  QVERIFY( raster.isValid() );
+  QgsZonalStatistics zs( &layer, &raster, QStringLiteral( "s" ), 1, QgsZonalStatistics::All );
+  QCOMPARE( zs.method(), QgsZonalStatistics::CellCenterTest );
+  zs.setMethod( QgsZonalStatistics::Scanline );
+  QCOMPARE( zs.method(), QgsZonalStatistics::Scanline );
+  QCOMPARE( zs.calculateStatistics( nullptr ), 0 );
+
+  // compare with the cells whose centers are inside the polygons
+  int checked = 0;
+  QgsFeature f;
+  QgsFeatureIterator it = layer.getFeatures();
+  while ( it.nextFeature( f ) )
+  {
+    QgsGeometry geometry = f.geometry();
+    QgsRectangle box = geometry.boundingBox();
+    int firstColumn = std::max( 0, static_cast< int >( std::floor( ( box.xMinimum() - originX ) / cellSize ) ) );
+    int lastColumn = std::min( width - 1, static_cast< int >( std::floor( ( box.xMaximum() - originX ) / cellSize ) ) );
+    int firstRow = std::max( 0, static_cast< int >( std::floor( ( originY - box.yMaximum() ) / cellSize ) ) );
+    int lastRow = std::min( height - 1, static_cast< int >( std::floor( ( originY - box.yMinimum() ) / cellSize ) ) );
+    std::vector< float > values;
+    for ( int row = firstRow; row <= lastRow; ++row )
+    {
+      for ( int col = firstColumn; col <= lastColumn; ++col )
+      {
+        float value = data[ static_cast< size_t >( row ) * width + col ];
+        QgsPoint center( originX + ( col + 0.5 ) * cellSize, originY - ( row + 0.5 ) * cellSize );
+        if ( value != nodata && geometry.contains( &center ) )
+          values.push_back( value );
+      }
+    }
+
+    if ( values.size() <= 1 )
+    {
+      // precise intersection with the cells
+      QVERIFY( f.attribute( "scount" ).toDouble() > 0 );
+      QVERIFY( f.attribute( "scount" ).toDouble() < 1 );
+      continue;
+    }
+
+    std::sort( values.begin(), values.end() );
+    double sum = 0;
+    std::map< float, int > valueCounts;
+    for ( float value : values )
+    {
+      sum += value;
+      valueCounts[value]++;
+    }
+    double count = values.size();
+    double mean = sum / count;
+    double sumSquared = 0;
+    for ( float value : values )
+      sumSquared += ( value - mean ) * ( value - mean );
+    double median = values.size() % 2 ? values[values.size() / 2] : ( values[values.size() / 2 - 1] + values[values.size() / 2] ) / 2.0;
+    float minority = valueCounts.begin()->first;
+    float majority = valueCounts.begin()->first;
+    for ( const auto &valueCount : valueCounts )
+    {
+      if ( valueCount.second < valueCounts[minority] )
+        minority = valueCount.first;
+      if ( valueCount.second > valueCounts[majority] )
+        majority = valueCount.first;
+    }
+
+    QCOMPARE( f.attribute( "scount" ).toDouble(), count );
+    QVERIFY( qgsDoubleNear( f.attribute( "ssum" ).toDouble(), sum, 0.001 ) );
+    QVERIFY( qgsDoubleNear( f.attribute( "smean" ).toDouble(), mean, 0.000001 ) );
+    QCOMPARE( f.attribute( "smedian" ).toDouble(), median );
+    QVERIFY( qgsDoubleNear( f.attribute( "sstdev" ).toDouble(), std::sqrt( sumSquared / count ), 0.000001 ) );
+    QCOMPARE( f.attribute( "smin" ).toDouble(), static_cast< double >( values.front() ) );
+    QCOMPARE( f.attribute( "smax" ).toDouble(), static_cast< double >( values.back() ) );
+    QCOMPARE( f.attribute( "srange" ).toDouble(), static_cast< double >( values.back() - values.front() ) );
+    QCOMPARE( f.attribute( "sminority" ).toDouble(), static_cast< double >( minority ) );
+    QCOMPARE( f.attribute( "smajority" ).toDouble(), static_cast< double >( majority ) );
+    QCOMPARE( f.attribute( "svariety" ).toInt(), static_cast< int >( valueCounts.size() ) );
+    checked++;
+  }
+  QCOMPARE( checked, wkts.size() - 1 );
+
+  QFile::remove( rasterFile );
+}
+
 QGSTEST_MAIN( TestQgsZonalStatistics )
 #include "testqgszonalstatistics.moc"
@@ -24,6 +24,32 @@
 #include <qgscontrastenhancement.h>
 #include <qgslinearminmaxenhancement.h>
 #include <qgslinearminmaxenhancementwithclip.h>
+#include <qgssinglebandgrayrenderer.h>
+#include <qgsmultibandcolorrenderer.h>
+#include <memory>
+
+//! In-memory raster input returning copies of a single band block
+class TestBlockInput : public QgsRasterInterface
+{
+  public:
+    explicit TestBlockInput( QgsRasterBlock *block )
+      : mBlock( block )
+    {}
+
+    QgsRasterInterface *clone() const override { return nullptr; }
+    Qgis::DataType dataType( int ) const override { return mBlock->dataType(); }
+    int bandCount() const override { return 1; }
+
+    QgsRasterBlock *block( int, const QgsRectangle &, int, int, QgsRasterBlockFeedback * = nullptr ) override
+    {
+      QgsRasterBlock *block = new QgsRasterBlock( mBlock->dataType(), mBlock->width(), mBlock->height() );
+      block->setData( mBlock->data() );
+      return block;
+    }
+
+  private:
+    QgsRasterBlock *mBlock = nullptr;
+};
 
 /** \ingroup UnitTests
  * This is a unit test for the ContrastEnhancements contrast enhancement classes.
@@ -40,6 +66,7 @@ class TestContrastEnhancements: public QObject
     void clipMinMaxEnhancementTest();
     void linearMinMaxEnhancementWithClipTest();
     void linearMinMaxEnhancementTest();
+    void bulkEnhancementTest();
   private:
     QString mReport;
 };
@@ -102,5 +129,93 @@ void TestContrastEnhancements::linearMinMaxEnhancementTest()
   //Original pixel value of 240 should be scaled to 255
   QVERIFY( 255.0 == myEnhancement.enhance( 240.0 ) );
 }
+
+void TestContrastEnhancements::bulkEnhancementTest()
+{
+  // the bulk enhancement must give the same results as enhancing value by value
+  QList< QgsContrastEnhancement::ContrastEnhancementAlgorithm > algorithms;
+  algorithms << QgsContrastEnhancement::NoEnhancement
+             << QgsContrastEnhancement::StretchToMinimumMaximum
+             << QgsContrastEnhancement::StretchAndClipToMinimumMaximum
+             << QgsContrastEnhancement::ClipToMinimumMaximum;
+  QList< Qgis::DataType > dataTypes;
+  dataTypes << Qgis::Byte << Qgis::Int16 << Qgis::Float32;
+
+  QVector<float> values;
+  for ( int i = -300; i <= 300; ++i )
+  {
+    values << i + 0.25f * ( i % 4 );
+  }
+  values << std::numeric_limits<float>::quiet_NaN();
+
+  Q_FOREACH ( Qgis::DataType dataType, dataTypes )
+  {
+    Q_FOREACH ( QgsContrastEnhancement::ContrastEnhancementAlgorithm algorithm, algorithms )
+    {
+      QgsContrastEnhancement enhancement( dataType );
+      enhancement.setMinimumValue( 10.0, false );
+      enhancement.setMaximumValue( 240.0, false );
+      enhancement.setContrastEnhancementAlgorithm( algorithm );
+
+      QVector<int> enhanced( values.size() );
+      enhancement.enhanceContrast( values.constData(), enhanced.data(), values.size() );
+
+      for ( int i = 0; i < values.size(); ++i )
+      {
+        const double value = values.at( i );
+        if ( dataType != Qgis::Float32 && value != std::floor( value ) )
+          continue; // not a valid value of the data type
+        if ( qIsNaN( value ) || !enhancement.isValueInDisplayableRange( value ) )
+        {
+          QCOMPARE( enhanced.at( i ), -1 );
+        }
+        else if ( value >= QgsContrastEnhancement::minimumValuePossible( dataType ) && value <= QgsContrastEnhancement::maximumValuePossible( dataType ) )
+        {
+          QCOMPARE( enhanced.at( i ), enhancement.enhanceContrast( value ) );
+        }
+      }
+    }
+  }
+
+  // Float64 and Int32 values are not rounded to floats by the renderers, so a pixel at the exact
+  // maximum is drawn with the full intensity. 2^24 + 1 would be rounded down to 2^24 as a float
+  const double maximum = 16777217.0;
+  QList< Qgis::DataType > preciseDataTypes;
+  preciseDataTypes << Qgis::Float64 << Qgis::Int32;
+  Q_FOREACH ( Qgis::DataType dataType, preciseDataTypes )
+  {
+    QgsRasterBlock block( dataType, 2, 1 );
+    block.setValue( 0, 0, 1.0 );
+    block.setValue( 0, 1, maximum );
+    TestBlockInput input( &block );
+    const QgsRectangle extent( 0, 0, 2, 1 );
+
+    QgsContrastEnhancement *grayEnhancement = new QgsContrastEnhancement( dataType );
+    grayEnhancement->setContrastEnhancementAlgorithm( QgsContrastEnhancement::StretchAndClipToMinimumMaximum );
+    grayEnhancement->setMinimumValue( 1.0 );
+    grayEnhancement->setMaximumValue( maximum );
+    QCOMPARE( grayEnhancement->enhanceContrast( maximum ), 255 );
+
+    QgsSingleBandGrayRenderer grayRenderer( &input, 1 );
+    grayRenderer.setContrastEnhancement( grayEnhancement );
+    std::unique_ptr< QgsRasterBlock > grayOutput( grayRenderer.block( 1, extent, 2, 1 ) );
+    QCOMPARE( grayOutput->color( 0, 0 ), qRgba( 0, 0, 0, 255 ) );
+    QCOMPARE( grayOutput->color( 0, 1 ), qRgba( 255, 255, 255, 255 ) );
+
+    QgsContrastEnhancement *enhancements[3];
+    for ( int i = 0; i < 3; ++i )
+    {
+      enhancements[i] = new QgsContrastEnhancement( dataType );
+      enhancements[i]->setContrastEnhancementAlgorithm( QgsContrastEnhancement::StretchAndClipToMinimumMaximum );
+      enhancements[i]->setMinimumValue( 1.0 );
+      enhancements[i]->setMaximumValue( maximum );
+    }
+    QgsMultiBandColorRenderer colorRenderer( &input, 1, 1, 1, enhancements[0], enhancements[1], enhancements[2] );
+    std::unique_ptr< QgsRasterBlock > colorOutput( colorRenderer.block( 1, extent, 2, 1 ) );
+    QCOMPARE( colorOutput->color( 0, 0 ), qRgba( 0, 0, 0, 255 ) );
+    QCOMPARE( colorOutput->color( 0, 1 ), qRgba( 255, 255, 255, 255 ) );
+  }
+}
+
 QGSTEST_MAIN( TestContrastEnhancements )
 #include "testcontrastenhancements.moc"
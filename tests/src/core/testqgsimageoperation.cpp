@@ -81,6 +81,9 @@ class TestQgsImageOperation : public QObject
     void flipHorizontal();
     void flipVertical();
 
+    //threaded operations
+    void distanceTransformThreaded();
+
   private:
 
     QString mReport;
@@ -446,6 +449,27 @@ void TestQgsImageOperation::flipVertical()
   QVERIFY( result );
 }
 
+void TestQgsImageOperation::distanceTransformThreaded()
+{
+  // large enough to be transformed in threads
+  const int width = 700;
+  const int height = 500;
+  QVector< double > serial( width * height, 1E20 );
+  for ( int y = 0; y < height; y += 37 )
+  {
+    for ( int x = ( y * 13 ) % 53; x < width; x += 53 )
+    {
+      serial[ x + y * width ] = 0;
+    }
+  }
+  QVector< double > threaded = serial;
+
+  QgsImageOperation::distanceTransform2d( serial.data(), width, height, false );
+  QgsImageOperation::distanceTransform2d( threaded.data(), width, height, true );
+  QCOMPARE( threaded, serial );
+  QCOMPARE( serial.at( 1 + width ), 2.0 );
+}
+
 //
 // Private helper functions not called directly by CTest
 //
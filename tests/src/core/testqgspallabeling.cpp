@@ -18,6 +18,9 @@
 #include <QStringList>
 
 #include "qgspallabeling.h"
+#include "qgstextlayoutcache.h"
+#include "qgsfontutils.h"
+#include <QFontMetricsF>
 
 class TestQgsPalLabeling: public QObject
 {
@@ -30,6 +33,7 @@ class TestQgsPalLabeling: public QObject
     void cleanup();// will be called after every testfunction.
     void wrapChar();//test wrapping text lines
     void graphemes(); //test splitting strings to graphemes
+    void textLayoutCache();
 
   private:
 };
@@ -169,5 +173,64 @@ void TestQgsPalLabeling::graphemes()
             << expected2Pt11 );
 }
 
+void TestQgsPalLabeling::textLayoutCache()
+{
+  QgsTextLayoutCache cache;
+  QFont font = QgsFontUtils::getStandardTestFont( QStringLiteral( "Bold" ), 12 );
+  QFontMetricsF fm( font );
+
+  QCOMPARE( cache.textWidth( font, QStringLiteral( "a label" ) ), fm.width( QStringLiteral( "a label" ) ) );
+  QCOMPARE( cache.count(), 1 );
+  QCOMPARE( cache.misses(), 1 );
+  QCOMPARE( cache.textWidth( font, QStringLiteral( "a label" ) ), fm.width( QStringLiteral( "a label" ) ) );
+  QCOMPARE( cache.hits(), 1 );
+
+  // path is stored alongside the width
+  QPainterPath expected;
+  expected.setFillRule( Qt::WindingFill );
+  expected.addText( 0, 0, font, QStringLiteral( "a label" ) );
+  QCOMPARE( cache.textPath( font, QStringLiteral( "a label" ) ), expected );
+  QCOMPARE( cache.count(), 1 );
+  QCOMPARE( cache.misses(), 2 );
+  QCOMPARE( cache.textPath( font, QStringLiteral( "a label" ) ), expected );
+  QCOMPARE( cache.hits(), 2 );
+
+  // different font properties must not share cached lines
+  QFont spacedFont = font;
+  spacedFont.setLetterSpacing( QFont::AbsoluteSpacing, 5 );
+  QCOMPARE( cache.textWidth( spacedFont, QStringLiteral( "a label" ) ), QFontMetricsF( spacedFont ).width( QStringLiteral( "a label" ) ) );
+  QCOMPARE( cache.count(), 2 );
+  QFont largerFont = font;
+  largerFont.setPixelSize( 30 );
+  cache.textWidth( largerFont, QStringLiteral( "a label" ) );
+  QCOMPARE( cache.count(), 3 );
+
+  // least recently used lines are discarded when the cache is full
+  QgsTextLayoutCache lineCache;
+  lineCache.textWidth( font, QStringLiteral( "label 1" ) );
+  QgsTextLayoutCache smallCache( 2 * lineCache.size() );
+  smallCache.textWidth( font, QStringLiteral( "label 1" ) );
+  smallCache.textWidth( font, QStringLiteral( "label 2" ) );
+  QCOMPARE( smallCache.count(), 2 );
+  smallCache.textWidth( font, QStringLiteral( "label 1" ) );
+  smallCache.textWidth( font, QStringLiteral( "label 3" ) );
+  QCOMPARE( smallCache.count(), 2 );
+  QCOMPARE( smallCache.hits(), 1 );
+  smallCache.textWidth( font, QStringLiteral( "label 1" ) );
+  QCOMPARE( smallCache.hits(), 2 );
+  smallCache.textWidth( font, QStringLiteral( "label 2" ) );
+  QCOMPARE( smallCache.hits(), 2 );
+
+  // lines with paths cost more than widths
+  int widthSize = cache.size();
+  cache.textPath( font, QStringLiteral( "another label" ) );
+  QVERIFY( cache.size() - widthSize > lineCache.size() );
+
+  cache.clear();
+  QCOMPARE( cache.count(), 0 );
+  QCOMPARE( cache.hits(), 0 );
+  QCOMPARE( cache.misses(), 0 );
+}
+
 QGSTEST_MAIN( TestQgsPalLabeling )
 #include "testqgspallabeling.moc"
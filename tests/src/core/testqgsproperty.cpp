@@ -23,6 +23,7 @@
 #include "qgsapplication.h"
 #include "qgscolorramp.h"
 #include "qgssymbollayerutils.h"
+#include "qgspropertyresultcache.h"
 #include <QObject>
 
 enum PropertyKeys
@@ -79,6 +80,7 @@ class TestQgsProperty : public QObject
     void staticProperty(); //test for QgsStaticProperty
     void fieldBasedProperty(); //test for QgsFieldBasedProperty
     void expressionBasedProperty(); //test for QgsExpressionBasedProperty
+    void expressionResultCache(); //test caching of expression based property results
     void equality();
     void propertyTransformer(); //test for QgsPropertyTransformer
     void propertyTransformerFromExpression(); // text converting expression into QgsPropertyTransformer
@@ -562,6 +564,107 @@ void TestQgsProperty::expressionBasedProperty()
   QVERIFY( p4.transformer() );
 }
 
+void TestQgsProperty::expressionResultCache()
+{
+  QgsFields fields;
+  fields.append( QgsField( "field1", QVariant::Int ) );
+  fields.append( QgsField( "field2", QVariant::String ) );
+  QgsFeature ft( fields );
+  ft.setAttributes( QgsAttributes() << QVariant( 5 ) << QVariant( "a" ) );
+  ft.setValid( true );
+
+  QgsExpressionContext context;
+  context.setFields( fields );
+  context.setFeature( ft );
+  QVERIFY( !context.propertyResultCache() );
+  context.setPropertyResultCacheEnabled( true );
+  QgsPropertyResultCache *cache = context.propertyResultCache();
+  QVERIFY( cache );
+
+  // identical expressions in different properties share results
+  QgsProperty property1 = QgsProperty::fromExpression( QStringLiteral( "\"field1\" * 2" ) );
+  QgsProperty property2 = QgsProperty::fromExpression( QStringLiteral( "\"field1\" * 2" ) );
+  QCOMPARE( property1.value( context, -1 ).toInt(), 10 );
+  QCOMPARE( cache->misses(), 1 );
+  QCOMPARE( cache->hits(), 0 );
+  QCOMPARE( property2.value( context, -1 ).toInt(), 10 );
+  QCOMPARE( cache->hits(), 1 );
+
+  // an unrelated attribute change still hits the cache
+  ft.setAttribute( 1, QVariant( "b" ) );
+  context.setFeature( ft );
+  QCOMPARE( property1.value( context, -1 ).toInt(), 10 );
+  QCOMPARE( cache->hits(), 2 );
+
+  // a referenced attribute change must not
+  ft.setAttribute( 0, QVariant( 6 ) );
+  context.setFeature( ft );
+  QCOMPARE( property1.value( context, -1 ).toInt(), 12 );
+  QCOMPARE( cache->misses(), 2 );
+  QCOMPARE( cache->count(), 2 );
+
+  // copies of the context share the cache
+  QgsExpressionContext copy( context );
+  QCOMPARE( copy.propertyResultCache(), cache );
+  QCOMPARE( property2.value( copy, -1 ).toInt(), 12 );
+  QCOMPARE( cache->hits(), 3 );
+
+  // expressions which depend on more than the attributes are never cached
+  QgsProperty property3 = QgsProperty::fromExpression( QStringLiteral( "\"field1\" + $id" ) );
+  property3.value( context, -1 );
+  QgsProperty property4 = QgsProperty::fromExpression( QStringLiteral( "\"field1\" + rand(1, 10)" ) );
+  property4.value( context, -1 );
+  QgsProperty property5 = QgsProperty::fromExpression( QStringLiteral( "CASE WHEN \"field1\" > 3 THEN @some_var END" ) );
+  property5.value( context, -1 );
+  QCOMPARE( cache->hits(), 3 );
+  QCOMPARE( cache->misses(), 2 );
+
+  // but conditions only using attributes are
+  QgsProperty property6 = QgsProperty::fromExpression( QStringLiteral( "CASE WHEN \"field1\" > 3 THEN upper(\"field2\") ELSE 'x' END" ) );
+  QCOMPARE( property6.value( context, QString() ).toString(), QStringLiteral( "B" ) );
+  QCOMPARE( property6.value( context, QString() ).toString(), QStringLiteral( "B" ) );
+  QCOMPARE( cache->hits(), 4 );
+  QCOMPARE( cache->misses(), 3 );
+
+  cache->clear();
+  QCOMPARE( cache->count(), 0 );
+  QCOMPARE( cache->hits(), 0 );
+
+  context.setPropertyResultCacheEnabled( false );
+  QVERIFY( !context.propertyResultCache() );
+  QCOMPARE( property1.value( context, -1 ).toInt(), 12 );
+
+  // times which only differ by milliseconds must not share results
+  QgsFields timeFields;
+  timeFields.append( QgsField( "dt", QVariant::DateTime ) );
+  QgsFeature timeFeature( timeFields );
+  timeFeature.setAttributes( QgsAttributes() << QVariant( QDateTime( QDate( 2017, 1, 1 ), QTime( 10, 0, 0, 100 ), Qt::UTC ) ) );
+  timeFeature.setValid( true );
+  QgsExpressionContext timeContext;
+  timeContext.setFields( timeFields );
+  timeContext.setFeature( timeFeature );
+  timeContext.setPropertyResultCacheEnabled( true );
+  QgsProperty epoch = QgsProperty::fromExpression( QStringLiteral( "epoch(\"dt\")" ) );
+  QCOMPARE( epoch.value( timeContext, 0 ).toLongLong(), Q_INT64_C( 1483264800100 ) );
+  timeFeature.setAttribute( 0, QVariant( QDateTime( QDate( 2017, 1, 1 ), QTime( 10, 0, 0, 200 ), Qt::UTC ) ) );
+  timeContext.setFeature( timeFeature );
+  QCOMPARE( epoch.value( timeContext, 0 ).toLongLong(), Q_INT64_C( 1483264800200 ) );
+  QCOMPARE( timeContext.propertyResultCache()->hits(), 0 );
+
+  // a full cache discards the least recently used results
+  QgsPropertyResultCache smallCache( 2 );
+  smallCache.insert( QStringLiteral( "a" ), 1 );
+  smallCache.insert( QStringLiteral( "b" ), 2 );
+  QVariant result;
+  QVERIFY( smallCache.lookup( QStringLiteral( "a" ), result ) );
+  smallCache.insert( QStringLiteral( "c" ), 3 );
+  QCOMPARE( smallCache.count(), 2 );
+  QVERIFY( smallCache.lookup( QStringLiteral( "a" ), result ) );
+  QCOMPARE( result.toInt(), 1 );
+  QVERIFY( !smallCache.lookup( QStringLiteral( "b" ), result ) );
+  QVERIFY( smallCache.lookup( QStringLiteral( "c" ), result ) );
+}
+
 void TestQgsProperty::equality()
 {
   QgsProperty dd1;
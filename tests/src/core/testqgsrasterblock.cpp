@@ -17,9 +17,13 @@
 #include <QObject>
 #include <QString>
 #include <QTemporaryFile>
+#include <memory>
+#include <cmath>
+#include <limits>
 
 #include "qgsrasterlayer.h"
 #include "qgsrasterdataprovider.h"
+#include "qgscolorrampshader.h"
 
 /** \ingroup UnitTests
  * This is a unit test for the QgsRasterBlock class.
@@ -43,6 +47,9 @@ class TestQgsRasterBlock : public QObject
 
     void testBasic();
     void testWrite();
+    void testValuesAsFloat();
+    void testLookupColors();
+    void testShadeValues();
 
   private:
 
@@ -217,6 +224,133 @@ void TestQgsRasterBlock::testWrite()
   delete block;
 }
 
+void TestQgsRasterBlock::testValuesAsFloat()
+{
+  // no data value
+  std::unique_ptr< QgsRasterBlock > block( mpRasterLayer->dataProvider()->block( 1, mpRasterLayer->extent(), mpRasterLayer->width(), mpRasterLayer->height() ) );
+  QVector<float> values = block->valuesAsFloat();
+  QCOMPARE( values.size(), 100 );
+  for ( int i = 0; i < values.size(); ++i )
+  {
+    if ( block->isNoData( i ) )
+      QVERIFY( qIsNaN( values.at( i ) ) );
+    else
+      QCOMPARE( static_cast< double >( values.at( i ) ), block->value( i ) );
+  }
+  QCOMPARE( values.at( 0 ), 2.0f );
+  QVERIFY( qIsNaN( values.at( 2 ) ) );
+
+  // no data bitmap
+  QgsRasterBlock block2( Qgis::Float64, 10, 2 );
+  for ( int i = 0; i < 20; ++i )
+    block2.setValue( static_cast< qgssize >( i ), i * 0.5 );
+  block2.setIsNoData( 1, 9 );
+  block2.setIsNoData( 3 );
+  values = block2.valuesAsFloat();
+  QCOMPARE( values.size(), 20 );
+  QCOMPARE( values.at( 0 ), 0.0f );
+  QCOMPARE( values.at( 1 ), 0.5f );
+  QVERIFY( qIsNaN( values.at( 3 ) ) );
+  QCOMPARE( values.at( 10 ), 5.0f );
+  QVERIFY( qIsNaN( values.at( 19 ) ) );
+
+  // non numeric block
+  QgsRasterBlock block3( Qgis::ARGB32, 2, 2 );
+  values = block3.valuesAsFloat();
+  QCOMPARE( values.size(), 4 );
+  QVERIFY( qIsNaN( values.at( 0 ) ) );
+}
+
+void TestQgsRasterBlock::testLookupColors()
+{
+  const QRgb table[] = { qRgb( 255, 0, 0 ), qRgb( 0, 255, 0 ) };
+  const int indexes[] = { 0, 1, 2, -1 };
+  QRgb colors[4];
+  QgsRasterBlock::lookupColors( indexes, colors, 4, table, 2, qRgba( 0, 0, 0, 0 ) );
+  QCOMPARE( colors[0], qRgb( 255, 0, 0 ) );
+  QCOMPARE( colors[1], qRgb( 0, 255, 0 ) );
+  QCOMPARE( colors[2], qRgba( 0, 0, 0, 0 ) );
+  QCOMPARE( colors[3], qRgba( 0, 0, 0, 0 ) );
+}
+
+void TestQgsRasterBlock::testShadeValues()
+{
+  QList<QgsColorRampShader::ColorRampItem> items;
+  items << QgsColorRampShader::ColorRampItem( 10, QColor( 255, 0, 0 ) )
+        << QgsColorRampShader::ColorRampItem( 100, QColor( 0, 255, 0, 128 ) )
+        << QgsColorRampShader::ColorRampItem( 1000, QColor( 0, 0, 255 ) );
+
+  QVector<float> values;
+  for ( int i = -20; i < 1200; ++i )
+    values << i << i + 0.3f;
+  values << std::numeric_limits<float>::quiet_NaN() << std::numeric_limits<float>::infinity();
+  QVector<QRgb> colors( values.size() );
+  const QRgb defaultColor = qRgba( 0, 0, 0, 0 );
+
+  const QList<QgsColorRampShader::Type> types = QList<QgsColorRampShader::Type>() << QgsColorRampShader::Interpolated << QgsColorRampShader::Discrete << QgsColorRampShader::Exact;
+  Q_FOREACH ( QgsColorRampShader::Type type, types )
+  {
+    QgsColorRampShader shader;
+    shader.setColorRampType( type );
+    shader.setColorRampItemList( items );
+    Q_FOREACH ( Qgis::DataType dataType, QList<Qgis::DataType>() << Qgis::Int16 << Qgis::Float32 )
+    {
+      shader.shadeValues( values.constData(), colors.data(), values.size(), dataType, defaultColor );
+      for ( int i = 0; i < values.size(); ++i )
+      {
+        // integer tables are only exact for integer values
+        if ( dataType == Qgis::Int16 && values.at( i ) != std::floor( values.at( i ) ) )
+          continue;
+
+        int red, green, blue, alpha;
+        if ( qIsNaN( values.at( i ) ) || !shader.shade( values.at( i ), &red, &green, &blue, &alpha ) )
+        {
+          QCOMPARE( colors.at( i ), defaultColor );
+          continue;
+        }
+        if ( alpha < 255 )
+        {
+          red *= ( alpha / 255.0 );
+          green *= ( alpha / 255.0 );
+          blue *= ( alpha / 255.0 );
+        }
+        // premultiplying may double the difference of one level
+        const int tolerance = alpha < 255 ? 2 : 1;
+        const QRgb color = colors.at( i );
+        QVERIFY( qAbs( qRed( color ) - red ) <= tolerance );
+        QVERIFY( qAbs( qGreen( color ) - green ) <= tolerance );
+        QVERIFY( qAbs( qBlue( color ) - blue ) <= tolerance );
+        QVERIFY( qAbs( qAlpha( color ) - alpha ) <= 1 );
+        if ( dataType == Qgis::Int16 || type != QgsColorRampShader::Interpolated )
+          QCOMPARE( color, qRgba( red, green, blue, alpha ) );
+      }
+    }
+  }
+
+  // copies share the lookup tables until their color ramp changes
+  QgsColorRampShader original;
+  original.setColorRampItemList( items );
+  QVector<QRgb> originalColors( values.size() );
+  original.shadeValues( values.constData(), originalColors.data(), values.size(), Qgis::Float32, defaultColor );
+  QgsColorRampShader copy( original );
+  copy.shadeValues( values.constData(), colors.data(), values.size(), Qgis::Float32, defaultColor );
+  QCOMPARE( colors, originalColors );
+
+  copy.setColorRampItemList( QList<QgsColorRampShader::ColorRampItem>() << QgsColorRampShader::ColorRampItem( 10, QColor( 0, 0, 0 ) )
+                             << QgsColorRampShader::ColorRampItem( 1000, QColor( 255, 255, 255 ) ) );
+  copy.shadeValues( values.constData(), colors.data(), values.size(), Qgis::Float32, defaultColor );
+  QVERIFY( colors != originalColors );
+  int red, green, blue, alpha;
+  QVERIFY( copy.shade( 505, &red, &green, &blue, &alpha ) );
+  // interpolated colors from the binned table differ by at most one level
+  const QRgb color = colors.at( 2 * ( 505 + 20 ) );
+  QVERIFY( qAbs( qRed( color ) - red ) <= 1 );
+  QVERIFY( qAbs( qGreen( color ) - green ) <= 1 );
+  QVERIFY( qAbs( qBlue( color ) - blue ) <= 1 );
+  original.shadeValues( values.constData(), colors.data(), values.size(), Qgis::Float32, defaultColor );
+  QCOMPARE( colors, originalColors );
+}
+
 QGSTEST_MAIN( TestQgsRasterBlock )
 
 #include "testqgsrasterblock.moc"
@@ -117,6 +117,46 @@ class TestQgsRuleBasedRenderer: public QObject
       delete layer;
     }
 
+    void test_filter()
+    {
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "fld" ), QVariant::Int ) );
+
+      RRule *rootRule = new RRule( nullptr );
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 0, 0, QStringLiteral( "fld >= 5" ) ) );
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 0, 0, QStringLiteral( "fld <= 10" ) ) );
+      // duplicate filter
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 0, 0, QStringLiteral( "fld <= 10" ) ) );
+      // out of scale
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 1, 100, QStringLiteral( "fld = 1" ) ) );
+      // invalid filter
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 0, 0, QStringLiteral( "fld >" ) ) );
+      // no symbol and no children
+      rootRule->appendChild( new RRule( nullptr, 0, 0, QStringLiteral( "fld = 2" ) ) );
+      QgsRuleBasedRenderer r( rootRule );
+
+      QgsRenderContext ctx; // dummy render context
+      ctx.setRendererScale( 1000 );
+      ctx.expressionContext().setFields( fields );
+      r.startRender( ctx, fields );
+      QCOMPARE( r.filter( fields ), QStringLiteral( "(fld >= 5) OR (fld <= 10)" ) );
+      r.stopRender( ctx );
+
+      // an else rule matches everything not matched by the other rules
+      rootRule->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 0, 0, QStringLiteral( "ELSE" ) ) );
+      r.startRender( ctx, fields );
+      QCOMPARE( r.filter( fields ), QStringLiteral( "TRUE" ) );
+      r.stopRender( ctx );
+
+      // no rule can render anything at this scale
+      RRule *outOfScaleRoot = new RRule( nullptr );
+      outOfScaleRoot->appendChild( new RRule( QgsSymbol::defaultSymbol( QgsWkbTypes::PointGeometry ), 1, 100, QStringLiteral( "fld = 1" ) ) );
+      QgsRuleBasedRenderer r2( outOfScaleRoot );
+      r2.startRender( ctx, fields );
+      QCOMPARE( r2.filter( fields ), QStringLiteral( "FALSE" ) );
+      r2.stopRender( ctx );
+    }
+
     void test_clone_ruleKey()
     {
       RRule *rootRule = new RRule( 0 );
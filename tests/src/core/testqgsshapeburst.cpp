@@ -64,6 +64,7 @@ class TestQgsShapeburst : public QObject
     void shapeburstMaxDistanceMapUnits();
     void shapeburstIgnoreRings();
     void shapeburstSymbolFromQml();
+    void shapeburstDistanceCache();
 
   private:
     bool mTestHasError;
@@ -218,6 +219,31 @@ void TestQgsShapeburst::shapeburstSymbolFromQml()
   QVERIFY( imageCheck( "shapeburst_from_qml" ) );
 }
 
+void TestQgsShapeburst::shapeburstDistanceCache()
+{
+  mReport += QLatin1String( "<h2>Shapeburst symbol distance cache</h2>\n" );
+  int maxSize = QgsShapeburstFillSymbolLayer::distanceCacheMaximumSize();
+  QVERIFY( maxSize > 0 );
+
+  QgsShapeburstFillSymbolLayer::clearDistanceCache();
+  QCOMPARE( QgsShapeburstFillSymbolLayer::distanceCacheSize(), 0 );
+  QVERIFY( imageCheck( "shapeburst_from_qml" ) );
+  int cacheSize = QgsShapeburstFillSymbolLayer::distanceCacheSize();
+  QVERIFY( cacheSize > 0 );
+  QVERIFY( cacheSize <= maxSize );
+
+  // second render uses cached distance fields and must give the same result
+  QVERIFY( imageCheck( "shapeburst_from_qml" ) );
+  QCOMPARE( QgsShapeburstFillSymbolLayer::distanceCacheSize(), cacheSize );
+
+  // disabled cache
+  QgsShapeburstFillSymbolLayer::setDistanceCacheMaximumSize( 0 );
+  QCOMPARE( QgsShapeburstFillSymbolLayer::distanceCacheSize(), 0 );
+  QVERIFY( imageCheck( "shapeburst_from_qml" ) );
+  QCOMPARE( QgsShapeburstFillSymbolLayer::distanceCacheSize(), 0 );
+  QgsShapeburstFillSymbolLayer::setDistanceCacheMaximumSize( maxSize );
+}
+
 //
 // Private helper functions not called directly by CTest
 //
@@ -23,6 +23,9 @@ from qgis.core import (QgsMapRendererCache,
                        QgsFeature,
                        QgsGeometry,
                        QgsMapSettings,
+                       QgsMarkerSymbol,
+                       QgsSingleSymbolRenderer,
+                       QgsSettings,
                        QgsPoint)
 from qgis.testing import start_app, unittest
 from qgis.PyQt.QtCore import QSize, QThreadPool
@@ -426,6 +429,101 @@ class TestQgsMapRenderer(unittest.TestCase):
         self.assertFalse(job.isActive())
         self.assertEqual(len(finished_spy), 1)
 
+    def createLargeMarkerLayer(self, points):
+        """ returns a layer drawing points with translucent markers of 500 pixels """
+        layer = QgsVectorLayer("Point?field=fldtxt:string",
+                               "layer1", "memory")
+        features = []
+        for x, y in points:
+            f = QgsFeature(layer.fields())
+            f.setGeometry(QgsGeometry.fromPoint(QgsPoint(x, y)))
+            features.append(f)
+        layer.dataProvider().addFeatures(features)
+        symbol = QgsMarkerSymbol.createSimple({'size': '500', 'size_unit': 'Pixel', 'color': '255,0,0,100'})
+        layer.setRenderer(QgsSingleSymbolRenderer(symbol))
+        return layer
+
+    def renderImage(self, settings, cache=None):
+        job = QgsMapRendererSequentialJob(settings)
+        if cache is not None:
+            job.setCache(cache)
+        job.start()
+        job.waitForFinished()
+        return job.renderedImage()
+
+    def testPartialRepaintMatchesFullRender(self):
+        """ test that redrawing the dirty parts of a cached image after an edit matches a full render """
+        # the marker of the feature at 300, 324 reaches far into the tiles dirtied by an edit at 700, 324
+        layer = self.createLargeMarkerLayer([(300, 324), (900, 900)])
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(0, 0, 1024, 1024))
+        settings.setOutputSize(QSize(1024, 1024))
+        settings.setLayers([layer])
+
+        cache = QgsMapRendererCache()
+        self.assertTrue(layer.startEditing())
+        self.renderImage(settings, cache)
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+
+        f = QgsFeature(layer.fields())
+        f.setGeometry(QgsGeometry.fromPoint(QgsPoint(700, 324)))
+        self.assertTrue(layer.addFeature(f))
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+        self.assertEqual(len(cache.dirtyExtents(layer.id())), 1)
+
+        partial = self.renderImage(settings, cache)
+        self.assertEqual(partial, self.renderImage(settings))
+        layer.rollBack()
+
+    def testPanMatchesFullRender(self):
+        """ test that redrawing the parts of a cached image exposed by a pan matches a full render """
+        # the marker of the feature at 1100, 512 reaches far into the part of the map visible before the pan
+        layer = self.createLargeMarkerLayer([(500, 512), (1100, 512)])
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(0, 0, 1024, 1024))
+        settings.setOutputSize(QSize(1024, 1024))
+        settings.setLayers([layer])
+
+        cache = QgsMapRendererCache()
+        self.renderImage(settings, cache)
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+
+        settings.setExtent(QgsRectangle(300, 0, 1324, 1024))
+        panned = self.renderImage(settings, cache)
+        self.assertEqual(panned, self.renderImage(settings))
+
+    def testParallelSymbolLevels(self):
+        """ test that drawing ranges of symbol levels concurrently matches drawing them serially """
+        layer = QgsVectorLayer("Point?field=fldtxt:string",
+                               "layer1", "memory")
+        features = []
+        for i in range(2000):
+            f = QgsFeature(layer.fields())
+            f.setGeometry(QgsGeometry.fromPoint(QgsPoint(uniform(0, 100), uniform(0, 100))))
+            features.append(f)
+        layer.dataProvider().addFeatures(features)
+        symbol = QgsMarkerSymbol.createSimple({'size': '6', 'color': '255,0,0,100'})
+        outline = QgsMarkerSymbol.createSimple({'size': '9', 'color': '0,0,255,100'}).symbolLayer(0).clone()
+        outline.setRenderingPass(1)
+        symbol.appendSymbolLayer(outline)
+        renderer = QgsSingleSymbolRenderer(symbol)
+        renderer.setUsingSymbolLevels(True)
+        layer.setRenderer(renderer)
+
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(0, 0, 100, 100))
+        settings.setOutputSize(QSize(512, 512))
+        settings.setLayers([layer])
+
+        parallel = self.renderImage(settings)
+        # without memory for the images of concurrent ranges the levels are drawn serially
+        QgsSettings().setValue('qgis/parallel_symbol_levels_memory', 0)
+        try:
+            serial = self.renderImage(settings)
+        finally:
+            QgsSettings().remove('qgis/parallel_symbol_levels_memory')
+        self.assertEqual(parallel, serial)
+
     def runRendererChecks(self, renderer):
         """ runs all checks on the specified renderer """
         self.checkRendererUseCachedLabels(renderer)
@@ -442,6 +540,67 @@ class TestQgsMapRenderer(unittest.TestCase):
         """ run test suite on QgsMapRendererParallelJob"""
         self.runRendererChecks(QgsMapRendererParallelJob)
 
+    def testParallelProgressiveRendering(self):
+        """ test rendering a quick preview before the full quality map """
+        layer = QgsVectorLayer("Point?field=fldtxt:string",
+                               "layer1", "memory")
+        features = []
+        for i in range(2000):
+            f = QgsFeature(layer.fields())
+            f.setGeometry(QgsGeometry.fromPoint(QgsPoint(uniform(5, 25), uniform(25, 45))))
+            features.append(f)
+        layer.dataProvider().addFeatures(features)
+
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(5, 25, 25, 45))
+        settings.setOutputSize(QSize(600, 400))
+        settings.setLayers([layer])
+
+        # no progressive rendering
+        job = QgsMapRendererParallelJob(settings)
+        self.assertFalse(job.progressiveRendering())
+        self.assertEqual(job.timeToFirstFrame(), -1)
+        preview_spy = QSignalSpy(job.previewRendered)
+        job.start()
+        job.waitForFinished()
+        self.assertEqual(len(preview_spy), 0)
+        self.assertGreaterEqual(job.timeToFirstFrame(), 0)
+
+        cache = QgsMapRendererCache()
+        job = QgsMapRendererParallelJob(settings)
+        job.setCache(cache)
+        job.setProgressiveRendering(True)
+        self.assertTrue(job.progressiveRendering())
+        preview_spy = QSignalSpy(job.previewRendered)
+        finished_spy = QSignalSpy(job.finished)
+        job.start()
+        job.waitForFinished()
+        self.assertEqual(len(preview_spy), 1)
+        self.assertEqual(len(finished_spy), 1)
+        self.assertGreaterEqual(job.timeToFirstFrame(), 0)
+        self.assertLessEqual(job.timeToFirstFrame(), job.renderingTime())
+        self.assertFalse(job.renderedImage().isNull())
+        # full quality render was cached, not the preview
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+
+        # no preview needed if everything is cached
+        job = QgsMapRendererParallelJob(settings)
+        job.setCache(cache)
+        job.setProgressiveRendering(True)
+        preview_spy = QSignalSpy(job.previewRendered)
+        job.start()
+        job.waitForFinished()
+        self.assertEqual(len(preview_spy), 0)
+
+        # cancel while rendering preview
+        job = QgsMapRendererParallelJob(settings)
+        job.setProgressiveRendering(True)
+        finished_spy = QSignalSpy(job.finished)
+        job.start()
+        job.cancel()
+        self.assertFalse(job.isActive())
+        self.assertEqual(len(finished_spy), 1)
+
     def testSequentialRenderer(self):
         """ run test suite on QgsMapRendererSequentialJob"""
         self.runRendererChecks(QgsMapRendererSequentialJob)
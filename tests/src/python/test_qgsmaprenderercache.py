@@ -16,11 +16,15 @@ import qgis  # NOQA
 
 from qgis.core import (QgsMapRendererCache,
                        QgsRectangle,
+                       QgsFeature,
+                       QgsGeometry,
+                       QgsPoint,
+                       QgsMapToPixel,
                        QgsVectorLayer,
                        QgsProject)
 from qgis.testing import start_app, unittest
-from qgis.PyQt.QtCore import QCoreApplication
-from qgis.PyQt.QtGui import QImage
+from qgis.PyQt.QtCore import QCoreApplication, QRect
+from qgis.PyQt.QtGui import QImage, QColor, QRegion
 from time import sleep
 start_app()
 
@@ -97,6 +101,45 @@ class TestQgsMapRendererCache(unittest.TestCase):
         self.assertTrue(cache.cacheImage('layer').isNull())
         self.assertFalse(cache.hasCacheImage('layer'))
 
+    def testInitPan(self):
+        """ test that cached layer images are shifted rather than cleared when panning """
+        layer = QgsVectorLayer("Point?field=fldtxt:string",
+                               "layer", "memory")
+        QgsProject.instance().addMapLayer(layer)
+
+        cache = QgsMapRendererCache()
+        mtp = QgsMapToPixel(1, 50, 50, 100, 100, 0)
+        self.assertFalse(cache.init(QgsRectangle(0, 0, 100, 100), 1000, mtp, 5))
+
+        im = QImage(100, 100, QImage.Format_ARGB32_Premultiplied)
+        im.fill(QColor(255, 0, 0))
+        cache.setCacheImage(layer.id(), im, [layer])
+        cache.setCacheImage('labels', im, [layer])
+        self.assertTrue(cache.init(QgsRectangle(0, 0, 100, 100), 1000, mtp, 5))
+        self.assertTrue(cache.invalidRegion(layer.id()).isEmpty())
+
+        # pan by 10 pixels
+        mtp = QgsMapToPixel(1, 60, 50, 100, 100, 0)
+        self.assertFalse(cache.init(QgsRectangle(10, 0, 110, 100), 1000, mtp, 5))
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+        self.assertFalse(cache.hasCacheImage('labels'))
+        # newly exposed strip and margin along previous edge must be redrawn
+        self.assertEqual(cache.invalidRegion(layer.id()), QRegion(QRect(85, 0, 15, 100)))
+        shifted = cache.cacheImage(layer.id())
+        self.assertEqual(shifted.pixel(0, 50), QColor(255, 0, 0).rgba())
+        self.assertEqual(shifted.pixel(95, 50), 0)
+
+        # pan which isn't a whole number of pixels clears the cache
+        mtp = QgsMapToPixel(1, 60.5, 50, 100, 100, 0)
+        self.assertFalse(cache.init(QgsRectangle(10.5, 0, 110.5, 100), 1000, mtp, 5))
+        self.assertFalse(cache.hasCacheImage(layer.id()))
+
+        # so does a pan at a different scale
+        cache.setCacheImage(layer.id(), im, [layer])
+        mtp = QgsMapToPixel(2, 60.5, 60, 100, 100, 0)
+        self.assertFalse(cache.init(QgsRectangle(-39.5, -40, 160.5, 160), 2000, mtp, 5))
+        self.assertFalse(cache.hasCacheImage(layer.id()))
+
     def testRequestRepaintSimple(self):
         """ test requesting repaint with a single dependent layer """
         layer = QgsVectorLayer("Point?field=fldtxt:string",
@@ -217,6 +260,54 @@ class TestQgsMapRendererCache(unittest.TestCase):
         cache.setCacheImage('depends', im, [layer1, layer2])
         self.assertEqual(set(cache.dependentLayers('depends')), set([layer1, layer2]))
 
+    def testRequestPartialRepaint(self):
+        """ test requesting repaint of just a part of a layer """
+        layer1 = QgsVectorLayer("Point?field=fldtxt:string",
+                                "layer1", "memory")
+        layer2 = QgsVectorLayer("Point?field=fldtxt:string",
+                                "layer2", "memory")
+        QgsProject.instance().addMapLayers([layer1, layer2])
+
+        cache = QgsMapRendererCache()
+        im = QImage(200, 200, QImage.Format_RGB32)
+        cache.setCacheImage(layer1.id(), im, [layer1])
+        cache.setCacheImage('labels', im, [layer1, layer2])
+        cache.setCacheImage(layer2.id(), im, [layer2])
+        self.assertEqual(cache.dirtyExtents(layer1.id()), [])
+
+        # image rendered for the layer itself is kept, but images from other dependent renders are cleared
+        layer1.triggerPartialRepaint(QgsRectangle(1, 2, 3, 4))
+        self.assertTrue(cache.hasCacheImage(layer1.id()))
+        self.assertEqual(cache.dirtyExtents(layer1.id()), [QgsRectangle(1, 2, 3, 4)])
+        self.assertFalse(cache.hasCacheImage('labels'))
+        self.assertTrue(cache.hasCacheImage(layer2.id()))
+        self.assertEqual(cache.dirtyExtents(layer2.id()), [])
+
+        layer1.triggerPartialRepaint(QgsRectangle(5, 6, 7, 8))
+        self.assertEqual(cache.dirtyExtents(layer1.id()), [QgsRectangle(1, 2, 3, 4), QgsRectangle(5, 6, 7, 8)])
+
+        # caching a new image resets the dirty extents
+        cache.setCacheImage(layer1.id(), im, [layer1])
+        self.assertEqual(cache.dirtyExtents(layer1.id()), [])
+
+        # null extent requires a complete repaint
+        layer1.triggerPartialRepaint(QgsRectangle())
+        self.assertFalse(cache.hasCacheImage(layer1.id()))
+        self.assertTrue(cache.hasCacheImage(layer2.id()))
+
+        # editing a feature invalidates just its extent
+        cache.setCacheImage(layer1.id(), im, [layer1])
+        self.assertTrue(layer1.startEditing())
+        self.assertFalse(cache.hasCacheImage(layer1.id()))
+        cache.setCacheImage(layer1.id(), im, [layer1])
+        f = QgsFeature(layer1.fields())
+        f.setGeometry(QgsGeometry.fromPoint(QgsPoint(3, 4)))
+        self.assertTrue(layer1.addFeature(f))
+        self.assertTrue(cache.hasCacheImage(layer1.id()))
+        self.assertEqual(cache.dirtyExtents(layer1.id()), [QgsRectangle(3, 4, 3, 4)])
+        layer1.rollBack()
+        self.assertFalse(cache.hasCacheImage(layer1.id()))
+
     def testLayerRemoval(self):
         """test that cached image is cleared when a dependent layer is removed"""
         cache = QgsMapRendererCache()
@@ -0,0 +1,246 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsMvtEncoder.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import struct
+
+from qgis.core import (QgsMvtEncoder,
+                       QgsVectorLayer,
+                       QgsFeature,
+                       QgsGeometry,
+                       QgsRectangle,
+                       QgsCoordinateReferenceSystem)
+from qgis.testing import start_app, unittest
+from qgis.PyQt.QtCore import QBuffer, QIODevice
+
+app = start_app()
+
+
+def readVarint(data, pos):
+    result = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        result |= (b & 0x7f) << shift
+        if not b & 0x80:
+            return result, pos
+        shift += 7
+
+
+def readMessage(data):
+    """ Decodes a protocol buffer message into a list of (field, value) pairs """
+    fields = []
+    pos = 0
+    while pos < len(data):
+        key, pos = readVarint(data, pos)
+        field, wireType = key >> 3, key & 0x7
+        if wireType == 0:
+            value, pos = readVarint(data, pos)
+        elif wireType == 1:
+            value = struct.unpack('<d', data[pos:pos + 8])[0]
+            pos += 8
+        elif wireType == 2:
+            length, pos = readVarint(data, pos)
+            value = data[pos:pos + length]
+            pos += length
+        else:
+            raise ValueError('unexpected wire type')
+        fields.append((field, value))
+    return fields
+
+
+def readPacked(data):
+    values = []
+    pos = 0
+    while pos < len(data):
+        value, pos = readVarint(data, pos)
+        values.append(value)
+    return values
+
+
+def unZigZag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decodeTile(data):
+    """ Decodes a vector tile into a dict of layer name to layer dict """
+    layers = {}
+    for field, layerData in readMessage(bytes(data)):
+        assert field == 3
+        layer = {'features': [], 'keys': [], 'values': []}
+        for f, v in readMessage(layerData):
+            if f == 1:
+                layer['name'] = v.decode()
+            elif f == 2:
+                layer['features'].append(dict((ff, vv) for ff, vv in readMessage(v)))
+            elif f == 3:
+                layer['keys'].append(v.decode())
+            elif f == 4:
+                ff, vv = readMessage(v)[0]
+                layer['values'].append(vv.decode() if ff == 1 else vv)
+            elif f == 5:
+                layer['extent'] = v
+            elif f == 15:
+                layer['version'] = v
+        for feature in layer['features']:
+            tags = readPacked(feature.get(2, b''))
+            feature['attributes'] = dict((layer['keys'][tags[i]], layer['values'][tags[i + 1]]) for i in range(0, len(tags), 2))
+            feature['geometry'] = readPacked(feature[4])
+        layers[layer['name']] = layer
+    return layers
+
+
+def decodeCommands(commands):
+    """ Decodes geometry commands into a list of (command, [points]) with absolute coordinates """
+    result = []
+    x = y = 0
+    i = 0
+    while i < len(commands):
+        command, count = commands[i] & 0x7, commands[i] >> 3
+        i += 1
+        if command == 7:
+            result.append((command, []))
+            continue
+        points = []
+        for _ in range(count):
+            x += unZigZag(commands[i])
+            y += unZigZag(commands[i + 1])
+            points.append((x, y))
+            i += 2
+        result.append((command, points))
+    return result
+
+
+class TestQgsMvtEncoder(unittest.TestCase):
+
+    def createLayer(self):
+        layer = QgsVectorLayer("Polygon?crs=epsg:3857&field=name:string&field=value:integer&field=secret:string", "polys", "memory")
+        f1 = QgsFeature(layer.fields())
+        f1.setAttributes(['a', 1, 'x'])
+        f1.setGeometry(QgsGeometry.fromWkt('Polygon((10 10, 90 10, 90 90, 10 90, 10 10),(20 20, 20 30, 30 30, 30 20, 20 20))'))
+        f2 = QgsFeature(layer.fields())
+        f2.setAttributes(['b', 1, 'y'])
+        f2.setGeometry(QgsGeometry.fromWkt('Polygon((-50 -50, 50 -50, 50 50, -50 50, -50 -50))'))
+        f3 = QgsFeature(layer.fields())
+        f3.setAttributes(['outside', 2, 'z'])
+        f3.setGeometry(QgsGeometry.fromWkt('Polygon((500 500, 600 500, 600 600, 500 500))'))
+        layer.dataProvider().addFeatures([f1, f2, f3])
+        return layer
+
+    def testMimeType(self):
+        self.assertEqual(QgsMvtEncoder.mimeType(), 'application/vnd.mapbox-vector-tile')
+
+    def testClipExtent(self):
+        encoder = QgsMvtEncoder(QgsRectangle(0, 0, 100, 100), 100, 10)
+        self.assertEqual(encoder.clipExtent(), QgsRectangle(-10, -10, 110, 110))
+
+    def testAddLayer(self):
+        layer = self.createLayer()
+        encoder = QgsMvtEncoder(QgsRectangle(0, 0, 100, 100), 100, 10)
+        self.assertEqual(encoder.addLayer(layer, layer.crs(), '', set(['secret'])), 2)
+        self.assertEqual(encoder.featureCount(), 2)
+
+        tile = decodeTile(encoder.data())
+        self.assertEqual(list(tile.keys()), ['polys'])
+        polys = tile['polys']
+        self.assertEqual(polys['version'], 2)
+        self.assertEqual(polys['extent'], 100)
+        self.assertEqual(len(polys['features']), 2)
+        # excluded attributes are not written, equal values are shared
+        self.assertEqual(polys['keys'], ['name', 'value'])
+        self.assertEqual(polys['values'], ['a', 1, 'b'])
+        self.assertEqual(polys['features'][0]['attributes'], {'name': 'a', 'value': 1})
+        self.assertEqual(polys['features'][1]['attributes'], {'name': 'b', 'value': 1})
+
+        # polygon with hole, y axis points down
+        self.assertEqual(polys['features'][0][3], 3)
+        commands = decodeCommands(polys['features'][0]['geometry'])
+        self.assertEqual([c for c, p in commands], [1, 2, 7, 1, 2, 7])
+        exterior = commands[0][1] + commands[1][1]
+        self.assertEqual(sorted(exterior), [(10, 10), (10, 90), (90, 10), (90, 90)])
+        interior = commands[3][1] + commands[4][1]
+        self.assertEqual(sorted(interior), [(20, 70), (20, 80), (30, 70), (30, 80)])
+
+        def area(ring):
+            return sum(ring[i][0] * ring[(i + 1) % len(ring)][1] - ring[(i + 1) % len(ring)][0] * ring[i][1] for i in range(len(ring)))
+        self.assertGreater(area(exterior), 0)
+        self.assertLess(area(interior), 0)
+
+        # clipped to the buffer
+        commands = decodeCommands(polys['features'][1]['geometry'])
+        ring = commands[0][1] + commands[1][1]
+        self.assertEqual(min(p[0] for p in ring), -10)
+        self.assertEqual(max(p[1] for p in ring), 110)
+
+    def testStreaming(self):
+        buffer = QBuffer()
+        buffer.open(QIODevice.WriteOnly)
+
+        encoder = QgsMvtEncoder(QgsRectangle(0, 0, 100, 100), 4096, 64)
+        encoder.setDevice(buffer)
+        encoder.beginLayer('points')
+        f = QgsFeature(5)
+        f.setGeometry(QgsGeometry.fromWkt('MultiPoint((0 100),(50 50),(1000 1000))'))
+        self.assertTrue(encoder.addFeature(f))
+        f.setGeometry(QgsGeometry.fromWkt('Point(1000 1000)'))
+        self.assertFalse(encoder.addFeature(f))
+        # empty layers are skipped
+        encoder.beginLayer('empty')
+        encoder.beginLayer('lines')
+        f.setGeometry(QgsGeometry.fromWkt('LineString(-1000 50, 1000 50)'))
+        self.assertTrue(encoder.addFeature(f))
+        self.assertTrue(encoder.endLayer())
+        self.assertTrue(encoder.data().isEmpty())
+
+        tile = decodeTile(buffer.data())
+        self.assertEqual(sorted(tile.keys()), ['lines', 'points'])
+
+        point = tile['points']['features'][0]
+        self.assertEqual(point[1], 5)
+        self.assertEqual(point[3], 1)
+        self.assertEqual(decodeCommands(point['geometry']), [(1, [(0, 0), (2048, 2048)])])
+
+        line = tile['lines']['features'][0]
+        self.assertEqual(line[3], 2)
+        commands = decodeCommands(line['geometry'])
+        self.assertEqual(commands[0], (1, [(-64, 2048)]))
+        self.assertEqual(commands[1][1][-1], (4096 + 64, 2048))
+
+    def testLineLeavingClipExtent(self):
+        encoder = QgsMvtEncoder(QgsRectangle(0, 0, 100, 100), 100, 10)
+        encoder.beginLayer('lines')
+        f = QgsFeature(1)
+        # leaves the clip extent and enters it again, the parts must not be connected
+        f.setGeometry(QgsGeometry.fromWkt('LineString(50 50, 200 50, 200 80, 50 80)'))
+        self.assertTrue(encoder.addFeature(f))
+        self.assertTrue(encoder.endLayer())
+
+        line = decodeTile(encoder.data())['lines']['features'][0]
+        self.assertEqual(line[3], 2)
+        self.assertEqual(decodeCommands(line['geometry']),
+                         [(1, [(50, 50)]), (2, [(110, 50)]), (1, [(110, 20)]), (2, [(50, 20)])])
+
+    def testNoLayer(self):
+        encoder = QgsMvtEncoder(QgsRectangle(0, 0, 100, 100))
+        f = QgsFeature()
+        f.setGeometry(QgsGeometry.fromWkt('Point(50 50)'))
+        self.assertFalse(encoder.addFeature(f))
+        self.assertTrue(encoder.endLayer())
+        self.assertTrue(encoder.data().isEmpty())
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,484 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsRasterBlockCache.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import os
+import shutil
+import struct
+import tempfile
+
+from osgeo import gdal, osr
+from qgis.core import (QgsRasterLayer,
+                       QgsRasterBlockCache,
+                       QgsRasterRange,
+                       QgsRasterShader,
+                       QgsRectangle,
+                       QgsBilinearRasterResampler,
+                       QgsColorRampShader,
+                       QgsSingleBandPseudoColorRenderer,
+                       QgsMapSettings,
+                       QgsMapRendererSequentialJob,
+                       QgsSettings)
+from qgis.testing import start_app, unittest
+from qgis.PyQt.QtCore import QSize
+from qgis.PyQt.QtGui import QColor
+from utilities import unitTestDataPath
+
+start_app()
+
+
+class TestQgsRasterBlockCache(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        cls.basetestpath = tempfile.mkdtemp()
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(cls.basetestpath, True)
+
+    def setUp(self):
+        # the caches of all layers share their tiles
+        QgsRasterBlockCache.clearAll()
+
+    def tearDown(self):
+        QgsRasterBlockCache().setMaximumSize(100 * 1024 * 1024)
+
+    def createNoDataLayer(self):
+        """ Returns a layer of 48 x 48 pixels with scattered no data pixels and a block of no data """
+        path = os.path.join(self.basetestpath, 'nodata.tif')
+        if not os.path.exists(path):
+            size = 48
+            values = []
+            for row in range(size):
+                for column in range(size):
+                    if (row * 7 + column * 3) % 5 == 0 or (row < 8 and column < 8):
+                        values.append(-9999)
+                    else:
+                        values.append(row * size + column + 0.25)
+            ds = gdal.GetDriverByName('GTiff').Create(path, size, size, 1, gdal.GDT_Float32)
+            ds.SetGeoTransform([0, 1, 0, size, 0, -1])
+            srs = osr.SpatialReference()
+            srs.ImportFromEPSG(4326)
+            ds.SetProjection(srs.ExportToWkt())
+            band = ds.GetRasterBand(1)
+            band.SetNoDataValue(-9999)
+            band.WriteRaster(0, 0, size, size, struct.pack('%df' % len(values), *values))
+            ds = None
+
+        layer = QgsRasterLayer(path, 'nodata')
+        self.assertTrue(layer.isValid())
+        return layer
+
+    def createClassLayer(self):
+        """ Returns a layer of 64 x 64 pixels with the class codes 1 and 3 in a checkerboard """
+        path = os.path.join(self.basetestpath, 'classes.tif')
+        if not os.path.exists(path):
+            size = 64
+            values = [1 if (row + column) % 2 == 0 else 3 for row in range(size) for column in range(size)]
+            ds = gdal.GetDriverByName('GTiff').Create(path, size, size, 1, gdal.GDT_Byte)
+            ds.SetGeoTransform([0, 1, 0, size, 0, -1])
+            srs = osr.SpatialReference()
+            srs.ImportFromEPSG(4326)
+            ds.SetProjection(srs.ExportToWkt())
+            ds.GetRasterBand(1).WriteRaster(0, 0, size, size, struct.pack('%dB' % len(values), *values))
+            ds = None
+
+        layer = QgsRasterLayer(path, 'classes')
+        self.assertTrue(layer.isValid())
+        return layer
+
+    def render(self, layer, width, height):
+        settings = QgsMapSettings()
+        settings.setDestinationCrs(layer.crs())
+        settings.setExtent(layer.extent())
+        settings.setOutputSize(QSize(width, height))
+        settings.setLayers([layer])
+        job = QgsMapRendererSequentialJob(settings)
+        job.start()
+        job.waitForFinished()
+        return job.renderedImage()
+
+    def createLayer(self):
+        path = os.path.join(unitTestDataPath('raster'), 'band1_float32_noct_epsg4326.tif')
+        layer = QgsRasterLayer(path, 'test')
+        self.assertTrue(layer.isValid())
+        return layer
+
+    def subExtent(self, layer, column, row, width, height):
+        """ Returns the extent of a window of pixels of the layer """
+        extent = layer.extent()
+        xRes = extent.width() / layer.width()
+        yRes = extent.height() / layer.height()
+        return QgsRectangle(extent.xMinimum() + column * xRes, extent.yMaximum() - (row + height) * yRes,
+                            extent.xMinimum() + (column + width) * xRes, extent.yMaximum() - row * yRes)
+
+    def assertBlocksEqual(self, block, expected):
+        self.assertEqual(block.dataType(), expected.dataType())
+        self.assertEqual(block.width(), expected.width())
+        self.assertEqual(block.height(), expected.height())
+        for row in range(expected.height()):
+            for column in range(expected.width()):
+                self.assertEqual(block.isNoData(row, column), expected.isNoData(row, column))
+                if not expected.isNoData(row, column):
+                    self.assertEqual(block.value(row, column), expected.value(row, column))
+
+    def testPipe(self):
+        layer = self.createLayer()
+        # layers get a cache by default
+        self.assertIsNotNone(layer.pipe().blockCache())
+        self.assertEqual(layer.pipe().blockCache().maximumSize(), 100 * 1024 * 1024)
+        # averaging pyramids are opt-in
+        self.assertFalse(layer.pipe().blockCache().pyramidsEnabled())
+        cache = QgsRasterBlockCache()
+        self.assertTrue(layer.pipe().set(cache))
+        self.assertEqual(layer.pipe().blockCache(), cache)
+        # directly follows the provider
+        self.assertEqual(layer.pipe().at(1), cache)
+        self.assertEqual(layer.pipe().at(2), layer.pipe().renderer())
+        self.assertEqual(layer.renderer().input(), cache)
+
+        self.assertTrue(layer.pipe().remove(cache))
+        self.assertIsNone(layer.pipe().blockCache())
+        self.assertEqual(layer.renderer().input(), layer.dataProvider())
+
+    def testSettings(self):
+        settings = QgsSettings()
+        settings.setValue('/Raster/blockCacheSize', 1024 * 1024)
+        self.assertEqual(self.createLayer().pipe().blockCache().maximumSize(), 1024 * 1024)
+        settings.setValue('/Raster/blockCacheSize', 0)
+        self.assertIsNone(self.createLayer().pipe().blockCache())
+        settings.remove('/Raster/blockCacheSize')
+
+        settings.setValue('/Raster/blockCachePyramids', True)
+        self.assertTrue(self.createLayer().pipe().blockCache().pyramidsEnabled())
+        settings.remove('/Raster/blockCachePyramids')
+
+    def testLayerRendering(self):
+        layer = self.createLayer()
+        cache = layer.pipe().blockCache()
+        cache.setTileSize(8)
+        settings = QgsMapSettings()
+        settings.setDestinationCrs(layer.crs())
+        settings.setExtent(layer.extent())
+        settings.setOutputSize(QSize(layer.width(), layer.height()))
+        settings.setLayers([layer])
+
+        def render():
+            job = QgsMapRendererSequentialJob(settings)
+            job.start()
+            job.waitForFinished()
+            return job.renderedImage()
+
+        image = render()
+        reads = cache.readCount()
+        self.assertGreater(reads, 0)
+        # the missing tiles are read in few requests, not one per tile
+        self.assertGreater(cache.tileCount(), reads)
+
+        # redrawing the layer does not read the provider again
+        self.assertEqual(render(), image)
+        self.assertEqual(cache.readCount(), reads)
+
+        # neither does redrawing it zoomed out
+        settings.setOutputSize(QSize(layer.width() // 2, layer.height() // 2))
+        image = render()
+        reads = cache.readCount()
+        self.assertEqual(render(), image)
+        self.assertEqual(cache.readCount(), reads)
+
+    def testClassRendering(self):
+        """ averaged pyramid levels must not mix the codes of classified rasters """
+        colors = [QColor(255, 0, 0), QColor(0, 255, 0), QColor(0, 0, 255)]
+
+        def rampRenderer(layer, rampType, values):
+            rampShader = QgsColorRampShader()
+            rampShader.setColorRampType(rampType)
+            rampShader.setColorRampItemList([QgsColorRampShader.ColorRampItem(value, color) for value, color in zip(values, colors)])
+            shader = QgsRasterShader()
+            shader.setRasterShaderFunction(rampShader)
+            return QgsSingleBandPseudoColorRenderer(layer.dataProvider(), 1, shader)
+
+        settings = QgsSettings()
+        settings.setValue('/Raster/blockCachePyramids', True)
+        for rampType, values in ((QgsColorRampShader.Exact, (1, 2, 3)), (QgsColorRampShader.Discrete, (1.5, 2.5, 3.5))):
+            layer = self.createClassLayer()
+            self.assertTrue(layer.pipe().blockCache().pyramidsEnabled())
+            layer.setRenderer(rampRenderer(layer, rampType, values))
+            layer.resampleFilter().setZoomedOutResampler(QgsBilinearRasterResampler())
+
+            # class 2 would be the mean of the checkerboard
+            cached = self.render(layer, 16, 16)
+            self.assertTrue(layer.pipe().remove(layer.pipe().blockCache()))
+            self.assertIsNone(layer.pipe().blockCache())
+            self.assertEqual(cached, self.render(layer, 16, 16))
+        settings.remove('/Raster/blockCachePyramids')
+
+    def testBlocks(self):
+        layer = self.createLayer()
+        provider = layer.dataProvider()
+        cache = QgsRasterBlockCache(provider)
+        cache.setTileSize(8)
+        self.assertEqual(cache.tileCount(), 0)
+
+        width = layer.width()
+        height = layer.height()
+        extent = self.subExtent(layer, 0, 0, width, height)
+        expected = provider.block(1, extent, width, height)
+        self.assertBlocksEqual(cache.block(1, extent, width, height), expected)
+        tileCount = cache.tileCount()
+        self.assertEqual(tileCount, ((width + 7) // 8) * ((height + 7) // 8))
+        # all tiles are read from the provider at once
+        self.assertEqual(cache.readCount(), 1)
+        self.assertGreater(cache.size(), 0)
+
+        # same block again is read from the cache
+        self.assertBlocksEqual(cache.block(1, extent, width, height), expected)
+        self.assertEqual(cache.tileCount(), tileCount)
+
+        # panning by whole pixels at the same resolution reuses the tiles
+        extent = self.subExtent(layer, 3, 5, width - 6, height - 7)
+        expected = provider.block(1, extent, width - 6, height - 7)
+        self.assertBlocksEqual(cache.block(1, extent, width - 6, height - 7), expected)
+        self.assertEqual(cache.tileCount(), tileCount)
+
+        # another resolution uses its own tiles
+        extent = self.subExtent(layer, 0, 0, width, height)
+        expected = provider.block(1, extent, width * 2, height * 2)
+        self.assertBlocksEqual(cache.block(1, extent, width * 2, height * 2), expected)
+        self.assertGreater(cache.tileCount(), tileCount)
+
+        cache.clear()
+        self.assertEqual(cache.tileCount(), 0)
+        self.assertEqual(cache.size(), 0)
+
+    def testCompression(self):
+        layer = self.createLayer()
+        provider = layer.dataProvider()
+        cache = QgsRasterBlockCache(provider)
+        cache.setTileSize(8)
+        cache.setCompressionEnabled(True)
+        self.assertTrue(cache.compressionEnabled())
+
+        extent = self.subExtent(layer, 1, 2, layer.width() - 2, layer.height() - 3)
+        expected = provider.block(1, extent, layer.width() - 2, layer.height() - 3)
+        self.assertBlocksEqual(cache.block(1, extent, layer.width() - 2, layer.height() - 3), expected)
+        self.assertGreater(cache.tileCount(), 0)
+        self.assertBlocksEqual(cache.block(1, extent, layer.width() - 2, layer.height() - 3), expected)
+
+    def testNoData(self):
+        layer = self.createLayer()
+        provider = layer.dataProvider()
+        provider.setUseSourceNoDataValue(1, False)
+        cache = QgsRasterBlockCache(provider)
+        cache.setTileSize(8)
+
+        extent = self.subExtent(layer, 0, 0, layer.width(), layer.height())
+        block = cache.block(1, extent, layer.width(), layer.height())
+        value = block.value(0, 0)
+        self.assertFalse(block.isNoData(0, 0))
+
+        # changing the no data values of the provider must not use the cached tiles
+        provider.setUserNoDataValue(1, [QgsRasterRange(value, value)])
+        expected = provider.block(1, extent, layer.width(), layer.height())
+        block = cache.block(1, extent, layer.width(), layer.height())
+        self.assertTrue(block.isNoData(0, 0))
+        self.assertBlocksEqual(block, expected)
+
+    def testClone(self):
+        layer = self.createLayer()
+        cache = QgsRasterBlockCache()
+        cache.setTileSize(8)
+        layer.pipe().set(cache)
+        extent = self.subExtent(layer, 0, 0, layer.width(), layer.height())
+        cache.block(1, extent, layer.width(), layer.height())
+        self.assertGreater(cache.tileCount(), 0)
+
+        # clones share the cached tiles
+        clone = cache.clone()
+        self.assertEqual(clone.tileSize(), 8)
+        self.assertFalse(clone.pyramidsEnabled())
+        cache.setPyramidsEnabled(True)
+        self.assertTrue(cache.clone().pyramidsEnabled())
+        self.assertEqual(clone.tileCount(), cache.tileCount())
+        clone.setInput(layer.dataProvider())
+        reads = cache.readCount()
+        clone.block(1, extent, layer.width(), layer.height())
+        self.assertEqual(cache.readCount(), reads)
+        clone.clear()
+        self.assertEqual(cache.tileCount(), 0)
+
+        # reloading the layer empties the cache
+        cache.block(1, extent, layer.width(), layer.height())
+        self.assertGreater(cache.tileCount(), 0)
+        layer.reload()
+        self.assertEqual(cache.tileCount(), 0)
+
+    def testMaximumSize(self):
+        layer = self.createLayer()
+        provider = layer.dataProvider()
+        cache = QgsRasterBlockCache(provider)
+        cache.setTileSize(4)
+        self.assertEqual(cache.maximumSize(), 100 * 1024 * 1024)
+        cache.setMaximumSize(5 * 1024)
+        self.assertEqual(cache.maximumSize(), 5 * 1024)
+
+        # 9 tiles taking 1 KiB each do not fit
+        extent = self.subExtent(layer, 0, 0, 10, 10)
+        expected = provider.block(1, extent, 10, 10)
+        self.assertBlocksEqual(cache.block(1, extent, 10, 10), expected)
+        self.assertLessEqual(cache.size(), 5 * 1024)
+        self.assertGreater(cache.tileCount(), 0)
+        self.assertLess(cache.tileCount(), 9)
+
+        # blocks larger than the cache are read directly
+        cache.clear()
+        cache.setMaximumSize(300)
+        self.assertBlocksEqual(cache.block(1, extent, 10, 10), expected)
+        self.assertEqual(cache.tileCount(), 0)
+
+    def testSharedStorage(self):
+        layer = self.createLayer()
+        cache = QgsRasterBlockCache(layer.dataProvider())
+        cache.setTileSize(8)
+        otherLayer = self.createNoDataLayer()
+        otherCache = QgsRasterBlockCache(otherLayer.dataProvider())
+        otherCache.setTileSize(8)
+
+        # the budget is shared by all caches, and may exceed the range of int
+        cache.setMaximumSize(5 * 1024 * 1024 * 1024)
+        self.assertEqual(otherCache.maximumSize(), 5 * 1024 * 1024 * 1024)
+
+        extent = self.subExtent(layer, 0, 0, layer.width(), layer.height())
+        cache.block(1, extent, layer.width(), layer.height())
+        tileCount = cache.tileCount()
+        self.assertGreater(tileCount, 0)
+        otherCache.block(1, otherLayer.extent(), otherLayer.width(), otherLayer.height())
+        self.assertEqual(cache.tileCount(), tileCount + 36)
+
+        # caches of the same data source share their tiles
+        sameSourceCache = QgsRasterBlockCache(self.createLayer().dataProvider())
+        sameSourceCache.setTileSize(8)
+        sameSourceCache.block(1, extent, layer.width(), layer.height())
+        self.assertEqual(sameSourceCache.readCount(), 0)
+
+        # clearing a cache only removes the tiles of its data source
+        cache.clear()
+        self.assertEqual(cache.tileCount(), 36)
+        QgsRasterBlockCache.clearAll()
+        self.assertEqual(cache.tileCount(), 0)
+
+    def testPyramids(self):
+        layer = self.createLayer()
+        provider = layer.dataProvider()
+        self.assertFalse(provider.hasPyramids())
+        cache = QgsRasterBlockCache(provider)
+        cache.setTileSize(4)
+        self.assertFalse(cache.pyramidsEnabled())
+        cache.setPyramidsEnabled(True)
+        self.assertTrue(cache.pyramidsEnabled())
+
+        width = layer.width() // 4 * 4
+        height = layer.height() // 4 * 4
+        extent = self.subExtent(layer, 0, 0, width, height)
+        native = provider.block(1, extent, width, height)
+
+        def mean(level, row, column):
+            size = 2 ** level
+            values = [native.value(r, c) for r in range(row * size, (row + 1) * size)
+                      for c in range(column * size, (column + 1) * size) if not native.isNoData(r, c)]
+            return sum(values) / len(values) if values else None
+
+        # zoomed out blocks are the means of the native pixels
+        for level in (1, 2):
+            size = 2 ** level
+            block = cache.block(1, extent, width // size, height // size)
+            self.assertEqual(block.dataType(), native.dataType())
+            self.assertEqual(block.width(), width // size)
+            for row in range(height // size):
+                for column in range(width // size):
+                    expected = mean(level, row, column)
+                    if expected is None:
+                        self.assertTrue(block.isNoData(row, column))
+                    else:
+                        self.assertFalse(block.isNoData(row, column))
+                        self.assertAlmostEqual(block.value(row, column), expected, delta=abs(expected) * 1e-6)
+
+        # the levels are built once
+        tileCount = cache.tileCount()
+        self.assertGreater(tileCount, 0)
+        cache.block(1, extent, width // 2, height // 2)
+        cache.block(1, extent, width // 4, height // 4)
+        self.assertEqual(cache.tileCount(), tileCount)
+
+        # sizes between two levels are sampled from the finer level
+        block = cache.block(1, extent, width // 3, height // 3)
+        self.assertEqual(cache.tileCount(), tileCount)
+        self.assertEqual(block.width(), width // 3)
+
+        # blocks at the native resolution do not use the pyramid
+        self.assertBlocksEqual(cache.block(1, extent, width, height), native)
+
+    def testPyramidNoData(self):
+        layer = self.createNoDataLayer()
+        provider = layer.dataProvider()
+        self.assertFalse(provider.hasPyramids())
+        extent = layer.extent()
+        size = layer.width()
+        native = provider.block(1, extent, size, size)
+
+        def createCache():
+            cache = QgsRasterBlockCache(provider)
+            cache.setTileSize(4)
+            cache.setPyramidsEnabled(True)
+            return cache
+
+        def checkLevel(cache, level):
+            """ checks that the pixels of a level are the means of the valid native pixels they cover """
+            pixels = 2 ** level
+            block = cache.block(1, extent, size // pixels, size // pixels)
+            self.assertEqual(block.width(), size // pixels)
+            for row in range(size // pixels):
+                for column in range(size // pixels):
+                    values = [native.value(r, c) for r in range(row * pixels, (row + 1) * pixels)
+                              for c in range(column * pixels, (column + 1) * pixels) if not native.isNoData(r, c)]
+                    if not values:
+                        self.assertTrue(block.isNoData(row, column))
+                    else:
+                        self.assertFalse(block.isNoData(row, column))
+                        expected = sum(values) / len(values)
+                        self.assertAlmostEqual(block.value(row, column), expected, delta=abs(expected) * 1e-5)
+
+        # each level is averaged from the native pixels, whether it is read from the provider
+        # or built from the level below
+        for level in range(1, 5):
+            checkLevel(createCache(), level)
+
+        # reading a level caches the finer levels it covers, and the coarser levels are
+        # built from the cached tiles
+        cache = createCache()
+        checkLevel(cache, 2)
+        reads = cache.readCount()
+        self.assertGreater(reads, 0)
+        for level in (1, 3, 4):
+            checkLevel(cache, level)
+        self.assertEqual(cache.readCount(), reads)
+
+        # blocks coarser than the pyramid are read from the provider
+        self.assertBlocksEqual(cache.block(1, extent, 1, 1), provider.block(1, extent, 1, 1))
+        self.assertEqual(cache.readCount(), reads + 1)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,96 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsRasterDrawer.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import os
+
+from qgis.core import (QgsRasterLayer,
+                       QgsRasterIterator,
+                       QgsRasterDrawer,
+                       QgsRasterViewPort,
+                       QgsRasterBlockFeedback,
+                       QgsMapToPixel,
+                       QgsPoint)
+from qgis.testing import start_app, unittest
+from qgis.PyQt.QtCore import QThreadPool
+from qgis.PyQt.QtGui import QImage, QPainter
+from utilities import unitTestDataPath
+
+start_app()
+
+
+class TestQgsRasterDrawer(unittest.TestCase):
+
+    def tearDown(self):
+        # avoid crash on finish, probably related to https://bugreports.qt.io/browse/QTBUG-35760
+        QThreadPool.globalInstance().waitForDone()
+
+    def drawLayer(self, layer, parallel, feedback=None, width=400, height=300, tileSize=(64, 48)):
+        extent = layer.extent()
+
+        viewPort = QgsRasterViewPort()
+        viewPort.mTopLeftPoint = QgsPoint(0, 0)
+        viewPort.mBottomRightPoint = QgsPoint(width, height)
+        viewPort.mWidth = width
+        viewPort.mHeight = height
+        viewPort.mDrawnExtent = extent
+        mapToPixel = QgsMapToPixel(extent.width() / width, extent.center().x(), extent.center().y(), width, height, 0)
+
+        image = QImage(width, height, QImage.Format_ARGB32_Premultiplied)
+        image.fill(0)
+        painter = QPainter(image)
+        iterator = QgsRasterIterator(layer.pipe().last())
+        if tileSize:
+            # force the raster to be read in many parts
+            iterator.setMaximumTileWidth(tileSize[0])
+            iterator.setMaximumTileHeight(tileSize[1])
+        drawer = QgsRasterDrawer(iterator)
+        drawer.setParallelRendering(parallel)
+        drawer.draw(painter, viewPort, mapToPixel, feedback)
+        painter.end()
+        return image
+
+    def testParallelRendering(self):
+        drawer = QgsRasterDrawer(None)
+        self.assertFalse(drawer.parallelRendering())
+        drawer.setParallelRendering(True)
+        self.assertTrue(drawer.parallelRendering())
+
+        layer = QgsRasterLayer(os.path.join(unitTestDataPath(), 'landsat.tif'), 'landsat')
+        self.assertTrue(layer.isValid())
+
+        sequential = self.drawLayer(layer, False)
+        parallel = self.drawLayer(layer, True)
+        self.assertEqual(sequential, parallel)
+        self.assertNotEqual(parallel.pixel(200, 150), 0)
+
+    def testParallelRenderingSingleTile(self):
+        # the viewport fits into a single tile, but is still split for parallel reading
+        layer = QgsRasterLayer(os.path.join(unitTestDataPath(), 'landsat.tif'), 'landsat')
+        sequential = self.drawLayer(layer, False, width=1024, height=768, tileSize=None)
+        parallel = self.drawLayer(layer, True, width=1024, height=768, tileSize=None)
+        self.assertEqual(sequential, parallel)
+        self.assertNotEqual(parallel.pixel(512, 384), 0)
+
+    def testCanceled(self):
+        layer = QgsRasterLayer(os.path.join(unitTestDataPath(), 'landsat.tif'), 'landsat')
+        feedback = QgsRasterBlockFeedback()
+        feedback.cancel()
+        image = self.drawLayer(layer, True, feedback)
+        self.assertEqual(image.pixel(200, 150), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,89 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsRasterProjector.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import os
+
+from qgis.core import (QgsRasterLayer,
+                       QgsRasterProjector,
+                       QgsCoordinateReferenceSystem,
+                       QgsCoordinateTransform)
+from qgis.testing import start_app, unittest
+from utilities import unitTestDataPath
+
+start_app()
+
+
+class TestQgsRasterProjector(unittest.TestCase):
+
+    def setUp(self):
+        self.layer = QgsRasterLayer(os.path.join(unitTestDataPath(), 'landsat.tif'), 'landsat')
+        self.assertTrue(self.layer.isValid())
+        self.destCrs = QgsCoordinateReferenceSystem('EPSG:4326')
+        ct = QgsCoordinateTransform(self.layer.crs(), self.destCrs)
+        self.extent = ct.transformBoundingBox(self.layer.extent())
+        # large enough to be reprojected with several threads
+        self.width = 400
+        self.height = 300
+
+    def createProjector(self, precision):
+        projector = QgsRasterProjector()
+        projector.setInput(self.layer.dataProvider())
+        projector.setCrs(self.layer.crs(), self.destCrs)
+        projector.setPrecision(precision)
+        return projector
+
+    def testSharedGrid(self):
+        """ Test that blocks reprojected with a cached grid are the same as with a new grid """
+        projector = self.createProjector(QgsRasterProjector.Approximate)
+        block = projector.block(1, self.extent, self.width, self.height)
+        self.assertTrue(block.isValid())
+        self.assertEqual(block.width(), self.width)
+        self.assertEqual(block.height(), self.height)
+        data = block.data()
+
+        # same projector, other band uses the same grid
+        self.assertEqual(projector.block(1, self.extent, self.width, self.height).data(), data)
+        self.assertEqual(projector.block(2, self.extent, self.width, self.height).data(),
+                         self.createProjector(QgsRasterProjector.Approximate).block(2, self.extent, self.width, self.height).data())
+
+        # clones share the cache
+        clone = projector.clone()
+        clone.setInput(self.layer.dataProvider())
+        self.assertEqual(clone.block(1, self.extent, self.width, self.height).data(), data)
+
+        # new projector
+        self.assertEqual(self.createProjector(QgsRasterProjector.Approximate).block(1, self.extent, self.width, self.height).data(), data)
+
+    def testApproximation(self):
+        """ Test that the approximation is close to the exact reprojection """
+        approximate = self.createProjector(QgsRasterProjector.Approximate).block(1, self.extent, self.width, self.height)
+        exact = self.createProjector(QgsRasterProjector.Exact).block(1, self.extent, self.width, self.height)
+        self.assertTrue(exact.isValid())
+
+        same = 0
+        data = 0
+        for row in range(self.height):
+            for col in range(self.width):
+                if not exact.isNoData(row, col):
+                    data += 1
+                    if not approximate.isNoData(row, col) and approximate.value(row, col) == exact.value(row, col):
+                        same += 1
+        self.assertGreater(data, self.width * self.height / 4)
+        self.assertGreater(same, 0.9 * data)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,136 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsRasterQuantileSketch.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import math
+import os
+import random
+
+from qgis.core import (QgsRasterLayer,
+                       QgsRasterQuantileSketch,
+                       QgsRasterMinMaxOrigin)
+from qgis.PyQt.QtXml import QDomDocument
+from qgis.testing import start_app, unittest
+from utilities import unitTestDataPath
+
+start_app()
+
+
+class TestQgsRasterQuantileSketch(unittest.TestCase):
+
+    def assertRankWithin(self, sortedValues, value, fraction, error):
+        """ Checks that the rank of value in sortedValues is within error of fraction """
+        below = sum(1 for v in sortedValues if v < value)
+        belowOrEqual = sum(1 for v in sortedValues if v <= value)
+        count = len(sortedValues)
+        self.assertLessEqual(below / count - error, fraction)
+        self.assertGreaterEqual(belowOrEqual / count + error, fraction)
+
+    def testEmpty(self):
+        sketch = QgsRasterQuantileSketch()
+        self.assertTrue(sketch.isEmpty())
+        self.assertEqual(sketch.count(), 0)
+        self.assertTrue(math.isnan(sketch.minimum()))
+        self.assertTrue(math.isnan(sketch.quantile(0.5)))
+        self.assertTrue(math.isnan(sketch.stdDev()))
+
+        sketch.add(float('nan'))
+        self.assertTrue(sketch.isEmpty())
+
+    def testQuantiles(self):
+        random.seed(3)
+        values = [random.gauss(10, 3) for _ in range(50000)]
+        sketch = QgsRasterQuantileSketch(0.01)
+        self.assertEqual(sketch.rankError(), 0.01)
+        for v in values:
+            sketch.add(v)
+        self.assertEqual(sketch.count(), len(values))
+        # memory is bounded
+        self.assertLess(sketch.retainedCount(), 2000)
+
+        sortedValues = sorted(values)
+        self.assertEqual(sketch.minimum(), sortedValues[0])
+        self.assertEqual(sketch.maximum(), sortedValues[-1])
+        self.assertEqual(sketch.quantile(0), sortedValues[0])
+        self.assertEqual(sketch.quantile(1), sortedValues[-1])
+        mean = sum(values) / len(values)
+        self.assertAlmostEqual(sketch.mean(), mean, 6)
+        stdDev = math.sqrt(sum((v - mean) ** 2 for v in values) / (len(values) - 1))
+        self.assertAlmostEqual(sketch.stdDev(), stdDev, 6)
+
+        for fraction in (0.02, 0.1, 0.5, 0.9, 0.98):
+            self.assertRankWithin(sortedValues, sketch.quantile(fraction), fraction, 0.01)
+            self.assertAlmostEqual(sketch.rank(sortedValues[int(fraction * len(values))]), fraction, delta=0.01)
+
+    def testMerge(self):
+        random.seed(5)
+        values = [random.uniform(-100, 100) for _ in range(40000)]
+        parts = [QgsRasterQuantileSketch(0.01) for _ in range(4)]
+        for i, v in enumerate(values):
+            parts[i % 4].add(v)
+        sketch = QgsRasterQuantileSketch(0.01)
+        for part in parts:
+            sketch.merge(part)
+        self.assertEqual(sketch.count(), len(values))
+
+        sortedValues = sorted(values)
+        self.assertEqual(sketch.minimum(), sortedValues[0])
+        self.assertEqual(sketch.maximum(), sortedValues[-1])
+        self.assertAlmostEqual(sketch.mean(), sum(values) / len(values), 6)
+        for fraction in (0.02, 0.25, 0.5, 0.75, 0.98):
+            self.assertRankWithin(sortedValues, sketch.quantile(fraction), fraction, 0.01)
+
+    def testRaster(self):
+        path = os.path.join(unitTestDataPath('raster'), 'band1_float32_noct_epsg4326.tif')
+        layer = QgsRasterLayer(path, 'test')
+        self.assertTrue(layer.isValid())
+        provider = layer.dataProvider()
+
+        block = provider.block(1, layer.extent(), layer.width(), layer.height())
+        values = sorted(block.value(row, column) for row in range(block.height()) for column in range(block.width())
+                        if not block.isNoData(row, column))
+
+        sketch = provider.quantileSketch(1, 0.01)
+        # few values are kept exactly
+        self.assertEqual(sketch.count(), len(values))
+        self.assertEqual(sketch.minimum(), values[0])
+        self.assertEqual(sketch.maximum(), values[-1])
+        stats = provider.bandStatistics(1)
+        self.assertAlmostEqual(sketch.mean(), stats.mean, delta=abs(stats.mean) * 1e-6 + 1e-6)
+        for fraction in (0.02, 0.5, 0.98):
+            self.assertRankWithin(values, sketch.quantile(fraction), fraction, 0.01)
+
+        # cached sketches are reused for the same or larger errors
+        self.assertEqual(provider.quantileSketch(1, 0.05).rankError(), 0.01)
+        self.assertEqual(provider.quantileSketch(1, 0.001).rankError(), 0.001)
+
+    def testMinMaxOrigin(self):
+        origin = QgsRasterMinMaxOrigin()
+        self.assertEqual(origin.quantileRankError(), 0)
+        origin.setQuantileRankError(0.005)
+        self.assertEqual(origin.quantileRankError(), 0.005)
+        self.assertFalse(origin == QgsRasterMinMaxOrigin())
+
+        doc = QDomDocument()
+        elem = doc.createElement('minMaxOrigin')
+        origin.writeXml(doc, elem)
+        restored = QgsRasterMinMaxOrigin()
+        restored.readXml(elem)
+        self.assertEqual(restored.quantileRankError(), 0.005)
+        self.assertTrue(restored == origin)
+
+
+if __name__ == '__main__':
+    unittest.main()
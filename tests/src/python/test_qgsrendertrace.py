@@ -0,0 +1,124 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsRenderTrace.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import json
+import os
+import tempfile
+
+from qgis.core import (QgsRenderTrace,
+                       QgsMapRendererParallelJob,
+                       QgsMapRendererSequentialJob,
+                       QgsVectorLayer,
+                       QgsFeature,
+                       QgsGeometry,
+                       QgsMapSettings,
+                       QgsRectangle,
+                       QgsPoint)
+from qgis.testing import start_app, unittest
+from qgis.PyQt.QtCore import QSize, QThreadPool
+
+app = start_app()
+
+
+class TestQgsRenderTrace(unittest.TestCase):
+
+    def tearDown(self):
+        # avoid crash on finish, probably related to https://bugreports.qt.io/browse/QTBUG-35760
+        QThreadPool.globalInstance().waitForDone()
+
+    def testAddSpan(self):
+        trace = QgsRenderTrace()
+        self.assertEqual(trace.spanCount(), 0)
+        trace.addSpan('span', 'test', 10, 20, {'features': 5})
+        self.assertEqual(trace.spanCount(), 1)
+        self.assertGreaterEqual(trace.elapsed(), 0)
+
+        events = json.loads(bytes(trace.toChromeTrace()).decode())['traceEvents']
+        self.assertEqual(len(events), 1)
+        self.assertEqual(events[0]['name'], 'span')
+        self.assertEqual(events[0]['cat'], 'test')
+        self.assertEqual(events[0]['ph'], 'X')
+        self.assertEqual(events[0]['ts'], 10)
+        self.assertEqual(events[0]['dur'], 20)
+        self.assertEqual(events[0]['args']['features'], 5)
+
+        trace.clear()
+        self.assertEqual(trace.spanCount(), 0)
+
+    def testWriteChromeTrace(self):
+        trace = QgsRenderTrace()
+        trace.addSpan('span', 'test', 0, 1)
+        path = os.path.join(tempfile.mkdtemp(), 'trace.json')
+        self.assertTrue(trace.writeChromeTrace(path))
+        with open(path) as f:
+            self.assertEqual(len(json.load(f)['traceEvents']), 1)
+
+    def checkRenderJob(self, job_type):
+        layer = QgsVectorLayer("Point?field=fldtxt:string", "layer1", "memory")
+        features = []
+        for i in range(10):
+            f = QgsFeature()
+            f.setGeometry(QgsGeometry.fromPoint(QgsPoint(i, i)))
+            features.append(f)
+        layer.dataProvider().addFeatures(features)
+
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(-1, -1, 11, 11))
+        settings.setOutputSize(QSize(200, 200))
+        settings.setLayers([layer])
+
+        trace = QgsRenderTrace()
+        job = job_type(settings)
+        job.setRenderTrace(trace)
+        self.assertEqual(job.renderTrace(), trace)
+        job.start()
+        job.waitForFinished()
+
+        events = json.loads(bytes(trace.toChromeTrace()).decode())['traceEvents']
+        names = [e['name'] for e in events]
+        self.assertIn('layer1', names)
+        self.assertIn('Prepare', names)
+        self.assertIn('Labeling', names)
+        if job_type == QgsMapRendererParallelJob:
+            self.assertIn('Compose image', names)
+
+        draw = [e for e in events if e['name'] == 'Draw features'][0]
+        self.assertEqual(draw['cat'], 'vector')
+        self.assertEqual(draw['args']['layer_id'], layer.id())
+        self.assertEqual(draw['args']['features'], 10)
+        self.assertEqual(draw['args']['vertices'], 10)
+
+    def testParallelJob(self):
+        self.checkRenderJob(QgsMapRendererParallelJob)
+
+    def testSequentialJob(self):
+        self.checkRenderJob(QgsMapRendererSequentialJob)
+
+    def testNoTrace(self):
+        layer = QgsVectorLayer("Point?field=fldtxt:string", "layer1", "memory")
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(-1, -1, 11, 11))
+        settings.setOutputSize(QSize(200, 200))
+        settings.setLayers([layer])
+
+        job = QgsMapRendererParallelJob(settings)
+        self.assertIsNone(job.renderTrace())
+        job.start()
+        job.waitForFinished()
+
+
+if __name__ == '__main__':
+    unittest.main()
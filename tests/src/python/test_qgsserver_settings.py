@@ -133,6 +133,16 @@ class TestQgsServerSettings(unittest.TestCase):
         self.assertEqual(self.settings.cacheDirectory(), "/tmp/fake")
         os.environ.pop(env)
 
+    def test_env_render_trace_max_files(self):
+        env = "QGIS_SERVER_RENDER_TRACE_MAX_FILES"
+
+        self.assertEqual(self.settings.renderTraceMaxFiles(), 100)
+
+        os.environ[env] = "10"
+        self.settings.load()
+        self.assertEqual(self.settings.renderTraceMaxFiles(), 10)
+        os.environ.pop(env)
+
     def test_priority(self):
         env = "QGIS_OPTIONS_PATH"
         dpath = "conf0"
@@ -0,0 +1,137 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsSvgCache.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import os
+import shutil
+import tempfile
+
+from qgis.PyQt.QtGui import QColor
+from qgis.core import QgsSvgCache
+from qgis.testing import start_app, unittest
+from utilities import unitTestDataPath
+
+start_app()
+TEST_DATA_DIR = unitTestDataPath()
+
+
+class TestQgsSvgCache(unittest.TestCase):
+
+    def setUp(self):
+        self.svg = os.path.join(TEST_DATA_DIR, 'sample_svg.svg')
+        self.cache_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.cache_dir, True)
+
+    def image(self, cache, size=30, color=QColor(255, 0, 0)):
+        image, fits_in_cache = cache.svgAsImage(self.svg, size, color, QColor(0, 0, 0), 1, 1)
+        self.assertTrue(fits_in_cache)
+        return image
+
+    def testStatistics(self):
+        cache = QgsSvgCache()
+        image = self.image(cache)
+        self.assertFalse(image.isNull())
+        self.assertEqual(cache.imageCacheMisses(), 1)
+        self.assertEqual(cache.imageCacheHits(), 0)
+        self.assertEqual(self.image(cache), image)
+        self.assertEqual(cache.imageCacheHits(), 1)
+        self.image(cache, color=QColor(0, 255, 0))
+        self.assertEqual(cache.imageCacheMisses(), 2)
+        cache.resetStatistics()
+        self.assertEqual(cache.imageCacheHits(), 0)
+        self.assertEqual(cache.imageCacheMisses(), 0)
+
+    def testMaximumSize(self):
+        cache = QgsSvgCache()
+        self.image(cache, 100)
+        size = cache.cacheSize()
+        self.assertGreaterEqual(size, 100 * 100 * 4)
+        # only room for a single image, least recently used ones get removed
+        cache.setMaximumCacheSize(int(size * 1.5))
+        self.assertEqual(cache.maximumCacheSize(), int(size * 1.5))
+        self.image(cache, 100, QColor(0, 255, 0))
+        self.assertLessEqual(cache.cacheSize(), cache.maximumCacheSize())
+        self.image(cache, 100, QColor(0, 255, 0))
+        self.assertEqual(cache.imageCacheHits(), 1)
+        self.image(cache, 100)
+        self.assertEqual(cache.imageCacheMisses(), 3)
+
+    def testSharedCache(self):
+        # two caches sharing a directory, like two server processes
+        cache1 = QgsSvgCache()
+        cache1.setSharedCacheDirectory(self.cache_dir)
+        self.assertEqual(cache1.sharedCacheDirectory(), self.cache_dir)
+        cache2 = QgsSvgCache()
+        cache2.setSharedCacheDirectory(self.cache_dir)
+
+        image1 = self.image(cache1)
+        self.assertEqual(cache1.sharedImageCacheHits(), 0)
+        self.assertEqual(len(os.listdir(self.cache_dir)), 1)
+
+        image2 = self.image(cache2)
+        self.assertEqual(cache2.sharedImageCacheHits(), 1)
+        self.assertEqual(image1, image2)
+
+        # different parameters are not shared
+        self.image(cache2, color=QColor(0, 0, 255))
+        self.assertEqual(cache2.sharedImageCacheHits(), 1)
+        self.assertEqual(len(os.listdir(self.cache_dir)), 2)
+
+        # images from the shared cache can be modified without affecting the cache
+        image2.fill(0)
+        self.assertEqual(self.image(cache2), image1)
+
+        cache2.setSharedCacheDirectory('')
+        self.assertEqual(cache2.sharedCacheDirectory(), '')
+
+    def testSharedCacheEviction(self):
+        cache1 = QgsSvgCache()
+        cache1.setSharedCacheDirectory(self.cache_dir)
+        self.image(cache1)
+        file_size = os.path.getsize(os.path.join(self.cache_dir, os.listdir(self.cache_dir)[0]))
+
+        # room for two images, the least recently used one gets removed
+        cache1.setMaximumSharedCacheSize(file_size * 2)
+        self.assertEqual(cache1.maximumSharedCacheSize(), file_size * 2)
+        self.image(cache1, color=QColor(0, 255, 0))
+        self.assertEqual(len(os.listdir(self.cache_dir)), 2)
+        for name in os.listdir(self.cache_dir):
+            path = os.path.join(self.cache_dir, name)
+            os.utime(path, (os.path.getmtime(path) - 100, os.path.getmtime(path) - 100))
+
+        # using the older image makes the other one the least recently used
+        cache2 = QgsSvgCache()
+        cache2.setSharedCacheDirectory(self.cache_dir)
+        cache2.setMaximumSharedCacheSize(file_size * 2)
+        self.image(cache2)
+        self.assertEqual(cache2.sharedImageCacheHits(), 1)
+        self.image(cache2, color=QColor(0, 0, 255))
+        self.assertEqual(len(os.listdir(self.cache_dir)), 2)
+
+        cache3 = QgsSvgCache()
+        cache3.setSharedCacheDirectory(self.cache_dir)
+        cache3.setMaximumSharedCacheSize(file_size * 2)
+        self.image(cache3)
+        self.image(cache3, color=QColor(0, 0, 255))
+        self.assertEqual(cache3.sharedImageCacheHits(), 2)
+        self.image(cache3, color=QColor(0, 255, 0))
+        self.assertEqual(cache3.sharedImageCacheHits(), 2)
+        self.assertEqual(len(os.listdir(self.cache_dir)), 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,125 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsTileSeeder.
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2026'
+__copyright__ = 'Copyright 2026, The QGIS Project'
+# This will get replaced with a git SHA1 when you do a git archive
+__revision__ = '$Format:%H$'
+
+import qgis  # NOQA
+
+import os
+import tempfile
+
+from qgis.core import (QgsTileSeeder,
+                       QgsVectorLayer,
+                       QgsFeature,
+                       QgsGeometry,
+                       QgsMapSettings,
+                       QgsRectangle,
+                       QgsFeedback)
+from qgis.testing import start_app, unittest
+from qgis.PyQt.QtCore import QThreadPool
+from qgis.PyQt.QtGui import QColor
+
+app = start_app()
+
+WORLD = 20037508.342789244
+
+
+class CollectingSeeder(QgsTileSeeder):
+
+    def __init__(self, settings):
+        QgsTileSeeder.__init__(self, settings)
+        self.tiles = {}
+        self.vectorTiles = {}
+
+    def writeTile(self, x, y, zoom, image):
+        self.tiles[(zoom, x, y)] = image
+        return True
+
+    def writeVectorTile(self, x, y, zoom, tile):
+        self.vectorTiles[(zoom, x, y)] = tile
+        return True
+
+
+class TestQgsTileSeeder(unittest.TestCase):
+
+    def tearDown(self):
+        # avoid crash on finish, probably related to https://bugreports.qt.io/browse/QTBUG-35760
+        QThreadPool.globalInstance().waitForDone()
+
+    def createSettings(self):
+        # a polygon covering most of the north eastern quarter of the world, kept away from the
+        # tile edges so that no outline is drawn on neighbouring tiles
+        inset = WORLD / 50
+        layer = QgsVectorLayer("Polygon?crs=epsg:3857&field=name:string", "quarter", "memory")
+        f = QgsFeature(layer.fields())
+        f.setAttributes(['ne'])
+        f.setGeometry(QgsGeometry.fromRect(QgsRectangle(inset, inset, WORLD - inset, WORLD - inset)))
+        layer.dataProvider().addFeatures([f])
+        self.layer = layer
+
+        settings = QgsMapSettings()
+        settings.setLayers([layer])
+        settings.setBackgroundColor(QColor(0, 0, 0, 0))
+        return settings
+
+    def testTileExtent(self):
+        self.assertEqual(QgsTileSeeder.tileExtent(0, 0, 0), QgsRectangle(-WORLD, -WORLD, WORLD, WORLD))
+        self.assertEqual(QgsTileSeeder.tileExtent(1, 0, 1), QgsRectangle(0, 0, WORLD, WORLD))
+        self.assertEqual(QgsTileSeeder.tileExtent(0, 1, 1), QgsRectangle(-WORLD, -WORLD, 0, 0))
+
+    def testSeed(self):
+        seeder = CollectingSeeder(self.createSettings())
+        seeder.setMetaTileSize(2)
+        seeder.setMaximumParallelMetaTiles(2)
+        feedback = QgsFeedback()
+        written = seeder.seed(QgsRectangle(-WORLD, -WORLD, WORLD, WORLD), 0, 2, feedback)
+        self.assertEqual(feedback.progress(), 100)
+
+        # empty tiles are skipped: 1 tile at zoom 0, the north eastern tile at zoom 1 and 4 tiles at zoom 2
+        self.assertEqual(written, 6)
+        self.assertEqual(sorted(seeder.tiles.keys()), [(0, 0, 0), (1, 1, 0),
+                                                        (2, 2, 0), (2, 2, 1), (2, 3, 0), (2, 3, 1)])
+        for image in seeder.tiles.values():
+            self.assertEqual(image.width(), 256)
+            self.assertEqual(image.height(), 256)
+
+        # the layer fills the whole tile, apart from the outline
+        image = seeder.tiles[(2, 3, 0)]
+        self.assertEqual(image.pixelColor(128, 128).alpha(), 255)
+
+    def testSeedToDirectory(self):
+        seeder = QgsTileSeeder(self.createSettings())
+        directory = tempfile.mkdtemp()
+        seeder.setOutputDirectory(directory)
+        self.assertEqual(seeder.seed(QgsRectangle(1, 1, WORLD, WORLD), 1, 1), 1)
+        self.assertTrue(os.path.exists(os.path.join(directory, '1', '1', '0.png')))
+
+    def testSeedVectorTiles(self):
+        seeder = CollectingSeeder(self.createSettings())
+        seeder.setMetaTileSize(4)
+        written = seeder.seedVectorTiles(QgsRectangle(-WORLD, -WORLD, WORLD, WORLD), 0, 2)
+        self.assertEqual(written, len(seeder.vectorTiles))
+        self.assertIn((0, 0, 0), seeder.vectorTiles)
+        self.assertIn((2, 3, 0), seeder.vectorTiles)
+        self.assertNotIn((2, 0, 3), seeder.vectorTiles)
+        self.assertIn(b'quarter', bytes(seeder.vectorTiles[(1, 1, 0)]))
+
+    def testCancel(self):
+        seeder = CollectingSeeder(self.createSettings())
+        feedback = QgsFeedback()
+        feedback.cancel()
+        self.assertEqual(seeder.seed(QgsRectangle(-WORLD, -WORLD, WORLD, WORLD), 0, 2, feedback), 0)
+        self.assertEqual(seeder.seedVectorTiles(QgsRectangle(-WORLD, -WORLD, WORLD, WORLD), 0, 2, feedback), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()